@@ -51,6 +51,10 @@ IF (WALRUS_JIT)
     SET (WALRUS_DEFINITIONS ${WALRUS_DEFINITIONS} -DWALRUS_ENABLE_JIT)
 ENDIF()
 
+IF (WALRUS_COMPACT_BYTECODE)
+    SET (WALRUS_DEFINITIONS ${WALRUS_DEFINITIONS} -DWALRUS_COMPACT_BYTECODE)
+ENDIF()
+
 #######################################################
 # FLAGS FOR TEST
 #######################################################
@@ -149,4 +149,18 @@ ELSEIF (${WALRUS_OUTPUT} STREQUAL "api_test")
     c_api_example(table)
 #c_api_example(trap)
 #c_api_example(threads)
+
+    function(walrus_api_test NAME)
+        set(EXENAME walrus-api-${NAME})
+        add_executable(${EXENAME} ${WALRUS_ROOT}/test/api/${NAME}.c)
+        if (NOT COMPILER_IS_MSVC)
+            set_target_properties(${EXENAME} PROPERTIES COMPILE_FLAGS "-std=gnu11 -g3")
+        endif ()
+
+        target_link_libraries(${EXENAME} ${WALRUS_TARGET})
+    endfunction()
+
+    walrus_api_test(shared_module)
+    walrus_api_test(type_churn)
+    walrus_api_test(trap_loop)
 ENDIF()
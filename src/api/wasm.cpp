@@ -32,6 +32,8 @@
 #include "runtime/Trap.h"
 #include "runtime/TypeStore.h"
 #include "parser/WASMParser.h"
+#include "wabt/binary-reader.h"
+#include "wabt/walrus/binary-reader-walrus.h"
 
 using namespace Walrus;
 
@@ -89,6 +91,16 @@ struct wasm_exporttype_t {
 };
 
 struct wasm_config_t {
+    wasm_config_t()
+        : useJIT(false)
+        , hasGCOptions(false)
+    {
+    }
+
+    EngineOptions options;
+    bool useJIT;
+    bool hasGCOptions;
+    walrus_gc_options_t gcOptions;
 };
 
 struct wasm_engine_t {
@@ -99,7 +111,7 @@ struct wasm_engine_t {
 
     ~wasm_engine_t()
     {
-        delete engine;
+        engine->releaseRef();
     }
 
     Engine* get() const
@@ -325,6 +337,22 @@ struct wasm_module_t : wasm_ref_t {
     }
 };
 
+// Keeps the module alive until it is obtained by other stores.
+struct wasm_shared_module_t {
+    wasm_shared_module_t(Module* m)
+        : module(m)
+    {
+        module->addRef();
+    }
+
+    ~wasm_shared_module_t()
+    {
+        module->releaseRef();
+    }
+
+    Module* module;
+};
+
 struct wasm_func_t : wasm_extern_t {
     wasm_func_t(const wasm_func_t& other)
         : wasm_extern_t(other.get(), other.type()->clone())
@@ -637,9 +665,74 @@ const wasm_externtype_t* wasm_exporttype_type(const wasm_exporttype_t* exportTyp
 // Configuration
 own wasm_config_t* wasm_config_new()
 {
-    // TODO
-    RELEASE_ASSERT_NOT_REACHED();
-    return nullptr;
+    return new wasm_config_t();
+}
+
+void walrus_config_set_strategy(wasm_config_t* config, walrus_strategy_t strategy)
+{
+    config->useJIT = (strategy == WALRUS_STRATEGY_JIT);
+}
+
+void walrus_config_set_register_allocator(wasm_config_t* config, walrus_regalloc_t regalloc)
+{
+    config->options.jitFlags &= ~(JITFlagValue::disableRegAlloc | JITFlagValue::linearScanRegAlloc);
+    switch (regalloc) {
+    case WALRUS_REGALLOC_LINEAR_SCAN:
+        config->options.jitFlags |= JITFlagValue::linearScanRegAlloc;
+        break;
+    case WALRUS_REGALLOC_DISABLED:
+        config->options.jitFlags |= JITFlagValue::disableRegAlloc;
+        break;
+    default:
+        break;
+    }
+}
+
+void walrus_config_set_optimize_bytecode(wasm_config_t* config, bool enable)
+{
+    if (enable) {
+        config->options.jitFlags |= JITFlagValue::optimizeByteCode;
+    } else {
+        config->options.jitFlags &= ~JITFlagValue::optimizeByteCode;
+    }
+}
+
+void walrus_config_set_web_assembly3(wasm_config_t* config, bool enable)
+{
+    if (enable) {
+        config->options.featureFlags |= wabt::FeatureFlagValue::enableWebAssembly3;
+    } else {
+        config->options.featureFlags &= ~wabt::FeatureFlagValue::enableWebAssembly3;
+    }
+}
+
+void walrus_config_set_memory_reservation(wasm_config_t* config, uint64_t size)
+{
+    config->options.memoryReservedSize = size;
+}
+
+void walrus_config_set_memory_huge_pages(wasm_config_t* config, bool enable)
+{
+    if (enable) {
+        config->options.memoryFlags |= MemoryFlagValue::memoryHugePages;
+    } else {
+        config->options.memoryFlags &= ~MemoryFlagValue::memoryHugePages;
+    }
+}
+
+void walrus_config_set_memory_prefault(wasm_config_t* config, bool enable)
+{
+    if (enable) {
+        config->options.memoryFlags |= MemoryFlagValue::memoryPrefault;
+    } else {
+        config->options.memoryFlags &= ~MemoryFlagValue::memoryPrefault;
+    }
+}
+
+void walrus_config_set_gc_options(wasm_config_t* config, const walrus_gc_options_t* options)
+{
+    config->hasGCOptions = true;
+    config->gcOptions = *options;
 }
 
 // Engine
@@ -648,11 +741,24 @@ own wasm_engine_t* wasm_engine_new()
     return new wasm_engine_t(new Engine());
 }
 
-own wasm_engine_t* wasm_engine_new_with_config(own wasm_config_t*)
+own wasm_engine_t* wasm_engine_new_with_config(own wasm_config_t* config)
 {
-    // TODO
-    RELEASE_ASSERT_NOT_REACHED();
-    return nullptr;
+    ASSERT(config);
+    EngineOptions options = config->options;
+
+#if defined(WALRUS_ENABLE_JIT)
+    if (config->useJIT) {
+        options.jitFlags |= JITFlagValue::useJIT;
+    }
+#endif
+
+    if (config->hasGCOptions) {
+        // Ignored when a store already exists.
+        walrus_gc_set_options(&config->gcOptions);
+    }
+
+    wasm_config_delete(config);
+    return new wasm_engine_t(new Engine(options));
 }
 
 // Store
@@ -662,6 +768,41 @@ own wasm_store_t* wasm_store_new(wasm_engine_t* engine)
     return new wasm_store_t(new Store(engine->get()));
 }
 
+bool walrus_gc_set_options(const walrus_gc_options_t* options)
+{
+    GCOptions gcOptions;
+    gcOptions.markerThreads = options->marker_threads;
+    switch (options->mode) {
+    case WALRUS_GC_INCREMENTAL:
+        gcOptions.mode = GCOptions::Incremental;
+        break;
+    case WALRUS_GC_GENERATIONAL:
+        gcOptions.mode = GCOptions::Generational;
+        break;
+    default:
+        gcOptions.mode = GCOptions::Default;
+        break;
+    }
+    gcOptions.freeSpaceDivisor = options->free_space_divisor;
+    gcOptions.initialHeapSize = options->initial_heap_size;
+    gcOptions.maxHeapSize = options->max_heap_size;
+    return Store::setGCOptions(gcOptions);
+}
+
+void walrus_store_gc_stats(const wasm_store_t* store, walrus_gc_stats_t* out)
+{
+    static_assert(WALRUS_GC_PAUSE_HISTOGRAM_SIZE == GCStatistics::PauseHistogramSize, "histogram sizes must match");
+    GCStatistics statistics = store->get()->gcStatistics();
+
+    out->collections = statistics.collections;
+    out->total_pause_time = statistics.totalPauseTime;
+    out->max_pause_time = statistics.maxPauseTime;
+    memcpy(out->pause_histogram, statistics.pauseHistogram, sizeof(out->pause_histogram));
+    out->process_bytes_allocated = statistics.processBytesAllocated;
+    out->heap_size = statistics.heapSize;
+    out->recursive_types = statistics.recursiveTypes;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
 
@@ -809,7 +950,9 @@ void wasm_trap_trigger(const char* message, size_t length)
 // Modules
 own wasm_module_t* wasm_module_new(wasm_store_t* store, const wasm_byte_vec_t* binary)
 {
-    auto parseResult = WASMParser::parseBinary(store->get(), std::string(), reinterpret_cast<uint8_t*>(binary->data), binary->size);
+    const EngineOptions& options = store->get()->engine()->options();
+    auto parseResult = WASMParser::parseBinary(store->get(), std::string(), reinterpret_cast<uint8_t*>(binary->data), binary->size,
+                                               options.jitFlags, options.featureFlags);
     if (!parseResult.first.hasValue()) {
         return nullptr;
     }
@@ -818,7 +961,9 @@ own wasm_module_t* wasm_module_new(wasm_store_t* store, const wasm_byte_vec_t* b
 
 bool wasm_module_validate(wasm_store_t* store, const wasm_byte_vec_t* binary)
 {
-    auto parseResult = WASMParser::parseBinary(store->get(), std::string(), reinterpret_cast<uint8_t*>(binary->data), binary->size);
+    // Validation does not need the code to be compiled.
+    auto parseResult = WASMParser::parseBinary(store->get(), std::string(), reinterpret_cast<uint8_t*>(binary->data), binary->size,
+                                               0, store->get()->engine()->options().featureFlags);
     if (!parseResult.first.hasValue()) {
         return false;
     }
@@ -900,6 +1045,23 @@ own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*
     return nullptr;
 }
 
+own wasm_shared_module_t* wasm_module_share(const wasm_module_t* module)
+{
+    return new wasm_shared_module_t(module->get());
+}
+
+own wasm_module_t* wasm_module_obtain(wasm_store_t* store, const wasm_shared_module_t* shared)
+{
+    // The parsed byte code, the types and the compiled
+    // code are reused, only a new reference is created.
+    if (shared->module->engine() != store->get()->engine()) {
+        return nullptr;
+    }
+
+    store->get()->appendModule(shared->module);
+    return new wasm_module_t(shared->module);
+}
+
 // Function Instances
 static FunctionType* ToWalrusFunctionType(const wasm_functype_t* ft)
 {
@@ -1020,7 +1182,7 @@ own wasm_trap_t* wasm_func_call(
     auto trapResult = trap.run([](ExecutionState& state, void* d) {
         RunData* data = reinterpret_cast<RunData*>(d);
 
-        data->fn->call(state, data->args.data(), data->results.data());
+        data->fn->tryCall(state, data->args.data(), data->results.data());
     },
                                &data);
 
@@ -1043,6 +1205,92 @@ own wasm_trap_t* wasm_func_call(
     return nullptr;
 }
 
+static bool SupportsSlot(Value::Type type)
+{
+    return type == Value::Type::I32 || type == Value::Type::I64 || type == Value::Type::F32 || type == Value::Type::F64;
+}
+
+static bool SupportsSlots(const wasm_valtype_vec_t* types)
+{
+    for (size_t i = 0; i < types->size; i++) {
+        if (!SupportsSlot(types->data[i]->type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool walrus_functype_supports_slots(const wasm_functype_t* ft)
+{
+    return SupportsSlots(&ft->params) && SupportsSlots(&ft->results);
+}
+
+own wasm_func_t* walrus_func_new_unchecked(
+    wasm_store_t* store, const wasm_functype_t* ft, walrus_func_callback_unchecked_t callback,
+    void* env)
+{
+    if (!walrus_functype_supports_slots(ft)) {
+        return nullptr;
+    }
+
+    ImportedSlotFunction* func = ImportedSlotFunction::createImportedSlotFunction(
+        store->get(),
+        ToWalrusFunctionType(ft),
+        [=](ExecutionState& state, uint64_t* slots, void* d) {
+            auto trap = callback(env, slots);
+
+            if (trap) {
+                std::string message(trap->message.data, trap->message.size);
+                wasm_trap_delete(trap);
+                Trap::throwException(state, message);
+            }
+        },
+        nullptr);
+
+    return new wasm_func_t(func, ft->clone());
+}
+
+own wasm_trap_t* walrus_func_call_unchecked(
+    const wasm_func_t* func, walrus_slot_t* slots)
+{
+    return walrus_func_call_batch(func, slots, 1, nullptr);
+}
+
+own wasm_trap_t* walrus_func_call_batch(
+    const wasm_func_t* func, walrus_slot_t* slots, size_t count, size_t* trap_index)
+{
+    ASSERT(walrus_functype_supports_slots(func->type()));
+
+    struct RunData {
+        Function* fn;
+        walrus_slot_t* slots;
+        size_t count;
+        size_t index;
+    } data = { func->get(), slots, count, 0 };
+    Trap trap;
+    auto trapResult = trap.run([](ExecutionState& state, void* d) {
+        RunData* data = reinterpret_cast<RunData*>(d);
+        const FunctionType* functionType = data->fn->functionType();
+        size_t slotCount = std::max(functionType->param().size(), functionType->result().size());
+
+        for (; data->index < data->count; data->index++) {
+            if (!data->fn->callWithSlots(state, data->slots + data->index * slotCount)) {
+                return;
+            }
+        }
+    },
+                               &data);
+
+    if (trap_index != nullptr) {
+        *trap_index = data.index;
+    }
+
+    if (trapResult.exception) {
+        return new wasm_trap_t(new Trap(), trapResult.exception->message());
+    }
+    return nullptr;
+}
+
 // Global Instances
 own wasm_global_t* wasm_global_new(
     wasm_store_t* store, const wasm_globaltype_t* gt, const wasm_val_t* val)
@@ -1233,10 +1481,11 @@ own wasm_instance_t* wasm_instance_new(
     own wasm_trap_t** outTrap)
 {
     struct RunData {
+        Store* store;
         Module* module;
         ExternVector importValues;
         Instance* instance;
-    } data = { module->get(), ExternVector(), nullptr };
+    } data = { store->get(), module->get(), ExternVector(), nullptr };
 
     data.importValues.reserve(imports->size);
     for (size_t i = 0; i < imports->size; i++) {
@@ -1246,7 +1495,7 @@ own wasm_instance_t* wasm_instance_new(
     Walrus::Trap trap;
     auto trapResult = trap.run([](ExecutionState& state, void* d) {
         RunData* data = reinterpret_cast<RunData*>(d);
-        data->instance = data->module->instantiate(state, data->importValues);
+        data->instance = data->module->instantiate(state, data->store, data->importValues);
     },
                                &data);
 
@@ -1325,7 +1574,7 @@ uint32_t wasm_instance_func_index(const wasm_instance_t* ins, const wasm_func_t*
     }
 
 //WASM_IMPL_OWN(frame);
-//WASM_IMPL_OWN(config);
+WASM_IMPL_OWN(config);
 WASM_IMPL_OWN(engine);
 WASM_IMPL_OWN(store);
 
@@ -1514,7 +1763,7 @@ WASM_IMPL_REF(module); // FIXME
             const_cast<wasm_shared_##name##_t*>(t));                           \
     }
 
-//WASM_IMPL_SHARABLE_REF(module)
+WASM_IMPL_OWN(shared_module);
 
 #define WASM_IMPL_EXTERN(name)                                                 \
     const wasm_##name##type_t* wasm_externtype_as_##name##type_const(          \
@@ -128,6 +128,7 @@ WASM_DECLARE_OWN(config)
 WASM_API_EXTERN own wasm_config_t* wasm_config_new(void);
 
 // Embedders may provide custom functions for manipulating configs.
+// See the walrus_config functions below.
 
 
 // Engine
@@ -145,6 +146,77 @@ WASM_DECLARE_OWN(store)
 WASM_API_EXTERN own wasm_store_t* wasm_store_new(wasm_engine_t*);
 
 
+// Garbage collector (walrus extension)
+
+typedef uint8_t walrus_gc_mode_t;
+enum walrus_gc_mode_enum {
+  WALRUS_GC_DEFAULT,
+  WALRUS_GC_INCREMENTAL,
+  WALRUS_GC_GENERATIONAL,
+};
+
+// Zero values keep the defaults of the collector.
+typedef struct walrus_gc_options_t {
+  uint32_t marker_threads;
+  walrus_gc_mode_t mode;
+  uint32_t free_space_divisor;
+  size_t initial_heap_size;
+  size_t max_heap_size;
+} walrus_gc_options_t;
+
+// The heap is shared by all stores: returns false after the first store is created.
+WASM_API_EXTERN bool walrus_gc_set_options(const walrus_gc_options_t*);
+
+#define WALRUS_GC_PAUSE_HISTOGRAM_SIZE 8
+
+// Pause times are in microseconds. Bucket n of the histogram counts
+// pauses in [2^(n-1), 2^n) milliseconds, bucket 0 is below 1ms.
+// The allocated bytes and the heap size are process-wide, because the
+// heap is shared: they include the allocations of every store. The
+// recursive types are the type groups kept by the engine of the store.
+typedef struct walrus_gc_stats_t {
+  uint64_t collections;
+  uint64_t total_pause_time;
+  uint64_t max_pause_time;
+  uint64_t pause_histogram[WALRUS_GC_PAUSE_HISTOGRAM_SIZE];
+  uint64_t process_bytes_allocated;
+  uint64_t heap_size;
+  uint64_t recursive_types;
+} walrus_gc_stats_t;
+
+WASM_API_EXTERN void walrus_store_gc_stats(const wasm_store_t*, walrus_gc_stats_t* out);
+
+
+// Configuration (walrus extension)
+
+typedef uint8_t walrus_strategy_t;
+enum walrus_strategy_enum {
+  WALRUS_STRATEGY_INTERPRETER,
+  // Falls back to the interpreter when the JIT compiler is not available.
+  WALRUS_STRATEGY_JIT,
+};
+
+typedef uint8_t walrus_regalloc_t;
+enum walrus_regalloc_enum {
+  WALRUS_REGALLOC_DEFAULT,
+  WALRUS_REGALLOC_LINEAR_SCAN,
+  WALRUS_REGALLOC_DISABLED,
+};
+
+WASM_API_EXTERN void walrus_config_set_strategy(wasm_config_t*, walrus_strategy_t);
+WASM_API_EXTERN void walrus_config_set_register_allocator(wasm_config_t*, walrus_regalloc_t);
+WASM_API_EXTERN void walrus_config_set_optimize_bytecode(wasm_config_t*, bool);
+WASM_API_EXTERN void walrus_config_set_web_assembly3(wasm_config_t*, bool);
+// Address space reserved for each linear memory, zero keeps the default.
+WASM_API_EXTERN void walrus_config_set_memory_reservation(wasm_config_t*, uint64_t size);
+// Align linear memories to 2MB and ask for transparent huge pages.
+WASM_API_EXTERN void walrus_config_set_memory_huge_pages(wasm_config_t*, bool);
+// Allocate the pages of linear memories when they become accessible.
+WASM_API_EXTERN void walrus_config_set_memory_prefault(wasm_config_t*, bool);
+// Applied by wasm_engine_new_with_config, see walrus_gc_set_options.
+WASM_API_EXTERN void walrus_config_set_gc_options(wasm_config_t*, const walrus_gc_options_t*);
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
 
@@ -397,6 +469,9 @@ WASM_API_EXTERN own wasm_foreign_t* wasm_foreign_new(wasm_store_t*);
 
 // Modules
 
+// A shared module can only be obtained by the stores of the engine which
+// parsed it. These stores share the module without locking, so they must
+// be used by one thread at a time.
 WASM_DECLARE_SHARABLE_REF(module)
 
 WASM_API_EXTERN own wasm_module_t* wasm_module_new(
@@ -433,6 +508,39 @@ WASM_API_EXTERN size_t wasm_func_result_arity(const wasm_func_t*);
 WASM_API_EXTERN own wasm_trap_t* wasm_func_call(
   const wasm_func_t*, const wasm_val_vec_t* args, wasm_val_vec_t* results);
 
+// Raw slot calls (walrus extension)
+
+// Each parameter and result is stored in a 64 bit slot. The slots hold the
+// parameters before the call, and the results after it, so their number must
+// be the maximum of the parameter and result arities. 32 bit values are stored
+// in the low bits, and floating point values are stored as their bit patterns.
+typedef uint64_t walrus_slot_t;
+
+typedef own wasm_trap_t* (*walrus_func_callback_unchecked_t)(
+  void* env, walrus_slot_t* slots);
+
+// Only functions with numeric parameter and result types can be called
+// with slots. This should be checked once before the unchecked calls.
+WASM_API_EXTERN bool walrus_functype_supports_slots(const wasm_functype_t*);
+
+// Returns with NULL if the type does not support slots.
+WASM_API_EXTERN own wasm_func_t* walrus_func_new_unchecked(
+  wasm_store_t*, const wasm_functype_t* type, walrus_func_callback_unchecked_t,
+  void* env);
+
+// The slot types are not checked, and no memory is allocated unless a trap is returned.
+WASM_API_EXTERN own wasm_trap_t* walrus_func_call_unchecked(
+  const wasm_func_t*, walrus_slot_t* slots);
+
+// Calls the function count times using the same execution state and trap handler.
+// Each call uses max(parameter count, result count) slots, and the slots of each
+// call follow the slots of the previous call, so the buffer must hold count times
+// that many slots. When a call traps, the remaining calls are skipped, and
+// trap_index (if not NULL) is set to the index of the trapping call. Otherwise
+// trap_index is set to count.
+WASM_API_EXTERN own wasm_trap_t* walrus_func_call_batch(
+  const wasm_func_t*, walrus_slot_t* slots, size_t count, size_t* trap_index);
+
 
 // Global Instances
 
@@ -28,8 +28,14 @@ static const uint8_t g_byteCodeSize[ByteCode::OpcodeKindEnd] = {
 };
 // clang-format on
 
+#if defined(WALRUS_COMPACT_BYTECODE)
+static_assert(ByteCode::OpcodeKindEnd <= UINT16_MAX, "opcodes must fit into the compact encoding");
+#endif
+
 ByteCode::ByteCode(ByteCode::Opcode opcode)
-#if defined(WALRUS_ENABLE_COMPUTED_GOTO)
+#if defined(WALRUS_COMPACT_BYTECODE)
+    : m_opcode(static_cast<uint16_t>(opcode))
+#elif defined(WALRUS_ENABLE_COMPUTED_GOTO)
     : m_opcodeInAddress(g_byteCodeTable.m_addressTable[opcode])
 #else
     : m_opcode(opcode)
@@ -37,7 +43,12 @@ ByteCode::ByteCode(ByteCode::Opcode opcode)
 {
 }
 
-#if defined(WALRUS_ENABLE_COMPUTED_GOTO)
+#if defined(WALRUS_COMPACT_BYTECODE)
+ByteCode::Opcode ByteCode::opcode() const
+{
+    return static_cast<Opcode>(m_opcode);
+}
+#elif defined(WALRUS_ENABLE_COMPUTED_GOTO)
 ByteCode::Opcode ByteCode::opcode() const
 {
     return static_cast<Opcode>(g_byteCodeTable.m_addressToOpcodeTable[m_opcodeInAddress]);
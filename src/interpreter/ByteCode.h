@@ -1418,7 +1418,14 @@ class FunctionType;
     FOR_EACH_BYTECODE_ATOMIC_OTHER(F)               \
     FOR_EACH_BYTECODE_ATOMIC_OTHER_M64(F)
 
+#if defined(WALRUS_COMPACT_BYTECODE)
+// The opcode is a 16 bit index into g_byteCodeTable instead of a handler
+// address, and the operands are packed after it. The alignment keeps the
+// size of every byte code pointer aligned, like the default encoding.
+class alignas(sizeof(void*)) ByteCode {
+#else
 class ByteCode {
+#endif
 public:
     // clang-format off
     enum Opcode : uint32_t {
@@ -1443,7 +1450,7 @@ protected:
     ByteCode(Opcode opcode);
 
     ByteCode()
-#if defined(WALRUS_ENABLE_COMPUTED_GOTO)
+#if defined(WALRUS_ENABLE_COMPUTED_GOTO) && !defined(WALRUS_COMPACT_BYTECODE)
         : m_opcodeInAddress(nullptr)
 #else
         : m_opcode(Opcode::OpcodeKindEnd)
@@ -1451,10 +1458,14 @@ protected:
     {
     }
 
+#if defined(WALRUS_COMPACT_BYTECODE)
+    uint16_t m_opcode;
+#else
     union {
         Opcode m_opcode;
         void* m_opcodeInAddress;
     };
+#endif
 };
 
 class ByteCodeOffset2 : public ByteCode {
@@ -1470,6 +1481,7 @@ public:
     ByteCodeStackOffset stackOffset2() const { return m_stackOffset2; }
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_stackOffset1;
     ByteCodeStackOffset m_stackOffset2;
 };
@@ -1488,6 +1500,7 @@ public:
     ByteCodeStackOffset stackOffset3() const { return m_stackOffsets[2]; }
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_stackOffsets[3];
 };
 
@@ -1505,6 +1518,7 @@ public:
     int32_t int32Value() const { return static_cast<int32_t>(m_value); }
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_stackOffset;
     uint32_t m_value;
 };
@@ -1522,6 +1536,7 @@ public:
     ByteCodeStackOffset stackOffset2() const { return m_stackOffset2; }
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_stackOffset1;
     ByteCodeStackOffset m_stackOffset2;
 };
@@ -1654,8 +1669,10 @@ public:
     ByteCodeTable();
 #if defined(WALRUS_ENABLE_COMPUTED_GOTO)
     void* m_addressTable[ByteCode::OpcodeKindEnd];
+#if !defined(WALRUS_COMPACT_BYTECODE)
     std::unordered_map<void*, int> m_addressToOpcodeTable;
 #endif
+#endif
 };
 
 extern ByteCodeTable g_byteCodeTable;
@@ -1683,6 +1700,7 @@ public:
 #endif
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_dstOffset;
     uint32_t m_value;
 };
@@ -1711,6 +1729,7 @@ public:
 #endif
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_dstOffset;
     uint64_t m_value;
 };
@@ -1738,6 +1757,7 @@ public:
 #endif
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_dstOffset;
     // Maintains 32 bit alignment.
     uint32_t m_value[4];
@@ -1929,6 +1949,7 @@ public:
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
 
 protected:
+    friend class ByteCodeOptimizer;
     // The field list is intentionally reserved, to avoid
     // merging the integer and float code paths in the interpreter.
     ByteCodeStackOffset m_dstOffset;
@@ -2586,6 +2607,7 @@ public:
 #endif
 
 protected:
+    friend class ByteCodeOptimizer;
     ByteCodeStackOffset m_condOffset;
     uint8_t m_valueSize;
     uint8_t m_isFloat;
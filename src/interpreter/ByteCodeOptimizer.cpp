@@ -0,0 +1,1140 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+#include "interpreter/ByteCodeOptimizer.h"
+
+namespace Walrus {
+
+// Liveness of stack slots is tracked in 4 byte units.
+static const size_t s_unitSize = 4;
+static const uint32_t s_noReplacement = std::numeric_limits<uint32_t>::max();
+// Liveness is recomputed after each removal round, since removing a store
+// may turn the stores of its operands dead as well.
+static const size_t s_maxDeadStoreRounds = 8;
+
+static inline bool isOverlapping(uint16_t offset1, uint16_t size1, uint16_t offset2, uint16_t size2)
+{
+    return offset1 < offset2 + size2 && offset2 < offset1 + size1;
+}
+
+static inline int32_t relativeOffset(size_t from, size_t to)
+{
+    return static_cast<int32_t>(static_cast<int64_t>(to) - static_cast<int64_t>(from));
+}
+
+static bool canTrap(ByteCode::Opcode opcode)
+{
+    switch (opcode) {
+    case ByteCode::I32DivSOpcode:
+    case ByteCode::I32DivUOpcode:
+    case ByteCode::I32RemSOpcode:
+    case ByteCode::I32RemUOpcode:
+    case ByteCode::I64DivSOpcode:
+    case ByteCode::I64DivUOpcode:
+    case ByteCode::I64RemSOpcode:
+    case ByteCode::I64RemUOpcode:
+    case ByteCode::I32TruncF32SOpcode:
+    case ByteCode::I32TruncF32UOpcode:
+    case ByteCode::I32TruncF64SOpcode:
+    case ByteCode::I32TruncF64UOpcode:
+    case ByteCode::I64TruncF32SOpcode:
+    case ByteCode::I64TruncF32UOpcode:
+    case ByteCode::I64TruncF64SOpcode:
+    case ByteCode::I64TruncF64UOpcode:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool foldBinary(ByteCode::Opcode opcode, uint64_t lhs, uint64_t rhs, uint64_t& result)
+{
+    uint32_t lhs32 = static_cast<uint32_t>(lhs);
+    uint32_t rhs32 = static_cast<uint32_t>(rhs);
+
+    switch (opcode) {
+    case ByteCode::I32AddOpcode:
+        result = lhs32 + rhs32;
+        return true;
+    case ByteCode::I32SubOpcode:
+        result = lhs32 - rhs32;
+        return true;
+    case ByteCode::I32MulOpcode:
+        result = lhs32 * rhs32;
+        return true;
+    case ByteCode::I32AndOpcode:
+        result = lhs32 & rhs32;
+        return true;
+    case ByteCode::I32OrOpcode:
+        result = lhs32 | rhs32;
+        return true;
+    case ByteCode::I32XorOpcode:
+        result = lhs32 ^ rhs32;
+        return true;
+    case ByteCode::I32ShlOpcode:
+        result = static_cast<uint32_t>(lhs32 << (rhs32 & 31));
+        return true;
+    case ByteCode::I32ShrSOpcode:
+        result = static_cast<uint32_t>(static_cast<int32_t>(lhs32) >> (rhs32 & 31));
+        return true;
+    case ByteCode::I32ShrUOpcode:
+        result = lhs32 >> (rhs32 & 31);
+        return true;
+    case ByteCode::I32EqOpcode:
+        result = lhs32 == rhs32;
+        return true;
+    case ByteCode::I32NeOpcode:
+        result = lhs32 != rhs32;
+        return true;
+    case ByteCode::I32LtSOpcode:
+        result = static_cast<int32_t>(lhs32) < static_cast<int32_t>(rhs32);
+        return true;
+    case ByteCode::I32LtUOpcode:
+        result = lhs32 < rhs32;
+        return true;
+    case ByteCode::I32LeSOpcode:
+        result = static_cast<int32_t>(lhs32) <= static_cast<int32_t>(rhs32);
+        return true;
+    case ByteCode::I32LeUOpcode:
+        result = lhs32 <= rhs32;
+        return true;
+    case ByteCode::I32GtSOpcode:
+        result = static_cast<int32_t>(lhs32) > static_cast<int32_t>(rhs32);
+        return true;
+    case ByteCode::I32GtUOpcode:
+        result = lhs32 > rhs32;
+        return true;
+    case ByteCode::I32GeSOpcode:
+        result = static_cast<int32_t>(lhs32) >= static_cast<int32_t>(rhs32);
+        return true;
+    case ByteCode::I32GeUOpcode:
+        result = lhs32 >= rhs32;
+        return true;
+    case ByteCode::I64AddOpcode:
+        result = lhs + rhs;
+        return true;
+    case ByteCode::I64SubOpcode:
+        result = lhs - rhs;
+        return true;
+    case ByteCode::I64MulOpcode:
+        result = lhs * rhs;
+        return true;
+    case ByteCode::I64AndOpcode:
+        result = lhs & rhs;
+        return true;
+    case ByteCode::I64OrOpcode:
+        result = lhs | rhs;
+        return true;
+    case ByteCode::I64XorOpcode:
+        result = lhs ^ rhs;
+        return true;
+    case ByteCode::I64ShlOpcode:
+        result = lhs << (rhs & 63);
+        return true;
+    case ByteCode::I64ShrSOpcode:
+        result = static_cast<uint64_t>(static_cast<int64_t>(lhs) >> (rhs & 63));
+        return true;
+    case ByteCode::I64ShrUOpcode:
+        result = lhs >> (rhs & 63);
+        return true;
+    case ByteCode::I64EqOpcode:
+        result = lhs == rhs;
+        return true;
+    case ByteCode::I64NeOpcode:
+        result = lhs != rhs;
+        return true;
+    case ByteCode::I64LtSOpcode:
+        result = static_cast<int64_t>(lhs) < static_cast<int64_t>(rhs);
+        return true;
+    case ByteCode::I64LtUOpcode:
+        result = lhs < rhs;
+        return true;
+    case ByteCode::I64LeSOpcode:
+        result = static_cast<int64_t>(lhs) <= static_cast<int64_t>(rhs);
+        return true;
+    case ByteCode::I64LeUOpcode:
+        result = lhs <= rhs;
+        return true;
+    case ByteCode::I64GtSOpcode:
+        result = static_cast<int64_t>(lhs) > static_cast<int64_t>(rhs);
+        return true;
+    case ByteCode::I64GtUOpcode:
+        result = lhs > rhs;
+        return true;
+    case ByteCode::I64GeSOpcode:
+        result = static_cast<int64_t>(lhs) >= static_cast<int64_t>(rhs);
+        return true;
+    case ByteCode::I64GeUOpcode:
+        result = lhs >= rhs;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool foldUnary(ByteCode::Opcode opcode, uint64_t value, uint64_t& result)
+{
+    uint32_t value32 = static_cast<uint32_t>(value);
+
+    switch (opcode) {
+    case ByteCode::I32EqzOpcode:
+        result = value32 == 0;
+        return true;
+    case ByteCode::I64EqzOpcode:
+        result = value == 0;
+        return true;
+    case ByteCode::I32Extend8SOpcode:
+        result = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(value32)));
+        return true;
+    case ByteCode::I32Extend16SOpcode:
+        result = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(value32)));
+        return true;
+    case ByteCode::I64Extend8SOpcode:
+        result = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(value)));
+        return true;
+    case ByteCode::I64Extend16SOpcode:
+        result = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(value)));
+        return true;
+    case ByteCode::I64Extend32SOpcode:
+    case ByteCode::I64ExtendI32SOpcode:
+        result = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value32)));
+        return true;
+    case ByteCode::I64ExtendI32UOpcode:
+    case ByteCode::I32WrapI64Opcode:
+        result = value32;
+        return true;
+    default:
+        return false;
+    }
+}
+
+ByteCodeOptimizer::ByteCodeOptimizer(ByteCodeVector& byteCode, uint16_t paramStackSize, uint16_t requiredStackSize)
+    : m_byteCode(byteCode)
+    , m_paramStackSize(paramStackSize)
+    , m_requiredStackSize(requiredStackSize)
+    , m_unitCount(0)
+    , m_hasOpaqueByteCode(false)
+    , m_isChanged(false)
+{
+}
+
+ByteCode* ByteCodeOptimizer::byteCodeAt(const Instruction& instr)
+{
+    if (instr.replacement != s_noReplacement) {
+        return reinterpret_cast<ByteCode*>(m_replacements.data() + instr.replacement);
+    }
+    return reinterpret_cast<ByteCode*>(m_byteCode.data() + instr.position);
+}
+
+void ByteCodeOptimizer::decode(ByteCode* code, Operands& ops)
+{
+#define READ(fieldPtr, valueSize) \
+    ops.reads.push_back({ fieldPtr, *(fieldPtr), static_cast<uint16_t>(valueSize) });
+#define READ_VALUE(value, valueSize) \
+    ops.reads.push_back({ nullptr, value, static_cast<uint16_t>(valueSize) });
+#define WRITE(fieldPtr, valueSize) \
+    ops.writes.push_back({ fieldPtr, *(fieldPtr), static_cast<uint16_t>(valueSize) });
+#define MAY_WRITE(value, valueSize) \
+    ops.mayWrites.push_back({ nullptr, value, static_cast<uint16_t>(valueSize) });
+
+    ops.clear();
+    ByteCode::Opcode opcode = code->opcode();
+
+    switch (opcode) {
+#if !defined(NDEBUG)
+    case ByteCode::NopOpcode:
+        break;
+#endif
+    case ByteCode::Const32Opcode:
+        WRITE(&reinterpret_cast<Const32*>(code)->m_dstOffset, 4);
+        ops.isPure = true;
+        break;
+    case ByteCode::Const64Opcode:
+        WRITE(&reinterpret_cast<Const64*>(code)->m_dstOffset, 8);
+        ops.isPure = true;
+        break;
+    case ByteCode::Const128Opcode:
+        WRITE(&reinterpret_cast<Const128*>(code)->m_dstOffset, 16);
+        ops.isPure = true;
+        break;
+    case ByteCode::MoveI32Opcode:
+    case ByteCode::MoveI64Opcode:
+    case ByteCode::MoveV128Opcode: {
+        ByteCodeOffset2* move = reinterpret_cast<ByteCodeOffset2*>(code);
+        size_t size = opcode == ByteCode::MoveI32Opcode ? 4 : (opcode == ByteCode::MoveI64Opcode ? 8 : 16);
+        READ(&move->m_stackOffset1, size);
+        WRITE(&move->m_stackOffset2, size);
+        ops.isPure = true;
+        break;
+    }
+    case ByteCode::MoveF32Opcode:
+    case ByteCode::MoveF64Opcode: {
+        MoveFloat* move = reinterpret_cast<MoveFloat*>(code);
+        size_t size = opcode == ByteCode::MoveF32Opcode ? 4 : 8;
+        READ(&move->m_srcOffset, size);
+        WRITE(&move->m_dstOffset, size);
+        ops.isPure = true;
+        break;
+    }
+#define CASE_BINARY(name, op, paramType, resultType)                                       \
+    case ByteCode::name##Opcode: {                                                         \
+        ByteCodeOffset3* binary = reinterpret_cast<ByteCodeOffset3*>(code);                \
+        READ(&binary->m_stackOffsets[0], sizeof(paramType));                               \
+        READ(&binary->m_stackOffsets[1], sizeof(paramType));                               \
+        WRITE(&binary->m_stackOffsets[2], sizeof(resultType));                             \
+        ops.isPure = !canTrap(opcode);                                                     \
+        break;                                                                             \
+    }
+        FOR_EACH_BYTECODE_BINARY_OP(CASE_BINARY)
+#undef CASE_BINARY
+#define CASE_UNARY(name, op, type)                                                                                    \
+    case ByteCode::name##Opcode: {                                                                                    \
+        ByteCodeOffset2* unary = reinterpret_cast<ByteCodeOffset2*>(code);                                            \
+        READ(&unary->m_stackOffset1, sizeof(type));                                                                   \
+        WRITE(&unary->m_stackOffset2, (opcode == ByteCode::I32EqzOpcode || opcode == ByteCode::I64EqzOpcode) ? 4 : sizeof(type)); \
+        ops.isPure = true;                                                                                            \
+        break;                                                                                                        \
+    }
+        FOR_EACH_BYTECODE_UNARY_OP(CASE_UNARY)
+#undef CASE_UNARY
+#define CASE_UNARY_2(name, op, srcType, dstType, ...)                      \
+    case ByteCode::name##Opcode: {                                         \
+        ByteCodeOffset2* unary = reinterpret_cast<ByteCodeOffset2*>(code); \
+        READ(&unary->m_stackOffset1, sizeof(srcType));                     \
+        WRITE(&unary->m_stackOffset2, sizeof(dstType));                    \
+        ops.isPure = !canTrap(opcode);                                     \
+        break;                                                             \
+    }
+        FOR_EACH_BYTECODE_UNARY_OP_2_BASE(CASE_UNARY_2)
+#undef CASE_UNARY_2
+#define CASE_UNARY_2_REVERSED(name, op, srcType, dstType, ...)             \
+    case ByteCode::name##Opcode: {                                         \
+        ByteCodeOffset2* unary = reinterpret_cast<ByteCodeOffset2*>(code); \
+        READ(&unary->m_stackOffset2, sizeof(srcType));                     \
+        WRITE(&unary->m_stackOffset1, sizeof(dstType));                    \
+        ops.isPure = true;                                                 \
+        break;                                                             \
+    }
+        FOR_EACH_BYTECODE_UNARY_OP_2_REVERSED(CASE_UNARY_2_REVERSED)
+#undef CASE_UNARY_2_REVERSED
+#define CASE_LOAD(name, writeType, addressSize, srcIndex, dstIndex)                          \
+    case ByteCode::name##Opcode: {                                                           \
+        ByteCodeOffset2ValueBase* load = reinterpret_cast<ByteCodeOffset2ValueBase*>(code); \
+        READ(&load->m_stackOffset##srcIndex, addressSize);                                   \
+        WRITE(&load->m_stackOffset##dstIndex, sizeof(writeType));                            \
+        break;                                                                               \
+    }
+#define CASE_LOAD_INT(name, readType, writeType) CASE_LOAD(name, writeType, 4, 1, 2)
+#define CASE_LOAD_INT_M64(name, readType, writeType) CASE_LOAD(name, writeType, 8, 1, 2)
+#define CASE_LOAD_FLOAT(name, readType, writeType) CASE_LOAD(name, writeType, 4, 2, 1)
+#define CASE_LOAD_FLOAT_M64(name, readType, writeType) CASE_LOAD(name, writeType, 8, 2, 1)
+        FOR_EACH_BYTECODE_LOAD_INT_OP(CASE_LOAD_INT)
+        FOR_EACH_BYTECODE_LOAD_INT_M64_OP(CASE_LOAD_INT_M64)
+        FOR_EACH_BYTECODE_LOAD_FLOAT_OP(CASE_LOAD_FLOAT)
+        FOR_EACH_BYTECODE_LOAD_FLOAT_M64_OP(CASE_LOAD_FLOAT_M64)
+#undef CASE_LOAD_INT
+#undef CASE_LOAD_INT_M64
+#undef CASE_LOAD_FLOAT
+#undef CASE_LOAD_FLOAT_M64
+#undef CASE_LOAD
+#define CASE_STORE(name, readType, addressSize, addressIndex, valueIndex)                     \
+    case ByteCode::name##Opcode: {                                                            \
+        ByteCodeOffset2ValueBase* store = reinterpret_cast<ByteCodeOffset2ValueBase*>(code); \
+        READ(&store->m_stackOffset##addressIndex, addressSize);                               \
+        READ(&store->m_stackOffset##valueIndex, sizeof(readType));                            \
+        break;                                                                                \
+    }
+#define CASE_STORE_32(name, readType, writeType) CASE_STORE(name, readType, 4, 1, 2)
+#define CASE_STORE_32_M64(name, readType, writeType) CASE_STORE(name, readType, 8, 1, 2)
+#define CASE_STORE_64(name, readType, writeType) CASE_STORE(name, readType, 4, 2, 1)
+#define CASE_STORE_64_M64(name, readType, writeType) CASE_STORE(name, readType, 8, 2, 1)
+        FOR_EACH_BYTECODE_STORE_32_OP(CASE_STORE_32)
+        FOR_EACH_BYTECODE_STORE_32_M64_OP(CASE_STORE_32_M64)
+        FOR_EACH_BYTECODE_STORE_64_OP(CASE_STORE_64)
+        FOR_EACH_BYTECODE_STORE_64_M64_OP(CASE_STORE_64_M64)
+#undef CASE_STORE_32
+#undef CASE_STORE_32_M64
+#undef CASE_STORE_64
+#undef CASE_STORE_64_M64
+#undef CASE_STORE
+    case ByteCode::GlobalGet32Opcode:
+    case ByteCode::GlobalGet64Opcode:
+    case ByteCode::GlobalGet128Opcode: {
+        ByteCodeOffsetValue* get = reinterpret_cast<ByteCodeOffsetValue*>(code);
+        WRITE(&get->m_stackOffset, opcode == ByteCode::GlobalGet32Opcode ? 4 : (opcode == ByteCode::GlobalGet64Opcode ? 8 : 16));
+        ops.isPure = true;
+        break;
+    }
+    case ByteCode::GlobalSet32Opcode:
+    case ByteCode::GlobalSet64Opcode:
+    case ByteCode::GlobalSet128Opcode: {
+        ByteCodeOffsetValue* set = reinterpret_cast<ByteCodeOffsetValue*>(code);
+        READ(&set->m_stackOffset, opcode == ByteCode::GlobalSet32Opcode ? 4 : (opcode == ByteCode::GlobalSet64Opcode ? 8 : 16));
+        break;
+    }
+    case ByteCode::SelectOpcode: {
+        Select* select = reinterpret_cast<Select*>(code);
+        READ(&select->m_condOffset, 4);
+        READ(&select->m_src0Offset, select->m_valueSize);
+        READ(&select->m_src1Offset, select->m_valueSize);
+        WRITE(&select->m_dstOffset, select->m_valueSize);
+        ops.isPure = true;
+        break;
+    }
+    case ByteCode::JumpOpcode:
+        ops.kind = Operands::Jump;
+        break;
+    case ByteCode::JumpIfTrueOpcode:
+    case ByteCode::JumpIfFalseOpcode:
+        READ(&reinterpret_cast<ByteCodeOffsetValue*>(code)->m_stackOffset, 4);
+        ops.kind = Operands::ConditionalJump;
+        break;
+    case ByteCode::JumpIfNullOpcode:
+    case ByteCode::JumpIfNonNullOpcode:
+    case ByteCode::JumpIfCastGenericOpcode:
+    case ByteCode::JumpIfCastDefinedOpcode:
+        READ(&reinterpret_cast<ByteCodeOffsetValue*>(code)->m_stackOffset, sizeof(void*));
+        ops.kind = Operands::ConditionalJump;
+        break;
+    case ByteCode::BrTableOpcode:
+        READ_VALUE(reinterpret_cast<BrTable*>(code)->condOffset(), 4);
+        ops.kind = Operands::BrTable;
+        break;
+    case ByteCode::CallOpcode:
+    case ByteCode::CallIndirectOpcode:
+    case ByteCode::CallRefOpcode: {
+        ByteCodeStackOffset* offsets;
+        uint16_t parameterCount;
+        uint16_t resultCount;
+        if (opcode == ByteCode::CallOpcode) {
+            Call* call = reinterpret_cast<Call*>(code);
+            offsets = call->stackOffsets();
+            parameterCount = call->parameterOffsetsSize();
+            resultCount = call->resultOffsetsSize();
+        } else if (opcode == ByteCode::CallIndirectOpcode) {
+            CallIndirect* call = reinterpret_cast<CallIndirect*>(code);
+            // The index can be a 64 bit value for 64 bit tables.
+            READ_VALUE(call->calleeOffset(), 8);
+            offsets = call->stackOffsets();
+            parameterCount = call->parameterOffsetsSize();
+            resultCount = call->resultOffsetsSize();
+        } else {
+            CallRef* call = reinterpret_cast<CallRef*>(code);
+            READ_VALUE(call->calleeOffset(), sizeof(void*));
+            offsets = call->stackOffsets();
+            parameterCount = call->parameterOffsetsSize();
+            resultCount = call->resultOffsetsSize();
+        }
+
+        // Values are copied in machine word sized chunks.
+        for (uint16_t i = 0; i < parameterCount; i++) {
+            READ_VALUE(offsets[i], sizeof(size_t));
+        }
+        for (uint16_t i = 0; i < resultCount; i++) {
+            MAY_WRITE(offsets[parameterCount + i], sizeof(size_t));
+        }
+        break;
+    }
+    case ByteCode::EndOpcode: {
+        End* end = reinterpret_cast<End*>(code);
+        ByteCodeStackOffset* offsets = end->resultOffsets();
+        for (uint32_t i = 0; i < end->offsetsSize(); i++) {
+            READ_VALUE(offsets[i], sizeof(size_t));
+        }
+        ops.kind = Operands::Terminator;
+        break;
+    }
+    case ByteCode::UnreachableOpcode:
+        ops.kind = Operands::Terminator;
+        break;
+    case ByteCode::ThrowOpcode:
+    case ByteCode::ReturnCallOpcode:
+    case ByteCode::ReturnCallIndirectOpcode:
+    case ByteCode::ReturnCallRefOpcode:
+        ops.kind = Operands::Terminator;
+        ops.isOpaque = true;
+        break;
+    default:
+        ops.isOpaque = true;
+        break;
+    }
+
+#undef READ
+#undef READ_VALUE
+#undef WRITE
+#undef MAY_WRITE
+}
+
+bool ByteCodeOptimizer::buildInstructions()
+{
+    Operands ops;
+    size_t position = 0;
+    size_t byteCodeSize = m_byteCode.size();
+    size_t maxEnd = m_requiredStackSize;
+
+    while (position < byteCodeSize) {
+        ByteCode* code = reinterpret_cast<ByteCode*>(m_byteCode.data() + position);
+        Instruction instr;
+
+        instr.position = position;
+        instr.newPosition = 0;
+        instr.size = code->getSize();
+        instr.replacement = s_noReplacement;
+        instr.targetStart = m_targets.size();
+        instr.isLeader = false;
+        instr.isRemoved = false;
+
+        decode(code, ops);
+        m_hasOpaqueByteCode |= ops.isOpaque;
+
+        const std::vector<Operand>* lists[] = { &ops.reads, &ops.writes, &ops.mayWrites };
+        for (size_t i = 0; i < 3; i++) {
+            for (const auto& operand : *lists[i]) {
+                if (operand.offset % s_unitSize) {
+                    return false;
+                }
+                maxEnd = std::max(maxEnd, static_cast<size_t>(operand.offset) + operand.size);
+            }
+        }
+
+        switch (code->opcode()) {
+        case ByteCode::JumpOpcode:
+            m_targets.push_back(position + reinterpret_cast<Jump*>(code)->offset());
+            break;
+        case ByteCode::JumpIfTrueOpcode:
+        case ByteCode::JumpIfFalseOpcode:
+        case ByteCode::JumpIfNullOpcode:
+        case ByteCode::JumpIfNonNullOpcode:
+        case ByteCode::JumpIfCastGenericOpcode:
+        case ByteCode::JumpIfCastDefinedOpcode:
+            m_targets.push_back(position + reinterpret_cast<ByteCodeOffsetValue*>(code)->int32Value());
+            break;
+        case ByteCode::BrTableOpcode: {
+            BrTable* brTable = reinterpret_cast<BrTable*>(code);
+            m_targets.push_back(position + brTable->defaultOffset());
+            for (uint32_t i = 0; i < brTable->tableSize(); i++) {
+                m_targets.push_back(position + brTable->jumpOffsets()[i]);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        instr.targetCount = m_targets.size() - instr.targetStart;
+        // Temporarily marks that the following instruction starts a new block.
+        instr.isLeader = ops.kind != Operands::Normal;
+        m_instructions.push_back(instr);
+        position += instr.size;
+    }
+
+    if (m_instructions.empty()) {
+        return false;
+    }
+
+    // Instructions following a branch start a new block.
+    for (size_t i = m_instructions.size() - 1; i > 0; i--) {
+        m_instructions[i].isLeader = m_instructions[i - 1].isLeader;
+    }
+    m_instructions[0].isLeader = true;
+
+    for (auto& target : m_targets) {
+        size_t low = 0;
+        size_t high = m_instructions.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (m_instructions[mid].position < target) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        if (low >= m_instructions.size() || m_instructions[low].position != target) {
+            return false;
+        }
+        target = low;
+        m_instructions[low].isLeader = true;
+    }
+
+    m_unitCount = (maxEnd + s_unitSize - 1) / s_unitSize;
+    return true;
+}
+
+const ByteCodeOptimizer::Fact* ByteCodeOptimizer::findFact(const std::vector<Fact>& facts, uint16_t offset, uint16_t size)
+{
+    for (size_t i = facts.size(); i > 0; i--) {
+        const Fact& fact = facts[i - 1];
+        if (fact.dst == offset && fact.size == size) {
+            return &fact;
+        }
+    }
+
+    if (!m_globalFactIndex.empty()) {
+        int32_t index = m_globalFactIndex[offset / s_unitSize];
+        if (index >= 0 && m_globalFacts[index].dst == offset && m_globalFacts[index].size == size) {
+            return &m_globalFacts[index];
+        }
+    }
+    return nullptr;
+}
+
+void ByteCodeOptimizer::replaceWithConst(Instruction& instr, ByteCodeStackOffset dst, uint16_t size, uint64_t value)
+{
+    size_t start = m_replacements.size();
+
+    if (size == 4) {
+        Const32 code(dst, static_cast<uint32_t>(value));
+        m_replacements.insert(m_replacements.end(), reinterpret_cast<uint8_t*>(&code), reinterpret_cast<uint8_t*>(&code) + sizeof(Const32));
+        instr.size = sizeof(Const32);
+    } else {
+        ASSERT(size == 8);
+        Const64 code(dst, value);
+        m_replacements.insert(m_replacements.end(), reinterpret_cast<uint8_t*>(&code), reinterpret_cast<uint8_t*>(&code) + sizeof(Const64));
+        instr.size = sizeof(Const64);
+    }
+
+    instr.replacement = start;
+    m_isChanged = true;
+}
+
+void ByteCodeOptimizer::replaceWithJump(Instruction& instr)
+{
+    size_t start = m_replacements.size();
+    Jump code;
+
+    m_replacements.insert(m_replacements.end(), reinterpret_cast<uint8_t*>(&code), reinterpret_cast<uint8_t*>(&code) + sizeof(Jump));
+    instr.size = sizeof(Jump);
+    instr.replacement = start;
+    m_isChanged = true;
+}
+
+void ByteCodeOptimizer::propagate()
+{
+    // Maximum number of facts tracked inside a block, older ones are dropped.
+    const size_t maxFacts = 64;
+    size_t count = m_instructions.size();
+    size_t entryEnd = 1;
+    Operands ops;
+
+    while (entryEnd < count && !m_instructions[entryEnd].isLeader) {
+        entryEnd++;
+    }
+
+    // Slots which are only written by a constant in the entry block hold that
+    // constant in every other block. This is the case for the constant slots
+    // allocated by the parser.
+    if (!m_hasOpaqueByteCode && std::find(m_targets.begin(), m_targets.end(), 0) == m_targets.end()) {
+        std::vector<uint8_t> writeCount(m_unitCount, 0);
+        std::vector<bool> isRead(m_unitCount, false);
+
+        for (size_t i = 0; i < m_paramStackSize / s_unitSize && i < m_unitCount; i++) {
+            writeCount[i] = 2;
+        }
+
+        for (auto& instr : m_instructions) {
+            decode(byteCodeAt(instr), ops);
+            const std::vector<Operand>* lists[] = { &ops.writes, &ops.mayWrites };
+            for (size_t i = 0; i < 2; i++) {
+                for (const auto& operand : *lists[i]) {
+                    size_t end = std::min(m_unitCount, static_cast<size_t>((operand.offset + operand.size + s_unitSize - 1) / s_unitSize));
+                    for (size_t unit = operand.offset / s_unitSize; unit < end; unit++) {
+                        if (writeCount[unit] < 2) {
+                            writeCount[unit]++;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < entryEnd; i++) {
+            ByteCode* code = byteCodeAt(m_instructions[i]);
+            decode(code, ops);
+
+            if (code->opcode() == ByteCode::Const32Opcode || code->opcode() == ByteCode::Const64Opcode) {
+                const Operand& dst = ops.writes[0];
+                size_t end = (dst.offset + dst.size) / s_unitSize;
+                bool isConstant = true;
+
+                for (size_t unit = dst.offset / s_unitSize; unit < end; unit++) {
+                    if (writeCount[unit] != 1 || isRead[unit]) {
+                        isConstant = false;
+                        break;
+                    }
+                }
+
+                if (isConstant) {
+                    uint64_t value = code->opcode() == ByteCode::Const32Opcode ? reinterpret_cast<Const32*>(code)->value() : reinterpret_cast<Const64*>(code)->value();
+                    m_globalFacts.push_back({ dst.offset, dst.size, 0, true, value });
+                }
+            }
+
+            for (const auto& operand : ops.reads) {
+                size_t end = std::min(m_unitCount, static_cast<size_t>((operand.offset + operand.size + s_unitSize - 1) / s_unitSize));
+                for (size_t unit = operand.offset / s_unitSize; unit < end; unit++) {
+                    isRead[unit] = true;
+                }
+            }
+        }
+
+        if (!m_globalFacts.empty()) {
+            m_globalFactIndex.assign(m_unitCount, -1);
+            for (size_t i = 0; i < m_globalFacts.size(); i++) {
+                m_globalFactIndex[m_globalFacts[i].dst / s_unitSize] = static_cast<int32_t>(i);
+            }
+        }
+    }
+
+    std::vector<Fact> facts;
+    std::vector<int32_t> globalFactIndex;
+    // Global facts are not valid before the constants are written.
+    globalFactIndex.swap(m_globalFactIndex);
+
+    for (size_t i = 0; i < count; i++) {
+        Instruction& instr = m_instructions[i];
+
+        if (instr.isLeader) {
+            facts.clear();
+        }
+
+        if (i == entryEnd) {
+            m_globalFactIndex.swap(globalFactIndex);
+        }
+
+        if (instr.isRemoved) {
+            continue;
+        }
+
+        ByteCode* code = byteCodeAt(instr);
+        decode(code, ops);
+
+        if (ops.isOpaque) {
+            facts.clear();
+            continue;
+        }
+
+        // Forward copies.
+        for (auto& read : ops.reads) {
+            if (read.field == nullptr) {
+                continue;
+            }
+
+            const Fact* fact = findFact(facts, read.offset, read.size);
+            if (fact != nullptr && !fact->isConst && fact->src != read.offset) {
+                *read.field = fact->src;
+                read.offset = fact->src;
+                m_isChanged = true;
+            }
+        }
+
+        ByteCode::Opcode opcode = code->opcode();
+
+        // Fold constants.
+        if (opcode == ByteCode::JumpIfTrueOpcode || opcode == ByteCode::JumpIfFalseOpcode) {
+            const Fact* fact = findFact(facts, ops.reads[0].offset, 4);
+
+            if (fact != nullptr && fact->isConst) {
+                if ((static_cast<uint32_t>(fact->value) != 0) == (opcode == ByteCode::JumpIfTrueOpcode)) {
+                    replaceWithJump(instr);
+                } else {
+                    instr.isRemoved = true;
+                    m_isChanged = true;
+                }
+            }
+            continue;
+        }
+
+        if (ops.isPure && ops.writes.size() == 1 && (ops.writes[0].size == 4 || ops.writes[0].size == 8)
+            && ops.reads.size() >= 1 && ops.reads.size() <= 2) {
+            uint64_t values[2];
+            bool isConstant = true;
+
+            for (size_t j = 0; j < ops.reads.size(); j++) {
+                const Fact* fact = findFact(facts, ops.reads[j].offset, ops.reads[j].size);
+                if (fact == nullptr || !fact->isConst) {
+                    isConstant = false;
+                    break;
+                }
+                values[j] = fact->value;
+            }
+
+            if (isConstant) {
+                uint64_t result;
+                bool isFolded;
+
+                switch (opcode) {
+                case ByteCode::MoveI32Opcode:
+                case ByteCode::MoveF32Opcode:
+                case ByteCode::MoveI64Opcode:
+                case ByteCode::MoveF64Opcode:
+                    result = values[0];
+                    isFolded = true;
+                    break;
+                default:
+                    if (ops.reads.size() == 2) {
+                        isFolded = foldBinary(opcode, values[0], values[1], result);
+                    } else {
+                        isFolded = foldUnary(opcode, values[0], result);
+                    }
+                    break;
+                }
+
+                if (isFolded) {
+                    replaceWithConst(instr, ops.writes[0].offset, ops.writes[0].size, result);
+                    code = byteCodeAt(instr);
+                    decode(code, ops);
+                    opcode = code->opcode();
+                }
+            }
+        }
+
+        // Drop the facts invalidated by the writes.
+        const std::vector<Operand>* lists[] = { &ops.writes, &ops.mayWrites };
+        for (size_t j = 0; j < 2; j++) {
+            for (const auto& operand : *lists[j]) {
+                size_t k = 0;
+                for (size_t l = 0; l < facts.size(); l++) {
+                    const Fact& fact = facts[l];
+                    if (isOverlapping(fact.dst, fact.size, operand.offset, operand.size)
+                        || (!fact.isConst && isOverlapping(fact.src, fact.size, operand.offset, operand.size))) {
+                        continue;
+                    }
+                    facts[k++] = fact;
+                }
+                facts.resize(k);
+            }
+        }
+
+        if (facts.size() >= maxFacts) {
+            facts.erase(facts.begin());
+        }
+
+        switch (opcode) {
+        case ByteCode::Const32Opcode:
+            facts.push_back({ ops.writes[0].offset, 4, 0, true, reinterpret_cast<Const32*>(code)->value() });
+            break;
+        case ByteCode::Const64Opcode:
+            facts.push_back({ ops.writes[0].offset, 8, 0, true, reinterpret_cast<Const64*>(code)->value() });
+            break;
+        case ByteCode::MoveI32Opcode:
+        case ByteCode::MoveF32Opcode:
+        case ByteCode::MoveI64Opcode:
+        case ByteCode::MoveF64Opcode:
+        case ByteCode::MoveV128Opcode: {
+            const Operand& src = ops.reads[0];
+            const Operand& dst = ops.writes[0];
+            if (!isOverlapping(src.offset, src.size, dst.offset, dst.size)) {
+                facts.push_back({ dst.offset, dst.size, src.offset, false, 0 });
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+void ByteCodeOptimizer::buildBlocks()
+{
+    Operands ops;
+    size_t count = m_instructions.size();
+
+    m_blocks.clear();
+    m_blockOf.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        if (m_instructions[i].isLeader) {
+            m_blocks.push_back(Block());
+            m_blocks.back().start = i;
+        }
+        m_blockOf[i] = m_blocks.size() - 1;
+        m_blocks.back().end = i + 1;
+    }
+
+    for (size_t i = 0; i < m_blocks.size(); i++) {
+        Block& block = m_blocks[i];
+        bool hasFallThrough = true;
+
+        for (size_t j = block.end; j > block.start; j--) {
+            const Instruction& instr = m_instructions[j - 1];
+
+            if (instr.isRemoved) {
+                continue;
+            }
+
+            decode(byteCodeAt(instr), ops);
+            if (ops.kind != Operands::Normal) {
+                hasFallThrough = ops.kind == Operands::ConditionalJump;
+                for (uint32_t k = 0; k < instr.targetCount; k++) {
+                    block.successors.push_back(m_blockOf[m_targets[instr.targetStart + k]]);
+                }
+            }
+            break;
+        }
+
+        if (hasFallThrough && i + 1 < m_blocks.size()) {
+            block.successors.push_back(i + 1);
+        }
+    }
+}
+
+void ByteCodeOptimizer::computeLiveness(std::vector<uint64_t>& live, uint32_t blockIndex, bool removeDead, bool& removed)
+{
+    Block& block = m_blocks[blockIndex];
+    Operands ops;
+
+    for (size_t i = block.end; i > block.start; i--) {
+        Instruction& instr = m_instructions[i - 1];
+
+        if (instr.isRemoved) {
+            continue;
+        }
+
+        decode(byteCodeAt(instr), ops);
+
+        if (ops.isOpaque) {
+            std::fill(live.begin(), live.end(), ~static_cast<uint64_t>(0));
+            continue;
+        }
+
+        if (removeDead && ops.isPure && !ops.writes.empty()) {
+            bool isDead = true;
+
+            for (const auto& operand : ops.writes) {
+                size_t end = std::min(m_unitCount, static_cast<size_t>((operand.offset + operand.size + s_unitSize - 1) / s_unitSize));
+                for (size_t unit = operand.offset / s_unitSize; unit < end; unit++) {
+                    if (live[unit / 64] & (static_cast<uint64_t>(1) << (unit % 64))) {
+                        isDead = false;
+                        break;
+                    }
+                }
+            }
+
+            if (isDead) {
+                instr.isRemoved = true;
+                removed = true;
+                continue;
+            }
+        }
+
+        for (const auto& operand : ops.writes) {
+            size_t end = std::min(m_unitCount, static_cast<size_t>((operand.offset + operand.size + s_unitSize - 1) / s_unitSize));
+            for (size_t unit = operand.offset / s_unitSize; unit < end; unit++) {
+                live[unit / 64] &= ~(static_cast<uint64_t>(1) << (unit % 64));
+            }
+        }
+
+        for (const auto& operand : ops.reads) {
+            size_t end = std::min(m_unitCount, static_cast<size_t>((operand.offset + operand.size + s_unitSize - 1) / s_unitSize));
+            for (size_t unit = operand.offset / s_unitSize; unit < end; unit++) {
+                live[unit / 64] |= static_cast<uint64_t>(1) << (unit % 64);
+            }
+        }
+    }
+}
+
+bool ByteCodeOptimizer::removeDeadStores()
+{
+    size_t wordCount = (m_unitCount + 63) / 64;
+    std::vector<uint64_t> live(wordCount);
+    bool isChanged = false;
+
+    buildBlocks();
+
+    for (size_t round = 0; round < s_maxDeadStoreRounds; round++) {
+        for (auto& block : m_blocks) {
+            block.liveIn.assign(wordCount, 0);
+        }
+
+        bool isUpdated = true;
+        bool removed = false;
+
+        while (isUpdated) {
+            isUpdated = false;
+
+            for (size_t i = m_blocks.size(); i > 0; i--) {
+                Block& block = m_blocks[i - 1];
+
+                std::fill(live.begin(), live.end(), 0);
+                for (auto successor : block.successors) {
+                    for (size_t j = 0; j < wordCount; j++) {
+                        live[j] |= m_blocks[successor].liveIn[j];
+                    }
+                }
+
+                computeLiveness(live, i - 1, false, removed);
+                if (live != block.liveIn) {
+                    block.liveIn.swap(live);
+                    isUpdated = true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_blocks.size(); i++) {
+            std::fill(live.begin(), live.end(), 0);
+            for (auto successor : m_blocks[i].successors) {
+                for (size_t j = 0; j < wordCount; j++) {
+                    live[j] |= m_blocks[successor].liveIn[j];
+                }
+            }
+
+            computeLiveness(live, i, true, removed);
+        }
+
+        if (!removed) {
+            break;
+        }
+        isChanged = true;
+    }
+
+    m_isChanged |= isChanged;
+    return isChanged;
+}
+
+void ByteCodeOptimizer::removeRedundantJumps()
+{
+    size_t count = m_instructions.size();
+
+    for (size_t i = 0; i < count; i++) {
+        Instruction& instr = m_instructions[i];
+
+        if (instr.isRemoved || byteCodeAt(instr)->opcode() != ByteCode::JumpOpcode) {
+            continue;
+        }
+
+        size_t next = i + 1;
+        while (next < count && m_instructions[next].isRemoved) {
+            next++;
+        }
+
+        size_t target = m_targets[instr.targetStart];
+        while (target < count && m_instructions[target].isRemoved) {
+            target++;
+        }
+
+        if (target == next) {
+            instr.isRemoved = true;
+            m_isChanged = true;
+        }
+    }
+}
+
+void ByteCodeOptimizer::trimStackSize()
+{
+    if (m_hasOpaqueByteCode) {
+        return;
+    }
+
+    Operands ops;
+    size_t maxEnd = m_paramStackSize;
+
+    for (auto& instr : m_instructions) {
+        if (instr.isRemoved) {
+            continue;
+        }
+
+        decode(byteCodeAt(instr), ops);
+        const std::vector<Operand>* lists[] = { &ops.reads, &ops.writes, &ops.mayWrites };
+        for (size_t i = 0; i < 3; i++) {
+            for (const auto& operand : *lists[i]) {
+                maxEnd = std::max(maxEnd, static_cast<size_t>(operand.offset) + operand.size);
+            }
+        }
+    }
+
+    maxEnd = (maxEnd + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    if (maxEnd < m_requiredStackSize) {
+        m_requiredStackSize = maxEnd;
+        m_isChanged = true;
+    }
+}
+
+void ByteCodeOptimizer::emit()
+{
+    size_t newPosition = 0;
+
+    for (auto& instr : m_instructions) {
+        instr.newPosition = newPosition;
+        if (!instr.isRemoved) {
+            newPosition += instr.size;
+        }
+    }
+
+    std::vector<uint8_t> result(newPosition);
+
+    for (auto& instr : m_instructions) {
+        if (instr.isRemoved) {
+            continue;
+        }
+
+        memcpy(result.data() + instr.newPosition, byteCodeAt(instr), instr.size);
+
+        if (instr.targetCount == 0) {
+            continue;
+        }
+
+        ByteCode* code = reinterpret_cast<ByteCode*>(result.data() + instr.newPosition);
+        const uint32_t* targets = m_targets.data() + instr.targetStart;
+
+        switch (code->opcode()) {
+        case ByteCode::JumpOpcode:
+            reinterpret_cast<Jump*>(code)->setOffset(relativeOffset(instr.newPosition, m_instructions[targets[0]].newPosition));
+            break;
+        case ByteCode::JumpIfTrueOpcode:
+        case ByteCode::JumpIfFalseOpcode:
+        case ByteCode::JumpIfNullOpcode:
+        case ByteCode::JumpIfNonNullOpcode:
+        case ByteCode::JumpIfCastGenericOpcode:
+        case ByteCode::JumpIfCastDefinedOpcode:
+            reinterpret_cast<ByteCodeOffsetValue*>(code)->m_value = static_cast<uint32_t>(relativeOffset(instr.newPosition, m_instructions[targets[0]].newPosition));
+            break;
+        default: {
+            ASSERT(code->opcode() == ByteCode::BrTableOpcode);
+            BrTable* brTable = reinterpret_cast<BrTable*>(code);
+            int32_t* defaultOffset = reinterpret_cast<int32_t*>(reinterpret_cast<uint8_t*>(code) + BrTable::offsetOfDefault());
+
+            *defaultOffset = relativeOffset(instr.newPosition, m_instructions[targets[0]].newPosition);
+            for (uint32_t i = 0; i < brTable->tableSize(); i++) {
+                brTable->jumpOffsets()[i] = relativeOffset(instr.newPosition, m_instructions[targets[i + 1]].newPosition);
+            }
+            break;
+        }
+        }
+    }
+
+    m_byteCode.resizeWithUninitializedValues(result.size());
+    memcpy(m_byteCode.data(), result.data(), result.size());
+}
+
+bool ByteCodeOptimizer::optimize()
+{
+    if (!buildInstructions()) {
+        return false;
+    }
+
+    propagate();
+    removeDeadStores();
+    removeRedundantJumps();
+    trimStackSize();
+
+    if (m_isChanged) {
+        emit();
+    }
+    return m_isChanged;
+}
+
+} // namespace Walrus
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusByteCodeOptimizer__
+#define __WalrusByteCodeOptimizer__
+
+#include "interpreter/ByteCode.h"
+#include "util/Vector.h"
+
+namespace Walrus {
+
+// Load time optimizer for the byte code of a single function. It performs
+// constant and copy propagation inside basic blocks, folds integer operations
+// with constant operands, removes stores to dead stack slots, and trims the
+// required stack size. Functions with try-catch blocks are left unchanged.
+class ByteCodeOptimizer {
+public:
+    typedef Vector<uint8_t, std::allocator<uint8_t>> ByteCodeVector;
+
+    ByteCodeOptimizer(ByteCodeVector& byteCode, uint16_t paramStackSize, uint16_t requiredStackSize);
+
+    // Returns true, if the byte code has been changed.
+    bool optimize();
+
+    uint16_t requiredStackSize() const { return m_requiredStackSize; }
+
+private:
+    struct Operand {
+        ByteCodeStackOffset* field;
+        uint16_t offset;
+        uint16_t size;
+    };
+
+    struct Operands {
+        enum Kind : uint8_t {
+            Normal,
+            Jump,
+            ConditionalJump,
+            BrTable,
+            Terminator,
+        };
+
+        void clear()
+        {
+            reads.clear();
+            writes.clear();
+            mayWrites.clear();
+            kind = Normal;
+            isPure = false;
+            isOpaque = false;
+        }
+
+        std::vector<Operand> reads;
+        std::vector<Operand> writes;
+        // Writes which are not guaranteed to happen, e.g. call results.
+        std::vector<Operand> mayWrites;
+        Kind kind;
+        // Can be removed when all of its writes are dead.
+        bool isPure;
+        // Operands are unknown, everything is read and may be written.
+        bool isOpaque;
+    };
+
+    struct Instruction {
+        size_t position;
+        size_t newPosition;
+        uint32_t size;
+        uint32_t replacement;
+        uint32_t targetStart;
+        uint32_t targetCount;
+        bool isLeader;
+        bool isRemoved;
+    };
+
+    // A stack slot which holds a constant or a copy of another slot.
+    struct Fact {
+        uint16_t dst;
+        uint16_t size;
+        uint16_t src;
+        bool isConst;
+        uint64_t value;
+    };
+
+    struct Block {
+        uint32_t start;
+        uint32_t end;
+        std::vector<uint32_t> successors;
+        std::vector<uint64_t> liveIn;
+    };
+
+    ByteCode* byteCodeAt(const Instruction& instr);
+    void decode(ByteCode* code, Operands& ops);
+    void computeLiveness(std::vector<uint64_t>& live, uint32_t blockIndex, bool removeDead, bool& removed);
+    bool buildInstructions();
+    void propagate();
+    const Fact* findFact(const std::vector<Fact>& facts, uint16_t offset, uint16_t size);
+    void replaceWithConst(Instruction& instr, ByteCodeStackOffset dst, uint16_t size, uint64_t value);
+    void replaceWithJump(Instruction& instr);
+    void buildBlocks();
+    bool removeDeadStores();
+    void removeRedundantJumps();
+    void trimStackSize();
+    void emit();
+
+    ByteCodeVector& m_byteCode;
+    uint16_t m_paramStackSize;
+    uint16_t m_requiredStackSize;
+    size_t m_unitCount;
+    bool m_hasOpaqueByteCode;
+    bool m_isChanged;
+    std::vector<Instruction> m_instructions;
+    std::vector<uint32_t> m_targets;
+    std::vector<uint8_t> m_replacements;
+    // Slots which are written only once by a constant in the entry block.
+    std::vector<Fact> m_globalFacts;
+    std::vector<int32_t> m_globalFactIndex;
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_blockOf;
+};
+
+} // namespace Walrus
+
+#endif // __WalrusByteCodeOptimizer__
@@ -32,7 +32,7 @@
 #include "runtime/Tag.h"
 #include "util/MathOperation.h"
 
-#if defined(WALRUS_ENABLE_COMPUTED_GOTO) && !defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
+#if defined(WALRUS_ENABLE_COMPUTED_GOTO) && !defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL) && !defined(WALRUS_COMPACT_BYTECODE)
 extern char FillByteCodeOpcodeTableAsmLbl[];
 const void* FillByteCodeOpcodeAddress[] = { &FillByteCodeOpcodeTableAsmLbl[0] };
 #endif
@@ -148,13 +148,15 @@ ByteCodeTable::ByteCodeTable()
     // Dummy bytecode execution to initialize the ByteCodeTable.
     ExecutionState dummyState;
     ByteCode b;
-#if defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
+#if defined(WALRUS_COMPACT_BYTECODE)
+    b.m_opcode = ByteCode::FillOpcodeTableOpcode;
+#elif defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
     b.m_opcodeInAddress = nullptr;
 #else
     b.m_opcodeInAddress = const_cast<void*>(FillByteCodeOpcodeAddress[0]);
 #endif
     size_t pc = reinterpret_cast<size_t>(&b);
-    Interpreter::StackFrame dummyFrame(nullptr, 0);
+    Interpreter::StackFrame dummyFrame(dummyState, nullptr, 0);
     Interpreter::interpret(dummyState, pc, dummyFrame, nullptr);
 #endif
 }
@@ -222,42 +224,101 @@ T intNeg(T val) { return ~val + 1; }
 template <typename T>
 T intAvgr(ExecutionState& state, T lhs, T rhs) { return (lhs + rhs + 1) / 2; }
 
+// Result of an operation which may trap. The trap is returned by interpret().
 template <typename T>
-T intDiv(ExecutionState& state, T lhs, T rhs)
+struct TrapOr {
+    TrapOr(T value)
+        : value(value)
+        , trapCode(Exception::NoTrap)
+    {
+    }
+
+    TrapOr(Exception::TrapCode trapCode)
+        : value(0)
+        , trapCode(trapCode)
+    {
+    }
+
+    T value;
+    Exception::TrapCode trapCode;
+};
+
+template <typename T>
+ALWAYS_INLINE Exception::TrapCode trapCodeOf(const T&) { return Exception::NoTrap; }
+template <typename T>
+ALWAYS_INLINE Exception::TrapCode trapCodeOf(const TrapOr<T>& result) { return result.trapCode; }
+template <typename T>
+ALWAYS_INLINE const T& valueOf(const T& result) { return result; }
+template <typename T>
+ALWAYS_INLINE const T& valueOf(const TrapOr<T>& result) { return result.value; }
+
+// Stores the trap in the state, and returns with the trap status of interpret().
+static NEVER_INLINE ByteCodeStackOffset* trap(ExecutionState& state, Exception::TrapCode trapCode, uint64_t detail1 = 0, uint64_t detail2 = 0)
+{
+    state.setTrap(trapCode, detail1, detail2);
+    return nullptr;
+}
+
+// Memory accesses are checked before the access, so the trap is returned by
+// interpret() instead of thrown by the memory.
+#define CHECK_MEMORY_ACCESS(memory, offset, size, addend)                                                           \
+    if (UNLIKELY(!(memory)->checkAccess(offset, size, addend))) {                                                   \
+        return trap(state, Exception::OutOfBoundsMemoryAccessAt, static_cast<uint32_t>((offset) + (addend)), size); \
+    }
+
+#define CHECK_MEMORY_ACCESS_M64(memory, offset, size, addend)                                                       \
+    if (UNLIKELY(!(memory)->checkAccessM64(offset, size, addend))) {                                                \
+        return trap(state, Exception::OutOfBoundsMemoryAccessAt, static_cast<uint32_t>((offset) + (addend)), size); \
+    }
+
+#define CHECK_ATOMIC_ACCESS(memory, offset, size, addend) \
+    CHECK_MEMORY_ACCESS(memory, offset, size, addend)     \
+    if (UNLIKELY(((offset) + (addend)) % (size) != 0)) {  \
+        return trap(state, Exception::UnalignedAtomic);   \
+    }
+
+#define CHECK_ATOMIC_ACCESS_M64(memory, offset, size, addend) \
+    CHECK_MEMORY_ACCESS_M64(memory, offset, size, addend)     \
+    if (UNLIKELY(((offset) + (addend)) % (size) != 0)) {      \
+        return trap(state, Exception::UnalignedAtomic);       \
+    }
+
+template <typename T>
+TrapOr<T> intDiv(ExecutionState& state, T lhs, T rhs)
 {
     if (UNLIKELY(rhs == 0)) {
-        Trap::throwException(state, "integer divide by zero");
+        return Exception::IntegerDivideByZero;
     }
     if (UNLIKELY(!isNormalDivRem(lhs, rhs))) {
-        Trap::throwException(state, "integer overflow");
+        return Exception::IntegerOverflow;
     }
-    return lhs / rhs;
+    return static_cast<T>(lhs / rhs);
 }
 
 template <typename T>
-T intRem(ExecutionState& state, T lhs, T rhs)
+TrapOr<T> intRem(ExecutionState& state, T lhs, T rhs)
 {
     if (UNLIKELY(rhs == 0)) {
-        Trap::throwException(state, "integer divide by zero");
+        return Exception::IntegerDivideByZero;
     }
     if (LIKELY(isNormalDivRem(lhs, rhs))) {
-        return lhs % rhs;
+        return static_cast<T>(lhs % rhs);
     } else {
-        return 0;
+        return static_cast<T>(0);
     }
 }
 
 template <typename R, typename T>
-R doConvert(ExecutionState& state, T val)
+TrapOr<R> doConvert(ExecutionState& state, T val)
 {
     if (std::is_integral<R>::value && std::is_floating_point<T>::value) {
         // Don't use std::isnan here because T may be a non-floating-point type.
         if (UNLIKELY(isNaN(val))) {
-            Trap::throwException(state, "invalid conversion to integer");
+            return Exception::InvalidConversionToInteger;
         }
     }
     if (UNLIKELY(!canConvert<R>(val))) {
-        Trap::throwException(state, "integer overflow");
+        return Exception::IntegerOverflow;
     }
     return convert<R>(val);
 }
@@ -471,7 +532,7 @@ inline static void simdSplatOperation(ExecutionState& state, UnaryOperation* cod
     writeValue<ResultType>(bp, code->dstOffset(), result);
 }
 
-#if defined(WALRUS_ENABLE_COMPUTED_GOTO)
+#if defined(WALRUS_ENABLE_COMPUTED_GOTO) && !defined(WALRUS_COMPACT_BYTECODE)
 static void initAddressToOpcodeTable()
 {
 #define REGISTER_TABLE(name, ...) \
@@ -489,20 +550,25 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
     Memory** memories = reinterpret_cast<Memory**>(reinterpret_cast<uintptr_t>(instance) + Instance::alignedSize());
     uint8_t* bp = frame.bp();
 
+    // Valid only while this call is active; callInterpreter clears it on every exit.
     state.m_programCounterPointer = &programCounter;
 
 #define ADD_PROGRAM_COUNTER(codeName) programCounter += sizeof(codeName);
 
-#define BINARY_OPERATION(name, op, paramType, returnType)                   \
-    DEFINE_OPCODE(name)                                                     \
-        :                                                                   \
-    {                                                                       \
-        name* code = (name*)programCounter;                                 \
-        auto lhs = readValue<paramType>(bp, code->srcOffset()[0]);          \
-        auto rhs = readValue<paramType>(bp, code->srcOffset()[1]);          \
-        writeValue<returnType>(bp, code->dstOffset(), op(state, lhs, rhs)); \
-        ADD_PROGRAM_COUNTER(name);                                          \
-        NEXT_INSTRUCTION();                                                 \
+#define BINARY_OPERATION(name, op, paramType, returnType)               \
+    DEFINE_OPCODE(name)                                                 \
+        :                                                               \
+    {                                                                   \
+        name* code = (name*)programCounter;                             \
+        auto lhs = readValue<paramType>(bp, code->srcOffset()[0]);      \
+        auto rhs = readValue<paramType>(bp, code->srcOffset()[1]);      \
+        auto result = op(state, lhs, rhs);                              \
+        if (UNLIKELY(trapCodeOf(result) != Exception::NoTrap)) {        \
+            return trap(state, trapCodeOf(result));                     \
+        }                                                               \
+        writeValue<returnType>(bp, code->dstOffset(), valueOf(result)); \
+        ADD_PROGRAM_COUNTER(name);                                      \
+        NEXT_INSTRUCTION();                                             \
     }
 
 #define UNARY_OPERATION(name, op, type)                                                      \
@@ -515,14 +581,18 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         NEXT_INSTRUCTION();                                                                  \
     }
 
-#define UNARY_OPERATION_2(name, op, paramType, returnType, T1, T2)                                                     \
-    DEFINE_OPCODE(name)                                                                                                \
-        :                                                                                                              \
-    {                                                                                                                  \
-        name* code = (name*)programCounter;                                                                            \
-        writeValue<returnType>(bp, code->dstOffset(), op<T1, T2>(state, readValue<paramType>(bp, code->srcOffset()))); \
-        ADD_PROGRAM_COUNTER(name);                                                                                     \
-        NEXT_INSTRUCTION();                                                                                            \
+#define UNARY_OPERATION_2(name, op, paramType, returnType, T1, T2)                    \
+    DEFINE_OPCODE(name)                                                               \
+        :                                                                             \
+    {                                                                                 \
+        name* code = (name*)programCounter;                                           \
+        auto result = op<T1, T2>(state, readValue<paramType>(bp, code->srcOffset())); \
+        if (UNLIKELY(trapCodeOf(result) != Exception::NoTrap)) {                      \
+            return trap(state, trapCodeOf(result));                                   \
+        }                                                                             \
+        writeValue<returnType>(bp, code->dstOffset(), valueOf(result));               \
+        ADD_PROGRAM_COUNTER(name);                                                    \
+        NEXT_INSTRUCTION();                                                           \
     }
 
 #define MOVE_OPERATION(name, type)                                                                           \
@@ -647,464 +717,496 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         :                                                 \
     {                                                     \
         op(state, (TernaryOperation*)programCounter, bp); \
-        ADD_PROGRAM_COUNTER(BinaryOperation);             \
+        ADD_PROGRAM_COUNTER(TernaryOperation);            \
         NEXT_INSTRUCTION();                               \
     }
 
-#define MEMORY_LOAD_INT_OPERATION(opcodeName, readType, writeType)    \
-    DEFINE_OPCODE(opcodeName)                                         \
-        :                                                             \
-    {                                                                 \
-        MemoryLoad* code = (MemoryLoad*)programCounter;               \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset()); \
-        readType value;                                               \
-        memories[0]->load(state, offset, code->offset(), &value);     \
-        writeValue<writeType>(bp, code->dstOffset(), value);          \
-        ADD_PROGRAM_COUNTER(MemoryLoad);                              \
-        NEXT_INSTRUCTION();                                           \
-    }
-
-#define MEMORY_LOAD_INT_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                          \
-        :                                                              \
-    {                                                                  \
-        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;          \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());  \
-        readType value;                                                \
-        memories[0]->loadM64(state, offset, code->offset(), &value);   \
-        writeValue<writeType>(bp, code->dstOffset(), value);           \
-        ADD_PROGRAM_COUNTER(MemoryLoadM64);                            \
-        NEXT_INSTRUCTION();                                            \
-    }
-
-#define MEMORY_LOAD_FLOAT_OPERATION(opcodeName, readType, writeType)  \
-    DEFINE_OPCODE(opcodeName)                                         \
-        :                                                             \
-    {                                                                 \
-        MemoryLoadFloat* code = (MemoryLoadFloat*)programCounter;     \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset()); \
-        readType value;                                               \
-        memories[0]->load(state, offset, code->offset(), &value);     \
-        writeValue<writeType>(bp, code->dstOffset(), value);          \
-        ADD_PROGRAM_COUNTER(MemoryLoadFloat);                         \
-        NEXT_INSTRUCTION();                                           \
-    }
-
-#define MEMORY_LOAD_FLOAT_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                            \
-        :                                                                \
-    {                                                                    \
-        MemoryLoadFloatM64* code = (MemoryLoadFloatM64*)programCounter;  \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());    \
-        readType value;                                                  \
-        memories[0]->loadM64(state, offset, code->offset(), &value);     \
-        writeValue<writeType>(bp, code->dstOffset(), value);             \
-        ADD_PROGRAM_COUNTER(MemoryLoadFloatM64);                         \
-        NEXT_INSTRUCTION();                                              \
-    }
-
-#define MEMORY_LOAD_INT_MEMIDX_OPERATION(opcodeName, readType, writeType)        \
+#define MEMORY_LOAD_INT_OPERATION(opcodeName, readType, writeType)               \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
-        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;              \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                          \
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
         readType value;                                                          \
-        memories[code->memIndex()]->load(state, offset, code->offset(), &value); \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->load(state, offset, code->offset(), &value);                \
         writeValue<writeType>(bp, code->dstOffset(), value);                     \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                   \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                         \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define MEMORY_LOAD_INT_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)       \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;           \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());               \
-        readType value;                                                             \
-        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);                        \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                   \
-        NEXT_INSTRUCTION();                                                         \
+#define MEMORY_LOAD_INT_M64_OPERATION(opcodeName, readType, writeType)               \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;                        \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                \
+        readType value;                                                              \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->loadM64(state, offset, code->offset(), &value);                 \
+        writeValue<writeType>(bp, code->dstOffset(), value);                         \
+        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                          \
+        NEXT_INSTRUCTION();                                                          \
     }
 
-#define MEMORY_LOAD_FLOAT_MEMIDX_OPERATION(opcodeName, readType, writeType)      \
+#define MEMORY_LOAD_FLOAT_OPERATION(opcodeName, readType, writeType)             \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
-        MemoryLoadFloatMemIdx* code = (MemoryLoadFloatMemIdx*)programCounter;    \
+        MemoryLoadFloat* code = (MemoryLoadFloat*)programCounter;                \
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
         readType value;                                                          \
-        memories[code->memIndex()]->load(state, offset, code->offset(), &value); \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->load(state, offset, code->offset(), &value);                \
         writeValue<writeType>(bp, code->dstOffset(), value);                     \
-        ADD_PROGRAM_COUNTER(MemoryLoadFloatMemIdx);                              \
+        ADD_PROGRAM_COUNTER(MemoryLoadFloat);                                    \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define MEMORY_LOAD_FLOAT_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)     \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        MemoryLoadFloatMemIdxM64* code = (MemoryLoadFloatMemIdxM64*)programCounter; \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());               \
-        readType value;                                                             \
-        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);                        \
-        ADD_PROGRAM_COUNTER(MemoryLoadFloatMemIdxM64);                              \
-        NEXT_INSTRUCTION();                                                         \
-    }
-
-#define MEMORY_STORE_32_OPERATION(opcodeName, readType, writeType)      \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        MemoryStore32* code = (MemoryStore32*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset()); \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());   \
-        memories[0]->store(state, offset, code->offset(), value);       \
-        ADD_PROGRAM_COUNTER(MemoryStore32);                             \
-        NEXT_INSTRUCTION();                                             \
-    }
-
-#define MEMORY_STORE_32_M64_OPERATION(opcodeName, readType, writeType)  \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        MemoryStore32M64* code = (MemoryStore32M64*)programCounter;     \
-        writeType value = readValue<readType>(bp, code->valueOffset()); \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());   \
-        memories[0]->storeM64(state, offset, code->offset(), value);    \
-        ADD_PROGRAM_COUNTER(MemoryStore32M64);                          \
-        NEXT_INSTRUCTION();                                             \
+#define MEMORY_LOAD_FLOAT_M64_OPERATION(opcodeName, readType, writeType)             \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryLoadFloatM64* code = (MemoryLoadFloatM64*)programCounter;              \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                \
+        readType value;                                                              \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->loadM64(state, offset, code->offset(), &value);                 \
+        writeValue<writeType>(bp, code->dstOffset(), value);                         \
+        ADD_PROGRAM_COUNTER(MemoryLoadFloatM64);                                     \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define MEMORY_LOAD_INT_MEMIDX_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;                             \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                           \
+        readType value;                                                                         \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->load(state, offset, code->offset(), &value);                \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                    \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                                  \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define MEMORY_LOAD_INT_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;                           \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                               \
+        readType value;                                                                             \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);                 \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                        \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                                   \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define MEMORY_STORE_64_OPERATION(opcodeName, readType, writeType)      \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        MemoryStore64* code = (MemoryStore64*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset()); \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());   \
-        memories[0]->store(state, offset, code->offset(), value);       \
-        ADD_PROGRAM_COUNTER(MemoryStore64);                             \
-        NEXT_INSTRUCTION();                                             \
+#define MEMORY_LOAD_FLOAT_MEMIDX_OPERATION(opcodeName, readType, writeType)                     \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryLoadFloatMemIdx* code = (MemoryLoadFloatMemIdx*)programCounter;                   \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                           \
+        readType value;                                                                         \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->load(state, offset, code->offset(), &value);                \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                    \
+        ADD_PROGRAM_COUNTER(MemoryLoadFloatMemIdx);                                             \
+        NEXT_INSTRUCTION();                                                                     \
     }
 
-#define MEMORY_STORE_64_M64_OPERATION(opcodeName, readType, writeType)  \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        MemoryStore64M64* code = (MemoryStore64M64*)programCounter;     \
-        writeType value = readValue<readType>(bp, code->valueOffset()); \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());   \
-        memories[0]->storeM64(state, offset, code->offset(), value);    \
-        ADD_PROGRAM_COUNTER(MemoryStore64M64);                          \
-        NEXT_INSTRUCTION();                                             \
+#define MEMORY_LOAD_FLOAT_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)                     \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryLoadFloatMemIdxM64* code = (MemoryLoadFloatMemIdxM64*)programCounter;                 \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                               \
+        readType value;                                                                             \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);                 \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                        \
+        ADD_PROGRAM_COUNTER(MemoryLoadFloatMemIdxM64);                                              \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define MEMORY_STORE_MEMIDX_32_OPERATION(opcodeName, readType, writeType)        \
+#define MEMORY_STORE_32_OPERATION(opcodeName, readType, writeType)               \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
-        MemoryStoreMemIdx32* code = (MemoryStoreMemIdx32*)programCounter;        \
+        MemoryStore32* code = (MemoryStore32*)programCounter;                    \
         writeType value = readValue<readType>(bp, code->valueOffset());          \
         uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());            \
-        memories[code->memIndex()]->store(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32);                                \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(MemoryStore32);                                      \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define MEMORY_STORE_MEMIDX_32_M64_OPERATION(opcodeName, readType, writeType)       \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        MemoryStoreMemIdx32M64* code = (MemoryStoreMemIdx32M64*)programCounter;     \
-        writeType value = readValue<readType>(bp, code->valueOffset());             \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());               \
-        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32M64);                                \
-        NEXT_INSTRUCTION();                                                         \
+#define MEMORY_STORE_32_M64_OPERATION(opcodeName, readType, writeType)               \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryStore32M64* code = (MemoryStore32M64*)programCounter;                  \
+        writeType value = readValue<readType>(bp, code->valueOffset());              \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(MemoryStore32M64);                                       \
+        NEXT_INSTRUCTION();                                                          \
     }
 
-#define MEMORY_STORE_MEMIDX_64_OPERATION(opcodeName, readType, writeType)        \
+#define MEMORY_STORE_64_OPERATION(opcodeName, readType, writeType)               \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
-        MemoryStoreMemIdx64* code = (MemoryStoreMemIdx64*)programCounter;        \
+        MemoryStore64* code = (MemoryStore64*)programCounter;                    \
         writeType value = readValue<readType>(bp, code->valueOffset());          \
         uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());            \
-        memories[code->memIndex()]->store(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64);                                \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(MemoryStore64);                                      \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define MEMORY_STORE_MEMIDX_64_M64_OPERATION(opcodeName, readType, writeType)       \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        MemoryStoreMemIdx64M64* code = (MemoryStoreMemIdx64M64*)programCounter;     \
-        writeType value = readValue<readType>(bp, code->valueOffset());             \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());               \
-        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64M64);                                \
-        NEXT_INSTRUCTION();                                                         \
-    }
-
-#define SIMD_MEMORY_LOAD_SPLAT_OPERATION(opcodeName, opType)          \
-    DEFINE_OPCODE(opcodeName)                                         \
-        :                                                             \
-    {                                                                 \
-        using Type = typename SIMDType<opType>::Type;                 \
-        MemoryLoad* code = (MemoryLoad*)programCounter;               \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset()); \
-        opType value;                                                 \
-        memories[0]->load(state, offset, code->offset(), &value);     \
-        Type result;                                                  \
-        std::fill(std::begin(result.v), std::end(result.v), value);   \
-        writeValue<Type>(bp, code->dstOffset(), result);              \
-        ADD_PROGRAM_COUNTER(MemoryLoad);                              \
-        NEXT_INSTRUCTION();                                           \
-    }
-
-#define SIMD_MEMORY_LOAD_SPLAT_M64_OPERATION(opcodeName, opType)      \
-    DEFINE_OPCODE(opcodeName)                                         \
-        :                                                             \
-    {                                                                 \
-        using Type = typename SIMDType<opType>::Type;                 \
-        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;         \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset()); \
-        opType value;                                                 \
-        memories[0]->loadM64(state, offset, code->offset(), &value);  \
-        Type result;                                                  \
-        std::fill(std::begin(result.v), std::end(result.v), value);   \
-        writeValue<Type>(bp, code->dstOffset(), result);              \
-        ADD_PROGRAM_COUNTER(MemoryLoadM64);                           \
-        NEXT_INSTRUCTION();                                           \
-    }
-
-#define SIMD_MEMORY_LOAD_SPLAT_MEMIDX_OPERATION(opcodeName, opType)              \
+#define MEMORY_STORE_64_M64_OPERATION(opcodeName, readType, writeType)               \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryStore64M64* code = (MemoryStore64M64*)programCounter;                  \
+        writeType value = readValue<readType>(bp, code->valueOffset());              \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(MemoryStore64M64);                                       \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define MEMORY_STORE_MEMIDX_32_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryStoreMemIdx32* code = (MemoryStoreMemIdx32*)programCounter;                       \
+        writeType value = readValue<readType>(bp, code->valueOffset());                         \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                           \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32);                                               \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define MEMORY_STORE_MEMIDX_32_M64_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryStoreMemIdx32M64* code = (MemoryStoreMemIdx32M64*)programCounter;                     \
+        writeType value = readValue<readType>(bp, code->valueOffset());                             \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                               \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32M64);                                                \
+        NEXT_INSTRUCTION();                                                                         \
+    }
+
+#define MEMORY_STORE_MEMIDX_64_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryStoreMemIdx64* code = (MemoryStoreMemIdx64*)programCounter;                       \
+        writeType value = readValue<readType>(bp, code->valueOffset());                         \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                           \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64);                                               \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define MEMORY_STORE_MEMIDX_64_M64_OPERATION(opcodeName, readType, writeType)                       \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryStoreMemIdx64M64* code = (MemoryStoreMemIdx64M64*)programCounter;                     \
+        writeType value = readValue<readType>(bp, code->valueOffset());                             \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                               \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64M64);                                                \
+        NEXT_INSTRUCTION();                                                                         \
+    }
+
+#define SIMD_MEMORY_LOAD_SPLAT_OPERATION(opcodeName, opType)                     \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
         using Type = typename SIMDType<opType>::Type;                            \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                          \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
         opType value;                                                            \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->load(state, offset, code->offset(), &value);                \
         Type result;                                                             \
-        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;              \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
-        memories[code->memIndex()]->load(state, offset, code->offset(), &value); \
         std::fill(std::begin(result.v), std::end(result.v), value);              \
         writeValue<Type>(bp, code->dstOffset(), result);                         \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                   \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                         \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define SIMD_MEMORY_LOAD_SPLAT_MEMIDX_M64_OPERATION(opcodeName, opType)             \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        using Type = typename SIMDType<opType>::Type;                               \
-        opType value;                                                               \
-        Type result;                                                                \
-        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;           \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());               \
-        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value); \
-        std::fill(std::begin(result.v), std::end(result.v), value);                 \
-        writeValue<Type>(bp, code->dstOffset(), result);                            \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                   \
-        NEXT_INSTRUCTION();                                                         \
-    }
-
-#define SIMD_MEMORY_LOAD_EXTEND_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                              \
-        :                                                                  \
-    {                                                                      \
-        using WriteType = typename SIMDType<writeType>::Type;              \
-        MemoryLoad* code = (MemoryLoad*)programCounter;                    \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());      \
-        readType value;                                                    \
-        memories[0]->load(state, offset, code->offset(), &value);          \
-        WriteType result;                                                  \
-        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                   \
-            result[i] = value[i];                                          \
-        }                                                                  \
-        writeValue<WriteType>(bp, code->dstOffset(), result);              \
-        ADD_PROGRAM_COUNTER(MemoryLoad);                                   \
-        NEXT_INSTRUCTION();                                                \
-    }
-
-#define SIMD_MEMORY_LOAD_EXTEND_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                                  \
-        :                                                                      \
-    {                                                                          \
-        using WriteType = typename SIMDType<writeType>::Type;                  \
-        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;                  \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());          \
-        readType value;                                                        \
-        memories[0]->loadM64(state, offset, code->offset(), &value);           \
-        WriteType result;                                                      \
-        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                       \
-            result[i] = value[i];                                              \
-        }                                                                      \
-        writeValue<WriteType>(bp, code->dstOffset(), result);                  \
-        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                    \
-        NEXT_INSTRUCTION();                                                    \
-    }
-
-#define SIMD_MEMORY_LOAD_EXTEND_MEMIDX_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                                     \
-        :                                                                         \
-    {                                                                             \
-        using WriteType = typename SIMDType<writeType>::Type;                     \
-        readType value;                                                           \
-        WriteType result;                                                         \
-        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;               \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());             \
-        memories[code->memIndex()]->load(state, offset, code->offset(), &value);  \
-        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                          \
-            result[i] = value[i];                                                 \
-        }                                                                         \
-        writeValue<WriteType>(bp, code->dstOffset(), result);                     \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                    \
-        NEXT_INSTRUCTION();                                                       \
-    }
-
-#define SIMD_MEMORY_LOAD_EXTEND_MEMIDX_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                                         \
-        :                                                                             \
-    {                                                                                 \
-        using WriteType = typename SIMDType<writeType>::Type;                         \
-        readType value;                                                               \
-        WriteType result;                                                             \
-        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;             \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                 \
-        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);   \
-        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                              \
-            result[i] = value[i];                                                     \
-        }                                                                             \
-        writeValue<WriteType>(bp, code->dstOffset(), result);                         \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                     \
-        NEXT_INSTRUCTION();                                                           \
+#define SIMD_MEMORY_LOAD_SPLAT_M64_OPERATION(opcodeName, opType)                     \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        using Type = typename SIMDType<opType>::Type;                                \
+        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;                        \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                \
+        opType value;                                                                \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->loadM64(state, offset, code->offset(), &value);                 \
+        Type result;                                                                 \
+        std::fill(std::begin(result.v), std::end(result.v), value);                  \
+        writeValue<Type>(bp, code->dstOffset(), result);                             \
+        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                          \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define SIMD_MEMORY_LOAD_SPLAT_MEMIDX_OPERATION(opcodeName, opType)                             \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        using Type = typename SIMDType<opType>::Type;                                           \
+        opType value;                                                                           \
+        Type result;                                                                            \
+        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;                             \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                           \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->load(state, offset, code->offset(), &value);                \
+        std::fill(std::begin(result.v), std::end(result.v), value);                             \
+        writeValue<Type>(bp, code->dstOffset(), result);                                        \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                                  \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define SIMD_MEMORY_LOAD_SPLAT_MEMIDX_M64_OPERATION(opcodeName, opType)                             \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        using Type = typename SIMDType<opType>::Type;                                               \
+        opType value;                                                                               \
+        Type result;                                                                                \
+        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;                           \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                               \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);                 \
+        std::fill(std::begin(result.v), std::end(result.v), value);                                 \
+        writeValue<Type>(bp, code->dstOffset(), result);                                            \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                                   \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define SIMD_MEMORY_LOAD_LANE_OPERATION(opcodeName, opType)            \
-    DEFINE_OPCODE(opcodeName)                                          \
-        :                                                              \
-    {                                                                  \
-        using Type = typename SIMDType<opType>::Type;                  \
-        SIMDMemoryLoad* code = (SIMDMemoryLoad*)programCounter;        \
-        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset()); \
-        Type result = readValue<Type>(bp, code->src1Offset());         \
-        opType value;                                                  \
-        memories[0]->load(state, offset, code->offset(), &value);      \
-        result[code->index()] = value;                                 \
-        writeValue<Type>(bp, code->dstOffset(), result);               \
-        ADD_PROGRAM_COUNTER(SIMDMemoryLoad);                           \
-        NEXT_INSTRUCTION();                                            \
-    }
-
-#define SIMD_MEMORY_LOAD_LANE_M64_OPERATION(opcodeName, opType)        \
-    DEFINE_OPCODE(opcodeName)                                          \
-        :                                                              \
-    {                                                                  \
-        using Type = typename SIMDType<opType>::Type;                  \
-        SIMDMemoryLoadM64* code = (SIMDMemoryLoadM64*)programCounter;  \
-        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset()); \
-        Type result = readValue<Type>(bp, code->src1Offset());         \
-        opType value;                                                  \
-        memories[0]->loadM64(state, offset, code->offset(), &value);   \
-        result[code->index()] = value;                                 \
-        writeValue<Type>(bp, code->dstOffset(), result);               \
-        ADD_PROGRAM_COUNTER(SIMDMemoryLoadM64);                        \
-        NEXT_INSTRUCTION();                                            \
-    }
-
-#define SIMD_MEMORY_LOAD_LANE_MEMIDX_OPERATION(opcodeName, opType)               \
+#define SIMD_MEMORY_LOAD_EXTEND_OPERATION(opcodeName, readType, writeType)       \
+    DEFINE_OPCODE(opcodeName)                                                    \
+        :                                                                        \
+    {                                                                            \
+        using WriteType = typename SIMDType<writeType>::Type;                    \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                          \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
+        readType value;                                                          \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->load(state, offset, code->offset(), &value);                \
+        WriteType result;                                                        \
+        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                         \
+            result[i] = value[i];                                                \
+        }                                                                        \
+        writeValue<WriteType>(bp, code->dstOffset(), result);                    \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                         \
+        NEXT_INSTRUCTION();                                                      \
+    }
+
+#define SIMD_MEMORY_LOAD_EXTEND_M64_OPERATION(opcodeName, readType, writeType)       \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        using WriteType = typename SIMDType<writeType>::Type;                        \
+        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;                        \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                \
+        readType value;                                                              \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->loadM64(state, offset, code->offset(), &value);                 \
+        WriteType result;                                                            \
+        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                             \
+            result[i] = value[i];                                                    \
+        }                                                                            \
+        writeValue<WriteType>(bp, code->dstOffset(), result);                        \
+        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                          \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define SIMD_MEMORY_LOAD_EXTEND_MEMIDX_OPERATION(opcodeName, readType, writeType)               \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        using WriteType = typename SIMDType<writeType>::Type;                                   \
+        readType value;                                                                         \
+        WriteType result;                                                                       \
+        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;                             \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                           \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->load(state, offset, code->offset(), &value);                \
+        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                                        \
+            result[i] = value[i];                                                               \
+        }                                                                                       \
+        writeValue<WriteType>(bp, code->dstOffset(), result);                                   \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                                  \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define SIMD_MEMORY_LOAD_EXTEND_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)               \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        using WriteType = typename SIMDType<writeType>::Type;                                       \
+        readType value;                                                                             \
+        WriteType result;                                                                           \
+        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;                           \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                               \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);                 \
+        for (uint8_t i = 0; i < WriteType::Lanes; i++) {                                            \
+            result[i] = value[i];                                                                   \
+        }                                                                                           \
+        writeValue<WriteType>(bp, code->dstOffset(), result);                                       \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                                   \
+        NEXT_INSTRUCTION();                                                                         \
+    }
+
+#define SIMD_MEMORY_LOAD_LANE_OPERATION(opcodeName, opType)                      \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
         using Type = typename SIMDType<opType>::Type;                            \
-        SIMDMemoryLoadMemIdx* code = (SIMDMemoryLoadMemIdx*)programCounter;      \
+        SIMDMemoryLoad* code = (SIMDMemoryLoad*)programCounter;                  \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());           \
         Type result = readValue<Type>(bp, code->src1Offset());                   \
         opType value;                                                            \
-        memories[code->memIndex()]->load(state, offset, code->offset(), &value); \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->load(state, offset, code->offset(), &value);                \
         result[code->index()] = value;                                           \
         writeValue<Type>(bp, code->dstOffset(), result);                         \
-        ADD_PROGRAM_COUNTER(SIMDMemoryLoadMemIdx);                               \
+        ADD_PROGRAM_COUNTER(SIMDMemoryLoad);                                     \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define SIMD_MEMORY_LOAD_LANE_MEMIDX_M64_OPERATION(opcodeName, opType)              \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        using Type = typename SIMDType<opType>::Type;                               \
-        SIMDMemoryLoadMemIdxM64* code = (SIMDMemoryLoadMemIdxM64*)programCounter;   \
-        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());              \
-        Type result = readValue<Type>(bp, code->src1Offset());                      \
-        opType value;                                                               \
-        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value); \
-        result[code->index()] = value;                                              \
-        writeValue<Type>(bp, code->dstOffset(), result);                            \
-        ADD_PROGRAM_COUNTER(SIMDMemoryLoadMemIdxM64);                               \
-        NEXT_INSTRUCTION();                                                         \
-    }
-
-#define SIMD_MEMORY_STORE_LANE_OPERATION(opcodeName, opType)           \
-    DEFINE_OPCODE(opcodeName)                                          \
-        :                                                              \
-    {                                                                  \
-        using Type = typename SIMDType<opType>::Type;                  \
-        SIMDMemoryStore* code = (SIMDMemoryStore*)programCounter;      \
-        Type result = readValue<Type>(bp, code->src1Offset());         \
-        opType value = result[code->index()];                          \
-        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset()); \
-        memories[0]->store(state, offset, code->offset(), value);      \
-        ADD_PROGRAM_COUNTER(SIMDMemoryStore);                          \
-        NEXT_INSTRUCTION();                                            \
-    }
-
-#define SIMD_MEMORY_STORE_LANE_M64_OPERATION(opcodeName, opType)        \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        using Type = typename SIMDType<opType>::Type;                   \
-        SIMDMemoryStoreM64* code = (SIMDMemoryStoreM64*)programCounter; \
-        Type result = readValue<Type>(bp, code->src1Offset());          \
-        opType value = result[code->index()];                           \
-        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());  \
-        memories[0]->storeM64(state, offset, code->offset(), value);    \
-        ADD_PROGRAM_COUNTER(SIMDMemoryStoreM64);                        \
-        NEXT_INSTRUCTION();                                             \
+#define SIMD_MEMORY_LOAD_LANE_M64_OPERATION(opcodeName, opType)                      \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        using Type = typename SIMDType<opType>::Type;                                \
+        SIMDMemoryLoadM64* code = (SIMDMemoryLoadM64*)programCounter;                \
+        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());               \
+        Type result = readValue<Type>(bp, code->src1Offset());                       \
+        opType value;                                                                \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->loadM64(state, offset, code->offset(), &value);                 \
+        result[code->index()] = value;                                               \
+        writeValue<Type>(bp, code->dstOffset(), result);                             \
+        ADD_PROGRAM_COUNTER(SIMDMemoryLoadM64);                                      \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define SIMD_MEMORY_LOAD_LANE_MEMIDX_OPERATION(opcodeName, opType)                              \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        using Type = typename SIMDType<opType>::Type;                                           \
+        SIMDMemoryLoadMemIdx* code = (SIMDMemoryLoadMemIdx*)programCounter;                     \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                          \
+        Type result = readValue<Type>(bp, code->src1Offset());                                  \
+        opType value;                                                                           \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->load(state, offset, code->offset(), &value);                \
+        result[code->index()] = value;                                                          \
+        writeValue<Type>(bp, code->dstOffset(), result);                                        \
+        ADD_PROGRAM_COUNTER(SIMDMemoryLoadMemIdx);                                              \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define SIMD_MEMORY_LOAD_LANE_MEMIDX_M64_OPERATION(opcodeName, opType)                              \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        using Type = typename SIMDType<opType>::Type;                                               \
+        SIMDMemoryLoadMemIdxM64* code = (SIMDMemoryLoadMemIdxM64*)programCounter;                   \
+        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                              \
+        Type result = readValue<Type>(bp, code->src1Offset());                                      \
+        opType value;                                                                               \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);                 \
+        result[code->index()] = value;                                                              \
+        writeValue<Type>(bp, code->dstOffset(), result);                                            \
+        ADD_PROGRAM_COUNTER(SIMDMemoryLoadMemIdxM64);                                               \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define SIMD_MEMORY_STORE_LANE_MEMIDX_OPERATION(opcodeName, opType)              \
+#define SIMD_MEMORY_STORE_LANE_OPERATION(opcodeName, opType)                     \
     DEFINE_OPCODE(opcodeName)                                                    \
         :                                                                        \
     {                                                                            \
         using Type = typename SIMDType<opType>::Type;                            \
-        SIMDMemoryStoreMemIdx* code = (SIMDMemoryStoreMemIdx*)programCounter;    \
+        SIMDMemoryStore* code = (SIMDMemoryStore*)programCounter;                \
         Type result = readValue<Type>(bp, code->src1Offset());                   \
         opType value = result[code->index()];                                    \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());           \
-        memories[code->memIndex()]->store(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(SIMDMemoryStoreMemIdx);                              \
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(SIMDMemoryStore);                                    \
         NEXT_INSTRUCTION();                                                      \
     }
 
-#define SIMD_MEMORY_STORE_LANE_MEMIDX_M64_OPERATION(opcodeName, opType)             \
-    DEFINE_OPCODE(opcodeName)                                                       \
-        :                                                                           \
-    {                                                                               \
-        using Type = typename SIMDType<opType>::Type;                               \
-        SIMDMemoryStoreMemIdxM64* code = (SIMDMemoryStoreMemIdxM64*)programCounter; \
-        Type result = readValue<Type>(bp, code->src1Offset());                      \
-        opType value = result[code->index()];                                       \
-        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());              \
-        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(SIMDMemoryStoreMemIdxM64);                              \
-        NEXT_INSTRUCTION();                                                         \
+#define SIMD_MEMORY_STORE_LANE_M64_OPERATION(opcodeName, opType)                     \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        using Type = typename SIMDType<opType>::Type;                                \
+        SIMDMemoryStoreM64* code = (SIMDMemoryStoreM64*)programCounter;              \
+        Type result = readValue<Type>(bp, code->src1Offset());                       \
+        opType value = result[code->index()];                                        \
+        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());               \
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(SIMDMemoryStoreM64);                                     \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define SIMD_MEMORY_STORE_LANE_MEMIDX_OPERATION(opcodeName, opType)                             \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        using Type = typename SIMDType<opType>::Type;                                           \
+        SIMDMemoryStoreMemIdx* code = (SIMDMemoryStoreMemIdx*)programCounter;                   \
+        Type result = readValue<Type>(bp, code->src1Offset());                                  \
+        opType value = result[code->index()];                                                   \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                          \
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->store(state, offset, code->offset(), value);                \
+        ADD_PROGRAM_COUNTER(SIMDMemoryStoreMemIdx);                                             \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define SIMD_MEMORY_STORE_LANE_MEMIDX_M64_OPERATION(opcodeName, opType)                             \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        using Type = typename SIMDType<opType>::Type;                                               \
+        SIMDMemoryStoreMemIdxM64* code = (SIMDMemoryStoreMemIdxM64*)programCounter;                 \
+        Type result = readValue<Type>(bp, code->src1Offset());                                      \
+        opType value = result[code->index()];                                                       \
+        uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                              \
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->storeM64(state, offset, code->offset(), value);                 \
+        ADD_PROGRAM_COUNTER(SIMDMemoryStoreMemIdxM64);                                              \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
 #define SIMD_EXTRACT_LANE_OPERATION(opcodeName, readType, writeType)         \
@@ -1133,152 +1235,164 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         NEXT_INSTRUCTION();                                                   \
     }
 
-#define ATOMIC_MEMORY_LOAD_OPERATION(opcodeName, readType, writeType)   \
-    DEFINE_OPCODE(opcodeName)                                           \
-        :                                                               \
-    {                                                                   \
-        MemoryLoad* code = (MemoryLoad*)programCounter;                 \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());   \
-        readType value;                                                 \
-        memories[0]->atomicLoad(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);            \
-        ADD_PROGRAM_COUNTER(MemoryLoad);                                \
-        NEXT_INSTRUCTION();                                             \
+#define ATOMIC_MEMORY_LOAD_OPERATION(opcodeName, readType, writeType)            \
+    DEFINE_OPCODE(opcodeName)                                                    \
+        :                                                                        \
+    {                                                                            \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                          \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());            \
+        readType value;                                                          \
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicLoad(state, offset, code->offset(), &value);          \
+        writeValue<writeType>(bp, code->dstOffset(), value);                     \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                         \
+        NEXT_INSTRUCTION();                                                      \
     }
 
-#define ATOMIC_MEMORY_LOAD_M64_OPERATION(opcodeName, readType, writeType)  \
-    DEFINE_OPCODE(opcodeName)                                              \
-        :                                                                  \
-    {                                                                      \
-        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;              \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());      \
-        readType value;                                                    \
-        memories[0]->atomicLoadM64(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);               \
-        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                \
-        NEXT_INSTRUCTION();                                                \
-    }
-
-#define ATOMIC_MEMORY_LOAD_MEMIDX_OPERATION(opcodeName, readType, writeType)           \
-    DEFINE_OPCODE(opcodeName)                                                          \
-        :                                                                              \
-    {                                                                                  \
-        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;                    \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                  \
-        readType value;                                                                \
-        memories[code->memIndex()]->atomicLoad(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);                           \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                         \
-        NEXT_INSTRUCTION();                                                            \
-    }
-
-#define ATOMIC_MEMORY_LOAD_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)          \
-    DEFINE_OPCODE(opcodeName)                                                             \
-        :                                                                                 \
-    {                                                                                     \
-        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;                 \
-        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                     \
-        readType value;                                                                   \
-        memories[code->memIndex()]->atomicLoadM64(state, offset, code->offset(), &value); \
-        writeValue<writeType>(bp, code->dstOffset(), value);                              \
-        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                         \
-        NEXT_INSTRUCTION();                                                               \
-    }
-
-#define ATOMIC_MEMORY_STORE_32_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                             \
-        :                                                                 \
-    {                                                                     \
-        MemoryStore32* code = (MemoryStore32*)programCounter;             \
-        writeType value = readValue<readType>(bp, code->valueOffset());   \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());     \
-        memories[0]->atomicStore(state, offset, code->offset(), value);   \
-        ADD_PROGRAM_COUNTER(MemoryStore32);                               \
-        NEXT_INSTRUCTION();                                               \
-    }
-
-#define ATOMIC_MEMORY_STORE_32_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                                 \
-        :                                                                     \
-    {                                                                         \
-        MemoryStore32M64* code = (MemoryStore32M64*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset());       \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());         \
-        memories[0]->atomicStoreM64(state, offset, code->offset(), value);    \
-        ADD_PROGRAM_COUNTER(MemoryStore32M64);                                \
-        NEXT_INSTRUCTION();                                                   \
+#define ATOMIC_MEMORY_LOAD_M64_OPERATION(opcodeName, readType, writeType)            \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryLoadM64* code = (MemoryLoadM64*)programCounter;                        \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                \
+        readType value;                                                              \
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicLoadM64(state, offset, code->offset(), &value);           \
+        writeValue<writeType>(bp, code->dstOffset(), value);                         \
+        ADD_PROGRAM_COUNTER(MemoryLoadM64);                                          \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define ATOMIC_MEMORY_LOAD_MEMIDX_OPERATION(opcodeName, readType, writeType)                    \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryLoadMemIdx* code = (MemoryLoadMemIdx*)programCounter;                             \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                           \
+        readType value;                                                                         \
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicLoad(state, offset, code->offset(), &value);          \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                    \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdx);                                                  \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define ATOMIC_MEMORY_LOAD_MEMIDX_M64_OPERATION(opcodeName, readType, writeType)                    \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryLoadMemIdxM64* code = (MemoryLoadMemIdxM64*)programCounter;                           \
+        uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());                               \
+        readType value;                                                                             \
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicLoadM64(state, offset, code->offset(), &value);           \
+        writeValue<writeType>(bp, code->dstOffset(), value);                                        \
+        ADD_PROGRAM_COUNTER(MemoryLoadMemIdxM64);                                                   \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define ATOMIC_MEMORY_STORE_64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                             \
-        :                                                                 \
-    {                                                                     \
-        MemoryStore64* code = (MemoryStore64*)programCounter;             \
-        writeType value = readValue<readType>(bp, code->valueOffset());   \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());     \
-        memories[0]->atomicStore(state, offset, code->offset(), value);   \
-        ADD_PROGRAM_COUNTER(MemoryStore64);                               \
-        NEXT_INSTRUCTION();                                               \
+#define ATOMIC_MEMORY_STORE_32_OPERATION(opcodeName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                    \
+        :                                                                        \
+    {                                                                            \
+        MemoryStore32* code = (MemoryStore32*)programCounter;                    \
+        writeType value = readValue<readType>(bp, code->valueOffset());          \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());            \
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicStore(state, offset, code->offset(), value);          \
+        ADD_PROGRAM_COUNTER(MemoryStore32);                                      \
+        NEXT_INSTRUCTION();                                                      \
     }
 
-#define ATOMIC_MEMORY_STORE_64_M64_OPERATION(opcodeName, readType, writeType) \
-    DEFINE_OPCODE(opcodeName)                                                 \
-        :                                                                     \
-    {                                                                         \
-        MemoryStore64M64* code = (MemoryStore64M64*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset());       \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());         \
-        memories[0]->atomicStoreM64(state, offset, code->offset(), value);    \
-        ADD_PROGRAM_COUNTER(MemoryStore64M64);                                \
-        NEXT_INSTRUCTION();                                                   \
+#define ATOMIC_MEMORY_STORE_32_M64_OPERATION(opcodeName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryStore32M64* code = (MemoryStore32M64*)programCounter;                  \
+        writeType value = readValue<readType>(bp, code->valueOffset());              \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                \
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicStoreM64(state, offset, code->offset(), value);           \
+        ADD_PROGRAM_COUNTER(MemoryStore32M64);                                       \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define ATOMIC_MEMORY_STORE_64_OPERATION(opcodeName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                    \
+        :                                                                        \
+    {                                                                            \
+        MemoryStore64* code = (MemoryStore64*)programCounter;                    \
+        writeType value = readValue<readType>(bp, code->valueOffset());          \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());            \
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicStore(state, offset, code->offset(), value);          \
+        ADD_PROGRAM_COUNTER(MemoryStore64);                                      \
+        NEXT_INSTRUCTION();                                                      \
+    }
+
+#define ATOMIC_MEMORY_STORE_64_M64_OPERATION(opcodeName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                        \
+        :                                                                            \
+    {                                                                                \
+        MemoryStore64M64* code = (MemoryStore64M64*)programCounter;                  \
+        writeType value = readValue<readType>(bp, code->valueOffset());              \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                \
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(value), code->offset()); \
+        memories[0]->atomicStoreM64(state, offset, code->offset(), value);           \
+        ADD_PROGRAM_COUNTER(MemoryStore64M64);                                       \
+        NEXT_INSTRUCTION();                                                          \
+    }
+
+#define ATOMIC_MEMORY_STORE_MEMIDX_32_OPERATION(opcodeName, readType, writeType)                \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryStoreMemIdx32* code = (MemoryStoreMemIdx32*)programCounter;                       \
+        writeType value = readValue<readType>(bp, code->valueOffset());                         \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                           \
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicStore(state, offset, code->offset(), value);          \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32);                                               \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define ATOMIC_MEMORY_STORE_MEMIDX_32_M64_OPERATION(opcodeName, readType, writeType)                \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryStoreMemIdx32M64* code = (MemoryStoreMemIdx32M64*)programCounter;                     \
+        writeType value = readValue<readType>(bp, code->valueOffset());                             \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                               \
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicStoreM64(state, offset, code->offset(), value);           \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32M64);                                                \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
-#define ATOMIC_MEMORY_STORE_MEMIDX_32_OPERATION(opcodeName, readType, writeType)       \
-    DEFINE_OPCODE(opcodeName)                                                          \
-        :                                                                              \
-    {                                                                                  \
-        MemoryStoreMemIdx32* code = (MemoryStoreMemIdx32*)programCounter;              \
-        writeType value = readValue<readType>(bp, code->valueOffset());                \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                  \
-        memories[code->memIndex()]->atomicStore(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32);                                      \
-        NEXT_INSTRUCTION();                                                            \
-    }
-
-#define ATOMIC_MEMORY_STORE_MEMIDX_32_M64_OPERATION(opcodeName, readType, writeType)      \
-    DEFINE_OPCODE(opcodeName)                                                             \
-        :                                                                                 \
-    {                                                                                     \
-        MemoryStoreMemIdx32M64* code = (MemoryStoreMemIdx32M64*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset());                   \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                     \
-        memories[code->memIndex()]->atomicStoreM64(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx32M64);                                      \
-        NEXT_INSTRUCTION();                                                               \
-    }
-
-#define ATOMIC_MEMORY_STORE_MEMIDX_64_OPERATION(opcodeName, readType, writeType)       \
-    DEFINE_OPCODE(opcodeName)                                                          \
-        :                                                                              \
-    {                                                                                  \
-        MemoryStoreMemIdx64* code = (MemoryStoreMemIdx64*)programCounter;              \
-        writeType value = readValue<readType>(bp, code->valueOffset());                \
-        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                  \
-        memories[code->memIndex()]->atomicStore(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64);                                      \
-        NEXT_INSTRUCTION();                                                            \
-    }
-
-#define ATOMIC_MEMORY_STORE_MEMIDX_64_M64_OPERATION(opcodeName, readType, writeType)      \
-    DEFINE_OPCODE(opcodeName)                                                             \
-        :                                                                                 \
-    {                                                                                     \
-        MemoryStoreMemIdx64M64* code = (MemoryStoreMemIdx64M64*)programCounter;           \
-        writeType value = readValue<readType>(bp, code->valueOffset());                   \
-        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                     \
-        memories[code->memIndex()]->atomicStoreM64(state, offset, code->offset(), value); \
-        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64M64);                                      \
-        NEXT_INSTRUCTION();                                                               \
+#define ATOMIC_MEMORY_STORE_MEMIDX_64_OPERATION(opcodeName, readType, writeType)                \
+    DEFINE_OPCODE(opcodeName)                                                                   \
+        :                                                                                       \
+    {                                                                                           \
+        MemoryStoreMemIdx64* code = (MemoryStoreMemIdx64*)programCounter;                       \
+        writeType value = readValue<readType>(bp, code->valueOffset());                         \
+        uint32_t offset = readValue<uint32_t>(bp, code->dstOffset());                           \
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicStore(state, offset, code->offset(), value);          \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64);                                               \
+        NEXT_INSTRUCTION();                                                                     \
+    }
+
+#define ATOMIC_MEMORY_STORE_MEMIDX_64_M64_OPERATION(opcodeName, readType, writeType)                \
+    DEFINE_OPCODE(opcodeName)                                                                       \
+        :                                                                                           \
+    {                                                                                               \
+        MemoryStoreMemIdx64M64* code = (MemoryStoreMemIdx64M64*)programCounter;                     \
+        writeType value = readValue<readType>(bp, code->valueOffset());                             \
+        uint64_t offset = readValue<uint64_t>(bp, code->dstOffset());                               \
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset()); \
+        memories[code->memIndex()]->atomicStoreM64(state, offset, code->offset(), value);           \
+        ADD_PROGRAM_COUNTER(MemoryStoreMemIdx64M64);                                                \
+        NEXT_INSTRUCTION();                                                                         \
     }
 
 #define ATOMIC_MEMORY_RMW_OPERATION(opcodeName, R, T, operationName)                       \
@@ -1289,6 +1403,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T value = static_cast<T>(readValue<R>(bp, code->src1Offset()));                    \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                     \
         T old;                                                                             \
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(value), code->offset());           \
         memories[0]->atomicRmw(state, offset, code->offset(), value, &old, operationName); \
         writeValue<R>(bp, code->dstOffset(), static_cast<R>(old));                         \
         ADD_PROGRAM_COUNTER(AtomicRmw);                                                    \
@@ -1303,6 +1418,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T value = static_cast<T>(readValue<R>(bp, code->src1Offset()));                       \
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                        \
         T old;                                                                                \
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(value), code->offset());          \
         memories[0]->atomicRmwM64(state, offset, code->offset(), value, &old, operationName); \
         writeValue<R>(bp, code->dstOffset(), static_cast<R>(old));                            \
         ADD_PROGRAM_COUNTER(AtomicRmwM64);                                                    \
@@ -1317,6 +1433,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T value = static_cast<T>(readValue<R>(bp, code->src1Offset()));                                   \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                                    \
         T old;                                                                                            \
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset());           \
         memories[code->memIndex()]->atomicRmw(state, offset, code->offset(), value, &old, operationName); \
         writeValue<R>(bp, code->dstOffset(), static_cast<R>(old));                                        \
         ADD_PROGRAM_COUNTER(AtomicRmwMemIdx);                                                             \
@@ -1331,6 +1448,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T value = static_cast<T>(readValue<R>(bp, code->src1Offset()));                                      \
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                                       \
         T old;                                                                                               \
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset());          \
         memories[code->memIndex()]->atomicRmwM64(state, offset, code->offset(), value, &old, operationName); \
         writeValue<R>(bp, code->dstOffset(), static_cast<R>(old));                                           \
         ADD_PROGRAM_COUNTER(AtomicRmwMemIdxM64);                                                             \
@@ -1346,6 +1464,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T expectValue = readValue<T>(bp, code->src1Offset());                                    \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                           \
         V old;                                                                                   \
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(old), code->offset());                   \
         if (expectValue > std::numeric_limits<V>::max()) {                                       \
             memories[0]->atomicLoad(state, offset, code->offset(), &old);                        \
         } else {                                                                                 \
@@ -1366,6 +1485,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T expectValue = readValue<T>(bp, code->src1Offset());                                       \
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                              \
         V old;                                                                                      \
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(old), code->offset());                  \
         if (expectValue > std::numeric_limits<V>::max()) {                                          \
             memories[0]->atomicLoadM64(state, offset, code->offset(), &old);                        \
         } else {                                                                                    \
@@ -1386,6 +1506,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T expectValue = readValue<T>(bp, code->src1Offset());                                                   \
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                                          \
         V old;                                                                                                  \
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(old), code->offset());                   \
         if (expectValue > std::numeric_limits<V>::max()) {                                                      \
             memories[code->memIndex()]->atomicLoad(state, offset, code->offset(), &old);                        \
         } else {                                                                                                \
@@ -1406,6 +1527,7 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         T expectValue = readValue<T>(bp, code->src1Offset());                                                      \
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());                                             \
         V old;                                                                                                     \
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(old), code->offset());                  \
         if (expectValue > std::numeric_limits<V>::max()) {                                                         \
             memories[code->memIndex()]->atomicLoadM64(state, offset, code->offset(), &old);                        \
         } else {                                                                                                   \
@@ -1418,7 +1540,12 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
     }
 
 #if defined(WALRUS_ENABLE_COMPUTED_GOTO)
-#if defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
+#if defined(WALRUS_COMPACT_BYTECODE)
+    // The address table is empty until the first call fills it.
+    if (UNLIKELY(((ByteCode*)programCounter)->m_opcode == ByteCode::FillOpcodeTableOpcode)) {
+        goto FillOpcodeTableOpcodeLbl;
+    }
+#elif defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
     if (UNLIKELY((((ByteCode*)programCounter)->m_opcodeInAddress) == NULL)) {
         goto FillOpcodeTableOpcodeLbl;
     }
@@ -1430,7 +1557,11 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
 
 NextInstruction:
     /* Execute first instruction. */
+#if defined(WALRUS_COMPACT_BYTECODE)
+    goto* g_byteCodeTable.m_addressTable[((ByteCode*)programCounter)->m_opcode];
+#else
     goto*(((ByteCode*)programCounter)->m_opcodeInAddress);
+#endif
 #else
 
 #define DEFINE_OPCODE(codeName) case ByteCode::Opcode::codeName##Opcode
@@ -1441,7 +1572,7 @@ NextInstruction:
 #define NEXT_INSTRUCTION() \
     goto NextInstruction;
 NextInstruction:
-    auto currentOpcode = ((ByteCode*)programCounter)->m_opcode;
+    auto currentOpcode = static_cast<ByteCode::Opcode>(((ByteCode*)programCounter)->m_opcode);
 
     switch (currentOpcode) {
 #endif
@@ -1492,6 +1623,7 @@ NextInstruction:
     {
         Load32* code = (Load32*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(uint32_t), 0);
         memories[0]->load(state, offset, reinterpret_cast<uint32_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load32);
         NEXT_INSTRUCTION();
@@ -1502,6 +1634,7 @@ NextInstruction:
     {
         Load32M64* code = (Load32M64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(uint32_t), 0);
         memories[0]->loadM64(state, offset, reinterpret_cast<uint32_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load32M64);
         NEXT_INSTRUCTION();
@@ -1512,6 +1645,7 @@ NextInstruction:
     {
         Load64* code = (Load64*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(uint64_t), 0);
         memories[0]->load(state, offset, reinterpret_cast<uint64_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load64);
         NEXT_INSTRUCTION();
@@ -1522,6 +1656,7 @@ NextInstruction:
     {
         Load64M64* code = (Load64M64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(uint64_t), 0);
         memories[0]->loadM64(state, offset, reinterpret_cast<uint64_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load64M64);
         NEXT_INSTRUCTION();
@@ -1533,6 +1668,7 @@ NextInstruction:
         Store32* code = (Store32*)programCounter;
         uint32_t value = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), 0);
         memories[0]->store(state, offset, value);
         ADD_PROGRAM_COUNTER(Store32);
         NEXT_INSTRUCTION();
@@ -1544,6 +1680,7 @@ NextInstruction:
         Store32M64* code = (Store32M64*)programCounter;
         uint32_t value = readValue<uint32_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), 0);
         memories[0]->storeM64(state, offset, value);
         ADD_PROGRAM_COUNTER(Store32M64);
         NEXT_INSTRUCTION();
@@ -1555,6 +1692,7 @@ NextInstruction:
         Store64* code = (Store64*)programCounter;
         uint64_t value = readValue<uint64_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), 0);
         memories[0]->store(state, offset, value);
         ADD_PROGRAM_COUNTER(Store64);
         NEXT_INSTRUCTION();
@@ -1566,6 +1704,7 @@ NextInstruction:
         Store64M64* code = (Store64M64*)programCounter;
         uint64_t value = readValue<uint64_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), 0);
         memories[0]->storeM64(state, offset, value);
         ADD_PROGRAM_COUNTER(Store64M64);
         NEXT_INSTRUCTION();
@@ -1697,21 +1836,27 @@ NextInstruction:
     DEFINE_OPCODE(Call)
         :
     {
-        callOperation(state, programCounter, bp, instance);
+        if (UNLIKELY(!callOperation(state, programCounter, bp, instance))) {
+            return nullptr;
+        }
         NEXT_INSTRUCTION();
     }
 
     DEFINE_OPCODE(CallIndirect)
         :
     {
-        callIndirectOperation(state, programCounter, bp, instance);
+        if (UNLIKELY(!callIndirectOperation(state, programCounter, bp, instance))) {
+            return nullptr;
+        }
         NEXT_INSTRUCTION();
     }
 
     DEFINE_OPCODE(CallRef)
         :
     {
-        callRefOperation(state, programCounter, bp, instance);
+        if (UNLIKELY(!callRefOperation(state, programCounter, bp, instance))) {
+            return nullptr;
+        }
         NEXT_INSTRUCTION();
     }
 
@@ -1721,12 +1866,16 @@ NextInstruction:
         ReturnCall* code = (ReturnCall*)programCounter;
         Function* target = instance->function(code->index());
 
-        if (tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
-                              code->parameterOffsetsSize(), code->resultOffsetsSize())) {
+        TailCallResult result = tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
+                                                  code->parameterOffsetsSize(), code->resultOffsetsSize());
+        if (result == TailCallContinue) {
             bp = frame.bp();
             memories = reinterpret_cast<Memory**>(reinterpret_cast<uintptr_t>(instance) + Instance::alignedSize());
             NEXT_INSTRUCTION();
         }
+        if (UNLIKELY(result == TailCallTrap)) {
+            return nullptr;
+        }
         return code->stackOffsets() + code->parameterOffsetsSize();
     }
 
@@ -1738,23 +1887,27 @@ NextInstruction:
 
         uint32_t idx = readValue<uint32_t>(bp, code->calleeOffset());
         if (UNLIKELY(idx >= table->size())) {
-            Trap::throwException(state, "undefined element");
+            return trap(state, Exception::UndefinedElement);
         }
         auto target = reinterpret_cast<Function*>(table->uncheckedGetElement(idx));
         if (UNLIKELY(Value::isNull(target))) {
-            Trap::throwException(state, "uninitialized element " + std::to_string(idx));
+            return trap(state, Exception::UninitializedElementAt, idx);
         }
         const FunctionType* ft = target->functionType();
         if (UNLIKELY(!ft->equals(code->functionType()))) {
-            Trap::throwException(state, "indirect call type mismatch");
+            return trap(state, Exception::IndirectCallTypeMismatch);
         }
 
-        if (tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
-                              code->parameterOffsetsSize(), code->resultOffsetsSize())) {
+        TailCallResult result = tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
+                                                  code->parameterOffsetsSize(), code->resultOffsetsSize());
+        if (result == TailCallContinue) {
             bp = frame.bp();
             memories = reinterpret_cast<Memory**>(reinterpret_cast<uintptr_t>(instance) + Instance::alignedSize());
             NEXT_INSTRUCTION();
         }
+        if (UNLIKELY(result == TailCallTrap)) {
+            return nullptr;
+        }
         return code->stackOffsets() + code->parameterOffsetsSize();
     }
 
@@ -1765,19 +1918,23 @@ NextInstruction:
 
         auto target = readValue<Function*>(bp, code->calleeOffset());
         if (UNLIKELY(Value::isNull(target))) {
-            Trap::throwException(state, "null function reference");
+            return trap(state, Exception::NullFunctionReference);
         }
         const FunctionType* ft = target->functionType();
         if (UNLIKELY(!ft->equals(code->functionType()))) {
-            Trap::throwException(state, "call by reference type mismatch");
+            return trap(state, Exception::CallByReferenceTypeMismatch);
         }
 
-        if (tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
-                              code->parameterOffsetsSize(), code->resultOffsetsSize())) {
+        TailCallResult result = tailCallOperation(state, programCounter, frame, instance, target, code->stackOffsets(),
+                                                  code->parameterOffsetsSize(), code->resultOffsetsSize());
+        if (result == TailCallContinue) {
             bp = frame.bp();
             memories = reinterpret_cast<Memory**>(reinterpret_cast<uintptr_t>(instance) + Instance::alignedSize());
             NEXT_INSTRUCTION();
         }
+        if (UNLIKELY(result == TailCallTrap)) {
+            return nullptr;
+        }
         return code->stackOffsets() + code->parameterOffsetsSize();
     }
 
@@ -1937,7 +2094,11 @@ NextInstruction:
         uint32_t expect = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicWait(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[0]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[0]->atomicWait(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait32);
         NEXT_INSTRUCTION();
@@ -1951,7 +2112,11 @@ NextInstruction:
         uint32_t expect = readValue<uint32_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicWaitM64(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[0]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[0]->atomicWaitM64(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait32M64);
         NEXT_INSTRUCTION();
@@ -1965,7 +2130,11 @@ NextInstruction:
         uint32_t expect = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicWait(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[code->memIndex()]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[code->memIndex()]->atomicWait(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait32MemIdx);
         NEXT_INSTRUCTION();
@@ -1979,7 +2148,11 @@ NextInstruction:
         uint32_t expect = readValue<uint32_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicWaitM64(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[code->memIndex()]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[code->memIndex()]->atomicWaitM64(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait32MemIdxM64);
         NEXT_INSTRUCTION();
@@ -1993,7 +2166,11 @@ NextInstruction:
         uint64_t expect = readValue<uint64_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicWait(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS(memories[0], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[0]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[0]->atomicWait(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait64);
         NEXT_INSTRUCTION();
@@ -2007,7 +2184,11 @@ NextInstruction:
         uint64_t expect = readValue<uint64_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicWaitM64(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[0]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[0]->atomicWaitM64(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait64M64);
         NEXT_INSTRUCTION();
@@ -2021,7 +2202,11 @@ NextInstruction:
         uint64_t expect = readValue<uint64_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicWait(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[code->memIndex()]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[code->memIndex()]->atomicWait(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait64MemIdx);
         NEXT_INSTRUCTION();
@@ -2035,7 +2220,11 @@ NextInstruction:
         uint64_t expect = readValue<uint64_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicWaitM64(state, instance->module()->store(), offset, code->offset(), expect, timeOut, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, sizeof(expect), code->offset());
+        if (UNLIKELY(!memories[code->memIndex()]->isShared())) {
+            return trap(state, Exception::ExpectedSharedMemory);
+        }
+        memories[code->memIndex()]->atomicWaitM64(state, instance->store(), offset, code->offset(), expect, timeOut, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicWait64MemIdxM64);
         NEXT_INSTRUCTION();
@@ -2048,7 +2237,8 @@ NextInstruction:
         uint32_t count = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicNotify(state, instance->module()->store(), offset, code->offset(), count, &result);
+        CHECK_ATOMIC_ACCESS(memories[0], offset, 4, code->offset());
+        memories[0]->atomicNotify(state, instance->store(), offset, code->offset(), count, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicNotify);
         NEXT_INSTRUCTION();
@@ -2061,7 +2251,8 @@ NextInstruction:
         uint32_t count = readValue<uint32_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[0]->atomicNotifyM64(state, instance->module()->store(), offset, code->offset(), count, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[0], offset, 4, code->offset());
+        memories[0]->atomicNotifyM64(state, instance->store(), offset, code->offset(), count, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicNotifyM64);
         NEXT_INSTRUCTION();
@@ -2074,7 +2265,8 @@ NextInstruction:
         uint32_t count = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicNotify(state, instance->module()->store(), offset, code->offset(), count, &result);
+        CHECK_ATOMIC_ACCESS(memories[code->memIndex()], offset, 4, code->offset());
+        memories[code->memIndex()]->atomicNotify(state, instance->store(), offset, code->offset(), count, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicNotifyMemIdx);
         NEXT_INSTRUCTION();
@@ -2087,7 +2279,8 @@ NextInstruction:
         uint32_t count = readValue<uint32_t>(bp, code->src1Offset());
         uint64_t offset = readValue<uint64_t>(bp, code->src0Offset());
         uint32_t result;
-        memories[code->memIndex()]->atomicNotifyM64(state, instance->module()->store(), offset, code->offset(), count, &result);
+        CHECK_ATOMIC_ACCESS_M64(memories[code->memIndex()], offset, 4, code->offset());
+        memories[code->memIndex()]->atomicNotifyM64(state, instance->store(), offset, code->offset(), count, &result);
         writeValue<uint32_t>(bp, code->dstOffset(), result);
         ADD_PROGRAM_COUNTER(MemoryAtomicNotifyMemIdxM64);
         NEXT_INSTRUCTION();
@@ -2117,6 +2310,7 @@ NextInstruction:
         V128Load32Zero* code = (V128Load32Zero*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
         uint32_t value;
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset());
         memories[0]->load(state, offset, code->offset(), &value);
         Type result;
         std::fill(std::begin(result.v), std::end(result.v), 0);
@@ -2133,6 +2327,7 @@ NextInstruction:
         V128Load32ZeroM64* code = (V128Load32ZeroM64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
         uint32_t value;
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset());
         memories[0]->loadM64(state, offset, code->offset(), &value);
         Type result;
         std::fill(std::begin(result.v), std::end(result.v), 0);
@@ -2150,6 +2345,7 @@ NextInstruction:
         Type result;
         V128Load32ZeroMemIdx* code = (V128Load32ZeroMemIdx*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset());
         memories[code->memIndex()]->load(state, offset, code->offset(), &value);
         std::fill(std::begin(result.v), std::end(result.v), 0);
         result[0] = value;
@@ -2166,6 +2362,7 @@ NextInstruction:
         Type result;
         V128Load32ZeroMemIdxM64* code = (V128Load32ZeroMemIdxM64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset());
         memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);
         std::fill(std::begin(result.v), std::end(result.v), 0);
         result[0] = value;
@@ -2181,6 +2378,7 @@ NextInstruction:
         V128Load64Zero* code = (V128Load64Zero*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
         uint64_t value;
+        CHECK_MEMORY_ACCESS(memories[0], offset, sizeof(value), code->offset());
         memories[0]->load(state, offset, code->offset(), &value);
         Type result;
         std::fill(std::begin(result.v), std::end(result.v), 0);
@@ -2197,6 +2395,7 @@ NextInstruction:
         V128Load64ZeroM64* code = (V128Load64ZeroM64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
         uint64_t value;
+        CHECK_MEMORY_ACCESS_M64(memories[0], offset, sizeof(value), code->offset());
         memories[0]->loadM64(state, offset, code->offset(), &value);
         Type result;
         std::fill(std::begin(result.v), std::end(result.v), 0);
@@ -2214,6 +2413,7 @@ NextInstruction:
         Type result;
         V128Load64ZeroMemIdx* code = (V128Load64ZeroMemIdx*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS(memories[code->memIndex()], offset, sizeof(value), code->offset());
         memories[code->memIndex()]->load(state, offset, code->offset(), &value);
         std::fill(std::begin(result.v), std::end(result.v), 0);
         result[0] = value;
@@ -2230,6 +2430,7 @@ NextInstruction:
         Type result;
         V128Load64ZeroMemIdxM64* code = (V128Load64ZeroMemIdxM64*)programCounter;
         uint64_t offset = readValue<uint64_t>(bp, code->srcOffset());
+        CHECK_MEMORY_ACCESS_M64(memories[code->memIndex()], offset, sizeof(value), code->offset());
         memories[code->memIndex()]->loadM64(state, offset, code->offset(), &value);
         std::fill(std::begin(result.v), std::end(result.v), 0);
         result[0] = value;
@@ -2314,7 +2515,9 @@ NextInstruction:
         auto dstStart = readValue<uint32_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        m->init(state, sg, dstStart, srcStart, size);
+        if (UNLIKELY(!m->init(state, sg, dstStart, srcStart, size))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryInit);
         NEXT_INSTRUCTION();
     }
@@ -2328,7 +2531,9 @@ NextInstruction:
         auto dstStart = readValue<uint64_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        m->init(state, sg, dstStart, srcStart, size);
+        if (UNLIKELY(!m->init(state, sg, dstStart, srcStart, size))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryInitM64);
         NEXT_INSTRUCTION();
     }
@@ -2342,7 +2547,9 @@ NextInstruction:
         auto dstStart = readValue<uint32_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        srcMem->copy(state, dstStart, srcStart, size, dstMem);
+        if (UNLIKELY(!srcMem->copy(state, dstStart, srcStart, size, dstMem))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryCopy);
         NEXT_INSTRUCTION();
     }
@@ -2356,7 +2563,9 @@ NextInstruction:
         auto dstStart = readValue<uint64_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint64_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint64_t>(bp, code->srcOffsets()[2]);
-        srcMem->copy(state, dstStart, srcStart, size, dstMem);
+        if (UNLIKELY(!srcMem->copy(state, dstStart, srcStart, size, dstMem))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryCopyM64);
         NEXT_INSTRUCTION();
     }
@@ -2370,7 +2579,9 @@ NextInstruction:
         auto dstStart = readValue<uint64_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        srcMem->copy(state, dstStart, srcStart, size, dstMem);
+        if (UNLIKELY(!srcMem->copy(state, dstStart, srcStart, size, dstMem))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryCopyM64M32);
         NEXT_INSTRUCTION();
     }
@@ -2384,7 +2595,9 @@ NextInstruction:
         auto dstStart = readValue<uint32_t>(bp, code->srcOffsets()[0]);
         auto srcStart = readValue<uint64_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        srcMem->copy(state, dstStart, srcStart, size, dstMem);
+        if (UNLIKELY(!srcMem->copy(state, dstStart, srcStart, size, dstMem))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryCopyM32M64);
         NEXT_INSTRUCTION();
     }
@@ -2397,7 +2610,9 @@ NextInstruction:
         auto dstStart = readValue<uint32_t>(bp, code->srcOffsets()[0]);
         auto value = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint32_t>(bp, code->srcOffsets()[2]);
-        m->fill(state, dstStart, value, size);
+        if (UNLIKELY(!m->fill(state, dstStart, value, size))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryFill);
         NEXT_INSTRUCTION();
     }
@@ -2410,7 +2625,9 @@ NextInstruction:
         auto dstStart = readValue<uint64_t>(bp, code->srcOffsets()[0]);
         auto value = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         auto size = readValue<uint64_t>(bp, code->srcOffsets()[2]);
-        m->fill(state, dstStart, value, size);
+        if (UNLIKELY(!m->fill(state, dstStart, value, size))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(MemoryFillM64);
         NEXT_INSTRUCTION();
     }
@@ -2431,8 +2648,11 @@ NextInstruction:
         TableGet* code = (TableGet*)programCounter;
         ASSERT(code->tableIndex() < instance->module()->numberOfTableTypes());
         Table* table = instance->m_tables[code->tableIndex()];
-        void* val = table->getElement(state, readValue<uint32_t>(bp, code->srcOffset()));
-        writeValue(bp, code->dstOffset(), val);
+        uint32_t index = readValue<uint32_t>(bp, code->srcOffset());
+        if (UNLIKELY(index >= table->size())) {
+            return trap(state, Exception::OutOfBoundsTableAccess);
+        }
+        writeValue(bp, code->dstOffset(), table->uncheckedGetElement(index));
 
         ADD_PROGRAM_COUNTER(TableGet);
         NEXT_INSTRUCTION();
@@ -2445,7 +2665,11 @@ NextInstruction:
         ASSERT(code->tableIndex() < instance->module()->numberOfTableTypes());
         Table* table = instance->m_tables[code->tableIndex()];
         void* ptr = readValue<void*>(bp, code->src1Offset());
-        table->setElement(state, readValue<uint32_t>(bp, code->src0Offset()), ptr);
+        uint32_t index = readValue<uint32_t>(bp, code->src0Offset());
+        if (UNLIKELY(index >= table->size())) {
+            return trap(state, Exception::OutOfBoundsTableAccess);
+        }
+        table->uncheckedSetElement(index, ptr);
 
         ADD_PROGRAM_COUNTER(TableSet);
         NEXT_INSTRUCTION();
@@ -2500,7 +2724,9 @@ NextInstruction:
         uint32_t srcIndex = readValue<uint32_t>(bp, code->srcOffsets()[1]);
         uint32_t n = readValue<uint32_t>(bp, code->srcOffsets()[2]);
 
-        dstTable->copy(state, srcTable, n, srcIndex, dstIndex);
+        if (UNLIKELY(!dstTable->copy(state, srcTable, n, srcIndex, dstIndex))) {
+            return nullptr;
+        }
 
         ADD_PROGRAM_COUNTER(TableCopy);
         NEXT_INSTRUCTION();
@@ -2516,7 +2742,9 @@ NextInstruction:
         int32_t index = readValue<int32_t>(bp, code->srcOffsets()[0]);
         void* ptr = readValue<void*>(bp, code->srcOffsets()[1]);
         int32_t n = readValue<int32_t>(bp, code->srcOffsets()[2]);
-        table->fill(state, n, ptr, index);
+        if (UNLIKELY(!table->fill(state, n, ptr, index))) {
+            return nullptr;
+        }
 
         ADD_PROGRAM_COUNTER(TableFill);
         NEXT_INSTRUCTION();
@@ -2534,7 +2762,9 @@ NextInstruction:
 
         ASSERT(code->tableIndex() < instance->module()->numberOfTableTypes());
         Table* table = instance->m_tables[code->tableIndex()];
-        table->init(state, sg, dstStart, srcStart, size);
+        if (UNLIKELY(!table->init(state, sg, dstStart, srcStart, size))) {
+            return nullptr;
+        }
         ADD_PROGRAM_COUNTER(TableInit);
         NEXT_INSTRUCTION();
     }
@@ -2565,7 +2795,7 @@ NextInstruction:
 
         void* ptr = readValue<void*>(bp, code->stackOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null reference");
+            return trap(state, Exception::NullReference);
         }
 
         ADD_PROGRAM_COUNTER(RefAsNonNull);
@@ -2580,10 +2810,10 @@ NextInstruction:
         void* ptr = readValue<void*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
             if (!(code->srcInfo() & JumpIfCastGeneric::IsNullable)) {
-                Trap::throwException(state, "cast failure");
+                return trap(state, Exception::CastFailure);
             }
         } else if (!testRefGeneric(ptr, code->typeInfo())) {
-            Trap::throwException(state, "cast failure");
+            return trap(state, Exception::CastFailure);
         }
 
         ADD_PROGRAM_COUNTER(RefCastGeneric);
@@ -2598,10 +2828,10 @@ NextInstruction:
         void* ptr = readValue<void*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
             if (!(code->srcInfo() & JumpIfCastGeneric::IsNullable)) {
-                Trap::throwException(state, "cast failure");
+                return trap(state, Exception::CastFailure);
             }
         } else if (!testRefDefined(ptr, code->typeInfo())) {
-            Trap::throwException(state, "cast failure");
+            return trap(state, Exception::CastFailure);
         }
 
         ADD_PROGRAM_COUNTER(RefCastDefined);
@@ -2663,7 +2893,7 @@ NextInstruction:
 
         void* ptr = readValue<void*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null i31 reference");
+            return trap(state, Exception::NullI31Reference);
         }
         writeValue<int32_t>(bp, code->dstOffset(), Value::getI31SValue(ptr));
 
@@ -2678,7 +2908,7 @@ NextInstruction:
 
         void* ptr = readValue<void*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null i31 reference");
+            return trap(state, Exception::NullI31Reference);
         }
         writeValue<int32_t>(bp, code->dstOffset(), Value::getI31UValue(ptr));
 
@@ -2694,7 +2924,7 @@ NextInstruction:
         uint32_t length = readValue<uint32_t>(bp, code->src1Offset());
         GCArray* result = GCArray::arrayNew(length, code->typeInfo(), bp + code->src0Offset());
         if (UNLIKELY(result == nullptr)) {
-            Trap::throwException(state, "memory allocation failed");
+            return trap(state, Exception::MemoryAllocationFailed);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2710,7 +2940,7 @@ NextInstruction:
         uint32_t length = readValue<uint32_t>(bp, code->srcOffset());
         GCArray* result = GCArray::arrayNewDefault(length, code->typeInfo());
         if (UNLIKELY(result == nullptr)) {
-            Trap::throwException(state, "memory allocation failed");
+            return trap(state, Exception::MemoryAllocationFailed);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2725,7 +2955,7 @@ NextInstruction:
 
         GCArray* result = GCArray::arrayNewFixed(code->length(), code->typeInfo(), code->dataOffsets(), bp);
         if (UNLIKELY(result == nullptr)) {
-            Trap::throwException(state, "memory allocation failed");
+            return trap(state, Exception::MemoryAllocationFailed);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2743,9 +2973,9 @@ NextInstruction:
         GCArray* result = GCArray::arrayNewData(offset, size, code->typeInfo(), instance->dataSegment(code->index()));
         if (UNLIKELY(reinterpret_cast<uintptr_t>(result) <= GCArray::OutOfBoundsMaxAccess)) {
             if (UNLIKELY(result == nullptr)) {
-                Trap::throwException(state, "memory allocation failed");
+                return trap(state, Exception::MemoryAllocationFailed);
             }
-            Trap::throwException(state, "out of bounds memory access");
+            return trap(state, Exception::OutOfBoundsMemoryAccess);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2763,9 +2993,9 @@ NextInstruction:
         GCArray* result = GCArray::arrayNewElem(offset, size, code->typeInfo(), instance->elementSegment(code->index()));
         if (UNLIKELY(reinterpret_cast<uintptr_t>(result) <= GCArray::OutOfBoundsMaxAccess)) {
             if (UNLIKELY(result == nullptr)) {
-                Trap::throwException(state, "memory allocation failed");
+                return trap(state, Exception::MemoryAllocationFailed);
             }
-            Trap::throwException(state, "out of bounds table access");
+            return trap(state, Exception::OutOfBoundsTableAccess);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2780,7 +3010,7 @@ NextInstruction:
 
         GCArray* array = readValue<GCArray*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(array))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
         uint32_t log2Size = GCArray::getLog2Size(code->type());
         uint32_t offset = readValue<uint32_t>(bp, code->src1Offset());
@@ -2788,7 +3018,7 @@ NextInstruction:
         void* value_p = bp + code->src2Offset();
 
         if (array->length() < offset || (array->length() - offset) < fillSize) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         if (!(array->length() == offset || fillSize == 0)) {
@@ -2822,7 +3052,7 @@ NextInstruction:
         GCArray* dstArray = readValue<GCArray*>(bp, code->src0Offset());
         GCArray* srcArray = readValue<GCArray*>(bp, code->src2Offset());
         if (UNLIKELY(Value::isNull(dstArray) || Value::isNull(srcArray))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
         uint32_t dst_offset = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t src_offset = readValue<uint32_t>(bp, code->src3Offset());
@@ -2830,7 +3060,7 @@ NextInstruction:
 
         if (dstArray->length() < dst_offset || (dstArray->length() - dst_offset) < size
             || srcArray->length() < src_offset || (srcArray->length() - src_offset) < size) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         const uint8_t log2Size = code->log2Size();
@@ -2851,7 +3081,7 @@ NextInstruction:
 
         GCArray* array = readValue<GCArray*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(array))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
 
         uint32_t dst_offset = readValue<uint32_t>(bp, code->src1Offset());
@@ -2863,11 +3093,11 @@ NextInstruction:
         size_t dataSize = data->sizeInByte();
 
         if (arraySize < dst_offset || (arraySize - dst_offset) < size) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         if (dataSize < src_offset || ((dataSize - src_offset) >> log2Size) < size) {
-            Trap::throwException(state, "out of bounds memory access");
+            return trap(state, Exception::OutOfBoundsMemoryAccess);
         }
 
         uintptr_t mask = (static_cast<uintptr_t>(1) << log2Size) - 1;
@@ -2885,7 +3115,7 @@ NextInstruction:
 
         GCArray* array = readValue<GCArray*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(array))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
 
         uint32_t dst_offset = readValue<uint32_t>(bp, code->src1Offset());
@@ -2896,11 +3126,11 @@ NextInstruction:
         size_t elemSize = elements->size();
 
         if (arraySize < dst_offset || (arraySize - dst_offset) < size) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         if (elemSize < src_offset || (elemSize - src_offset) < size) {
-            Trap::throwException(state, "out of bounds table access");
+            return trap(state, Exception::OutOfBoundsTableAccess);
         }
 
         uintptr_t mask = static_cast<uintptr_t>(sizeof(void*)) - 1;
@@ -2918,12 +3148,12 @@ NextInstruction:
 
         GCArray* ptr = readValue<GCArray*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
 
         uint32_t pos = readValue<uint32_t>(bp, code->src1Offset());
         if (UNLIKELY(pos >= ptr->length())) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         GCArray::get(bp + code->dstOffset(), reinterpret_cast<uint8_t*>(ptr),
@@ -2940,12 +3170,12 @@ NextInstruction:
 
         GCArray* ptr = readValue<GCArray*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
 
         uint32_t pos = readValue<uint32_t>(bp, code->src1Offset());
         if (UNLIKELY(pos >= ptr->length())) {
-            Trap::throwException(state, "out of bounds array access");
+            return trap(state, Exception::OutOfBoundsArrayAccess);
         }
 
         GCArray::set(reinterpret_cast<uint8_t*>(ptr), bp + code->src2Offset(),
@@ -2962,7 +3192,7 @@ NextInstruction:
 
         GCArray* ptr = readValue<GCArray*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null array reference");
+            return trap(state, Exception::NullArrayReference);
         }
 
         writeValue<uint32_t>(bp, code->dstOffset(), ptr->length());
@@ -2977,7 +3207,7 @@ NextInstruction:
 
         GCStruct* result = GCStruct::structNew(code->typeInfo(), code->dataOffsets(), bp);
         if (UNLIKELY(result == nullptr)) {
-            Trap::throwException(state, "memory allocation failed");
+            return trap(state, Exception::MemoryAllocationFailed);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -2992,7 +3222,7 @@ NextInstruction:
 
         GCStruct* result = GCStruct::structNewDefault(code->typeInfo());
         if (UNLIKELY(result == nullptr)) {
-            Trap::throwException(state, "memory allocation failed");
+            return trap(state, Exception::MemoryAllocationFailed);
         }
         writeValue<void*>(bp, code->dstOffset(), result);
 
@@ -3007,7 +3237,7 @@ NextInstruction:
 
         GCStruct* ptr = readValue<GCStruct*>(bp, code->srcOffset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null structure reference");
+            return trap(state, Exception::NullStructureReference);
         }
 
         GCStruct::get(bp + code->dstOffset(),
@@ -3025,7 +3255,7 @@ NextInstruction:
 
         GCStruct* ptr = readValue<GCStruct*>(bp, code->src0Offset());
         if (UNLIKELY(Value::isNull(ptr))) {
-            Trap::throwException(state, "null structure reference");
+            return trap(state, Exception::NullStructureReference);
         }
 
         GCStruct::set(reinterpret_cast<uint8_t*>(ptr) + code->memberOffset(),
@@ -3061,9 +3291,7 @@ NextInstruction:
     DEFINE_OPCODE(Unreachable)
         :
     {
-        Trap::throwException(state, "unreachable executed");
-        ASSERT_NOT_REACHED();
-        NEXT_INSTRUCTION();
+        return trap(state, Exception::UnreachableExecuted);
     }
 
 #if !defined(NDEBUG)
@@ -3088,7 +3316,7 @@ NextInstruction:
 #if defined(COMPILER_GCC) && __GNUC__ >= 9
         __attribute__((cold));
 #endif
-#if !defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
+#if !defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL) && !defined(WALRUS_COMPACT_BYTECODE)
         asm volatile("FillByteCodeOpcodeTableAsmLbl:");
 #endif
 
@@ -3096,7 +3324,9 @@ NextInstruction:
     g_byteCodeTable.m_addressTable[ByteCode::name##Opcode] = &&name##OpcodeLbl;
         FOR_EACH_BYTECODE(REGISTER_TABLE)
 #undef REGISTER_TABLE
+#if !defined(WALRUS_COMPACT_BYTECODE)
         initAddressToOpcodeTable();
+#endif
         return nullptr;
     }
 #endif
@@ -3105,7 +3335,7 @@ NextInstruction:
     return nullptr;
 }
 
-NEVER_INLINE void Interpreter::callOperation(
+NEVER_INLINE bool Interpreter::callOperation(
     ExecutionState& state,
     size_t& programCounter,
     uint8_t* bp,
@@ -3113,13 +3343,16 @@ NEVER_INLINE void Interpreter::callOperation(
 {
     Call* code = (Call*)programCounter;
     Function* target = instance->function(code->index());
-    target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
+    if (UNLIKELY(!target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize()))) {
+        return false;
+    }
 
     programCounter += ByteCode::pointerAlignedSize(sizeof(Call) + sizeof(ByteCodeStackOffset) * code->parameterOffsetsSize()
                                                    + sizeof(ByteCodeStackOffset) * code->resultOffsetsSize());
+    return true;
 }
 
-NEVER_INLINE void Interpreter::callIndirectOperation(
+NEVER_INLINE bool Interpreter::callIndirectOperation(
     ExecutionState& state,
     size_t& programCounter,
     uint8_t* bp,
@@ -3130,24 +3363,30 @@ NEVER_INLINE void Interpreter::callIndirectOperation(
 
     uint32_t idx = readValue<uint32_t>(bp, code->calleeOffset());
     if (idx >= table->size()) {
-        Trap::throwException(state, "undefined element");
+        state.setTrap(Exception::UndefinedElement);
+        return false;
     }
     auto target = reinterpret_cast<Function*>(table->uncheckedGetElement(idx));
     if (UNLIKELY(Value::isNull(target))) {
-        Trap::throwException(state, "uninitialized element " + std::to_string(idx));
+        state.setTrap(Exception::UninitializedElementAt, idx);
+        return false;
     }
     const FunctionType* ft = target->functionType();
     if (!ft->equals(code->functionType())) {
-        Trap::throwException(state, "indirect call type mismatch");
+        state.setTrap(Exception::IndirectCallTypeMismatch);
+        return false;
     }
 
-    target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
+    if (UNLIKELY(!target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize()))) {
+        return false;
+    }
 
     programCounter += ByteCode::pointerAlignedSize(sizeof(CallIndirect) + sizeof(ByteCodeStackOffset) * code->parameterOffsetsSize()
                                                    + sizeof(ByteCodeStackOffset) * code->resultOffsetsSize());
+    return true;
 }
 
-NEVER_INLINE void Interpreter::callRefOperation(
+NEVER_INLINE bool Interpreter::callRefOperation(
     ExecutionState& state,
     size_t& programCounter,
     uint8_t* bp,
@@ -3157,20 +3396,25 @@ NEVER_INLINE void Interpreter::callRefOperation(
 
     auto target = readValue<Function*>(bp, code->calleeOffset());
     if (UNLIKELY(Value::isNull(target))) {
-        Trap::throwException(state, "null function reference");
+        state.setTrap(Exception::NullFunctionReference);
+        return false;
     }
     const FunctionType* ft = target->functionType();
     if (!ft->equals(code->functionType())) {
-        Trap::throwException(state, "call by reference type mismatch");
+        state.setTrap(Exception::CallByReferenceTypeMismatch);
+        return false;
     }
 
-    target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
+    if (UNLIKELY(!target->interpreterCall(state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize()))) {
+        return false;
+    }
 
     programCounter += ByteCode::pointerAlignedSize(sizeof(CallRef) + sizeof(ByteCodeStackOffset) * code->parameterOffsetsSize()
                                                    + sizeof(ByteCodeStackOffset) * code->resultOffsetsSize());
+    return true;
 }
 
-NEVER_INLINE bool Interpreter::tailCallOperation(
+NEVER_INLINE Interpreter::TailCallResult Interpreter::tailCallOperation(
     ExecutionState& state,
     size_t& programCounter,
     StackFrame& frame,
@@ -3205,15 +3449,117 @@ NEVER_INLINE bool Interpreter::tailCallOperation(
             state.m_currentFunction = definedTarget;
             instance = definedTarget->instance();
             programCounter = reinterpret_cast<size_t>(targetModuleFunction->byteCode());
-            return true;
+            return TailCallContinue;
         }
     }
 
     state.m_currentFunction = nullptr;
-    target->interpreterCall(state, frame.bp(), offsets, parameterOffsetCount, resultOffsetCount);
-    return false;
+    if (UNLIKELY(!target->interpreterCall(state, frame.bp(), offsets, parameterOffsetCount, resultOffsetCount))) {
+        return TailCallTrap;
+    }
+    return TailCallReturn;
+}
+
+#ifdef ENABLE_GC
+// Frames whose buffers were allocated by a tail call are not on the C stack,
+// so the collector does not find their references without this list.
+Interpreter::StackFrame* Interpreter::StackFrame::s_firstOwnedFrame;
+GC_push_other_roots_proc Interpreter::StackFrame::s_previousPushRoots;
+static MAY_THREAD_LOCAL char s_threadMarker;
+
+void* GC_CALLBACK Interpreter::StackFrame::replaceFrameBuffer(void* data)
+{
+    BufferReplacement* replacement = reinterpret_cast<BufferReplacement*>(data);
+    StackFrame* frame = replacement->frame;
+
+    if (frame->m_owned == nullptr) {
+        frame->m_thread = &s_threadMarker;
+        frame->m_next = s_firstOwnedFrame;
+        if (s_firstOwnedFrame != nullptr) {
+            s_firstOwnedFrame->m_prev = frame;
+        }
+        s_firstOwnedFrame = frame;
+    }
+
+    frame->m_owned = replacement->buffer;
+    frame->m_bp = replacement->buffer;
+    frame->m_capacity = replacement->capacity;
+    return nullptr;
 }
 
+void* GC_CALLBACK Interpreter::StackFrame::unlinkFrame(void* data)
+{
+    StackFrame* frame = reinterpret_cast<StackFrame*>(data);
+
+    if (frame->m_prev != nullptr) {
+        frame->m_prev->m_next = frame->m_next;
+    } else {
+        s_firstOwnedFrame = frame->m_next;
+    }
+
+    if (frame->m_next != nullptr) {
+        frame->m_next->m_prev = frame->m_prev;
+    }
+    return nullptr;
+}
+
+bool Interpreter::StackFrame::installPushRoots()
+{
+    s_previousPushRoots = GC_get_push_other_roots();
+    GC_set_push_other_roots(pushRoots);
+    return true;
+}
+
+const ByteCodeStackOffset* Interpreter::StackFrame::findStackMap(size_t& slotCount) const
+{
+    // The program counter of other threads may change during marking.
+    if (m_thread != &s_threadMarker || !m_state->m_programCounterPointer.hasValue()
+        || !m_state->m_currentFunction.hasValue()) {
+        return nullptr;
+    }
+
+    Function* function = m_state->m_currentFunction.value();
+    if (function->kind() != Function::DefinedFunctionKind) {
+        return nullptr;
+    }
+
+    ModuleFunction* moduleFunction = function->asDefinedFunction()->moduleFunction();
+    size_t byteCodeStart = reinterpret_cast<size_t>(moduleFunction->byteCode());
+    size_t programCounter = *m_state->m_programCounterPointer.value();
+
+    if (programCounter < byteCodeStart || programCounter >= byteCodeStart + moduleFunction->byteCodeSize()) {
+        return nullptr;
+    }
+
+    return moduleFunction->findStackMap(programCounter - byteCodeStart, slotCount);
+}
+
+void GC_CALLBACK Interpreter::StackFrame::pushRoots()
+{
+    for (StackFrame* frame = s_firstOwnedFrame; frame != nullptr; frame = frame->m_next) {
+        size_t slotCount;
+        const ByteCodeStackOffset* slots = frame->findStackMap(slotCount);
+
+        if (slots == nullptr) {
+            GC_push_all(frame->m_bp, frame->m_bp + frame->m_capacity);
+            continue;
+        }
+
+        for (size_t i = 0; i < slotCount; i++) {
+            void** slot = reinterpret_cast<void**>(frame->m_bp + slots[i]);
+
+            if (*slot != nullptr && !Value::isI31Value(*slot)) {
+                GC_push_all(slot, slot + 1);
+            }
+        }
+    }
+
+    if (s_previousPushRoots != nullptr) {
+        s_previousPushRoots();
+    }
+}
+#endif
+
 NEVER_INLINE bool Interpreter::testRefGeneric(void* refPtr, Value::Type type)
 {
     ASSERT(!Value::isNull(refPtr));
@@ -46,16 +46,25 @@ private:
         MAKE_STACK_ALLOCATED();
 
     public:
-        StackFrame(uint8_t* bp, size_t capacity)
+        StackFrame(ExecutionState& state, uint8_t* bp, size_t capacity)
             : m_bp(bp)
             , m_capacity(capacity)
             , m_owned(nullptr)
+#ifdef ENABLE_GC
+            , m_state(&state)
+            , m_thread(nullptr)
+            , m_prev(nullptr)
+            , m_next(nullptr)
+#endif
         {
         }
 
         ~StackFrame()
         {
             if (m_owned != nullptr) {
+#ifdef ENABLE_GC
+                GC_call_with_alloc_lock(unlinkFrame, this);
+#endif
                 deallocateBuffer(m_owned);
             }
         }
@@ -66,7 +75,11 @@ private:
         static uint8_t* allocateBuffer(size_t size)
         {
 #ifdef ENABLE_GC
-            return reinterpret_cast<uint8_t*>(GC_MALLOC_UNCOLLECTABLE(size));
+            static bool rootsInstalled = installPushRoots();
+            UNUSED_VARIABLE(rootsInstalled);
+
+            // Owned buffers are scanned by pushRoots().
+            return reinterpret_cast<uint8_t*>(GC_MALLOC_ATOMIC_UNCOLLECTABLE(size));
 #else
             return reinterpret_cast<uint8_t*>(malloc(size));
 #endif
@@ -74,12 +87,18 @@ private:
 
         void replaceBuffer(uint8_t* buffer, size_t capacity)
         {
-            if (m_owned != nullptr) {
-                deallocateBuffer(m_owned);
-            }
+            uint8_t* oldBuffer = m_owned;
+#ifdef ENABLE_GC
+            BufferReplacement replacement = { this, buffer, capacity };
+            GC_call_with_alloc_lock(replaceFrameBuffer, &replacement);
+#else
             m_owned = buffer;
             m_bp = buffer;
             m_capacity = capacity;
+#endif
+            if (oldBuffer != nullptr) {
+                deallocateBuffer(oldBuffer);
+            }
         }
 
     private:
@@ -92,16 +111,45 @@ private:
 #endif
         }
 
+#ifdef ENABLE_GC
+        struct BufferReplacement {
+            StackFrame* frame;
+            uint8_t* buffer;
+            size_t capacity;
+        };
+
+        // Owned buffers are linked into a list, which is only
+        // modified while the allocation lock of the collector is held.
+        static void* GC_CALLBACK replaceFrameBuffer(void* data);
+        static void* GC_CALLBACK unlinkFrame(void* data);
+        static bool installPushRoots();
+        static void GC_CALLBACK pushRoots();
+        const ByteCodeStackOffset* findStackMap(size_t& slotCount) const;
+
+        static StackFrame* s_firstOwnedFrame;
+        static GC_push_other_roots_proc s_previousPushRoots;
+#endif
+
         uint8_t* m_bp;
         size_t m_capacity;
         uint8_t* m_owned;
+#ifdef ENABLE_GC
+        ExecutionState* m_state;
+        const void* m_thread;
+        StackFrame* m_prev;
+        StackFrame* m_next;
+#endif
     };
 
-    ALWAYS_INLINE static void callInterpreter(ExecutionState& state, DefinedFunction* function, uint8_t* bp, ByteCodeStackOffset* offsets,
+    // Returns false if a trap is stored in the state.
+    ALWAYS_INLINE static bool callInterpreter(ExecutionState& state, DefinedFunction* function, uint8_t* bp, ByteCodeStackOffset* offsets,
                                               uint16_t parameterOffsetCount, uint16_t resultOffsetCount)
     {
         ExecutionState newState(state, function);
-        CHECK_STACK_LIMIT(newState);
+        if (IS_STACK_LIMIT_REACHED(newState)) {
+            state.setTrap(Exception::CallStackExhausted);
+            return false;
+        }
 
         auto moduleFunction = function->moduleFunction();
         ALLOCA(uint8_t, functionStackBase, moduleFunction->requiredStackSize());
@@ -111,20 +159,30 @@ private:
         }
 
         size_t programCounter = reinterpret_cast<size_t>(moduleFunction->byteCode());
-        StackFrame frame(functionStackBase, moduleFunction->requiredStackSize());
+        StackFrame frame(newState, functionStackBase, moduleFunction->requiredStackSize());
         ByteCodeStackOffset* resultOffsets;
 
 #if defined(WALRUS_ENABLE_JIT)
         if (moduleFunction->jitFunction() != nullptr) {
             resultOffsets = moduleFunction->jitFunction()->call(newState, function->instance(), functionStackBase);
+            if (UNLIKELY(resultOffsets == nullptr)) {
+                return false;
+            }
         } else
 #endif
         {
             while (true) {
                 try {
                     resultOffsets = interpret(newState, programCounter, frame, function->instance());
+                    newState.m_programCounterPointer.reset();
+                    if (UNLIKELY(resultOffsets == nullptr)) {
+                        return false;
+                    }
                     break;
                 } catch (std::unique_ptr<Exception>& e) {
+                    // The program counter of the unwound interpret() call is gone,
+                    // so the collector must scan this frame conservatively.
+                    newState.m_programCounterPointer.reset();
                     if (UNLIKELY(!newState.m_currentFunction.hasValue())) {
                         throw std::unique_ptr<Exception>(std::move(e));
                     }
@@ -166,36 +224,46 @@ private:
         for (size_t i = 0; i < resultOffsetCount; i++) {
             *((size_t*)(bp + offsets[i])) = *((size_t*)(frame.bp() + resultOffsets[i]));
         }
+        return true;
     }
 
+    // Returns with the result offsets, or nullptr if a trap is stored in the state.
     static ByteCodeStackOffset* interpret(ExecutionState& state,
                                           size_t programCounter,
                                           StackFrame& frame,
                                           Instance* instance);
 
-    static void callOperation(ExecutionState& state,
+    // The call operations return false if a trap is stored in the state.
+    static bool callOperation(ExecutionState& state,
                               size_t& programCounter,
                               uint8_t* bp,
                               Instance* instance);
 
-    static void callIndirectOperation(ExecutionState& state,
+    static bool callIndirectOperation(ExecutionState& state,
                                       size_t& programCounter,
                                       uint8_t* bp,
                                       Instance* instance);
 
-    static void callRefOperation(ExecutionState& state,
+    static bool callRefOperation(ExecutionState& state,
                                  size_t& programCounter,
                                  uint8_t* bp,
                                  Instance* instance);
 
-    static bool tailCallOperation(ExecutionState& state,
-                                  size_t& programCounter,
-                                  StackFrame& frame,
-                                  Instance*& instance,
-                                  Function* target,
-                                  ByteCodeStackOffset* offsets,
-                                  uint16_t parameterOffsetCount,
-                                  uint16_t resultOffsetCount);
+    enum TailCallResult {
+        // The target is executed by the current interpret() call.
+        TailCallContinue,
+        TailCallReturn,
+        TailCallTrap,
+    };
+
+    static TailCallResult tailCallOperation(ExecutionState& state,
+                                            size_t& programCounter,
+                                            StackFrame& frame,
+                                            Instance*& instance,
+                                            Function* target,
+                                            ByteCodeStackOffset* offsets,
+                                            uint16_t parameterOffsetCount,
+                                            uint16_t resultOffsetCount);
 
     static bool testRefGeneric(void* refPtr, Value::Type type);
     static bool testRefDefined(void* refPtr, const CompositeType** typeInfo);
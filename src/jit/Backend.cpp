@@ -45,6 +45,14 @@ extern "C" {
 #error Unsupported architecture
 #endif
 
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#else /* !COMPILER_MSVC */
+#include <cpuid.h>
+#endif /* COMPILER_MSVC */
+#endif /* SLJIT_CONFIG_X86_64 */
+
 #define OffsetOfContextField(field) \
     (static_cast<sljit_sw>(offsetof(ExecutionContext, field)))
 
@@ -204,6 +212,13 @@ public:
     {
         return offsetof(GCArray, m_length);
     }
+
+#ifdef ENABLE_GC
+    static sljit_sw gcRefIndex()
+    {
+        return offsetof(GCBase, m_refIndex);
+    }
+#endif
 };
 
 class SlowCase {
@@ -1045,6 +1060,21 @@ void Label::emit(sljit_compiler* compiler)
     addInfo(Label::kHasLabelData);
 }
 
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+static bool hasCpuFeatureSSE41()
+{
+    // CPUID leaf 1, bit 19 of ECX.
+#if defined(COMPILER_MSVC)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else /* !COMPILER_MSVC */
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 19)) != 0;
+#endif /* COMPILER_MSVC */
+}
+#endif /* SLJIT_CONFIG_X86_64 */
+
 JITCompiler::JITCompiler(Module* module, uint32_t JITFlags)
     : m_first(nullptr)
     , m_last(nullptr)
@@ -1075,6 +1105,16 @@ JITCompiler::JITCompiler(Module* module, uint32_t JITFlags)
     if (sljit_has_cpu_feature(SLJIT_HAS_CMOV)) {
         m_options |= JITCompiler::kHasCondMov;
     }
+
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+    static const bool hasSSE41 = hasCpuFeatureSSE41();
+
+    if (hasSSE41) {
+        m_options |= JITCompiler::kHasNativeFloatRounding;
+    }
+#elif (defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+    m_options |= JITCompiler::kHasNativeFloatRounding;
+#endif /* SLJIT_CONFIG_X86_64 */
 }
 
 void JITCompiler::compileFunction(JITFunction* jitFunc, bool isExternal)
@@ -23,6 +23,7 @@
 #include "runtime/Module.h"
 
 #include <map>
+#include <set>
 
 #if defined(COMPILER_MSVC)
 #include <BaseTsd.h>
@@ -98,6 +99,10 @@ static bool isFloatGlobal(uint32_t globalIndex, Module* module)
     return type == Value::F32 || type == Value::F64;
 }
 
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64) || (defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+#define HAS_INLINED_MEMORY_OPS
+#endif /* SLJIT_CONFIG_X86_64 || SLJIT_CONFIG_ARM_64 */
+
 // Helpers for simplifying descriptor definitions.
 
 #define I64_LOW (Instruction::Int64LowOperand | Instruction::TmpRequired)
@@ -199,6 +204,8 @@ static bool isFloatGlobal(uint32_t globalIndex, Module* module)
     OL3(OTCallbackI64I32I32, /* SSS */ I64, I32, I32)                                     \
     OL3(OTCallbackI32I64I32, /* SSS */ I32, I64, I32)                                     \
     OL3(OTCallbackI64I32I64, /* SSS */ I64, I32, I64)                                     \
+    OL5(OTMemoryFillInlined, /* SSSTT */ I32, I32, I32, PTR, PTR)                         \
+    OL6(OTMemoryCopyInlined, /* SSSTTT */ I32, I32, I32, PTR, PTR, PTR)                   \
     OL3(OTTableGrow, /* SSD */ PTR, I32, I32 | S0 | S1)                                   \
     OL3(OTTableFill, /* SSS */ I32, PTR, I32)                                             \
     OL4(OTTableSet, /* SSTT */ I32, PTR, I32 | S0, PTR)                                   \
@@ -269,13 +276,15 @@ static bool isFloatGlobal(uint32_t globalIndex, Module* module)
 
 #else /* !SLJIT_32BIT_ARCHITECTURE */
 
-#define OPERAND_TYPE_LIST_MATH                                    \
-    OL3(OTOp2I64, /* SSD */ I64, I64, I64 | S0 | S1)              \
-    OL4(OTLoadI64, /* SDTT */ I32, I64 | S0, PTR, I32 | S0)       \
-    OL4(OTLoadI64M64, /* SDTT */ I64, I64 | S0, PTR, I32 | S0)    \
-    OL1(OTGlobalGetI64, /* D */ I64)                              \
-    OL2(OTConvertInt64FromFloat32, /* SD */ F32 | TMP, I64 | TMP) \
-    OL2(OTConvertInt64FromFloat64, /* SD */ F64 | TMP, I64 | TMP) \
+#define OPERAND_TYPE_LIST_MATH                                            \
+    OL3(OTOp2I64, /* SSD */ I64, I64, I64 | S0 | S1)                      \
+    OL4(OTLoadI64, /* SDTT */ I32, I64 | S0, PTR, I32 | S0)               \
+    OL4(OTLoadI64M64, /* SDTT */ I64, I64 | S0, PTR, I32 | S0)            \
+    OL1(OTGlobalGetI64, /* D */ I64)                                      \
+    OL2(OTConvertInt64FromFloat32, /* SD */ F32 | TMP, I64 | TMP)         \
+    OL2(OTConvertInt64FromFloat64, /* SD */ F64 | TMP, I64 | TMP)         \
+    OL3(OTMinMaxF32, /* SSD */ F32 | TMP, F32 | TMP, F32 | TMP | S0 | S1) \
+    OL3(OTMinMaxF64, /* SSD */ F64 | TMP, F64 | TMP, F64 | TMP | S0 | S1) \
     OL4(OTSelectI64, /* SSSD */ I64, I64, I32, I64 | S0 | S1)
 
 #endif /* SLJIT_32BIT_ARCHITECTURE */
@@ -594,6 +603,180 @@ static uint32_t typeToStructRequiredInit(Value::Type type, bool isGet)
     }
 }
 
+#ifdef HAS_INLINED_MEMORY_OPS
+
+struct InlinedMemoryOps {
+    // Const32 byte codes before the first label of the function. The
+    // parser hoists the constants of a function to its start.
+    std::map<ByteCodeStackOffset, Const32*> entryConstants;
+    // Inlined memory.fill / memory.copy instructions whose size is an entry constant.
+    std::vector<ExtendedInstruction*> instructions;
+};
+
+static void collectEntryConstants(ModuleFunction* function, size_t endIdx, InlinedMemoryOps& inlinedOps)
+{
+    size_t idx = 0;
+
+    while (idx < endIdx) {
+        ByteCode* byteCode = function->getByteCode<ByteCode>(idx);
+        ByteCode::Opcode opcode = byteCode->opcode();
+
+        if (opcode == ByteCode::Const32Opcode) {
+            Const32* constant = reinterpret_cast<Const32*>(byteCode);
+            inlinedOps.entryConstants[constant->dstOffset()] = constant;
+        } else if (opcode != ByteCode::Const64Opcode && opcode != ByteCode::Const128Opcode) {
+            break;
+        }
+
+        idx += byteCode->getSize();
+    }
+}
+
+static void setMemoryFillCopyCallback(JITCompiler* compiler, Instruction* instr)
+{
+    instr->addInfo(Instruction::kIsCallback);
+    instr->setRequiredRegsDescriptor(OTCallbackI32I32I32);
+
+    if (instr->opcode() == ByteCode::MemoryCopyOpcode) {
+        compiler->increaseStackTmpSize(sizeof(MemoryCopyArguments));
+    }
+}
+
+// The size of memory.fill / memory.copy is constant, when it is set by the
+// previous instruction, or by an entry constant. The size is kept as the
+// third operand, so the instruction can be turned back to a callback.
+static void appendMemoryFillCopy(JITCompiler* compiler, InlinedMemoryOps& inlinedOps, ByteCode* byteCode,
+                                 ByteCode::Opcode opcode, const ByteCodeStackOffset* srcOffsets)
+{
+    bool isFill = (opcode == ByteCode::MemoryFillOpcode);
+    InstructionListItem* last = compiler->last();
+    uint32_t inlinedSize = 0;
+    bool isEntryConstant = false;
+
+    if (last != nullptr && !last->isLabel() && last->asInstruction()->opcode() == ByteCode::Const32Opcode
+        && *last->asInstruction()->operands() == STACK_OFFSET(srcOffsets[2])) {
+        inlinedSize = reinterpret_cast<Const32*>(last->asInstruction()->byteCode())->value();
+    } else {
+        auto it = inlinedOps.entryConstants.find(srcOffsets[2]);
+
+        if (it != inlinedOps.entryConstants.end()) {
+            inlinedSize = it->second->value();
+            isEntryConstant = true;
+        }
+    }
+
+    ExtendedInstruction* instr = compiler->appendExtended(byteCode, Instruction::Memory, opcode, 3, 0);
+
+    Operand* operands = instr->operands();
+    operands[0] = STACK_OFFSET(srcOffsets[0]);
+    operands[1] = STACK_OFFSET(srcOffsets[1]);
+    operands[2] = STACK_OFFSET(srcOffsets[2]);
+
+    if (inlinedSize == 0 || inlinedSize > (isFill ? JITCompiler::kMaxInlinedMemoryFill : JITCompiler::kMaxInlinedMemoryCopy)) {
+        setMemoryFillCopyCallback(compiler, instr);
+        return;
+    }
+
+    instr->value().inlinedSize = inlinedSize;
+    instr->setRequiredRegsDescriptor(isFill ? OTMemoryFillInlined : OTMemoryCopyInlined);
+
+    if (isEntryConstant) {
+        inlinedOps.instructions.push_back(instr);
+    }
+}
+
+static uint32_t operandTypeSlotCount(uint32_t typeInfo)
+{
+    switch (typeInfo & Instruction::TypeMask) {
+    case Instruction::Int64Operand:
+    case Instruction::Float64Operand:
+        return 2;
+    case Instruction::V128Operand:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+// An entry constant is only a constant, when no other instruction
+// writes its slot. Otherwise the inlining is reverted.
+static void checkInlinedMemoryOps(JITCompiler* compiler, InlinedMemoryOps& inlinedOps)
+{
+    if (inlinedOps.instructions.empty()) {
+        return;
+    }
+
+    std::set<Operand> sizeSlots;
+    std::set<Operand> writtenSlots;
+
+    for (auto it : inlinedOps.instructions) {
+        sizeSlots.insert(*it->getParam(2));
+    }
+
+    for (InstructionListItem* item = compiler->first(); item != nullptr; item = item->next()) {
+        if (!item->isInstruction()) {
+            continue;
+        }
+
+        Instruction* instr = item->asInstruction();
+        uint32_t resultCount = instr->resultCount();
+
+        if (resultCount == 0) {
+            continue;
+        }
+
+        Operand* result = instr->getResult(0);
+
+        if (instr->group() != Instruction::Call) {
+            if (instr->opcode() == ByteCode::Const32Opcode) {
+                auto it = inlinedOps.entryConstants.find(reinterpret_cast<Const32*>(instr->byteCode())->dstOffset());
+
+                if (it != inlinedOps.entryConstants.end() && it->second == instr->byteCode()) {
+                    continue;
+                }
+            }
+
+            uint32_t slotCount = operandTypeSlotCount(instr->getOperandDescriptor()[instr->paramCount()]);
+
+            for (uint32_t i = 0; i < slotCount; i++) {
+                if (sizeSlots.find(*result + i) != sizeSlots.end()) {
+                    writtenSlots.insert(*result + i);
+                }
+            }
+            continue;
+        }
+
+        FunctionType* functionType;
+
+        if (instr->opcode() == ByteCode::CallOpcode) {
+            functionType = compiler->module()->function(reinterpret_cast<Call*>(instr->byteCode())->index())->functionType();
+        } else if (instr->opcode() == ByteCode::CallIndirectOpcode) {
+            functionType = reinterpret_cast<CallIndirect*>(instr->byteCode())->functionType();
+        } else {
+            functionType = reinterpret_cast<CallRef*>(instr->byteCode())->functionType();
+        }
+
+        for (auto type : functionType->result().types()) {
+            uint32_t slotCount = operandTypeSlotCount(Instruction::valueTypeToOperandType(type));
+
+            for (uint32_t i = 0; i < slotCount; i++) {
+                if (sizeSlots.find(*result + i) != sizeSlots.end()) {
+                    writtenSlots.insert(*result + i);
+                }
+            }
+            result++;
+        }
+    }
+
+    for (auto it : inlinedOps.instructions) {
+        if (writtenSlots.find(*it->getParam(2)) != writtenSlots.end()) {
+            setMemoryFillCopyCallback(compiler, it);
+        }
+    }
+}
+
+#endif /* HAS_INLINED_MEMORY_OPS */
+
 static void compileFunction(JITCompiler* compiler)
 {
     size_t idx = 0;
@@ -671,6 +854,11 @@ static void compileFunction(JITCompiler* compiler)
         nextLabelIndex = it->first;
     }
 
+#ifdef HAS_INLINED_MEMORY_OPS
+    InlinedMemoryOps inlinedOps;
+    collectEntryConstants(function, std::min(nextLabelIndex, endIdx), inlinedOps);
+#endif /* HAS_INLINED_MEMORY_OPS */
+
     idx = 0;
     while (idx < endIdx) {
         if (idx == nextLabelIndex) {
@@ -831,15 +1019,24 @@ static void compileFunction(JITCompiler* compiler)
         }
         case ByteCode::F32MaxOpcode:
         case ByteCode::F32MinOpcode:
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
             requiredInit = OTOp2F32;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+            requiredInit = OTMinMaxF32;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
             FALLTHROUGH;
         case ByteCode::F64MaxOpcode:
         case ByteCode::F64MinOpcode: {
             group = Instruction::BinaryFloat;
             paramType = ParamTypes::ParamSrc2Dst;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
             info = Instruction::kIsCallback;
             if (requiredInit == OTNone)
                 requiredInit = OTOp2F64;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+            if (requiredInit == OTNone)
+                requiredInit = OTMinMaxF64;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
             break;
         }
         case ByteCode::F32CopysignOpcode:
@@ -933,7 +1130,16 @@ static void compileFunction(JITCompiler* compiler)
         case ByteCode::F64SqrtOpcode: {
             group = Instruction::UnaryFloat;
             paramType = ParamTypes::ParamSrcDst;
-            info = Instruction::kIsCallback;
+            if (!(compiler->options() & JITCompiler::kHasNativeFloatRounding)) {
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+                // Square root only needs SSE2.
+                if (opcode != ByteCode::F32SqrtOpcode && opcode != ByteCode::F64SqrtOpcode) {
+                    info = Instruction::kIsCallback;
+                }
+#else /* !SLJIT_CONFIG_X86_64 */
+                info = Instruction::kIsCallback;
+#endif /* SLJIT_CONFIG_X86_64 */
+            }
             if (requiredInit == OTNone)
                 requiredInit = OTOp1F64;
             break;
@@ -1044,9 +1250,13 @@ static void compileFunction(JITCompiler* compiler)
         case ByteCode::I64TruncSatF32UOpcode: {
             group = Instruction::ConvertFloat;
             paramType = ParamTypes::ParamSrcDst;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
             info = Instruction::kIsCallback;
             requiredInit = OTConvertInt64FromFloat32Callback;
             compiler->increaseStackTmpSize(8);
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+            requiredInit = OTConvertInt64FromFloat32;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
             break;
         }
         case ByteCode::I64TruncF64SOpcode: {
@@ -1065,9 +1275,13 @@ static void compileFunction(JITCompiler* compiler)
         case ByteCode::I64TruncSatF64UOpcode: {
             group = Instruction::ConvertFloat;
             paramType = ParamTypes::ParamSrcDst;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
             info = Instruction::kIsCallback;
             requiredInit = OTConvertInt64FromFloat64Callback;
             compiler->increaseStackTmpSize(8);
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+            requiredInit = OTConvertInt64FromFloat64;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
             break;
         }
         case ByteCode::I32TruncSatF32UOpcode: {
@@ -1912,6 +2126,13 @@ static void compileFunction(JITCompiler* compiler)
         case ByteCode::MemoryFillM64Opcode: {
             ByteCodeOffset3MemIndex* memoryFill = reinterpret_cast<ByteCodeOffset3MemIndex*>(byteCode);
 
+#ifdef HAS_INLINED_MEMORY_OPS
+            if (opcode == ByteCode::MemoryFillOpcode) {
+                appendMemoryFillCopy(compiler, inlinedOps, byteCode, opcode, memoryFill->srcOffsets());
+                break;
+            }
+#endif /* HAS_INLINED_MEMORY_OPS */
+
             Instruction* instr = compiler->append(byteCode, Instruction::Memory, opcode, 3, 0);
             instr->addInfo(Instruction::kIsCallback);
             instr->setRequiredRegsDescriptor(opcode == ByteCode::MemoryFillOpcode ? OTCallbackI32I32I32 : OTCallbackI64I32I64);
@@ -1928,6 +2149,13 @@ static void compileFunction(JITCompiler* compiler)
         case ByteCode::MemoryCopyM32M64Opcode: {
             ByteCodeOffset3MemIndex2* memoryCopy = reinterpret_cast<ByteCodeOffset3MemIndex2*>(byteCode);
 
+#ifdef HAS_INLINED_MEMORY_OPS
+            if (opcode == ByteCode::MemoryCopyOpcode) {
+                appendMemoryFillCopy(compiler, inlinedOps, byteCode, opcode, memoryCopy->srcOffsets());
+                break;
+            }
+#endif /* HAS_INLINED_MEMORY_OPS */
+
             Instruction* instr = compiler->append(byteCode, Instruction::Memory, opcode, 3, 0);
             instr->addInfo(Instruction::kIsCallback);
 
@@ -3576,6 +3804,10 @@ static void compileFunction(JITCompiler* compiler)
         idx += byteCode->getSize();
     }
 
+#ifdef HAS_INLINED_MEMORY_OPS
+    checkInlinedMemoryOps(compiler, inlinedOps);
+#endif /* HAS_INLINED_MEMORY_OPS */
+
     compiler->buildVariables(STACK_OFFSET(function->requiredStackSize()));
 
     if (compiler->JITFlags() & JITFlagValue::disableRegAlloc) {
@@ -16,17 +16,24 @@
 
 /* Only included by jit-backend.cc */
 
-static sljit_sw callFunction(
-    Call* code,
-    uint8_t* bp,
-    ExecutionContext* context)
+static sljit_sw callTarget(Function* target, ByteCodeStackOffset* offsets, uint16_t parameterOffsetCount,
+                           uint16_t resultOffsetCount, uint8_t* bp, ExecutionContext* context)
 {
-    Instance* instance = context->instance;
-    Function* target = instance->function(code->index());
+    if (target->kind() == Function::DefinedFunctionKind) {
+        DefinedFunction* definedFunction = target->asDefinedFunction();
+        JITFunction* jitFunction = definedFunction->moduleFunction()->jitFunction();
+
+        if (jitFunction != nullptr) {
+            return jitFunction->callFromJIT(context, definedFunction, bp, offsets, parameterOffsetCount, resultOffsetCount);
+        }
+    }
 
     sljit_sw error = ExecutionContext::NoError;
     try {
-        target->interpreterCall(context->state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
+        if (UNLIKELY(!target->interpreterCall(context->state, bp, offsets, parameterOffsetCount, resultOffsetCount))) {
+            context->error = ExecutionContext::InterpreterTrapError;
+            error = ExecutionContext::InterpreterTrapError;
+        }
     } catch (std::unique_ptr<Exception>& exception) {
         context->capturedException = exception.release();
         context->error = ExecutionContext::CapturedException;
@@ -36,6 +43,17 @@ static sljit_sw callFunction(
     return error;
 }
 
+static sljit_sw callFunction(
+    Call* code,
+    uint8_t* bp,
+    ExecutionContext* context)
+{
+    Instance* instance = context->instance;
+    Function* target = instance->function(code->index());
+
+    return callTarget(target, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize(), bp, context);
+}
+
 static sljit_sw callFunctionIndirect(
     CallIndirect* code,
     uint8_t* bp,
@@ -62,16 +80,7 @@ static sljit_sw callFunctionIndirect(
         return ExecutionContext::IndirectCallTypeMismatchError;
     }
 
-    sljit_sw error = ExecutionContext::NoError;
-    try {
-        target->interpreterCall(context->state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
-    } catch (std::unique_ptr<Exception>& exception) {
-        context->capturedException = exception.release();
-        context->error = ExecutionContext::CapturedException;
-        error = ExecutionContext::CapturedException;
-    }
-
-    return error;
+    return callTarget(target, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize(), bp, context);
 }
 
 static sljit_sw callFunctionRef(
@@ -93,16 +102,7 @@ static sljit_sw callFunctionRef(
         return ExecutionContext::CallRefTypeMismatchError;
     }
 
-    sljit_sw error = ExecutionContext::NoError;
-    try {
-        target->interpreterCall(context->state, bp, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize());
-    } catch (std::unique_ptr<Exception>& exception) {
-        context->capturedException = exception.release();
-        context->error = ExecutionContext::CapturedException;
-        error = ExecutionContext::CapturedException;
-    }
-
-    return error;
+    return callTarget(target, code->stackOffsets(), code->parameterOffsetsSize(), code->resultOffsetsSize(), bp, context);
 }
 
 static void emitCall(sljit_compiler* compiler, Instruction* instr)
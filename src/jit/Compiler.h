@@ -286,7 +286,7 @@ public:
 
     ExtendedInstruction* asExtended()
     {
-        ASSERT(group() == Instruction::DirectBranch || group() == Instruction::StackInit);
+        ASSERT(group() == Instruction::DirectBranch || group() == Instruction::StackInit || group() == Instruction::Memory);
         return reinterpret_cast<ExtendedInstruction*>(this);
     }
 
@@ -358,6 +358,8 @@ union InstructionValue {
     VariableRef offset;
     // For BrTable instruction.
     size_t targetLabelCount;
+    // For inlined memory operations.
+    uint32_t inlinedSize;
 };
 
 class ExtendedInstruction : public Instruction {
@@ -373,7 +375,7 @@ public:
 protected:
     static ExtendedInstruction* create(ByteCode* byteCode, Group group, ByteCode::Opcode opcode, uint32_t paramCount, size_t slots)
     {
-        ASSERT(group == Instruction::DirectBranch || group == Instruction::Call || group == Instruction::StackInit);
+        ASSERT(group == Instruction::DirectBranch || group == Instruction::Call || group == Instruction::StackInit || group == Instruction::Memory);
 
         return reinterpret_cast<ExtendedInstruction*>(Instruction::create(byteCode, group, opcode, paramCount, slots, true));
     }
@@ -676,6 +678,9 @@ struct VariableList {
     size_t paramCount;
     std::vector<Variable> variables;
     std::vector<CatchUpdate> catchUpdates;
+    // Loop depth weighted use counts divided by the range length,
+    // only computed by the linear scan register allocator.
+    std::vector<uint64_t> spillWeights;
 };
 
 class JITCompiler {
@@ -733,8 +738,11 @@ public:
 
     static const uint32_t kHasCondMov = 1 << 0;
     static const uint32_t kHasShortAtomic = 1 << 1;
+    static const uint32_t kHasNativeFloatRounding = 1 << 2;
 
     static const uint32_t kMaxInlinedBranchTable = 1024;
+    static const uint32_t kMaxInlinedMemoryFill = 64;
+    static const uint32_t kMaxInlinedMemoryCopy = 32;
 
     JITCompiler(Module* module, uint32_t JITFlags);
 
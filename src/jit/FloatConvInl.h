@@ -39,10 +39,9 @@ enum FloatConversionFlags : uint32_t {
         return ExecutionContext::NoError;                             \
     }
 
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
 CONVERT_FROM_FLOAT(convertF32ToU64, sljit_f32, uint64_t)
 CONVERT_FROM_FLOAT(convertF64ToU64, sljit_f64, uint64_t)
-
-#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
 CONVERT_FROM_FLOAT(convertF32ToU32, sljit_f32, uint32_t)
 CONVERT_FROM_FLOAT(convertF64ToU32, sljit_f64, uint32_t)
 CONVERT_FROM_FLOAT(convertF32ToS64, sljit_f32, int64_t)
@@ -89,14 +88,9 @@ TRUNC_SAT(truncSatF64ToU32, sljit_f64, uint32_t)
 
 TRUNC_SAT(truncSatF32ToS64, sljit_f32, int64_t)
 TRUNC_SAT(truncSatF64ToS64, sljit_f64, int64_t)
-
-#endif /* SLJIT_32BIT_ARCHITECTURE */
-
 TRUNC_SAT(truncSatF32ToU64, sljit_f32, uint64_t)
 TRUNC_SAT(truncSatF64ToU64, sljit_f64, uint64_t)
 
-#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
-
 #define CONVERT_TO_FLOAT(name, arg_type, result_type)                                     \
     static result_type name(uint32_t arg1, uint32_t arg2)                                 \
     {                                                                                     \
@@ -442,18 +436,119 @@ static void emitSaturatedConvertUnsigned32FromFloat(sljit_compiler* compiler, In
     MOVE_FROM_REG(compiler, SLJIT_MOV32, dstArg.arg, dstArg.argw, resultReg);
 }
 
+static void emitSetUnsigned64Limit(sljit_compiler* compiler, sljit_s32 opcode, sljit_s32 freg, sljit_f64 value)
+{
+    if (opcode & SLJIT_32) {
+        sljit_emit_fset32(compiler, freg, static_cast<sljit_f32>(value));
+    } else {
+        sljit_emit_fset64(compiler, freg, value);
+    }
+}
+
+/* Values in the [2^63, 2^64) range are converted after subtracting 2^63,
+   and the sign bit of the result is set afterwards. */
+static void emitConvertUnsigned64FromFloat(sljit_compiler* compiler, Instruction* instr, sljit_s32 opcode)
+{
+    ASSERT(!(instr->info() & Instruction::kIsCallback));
+
+    CompileContext* context = CompileContext::get(compiler);
+    Operand* operands = instr->operands();
+
+    JITArg srcArg(operands);
+    JITArg dstArg(operands + 1);
+
+    sljit_s32 sourceReg = GET_SOURCE_REG(srcArg.arg, instr->requiredReg(0));
+    sljit_s32 resultReg = GET_TARGET_REG(dstArg.arg, instr->requiredReg(1));
+    sljit_s32 tmpFReg = SLJIT_TMP_DEST_FREG;
+    sljit_s32 flag32 = opcode & SLJIT_32;
+
+    floatOperandToArg(compiler, operands, srcArg, sourceReg);
+    MOVE_TO_FREG(compiler, SLJIT_MOV_F64 | flag32, sourceReg, srcArg.arg, srcArg.argw);
+
+    sljit_jump* cmp = sljit_emit_fcmp(compiler, SLJIT_UNORDERED | flag32, sourceReg, 0, sourceReg, 0);
+    context->appendTrapJump(ExecutionContext::InvalidConversionToIntegerError, cmp);
+
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, -1.0);
+    cmp = sljit_emit_fcmp(compiler, SLJIT_F_LESS_EQUAL | flag32, sourceReg, 0, tmpFReg, 0);
+    context->appendTrapJump(ExecutionContext::IntegerOverflowError, cmp);
+
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, 18446744073709551616.0);
+    cmp = sljit_emit_fcmp(compiler, SLJIT_F_GREATER_EQUAL | flag32, sourceReg, 0, tmpFReg, 0);
+    context->appendTrapJump(ExecutionContext::IntegerOverflowError, cmp);
+
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, 9223372036854775808.0);
+    sljit_jump* highRange = sljit_emit_fcmp(compiler, SLJIT_F_GREATER_EQUAL | flag32, sourceReg, 0, tmpFReg, 0);
+
+    sljit_emit_fop1(compiler, opcode, resultReg, 0, sourceReg, 0);
+    sljit_jump* done = sljit_emit_jump(compiler, SLJIT_JUMP);
+
+    sljit_set_label(highRange, sljit_emit_label(compiler));
+    sljit_emit_fop2(compiler, SLJIT_SUB_F64 | flag32, tmpFReg, 0, sourceReg, 0, tmpFReg, 0);
+    sljit_emit_fop1(compiler, opcode, resultReg, 0, tmpFReg, 0);
+    sljit_emit_op2(compiler, SLJIT_XOR, resultReg, 0, resultReg, 0, SLJIT_IMM, static_cast<sljit_sw>(static_cast<sljit_uw>(1) << 63));
+
+    sljit_set_label(done, sljit_emit_label(compiler));
+    MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, resultReg);
+}
+
+static void emitSaturatedConvertUnsigned64FromFloat(sljit_compiler* compiler, Instruction* instr, sljit_s32 opcode)
+{
+    ASSERT(!(instr->info() & Instruction::kIsCallback));
+
+    Operand* operands = instr->operands();
+
+    JITArg srcArg(operands);
+    JITArg dstArg(operands + 1);
+
+    sljit_s32 sourceReg = GET_SOURCE_REG(srcArg.arg, instr->requiredReg(0));
+    sljit_s32 resultReg = GET_TARGET_REG(dstArg.arg, instr->requiredReg(1));
+    sljit_s32 tmpFReg = SLJIT_TMP_DEST_FREG;
+    sljit_s32 flag32 = opcode & SLJIT_32;
+
+    floatOperandToArg(compiler, operands, srcArg, sourceReg);
+    MOVE_TO_FREG(compiler, SLJIT_MOV_F64 | flag32, sourceReg, srcArg.arg, srcArg.argw);
+
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, 9223372036854775808.0);
+    sljit_jump* highRange = sljit_emit_fcmp(compiler, SLJIT_F_GREATER_EQUAL | flag32, sourceReg, 0, tmpFReg, 0);
+
+    /* NaN and negative values are converted to zero. */
+    sljit_emit_fop1(compiler, opcode, resultReg, 0, sourceReg, 0);
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, 0.0);
+    sljit_emit_fop1(compiler, SLJIT_CMP_F64 | SLJIT_SET_UNORDERED_OR_LESS | flag32, sourceReg, 0, tmpFReg, 0);
+    sljit_emit_select(compiler, SLJIT_UNORDERED_OR_LESS, resultReg, SLJIT_IMM, 0, resultReg);
+    sljit_jump* done = sljit_emit_jump(compiler, SLJIT_JUMP);
+
+    sljit_set_label(highRange, sljit_emit_label(compiler));
+    sljit_emit_fop2(compiler, SLJIT_SUB_F64 | flag32, tmpFReg, 0, sourceReg, 0, tmpFReg, 0);
+    sljit_emit_fop1(compiler, opcode, resultReg, 0, tmpFReg, 0);
+    sljit_emit_op2(compiler, SLJIT_XOR, resultReg, 0, resultReg, 0, SLJIT_IMM, static_cast<sljit_sw>(static_cast<sljit_uw>(1) << 63));
+
+    emitSetUnsigned64Limit(compiler, opcode, tmpFReg, 18446744073709551616.0);
+    sljit_emit_fop1(compiler, SLJIT_CMP_F64 | SLJIT_SET_ORDERED_GREATER_EQUAL | flag32, sourceReg, 0, tmpFReg, 0);
+    sljit_emit_select(compiler, SLJIT_ORDERED_GREATER_EQUAL, resultReg, SLJIT_IMM, -1, resultReg);
+
+    sljit_set_label(done, sljit_emit_label(compiler));
+    MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, resultReg);
+}
+
 #endif /* SLJIT_64BIT_ARCHITECTURE */
 
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
+
 static void checkConvertResult(sljit_compiler* compiler)
 {
     sljit_jump* cmp = sljit_emit_cmp(compiler, SLJIT_NOT_EQUAL, SLJIT_R0, 0, SLJIT_IMM, ExecutionContext::NoError);
     CompileContext::get(compiler)->appendTrapJump(ExecutionContext::GenericTrap, cmp);
 }
 
+#endif /* SLJIT_32BIT_ARCHITECTURE */
+
 static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
 {
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     uint32_t flags;
     sljit_sw addr = 0;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
 
     switch (instr->opcode()) {
     case ByteCode::I32TruncF32SOpcode: {
@@ -495,9 +590,14 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
 #endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncF32UOpcode: {
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
         flags = SourceIsFloat | DestinationIs64Bit;
         addr = GET_FUNC_ADDR(sljit_sw, convertF32ToU64);
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+        emitConvertUnsigned64FromFloat(compiler, instr, SLJIT_CONV_SW_FROM_F32);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncF64SOpcode: {
 #if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
@@ -510,9 +610,14 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
 #endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncF64UOpcode: {
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
         flags = SourceIsFloat | SourceIs64Bit | DestinationIs64Bit;
         addr = GET_FUNC_ADDR(sljit_sw, convertF64ToU64);
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+        emitConvertUnsigned64FromFloat(compiler, instr, SLJIT_CONV_SW_FROM_F64);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I32TruncSatF32SOpcode: {
         emitSaturatedConvertIntegerFromFloat(compiler, instr, SLJIT_CONV_S32_FROM_F32);
@@ -553,9 +658,14 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
 #endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncSatF32UOpcode: {
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
         flags = SourceIsFloat | DestinationIs64Bit | IsTruncSat;
         addr = GET_FUNC_ADDR(sljit_sw, truncSatF32ToU64);
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+        emitSaturatedConvertUnsigned64FromFloat(compiler, instr, SLJIT_CONV_SW_FROM_F32);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncSatF64SOpcode: {
 #if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
@@ -568,9 +678,14 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
 #endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::I64TruncSatF64UOpcode: {
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
         flags = SourceIsFloat | SourceIs64Bit | DestinationIs64Bit | IsTruncSat;
         addr = GET_FUNC_ADDR(sljit_sw, truncSatF64ToU64);
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+        emitSaturatedConvertUnsigned64FromFloat(compiler, instr, SLJIT_CONV_SW_FROM_F64);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     }
     case ByteCode::F32ConvertI32SOpcode: {
         emitConvertFloatFromInteger(compiler, instr, SLJIT_CONV_F32_FROM_S32);
@@ -631,6 +746,7 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
     }
     }
 
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     ASSERT(instr->info() & Instruction::kIsCallback);
     ASSERT((flags & SourceIsFloat) | (flags & DestinationIsFloat));
 
@@ -640,13 +756,6 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
     if (flags & DestinationIsFloat) {
         sljit_s32 argTypes = (flags & DestinationIs64Bit) ? SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_F64) : SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_F32);
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-        arg.set(operands);
-
-        sljit_s32 movOp = (flags & SourceIs64Bit) ? SLJIT_MOV : SLJIT_MOV32;
-        MOVE_TO_REG(compiler, movOp, SLJIT_R0, arg.arg, arg.argw);
-        argTypes |= (flags & SourceIs64Bit) ? SLJIT_ARG_VALUE(SLJIT_ARG_TYPE_W, 1) : SLJIT_ARG_VALUE(SLJIT_ARG_TYPE_32, 1);
-#else /* !SLJIT_64BIT_ARCHITECTURE */
         if (flags & SourceIs64Bit) {
             JITArgPair srcArgPair(operands);
 
@@ -659,7 +768,6 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
             MOVE_TO_REG(compiler, SLJIT_MOV, SLJIT_R0, arg.arg, arg.argw);
             argTypes |= SLJIT_ARG_VALUE(SLJIT_ARG_TYPE_W, 1);
         }
-#endif /* SLJIT_64BIT_ARCHITECTURE */
 
         sljit_emit_icall(compiler, SLJIT_CALL, argTypes, SLJIT_IMM, addr);
         arg.set(operands + 1);
@@ -679,9 +787,6 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
     /* Destination must not be immediate. */
     ASSERT(VARIABLE_TYPE(operands[1]) != Instruction::ConstPtr);
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-    arg.set(operands + 1);
-#else /* !SLJIT_64BIT_ARCHITECTURE */
     JITArgPair argPair;
 
     if (flags & DestinationIs64Bit) {
@@ -691,24 +796,13 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
     } else {
         arg.set(operands + 1);
     }
-#endif /* SLJIT_64BIT_ARCHITECTURE */
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-    if (flags & IsTruncSat) {
-        sljit_s32 movOp = (flags & DestinationIs64Bit) ? SLJIT_MOV : SLJIT_MOV32;
-        argTypes |= (flags & DestinationIs64Bit) ? SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_W) : SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_32);
-        sljit_emit_icall(compiler, SLJIT_CALL, argTypes, SLJIT_IMM, addr);
-        MOVE_FROM_REG(compiler, movOp, arg.arg, arg.argw, SLJIT_R0);
-        return;
-    }
-#else /* !SLJIT_64BIT_ARCHITECTURE */
     if ((flags & (IsTruncSat | DestinationIs64Bit)) == IsTruncSat) {
         argTypes |= SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_W);
         sljit_emit_icall(compiler, SLJIT_CALL, argTypes, SLJIT_IMM, addr);
         MOVE_FROM_REG(compiler, SLJIT_MOV, arg.arg, arg.argw, SLJIT_R0);
         return;
     }
-#endif /* SLJIT_64BIT_ARCHITECTURE */
 
     sljit_sw stackTmpStart = CompileContext::get(compiler)->stackTmpStart;
 
@@ -718,31 +812,19 @@ static void emitConvertFloat(sljit_compiler* compiler, Instruction* instr)
         sljit_get_local_base(compiler, SLJIT_R0, 0, stackTmpStart);
     }
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-    argTypes |= SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_W) | SLJIT_ARG_VALUE(SLJIT_ARG_TYPE_W, 2);
-#else /* !SLJIT_64BIT_ARCHITECTURE */
     argTypes |= SLJIT_ARG_VALUE(SLJIT_ARG_TYPE_W, 2);
     argTypes |= (flags & IsTruncSat) ? SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_RET_VOID) : SLJIT_ARG_RETURN(SLJIT_ARG_TYPE_W);
-#endif /* SLJIT_64BIT_ARCHITECTURE */
 
     sljit_emit_icall(compiler, SLJIT_CALL, argTypes, SLJIT_IMM, addr);
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-    checkConvertResult(compiler);
-#else /* !SLJIT_64BIT_ARCHITECTURE */
     if (!(flags & IsTruncSat)) {
         checkConvertResult(compiler);
     }
-#endif /* SLJIT_64BIT_ARCHITECTURE */
 
     if (arg.arg == SLJIT_MEM1(kFrameReg)) {
         return;
     }
 
-#if (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
-    sljit_s32 movOp = (flags & DestinationIs64Bit) ? SLJIT_MOV : SLJIT_MOV32;
-    sljit_emit_op1(compiler, movOp, arg.arg, arg.argw, SLJIT_MEM1(SLJIT_SP), stackTmpStart);
-#else /* !SLJIT_64BIT_ARCHITECTURE */
     if (!(flags & DestinationIs64Bit)) {
         sljit_emit_op1(compiler, SLJIT_MOV, arg.arg, arg.argw, SLJIT_MEM1(SLJIT_SP), stackTmpStart);
         return;
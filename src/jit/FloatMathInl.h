@@ -103,6 +103,8 @@ static void emitInitFR0FR1(sljit_compiler* compiler, sljit_s32 movOp, JITArg* pa
     sljit_emit_fop1(compiler, movOp, SLJIT_FR1, 0, SLJIT_TMP_DEST_FREG, 0);
 }
 
+#if !(defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+
 // Float operations.
 // TODO Canonical NaN
 static sljit_f32 floatFloor(sljit_f32 operand)
@@ -169,6 +171,101 @@ static sljit_f64 floatNearest(sljit_f64 val)
     return std::nearbyint(val);
 }
 
+#endif /* !SLJIT_CONFIG_ARM_64 */
+
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64) || (defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+
+#define HAS_NATIVE_FLOAT_ROUNDING
+
+// The rounding modes match the immediate of the x86 round instructions.
+enum FloatRoundingOp : uint32_t {
+    FloatRoundNearest = 0,
+    FloatRoundFloor = 1,
+    FloatRoundCeil = 2,
+    FloatRoundTrunc = 3,
+    FloatSqrt = 4,
+};
+
+static void emitFloatRoundingOp(sljit_compiler* compiler, uint32_t op, bool is32, sljit_s32 dstReg, sljit_s32 srcReg)
+{
+    sljit_s32 rd = sljit_get_register_index(SLJIT_FLOAT_REGISTER, dstReg);
+    sljit_s32 rn = sljit_get_register_index(SLJIT_FLOAT_REGISTER, srcReg);
+
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+    // roundss / roundsd (SSE4.1) and sqrtss / sqrtsd.
+    uint8_t buf[8];
+    uint8_t* ptr = buf;
+
+    if (op == FloatSqrt) {
+        *ptr++ = is32 ? 0xf3 : 0xf2;
+    } else {
+        *ptr++ = 0x66;
+    }
+
+    if (rd >= 8 || rn >= 8) {
+        *ptr++ = 0x40 | ((rd >= 8) ? 0x4 : 0) | ((rn >= 8) ? 0x1 : 0);
+    }
+
+    *ptr++ = 0x0f;
+
+    if (op == FloatSqrt) {
+        *ptr++ = 0x51;
+    } else {
+        *ptr++ = 0x3a;
+        *ptr++ = is32 ? 0x0a : 0x0b;
+    }
+
+    *ptr++ = 0xc0 | ((rd & 0x7) << 3) | (rn & 0x7);
+
+    if (op != FloatSqrt) {
+        // Precision exceptions are suppressed.
+        *ptr++ = 0x8 | op;
+    }
+
+    sljit_emit_op_custom(compiler, buf, static_cast<sljit_u32>(ptr - buf));
+#else /* !SLJIT_CONFIG_X86_64 */
+    static const uint32_t opcodes[] = {
+        0x1e244000, // frintn
+        0x1e254000, // frintm
+        0x1e24c000, // frintp
+        0x1e25c000, // frintz
+        0x1e21c000, // fsqrt
+    };
+
+    uint32_t opcode = opcodes[op] | (is32 ? 0 : (1 << 22)) | static_cast<uint32_t>(rd) | (static_cast<uint32_t>(rn) << 5);
+    sljit_emit_op_custom(compiler, &opcode, sizeof(uint32_t));
+#endif /* SLJIT_CONFIG_X86_64 */
+}
+
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+
+// Used when the round instructions are not available (no SSE4.1).
+static void emitFloatRoundingCallback(sljit_compiler* compiler, uint32_t op, bool is32, JITArg* args)
+{
+    ASSERT(op != FloatSqrt);
+
+    if (is32) {
+        static const f32Function1Param f32Funcs[] = { floatNearest, floatFloor, floatCeil, floatTrunc };
+
+        MOVE_TO_FREG(compiler, SLJIT_MOV_F32, SLJIT_FR0, args[0].arg, args[0].argw);
+        sljit_emit_icall(compiler, SLJIT_CALL, SLJIT_ARGS1(F32, F32), SLJIT_IMM, GET_FUNC_ADDR(sljit_sw, f32Funcs[op]));
+        MOVE_FROM_FREG(compiler, SLJIT_MOV_F32, args[1].arg, args[1].argw, SLJIT_FR0);
+        return;
+    }
+
+    static const f64Function1Param f64Funcs[] = { floatNearest, floatFloor, floatCeil, floatTrunc };
+
+    MOVE_TO_FREG(compiler, SLJIT_MOV_F64, SLJIT_FR0, args[0].arg, args[0].argw);
+    sljit_emit_icall(compiler, SLJIT_CALL, SLJIT_ARGS1(F64, F64), SLJIT_IMM, GET_FUNC_ADDR(sljit_sw, f64Funcs[op]));
+    MOVE_FROM_FREG(compiler, SLJIT_MOV_F64, args[1].arg, args[1].argw, SLJIT_FR0);
+}
+
+#endif /* SLJIT_CONFIG_X86_64 */
+
+#endif /* SLJIT_CONFIG_X86_64 || SLJIT_CONFIG_ARM_64 */
+
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
+
 static sljit_f32 floatMin(sljit_f32 lhs, sljit_f32 rhs)
 {
     if (SLJIT_UNLIKELY(std::isnan(lhs) || std::isnan(rhs))) {
@@ -213,6 +310,65 @@ static sljit_f64 floatMax(sljit_f64 lhs, sljit_f64 rhs)
     return std::max(lhs, rhs);
 }
 
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+
+// Sets dstReg to trueReg when the condition is true, and to falseReg otherwise.
+static void emitFloatSelectReg(sljit_compiler* compiler, sljit_s32 type, sljit_s32 dstReg, sljit_s32 trueReg, sljit_s32 falseReg)
+{
+    if (dstReg == trueReg) {
+        sljit_emit_fselect(compiler, type ^ 0x1, dstReg, falseReg, 0, trueReg);
+        return;
+    }
+
+    sljit_emit_fselect(compiler, type, dstReg, trueReg, 0, falseReg);
+}
+
+static void emitFloatMinMax(sljit_compiler* compiler, Instruction* instr, JITArg* args, bool isMin, bool is32)
+{
+    sljit_s32 movOp = is32 ? SLJIT_MOV_F32 : SLJIT_MOV_F64;
+    sljit_s32 flag32 = is32 ? SLJIT_32 : 0;
+
+    sljit_s32 srcReg0 = GET_SOURCE_REG(args[0].arg, instr->requiredReg(0));
+    sljit_s32 srcReg1 = GET_SOURCE_REG(args[1].arg, instr->requiredReg(1));
+    sljit_s32 dstReg = GET_TARGET_REG(args[2].arg, instr->requiredReg(2));
+
+    MOVE_TO_FREG(compiler, movOp, srcReg0, args[0].arg, args[0].argw);
+    MOVE_TO_FREG(compiler, movOp, srcReg1, args[1].arg, args[1].argw);
+
+    sljit_jump* unordered = sljit_emit_fcmp(compiler, SLJIT_UNORDERED | flag32, srcReg0, 0, srcReg1, 0);
+    sljit_jump* equal = sljit_emit_fcmp(compiler, SLJIT_F_EQUAL | flag32, srcReg0, 0, srcReg1, 0);
+
+    sljit_s32 type = isMin ? SLJIT_F_LESS : SLJIT_F_GREATER;
+    sljit_emit_fop1(compiler, SLJIT_CMP_F64 | (isMin ? SLJIT_SET_F_LESS : SLJIT_SET_F_GREATER) | flag32, srcReg0, 0, srcReg1, 0);
+    emitFloatSelectReg(compiler, type | flag32, dstReg, srcReg0, srcReg1);
+    sljit_jump* done = sljit_emit_jump(compiler, SLJIT_JUMP);
+
+    // Equal values can only differ in the sign of zero.
+    sljit_set_label(equal, sljit_emit_label(compiler));
+    sljit_emit_fcopy(compiler, is32 ? SLJIT_COPY32_FROM_F32 : SLJIT_COPY_FROM_F64, srcReg0, SLJIT_TMP_DEST_REG);
+    sljit_emit_op2u(compiler, SLJIT_SUB | SLJIT_SET_SIG_LESS | flag32, SLJIT_TMP_DEST_REG, 0, SLJIT_IMM, 0);
+
+    if (isMin) {
+        emitFloatSelectReg(compiler, SLJIT_SIG_LESS | flag32, dstReg, srcReg0, srcReg1);
+    } else {
+        emitFloatSelectReg(compiler, SLJIT_SIG_LESS | flag32, dstReg, srcReg1, srcReg0);
+    }
+
+    sljit_jump* equalDone = sljit_emit_jump(compiler, SLJIT_JUMP);
+
+    // The sum of the operands is a quiet NaN.
+    sljit_set_label(unordered, sljit_emit_label(compiler));
+    sljit_emit_fop2(compiler, SLJIT_ADD_F64 | flag32, dstReg, 0, srcReg0, 0, srcReg1, 0);
+
+    sljit_label* label = sljit_emit_label(compiler);
+    sljit_set_label(done, label);
+    sljit_set_label(equalDone, label);
+
+    MOVE_FROM_FREG(compiler, movOp, args[2].arg, args[2].argw, dstReg);
+}
+
+#endif /* SLJIT_32BIT_ARCHITECTURE */
+
 static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
 {
     Operand* operands = instr->operands();
@@ -226,8 +382,10 @@ static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
 
     sljit_s32 opcode = SLJIT_NOP;
     sljit_s32 dstReg;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     f32Function2Param f32Func = nullptr;
     f64Function2Param f64Func = nullptr;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
 
     switch (instr->opcode()) {
     case ByteCode::F32AddOpcode:
@@ -242,12 +400,19 @@ static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
     case ByteCode::F32DivOpcode:
         opcode = SLJIT_DIV_F32;
         break;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     case ByteCode::F32MaxOpcode:
         f32Func = floatMax;
         break;
     case ByteCode::F32MinOpcode:
         f32Func = floatMin;
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+    case ByteCode::F32MaxOpcode:
+    case ByteCode::F32MinOpcode:
+        emitFloatMinMax(compiler, instr, args, instr->opcode() == ByteCode::F32MinOpcode, true);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     case ByteCode::F64AddOpcode:
         opcode = SLJIT_ADD_F64;
         break;
@@ -260,12 +425,19 @@ static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
     case ByteCode::F64DivOpcode:
         opcode = SLJIT_DIV_F64;
         break;
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     case ByteCode::F64MaxOpcode:
         f64Func = floatMax;
         break;
     case ByteCode::F64MinOpcode:
         f64Func = floatMin;
         break;
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+    case ByteCode::F64MaxOpcode:
+    case ByteCode::F64MinOpcode:
+        emitFloatMinMax(compiler, instr, args, instr->opcode() == ByteCode::F64MinOpcode, false);
+        return;
+#endif /* SLJIT_32BIT_ARCHITECTURE */
     case ByteCode::F32CopysignOpcode:
     case ByteCode::F64CopysignOpcode:
         dstReg = GET_TARGET_REG(args[2].arg, instr->requiredReg(2));
@@ -284,6 +456,7 @@ static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
         return;
     }
 
+#if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
     ASSERT(instr->info() & Instruction::kIsCallback);
 
     if (f32Func) {
@@ -296,6 +469,9 @@ static void emitFloatBinary(sljit_compiler* compiler, Instruction* instr)
     emitInitFR0FR1(compiler, SLJIT_MOV_F64, args);
     sljit_emit_icall(compiler, SLJIT_CALL, SLJIT_ARGS2(F64, F64, F64), SLJIT_IMM, GET_FUNC_ADDR(sljit_sw, f64Func));
     MOVE_FROM_FREG(compiler, SLJIT_MOV_F64, args[2].arg, args[2].argw, SLJIT_FR0);
+#else /* !SLJIT_32BIT_ARCHITECTURE */
+    RELEASE_ASSERT_NOT_REACHED();
+#endif /* SLJIT_32BIT_ARCHITECTURE */
 }
 
 static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
@@ -308,11 +484,48 @@ static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
     floatOperandToArg(compiler, operands, args[0], instr->requiredReg(0));
     floatOperandToArg(compiler, operands + 1, args[1], 0);
 
-    sljit_s32 opcode;
+    sljit_s32 opcode = SLJIT_NOP;
+#ifdef HAS_NATIVE_FLOAT_ROUNDING
+    uint32_t roundingOp = 0;
+    bool is32 = true;
+#else /* !HAS_NATIVE_FLOAT_ROUNDING */
     f32Function1Param f32Func = nullptr;
     f64Function1Param f64Func = nullptr;
+#endif /* HAS_NATIVE_FLOAT_ROUNDING */
 
     switch (instr->opcode()) {
+#ifdef HAS_NATIVE_FLOAT_ROUNDING
+    case ByteCode::F64CeilOpcode:
+        is32 = false;
+        FALLTHROUGH;
+    case ByteCode::F32CeilOpcode:
+        roundingOp = FloatRoundCeil;
+        break;
+    case ByteCode::F64FloorOpcode:
+        is32 = false;
+        FALLTHROUGH;
+    case ByteCode::F32FloorOpcode:
+        roundingOp = FloatRoundFloor;
+        break;
+    case ByteCode::F64TruncOpcode:
+        is32 = false;
+        FALLTHROUGH;
+    case ByteCode::F32TruncOpcode:
+        roundingOp = FloatRoundTrunc;
+        break;
+    case ByteCode::F64NearestOpcode:
+        is32 = false;
+        FALLTHROUGH;
+    case ByteCode::F32NearestOpcode:
+        roundingOp = FloatRoundNearest;
+        break;
+    case ByteCode::F64SqrtOpcode:
+        is32 = false;
+        FALLTHROUGH;
+    case ByteCode::F32SqrtOpcode:
+        roundingOp = FloatSqrt;
+        break;
+#else /* !HAS_NATIVE_FLOAT_ROUNDING */
     case ByteCode::F32CeilOpcode:
         f32Func = floatCeil;
         break;
@@ -328,15 +541,6 @@ static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
     case ByteCode::F32SqrtOpcode:
         f32Func = sqrtf;
         break;
-    case ByteCode::F32NegOpcode:
-        opcode = SLJIT_NEG_F32;
-        break;
-    case ByteCode::F32AbsOpcode:
-        opcode = SLJIT_ABS_F32;
-        break;
-    case ByteCode::F32DemoteF64Opcode:
-        opcode = SLJIT_CONV_F32_FROM_F64;
-        break;
     case ByteCode::F64CeilOpcode:
         f64Func = floatCeil;
         break;
@@ -352,6 +556,16 @@ static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
     case ByteCode::F64SqrtOpcode:
         f64Func = sqrt;
         break;
+#endif /* HAS_NATIVE_FLOAT_ROUNDING */
+    case ByteCode::F32NegOpcode:
+        opcode = SLJIT_NEG_F32;
+        break;
+    case ByteCode::F32AbsOpcode:
+        opcode = SLJIT_ABS_F32;
+        break;
+    case ByteCode::F32DemoteF64Opcode:
+        opcode = SLJIT_CONV_F32_FROM_F64;
+        break;
     case ByteCode::F64NegOpcode:
         opcode = SLJIT_NEG_F64;
         break;
@@ -365,6 +579,33 @@ static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
         RELEASE_ASSERT_NOT_REACHED();
     }
 
+#ifdef HAS_NATIVE_FLOAT_ROUNDING
+    if (opcode == SLJIT_NOP) {
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64)
+        if (instr->info() & Instruction::kIsCallback) {
+            emitFloatRoundingCallback(compiler, roundingOp, is32, args);
+            return;
+        }
+#endif /* SLJIT_CONFIG_X86_64 */
+
+        ASSERT(!(instr->info() & Instruction::kIsCallback));
+        sljit_s32 movOp = is32 ? SLJIT_MOV_F32 : SLJIT_MOV_F64;
+        sljit_s32 dstReg = GET_TARGET_REG(args[1].arg, SLJIT_TMP_DEST_FREG);
+        sljit_s32 srcReg = args[0].arg;
+
+        if (!SLJIT_IS_REG(srcReg)) {
+            sljit_emit_fop1(compiler, movOp, dstReg, 0, args[0].arg, args[0].argw);
+            srcReg = dstReg;
+        }
+
+        emitFloatRoundingOp(compiler, roundingOp, is32, dstReg, srcReg);
+        MOVE_FROM_FREG(compiler, movOp, args[1].arg, args[1].argw, dstReg);
+        return;
+    }
+
+    ASSERT(!(instr->info() & Instruction::kIsCallback));
+    sljit_emit_fop1(compiler, opcode, args[1].arg, args[1].argw, args[0].arg, args[0].argw);
+#else /* !HAS_NATIVE_FLOAT_ROUNDING */
     if (f32Func) {
         ASSERT(instr->info() & Instruction::kIsCallback);
         MOVE_TO_FREG(compiler, SLJIT_MOV_F32, SLJIT_FR0, args[0].arg, args[0].argw);
@@ -379,6 +620,7 @@ static void emitFloatUnary(sljit_compiler* compiler, Instruction* instr)
         ASSERT(!(instr->info() & Instruction::kIsCallback));
         sljit_emit_fop1(compiler, opcode, args[1].arg, args[1].argw, args[0].arg, args[0].argw);
     }
+#endif /* HAS_NATIVE_FLOAT_ROUNDING */
 }
 
 static void emitFloatSelect(sljit_compiler* compiler, Instruction* instr, sljit_s32 type)
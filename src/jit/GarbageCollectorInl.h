@@ -671,6 +671,55 @@ static void emitGCDataCopy(sljit_compiler* compiler, Operand* operand, sljit_s32
 #endif /* SLJIT_CONFIG_X86_32 */
 }
 
+#if (defined ENABLE_GC) && (defined SLJIT_64BIT_ARCHITECTURE && SLJIT_64BIT_ARCHITECTURE)
+#define HAS_INLINED_GC_ALLOCATION
+
+static void markUsedScratchReg(sljit_u32& usedRegs, Operand* operand, Value::Type type)
+{
+    if (type == Value::F32 || type == Value::F64 || type == Value::V128) {
+        return;
+    }
+
+    JITArg arg(operand);
+
+    if (SLJIT_IS_REG(arg.arg) && arg.arg < SLJIT_R(SLJIT_NUMBER_OF_SCRATCH_REGISTERS)) {
+        usedRegs |= static_cast<sljit_u32>(1) << (arg.arg - SLJIT_R0);
+    }
+}
+
+static sljit_s32 getUnusedScratchReg(sljit_u32 usedRegs)
+{
+    for (sljit_s32 i = 0; i < SLJIT_NUMBER_OF_SCRATCH_REGISTERS; i++) {
+        if (!(usedRegs & (static_cast<sljit_u32>(1) << i))) {
+            return SLJIT_R(i);
+        }
+    }
+
+    return 0;
+}
+
+// Pops an object from the free list of the current thread, and initializes
+// its header. The returned jump is taken when the free list is empty.
+static sljit_jump* emitGCAllocationInlined(sljit_compiler* compiler, sljit_s32 objectReg, size_t size,
+                                           uintptr_t virtualTable, const CompositeType** typeInfo)
+{
+    sljit_sw freeListOffset = static_cast<sljit_sw>(GCObjectCache::freeListOffset(GCObjectCache::sizeClass(size)));
+
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_TMP_DEST_REG, 0, SLJIT_MEM1(SLJIT_SP), kContextOffset);
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_TMP_DEST_REG, 0, SLJIT_MEM1(SLJIT_TMP_DEST_REG), OffsetOfContextField(gcObjectCache));
+    sljit_emit_op1(compiler, SLJIT_MOV_P, objectReg, 0, SLJIT_MEM1(SLJIT_TMP_DEST_REG), freeListOffset);
+    sljit_jump* slowCase = sljit_emit_cmp(compiler, SLJIT_EQUAL, objectReg, 0, SLJIT_IMM, 0);
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_TMP_OPT_REG, 0, SLJIT_MEM1(objectReg), 0);
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_MEM1(SLJIT_TMP_DEST_REG), freeListOffset, SLJIT_TMP_OPT_REG, 0);
+
+    // The rest of the object is cleared by the collector.
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_MEM1(objectReg), 0, SLJIT_IMM, static_cast<sljit_sw>(virtualTable));
+    sljit_emit_op1(compiler, SLJIT_MOV_P, SLJIT_MEM1(objectReg), JITFieldAccessor::objectTypeInfo(), SLJIT_IMM, reinterpret_cast<sljit_sw>(typeInfo));
+    sljit_emit_op1(compiler, SLJIT_MOV, SLJIT_MEM1(objectReg), JITFieldAccessor::gcRefIndex(), SLJIT_IMM, -1);
+    return slowCase;
+}
+#endif /* ENABLE_GC && SLJIT_64BIT_ARCHITECTURE */
+
 static void emitGCArrayNew(sljit_compiler* compiler, Instruction* instr)
 {
     CompileContext* context = CompileContext::get(compiler);
@@ -708,6 +757,37 @@ static void emitGCArrayNew(sljit_compiler* compiler, Instruction* instr)
         ByteCodeStackOffset* end = stackOffset + arrayNewFixed->offsetsSize();
         Operand* param = instr->params();
         Value::Type type = arrayNewFixed->typeInfo()->field().type();
+#ifdef HAS_INLINED_GC_ALLOCATION
+        sljit_jump* done = nullptr;
+
+        // Numeric arrays are allocated from memory which is not scanned by the collector.
+        if (Value::isRefType(type)) {
+            uint32_t length = arrayNewFixed->length();
+            sljit_sw startOffset = static_cast<sljit_sw>((sizeof(GCArray) + sizeof(void*) - 1) & ~(sizeof(void*) - 1));
+            size_t totalSize = static_cast<size_t>(startOffset) + length * sizeof(void*);
+            sljit_u32 usedRegs = 0;
+
+            for (uint32_t i = 0; i < length; i++) {
+                markUsedScratchReg(usedRegs, param + i, type);
+            }
+
+            sljit_s32 objectReg = getUnusedScratchReg(usedRegs);
+
+            if (totalSize <= GCObjectCache::MaxObjectSize && objectReg != 0) {
+                sljit_jump* slowCase = emitGCAllocationInlined(compiler, objectReg, totalSize, GCArray::virtualTablePointer(), arrayNewFixed->typeInfo()->subTypeList());
+                sljit_emit_op1(compiler, SLJIT_MOV32, SLJIT_MEM1(objectReg), JITFieldAccessor::arrayLength(), SLJIT_IMM, static_cast<sljit_sw>(length));
+
+                for (uint32_t i = 0; i < length; i++) {
+                    emitGCDataCopy(compiler, param + i, objectReg, startOffset + static_cast<sljit_sw>(i * sizeof(void*)), type, GCCopySet);
+                }
+
+                JITArg dstArg(param + length);
+                MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, objectReg);
+                done = sljit_emit_jump(compiler, SLJIT_JUMP);
+                sljit_set_label(slowCase, sljit_emit_label(compiler));
+            }
+        }
+#endif /* HAS_INLINED_GC_ALLOCATION */
 
         while (stackOffset < end) {
             emitGCStore(compiler, *stackOffset++, param++, type);
@@ -722,6 +802,11 @@ static void emitGCArrayNew(sljit_compiler* compiler, Instruction* instr)
                                 sljit_emit_cmp(compiler, SLJIT_EQUAL, SLJIT_R0, 0, SLJIT_IMM, 0));
         JITArg dstArg(param);
         MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, SLJIT_R0);
+#ifdef HAS_INLINED_GC_ALLOCATION
+        if (done != nullptr) {
+            sljit_set_label(done, sljit_emit_label(compiler));
+        }
+#endif /* HAS_INLINED_GC_ALLOCATION */
         break;
     }
     case ByteCode::ArrayNewDataOpcode:
@@ -1007,14 +1092,33 @@ static void emitGCStructNew(sljit_compiler* compiler, Instruction* instr)
 {
     CompileContext* context = CompileContext::get(compiler);
 
+#ifdef HAS_INLINED_GC_ALLOCATION
+    sljit_jump* done = nullptr;
+#endif /* HAS_INLINED_GC_ALLOCATION */
+
     if (instr->opcode() == ByteCode::StructNewDefaultOpcode) {
         StructNewDefault* structNewDefault = reinterpret_cast<StructNewDefault*>(instr->byteCode());
+        JITArg dstArg(instr->operands());
+#ifdef HAS_INLINED_GC_ALLOCATION
+        const StructType* type = structNewDefault->typeInfo();
+
+        if (type->structSize() <= GCObjectCache::MaxObjectSize) {
+            sljit_jump* slowCase = emitGCAllocationInlined(compiler, SLJIT_R0, type->structSize(), GCStruct::virtualTablePointer(), type->subTypeList());
+            MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, SLJIT_R0);
+            done = sljit_emit_jump(compiler, SLJIT_JUMP);
+            sljit_set_label(slowCase, sljit_emit_label(compiler));
+        }
+#endif /* HAS_INLINED_GC_ALLOCATION */
         sljit_emit_op1(compiler, SLJIT_MOV, SLJIT_R0, 0, SLJIT_IMM, reinterpret_cast<sljit_sw>(structNewDefault->typeInfo()));
         sljit_emit_icall(compiler, SLJIT_CALL, SLJIT_ARGS1(P, P), SLJIT_IMM, GET_FUNC_ADDR(sljit_sw, GCStruct::structNewDefault));
         context->appendTrapJump(ExecutionContext::AllocationError,
                                 sljit_emit_cmp(compiler, SLJIT_EQUAL, SLJIT_R0, 0, SLJIT_IMM, 0));
-        JITArg dstArg(instr->operands());
         MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, SLJIT_R0);
+#ifdef HAS_INLINED_GC_ALLOCATION
+        if (done != nullptr) {
+            sljit_set_label(done, sljit_emit_label(compiler));
+        }
+#endif /* HAS_INLINED_GC_ALLOCATION */
         return;
     }
 
@@ -1022,6 +1126,37 @@ static void emitGCStructNew(sljit_compiler* compiler, Instruction* instr)
     ByteCodeStackOffset* stackOffset = structNew->dataOffsets();
     Operand* param = instr->params();
 
+#ifdef HAS_INLINED_GC_ALLOCATION
+    const StructType* type = structNew->typeInfo();
+
+    if (type->structSize() <= GCObjectCache::MaxObjectSize) {
+        const MutableTypeVector::Types& fields = type->fields().types();
+        const VectorWithFixedSize<uint32_t, std::allocator<uint32_t>>& fieldOffsets = type->fieldOffsets();
+        size_t size = fields.size();
+        sljit_u32 usedRegs = 0;
+
+        for (size_t i = 0; i < size; i++) {
+            markUsedScratchReg(usedRegs, param + i, fields[i].type());
+        }
+
+        sljit_s32 objectReg = getUnusedScratchReg(usedRegs);
+
+        if (objectReg != 0) {
+            // Fields are initialized directly from their operands.
+            sljit_jump* slowCase = emitGCAllocationInlined(compiler, objectReg, type->structSize(), GCStruct::virtualTablePointer(), type->subTypeList());
+
+            for (size_t i = 0; i < size; i++) {
+                emitGCDataCopy(compiler, param + i, objectReg, static_cast<sljit_sw>(fieldOffsets[i]), fields[i].type(), GCCopySet);
+            }
+
+            JITArg dstArg(param + size);
+            MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, objectReg);
+            done = sljit_emit_jump(compiler, SLJIT_JUMP);
+            sljit_set_label(slowCase, sljit_emit_label(compiler));
+        }
+    }
+#endif /* HAS_INLINED_GC_ALLOCATION */
+
     for (auto it : structNew->typeInfo()->fields().types()) {
         emitGCStore(compiler, *stackOffset++, param++, it.type());
     }
@@ -1034,6 +1169,11 @@ static void emitGCStructNew(sljit_compiler* compiler, Instruction* instr)
                             sljit_emit_cmp(compiler, SLJIT_EQUAL, SLJIT_R0, 0, SLJIT_IMM, 0));
     JITArg dstArg(param);
     MOVE_FROM_REG(compiler, SLJIT_MOV, dstArg.arg, dstArg.argw, SLJIT_R0);
+#ifdef HAS_INLINED_GC_ALLOCATION
+    if (done != nullptr) {
+        sljit_set_label(done, sljit_emit_label(compiler));
+    }
+#endif /* HAS_INLINED_GC_ALLOCATION */
 }
 
 static void emitGCStructAccess(sljit_compiler* compiler, Instruction* instr)
@@ -184,10 +184,13 @@ Instruction* JITCompiler::append(ByteCode* byteCode, Instruction::Group group, B
 ExtendedInstruction* JITCompiler::appendExtended(ByteCode* byteCode, Instruction::Group group, ByteCode::Opcode opcode, uint32_t paramCount, uint32_t resultCount)
 {
     ExtendedInstruction* instr = ExtendedInstruction::create(byteCode, group, opcode, paramCount, paramCount + resultCount);
-    ASSERT(group == Instruction::Call);
+    ASSERT(group == Instruction::Call || (group == Instruction::Memory && resultCount == 0));
 
     instr->m_resultCount = resultCount > 0 ? 1 : 0;
-    instr->value().resultCount = resultCount;
+
+    if (group == Instruction::Call) {
+        instr->value().resultCount = resultCount;
+    }
 
     append(instr);
     return instr;
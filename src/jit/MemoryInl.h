@@ -2491,9 +2491,9 @@ static sljit_s32 atomicWaitCallback(ExecutionContext* context, uint8_t* address,
     int64_t timeout = args[1];
 
     if (size == 8) {
-        instance->memory(0)->atomicWait(context->state, instance->module()->store(), address, expect, timeout, &result);
+        instance->memory(0)->atomicWait(context->state, instance->store(), address, expect, timeout, &result);
     } else {
-        instance->memory(0)->atomicWait(context->state, instance->module()->store(), address, (int32_t)expect, timeout, &result);
+        instance->memory(0)->atomicWait(context->state, instance->store(), address, (int32_t)expect, timeout, &result);
     }
 
     args[0] = result;
@@ -2614,7 +2614,7 @@ static void emitAtomicWait(sljit_compiler* compiler, Instruction* instr)
 static sljit_s32 atomicNotifyCallback(Instance* instance, uint8_t* address, int32_t count)
 {
     uint32_t result = 0;
-    instance->memory(0)->atomicNotify(instance->module()->store(), address, count, &result);
+    instance->memory(0)->atomicNotify(instance->store(), address, count, &result);
     return result;
 }
 
@@ -160,6 +160,144 @@ static void memoryParamToArg(sljit_compiler* compiler, CompileContext* context,
 
 #endif /* SLJIT_32BIT_ARCHITECTURE */
 
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64) || (defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+
+// Moves 1-16 bytes between registers and memory with
+// two integer accesses, which may overlap each other.
+static void emitInlinedMemoryMove(sljit_compiler* compiler, bool isLoad, sljit_s32 reg1, sljit_s32 reg2,
+                                  sljit_s32 baseReg, sljit_sw offset, sljit_u32 size)
+{
+    sljit_s32 opcode = SLJIT_MOV_U8;
+    sljit_u32 width = 1;
+
+    ASSERT(size >= 1 && size <= 16);
+
+    if (size >= 8) {
+        opcode = SLJIT_MOV;
+        width = 8;
+    } else if (size >= 4) {
+        opcode = SLJIT_MOV32;
+        width = 4;
+    } else if (size >= 2) {
+        opcode = SLJIT_MOV_U16;
+        width = 2;
+    }
+
+    if (isLoad) {
+        sljit_emit_op1(compiler, opcode, reg1, 0, SLJIT_MEM1(baseReg), offset);
+    } else {
+        sljit_emit_op1(compiler, opcode, SLJIT_MEM1(baseReg), offset, reg1, 0);
+    }
+
+    if (size == width) {
+        return;
+    }
+
+    offset += static_cast<sljit_sw>(size - width);
+
+    if (isLoad) {
+        sljit_emit_op1(compiler, opcode, reg2, 0, SLJIT_MEM1(baseReg), offset);
+    } else {
+        sljit_emit_op1(compiler, opcode, SLJIT_MEM1(baseReg), offset, reg2, 0);
+    }
+}
+
+static void emitMemoryFillInlined(sljit_compiler* compiler, Instruction* instr)
+{
+    Operand* params = instr->operands();
+    sljit_u32 size = instr->asExtended()->value().inlinedSize;
+    uint16_t memIndex = reinterpret_cast<ByteCodeOffset3MemIndex*>(instr->byteCode())->memIndex();
+    sljit_s32 baseReg = instr->requiredReg(0);
+    sljit_s32 valueReg = instr->requiredReg(1);
+
+    MemAddress addr(MemAddress::AbsoluteAddress, baseReg, valueReg, 0);
+    addr.check(compiler, params, 0, size, memIndex);
+
+    if (addr.memArg.arg == 0) {
+        return;
+    }
+
+    JITArg valueArg(params + 1);
+
+    if (size >= 16) {
+        if (SLJIT_IS_IMM(valueArg.arg)) {
+            valueArg.argw &= 0xff;
+        }
+
+        sljit_emit_simd_replicate(compiler, SLJIT_SIMD_REG_128 | SLJIT_SIMD_ELEM_8, SLJIT_TMP_DEST_FREG, valueArg.arg, valueArg.argw);
+
+        sljit_u32 offset = 0;
+        sljit_s32 type = SLJIT_SIMD_STORE | SLJIT_SIMD_REG_128 | SLJIT_SIMD_ELEM_128;
+
+        for (; offset + 16 <= size; offset += 16) {
+            sljit_emit_simd_mov(compiler, type, SLJIT_TMP_DEST_FREG, SLJIT_MEM1(baseReg), static_cast<sljit_sw>(offset));
+        }
+
+        if (offset < size) {
+            sljit_emit_simd_mov(compiler, type, SLJIT_TMP_DEST_FREG, SLJIT_MEM1(baseReg), static_cast<sljit_sw>(size - 16));
+        }
+        return;
+    }
+
+    const sljit_sw byteMask = static_cast<sljit_sw>(0x0101010101010101);
+
+    if (SLJIT_IS_IMM(valueArg.arg)) {
+        sljit_emit_op1(compiler, SLJIT_MOV, valueReg, 0, SLJIT_IMM, (valueArg.argw & 0xff) * byteMask);
+    } else {
+        sljit_emit_op1(compiler, SLJIT_MOV_U8, valueReg, 0, valueArg.arg, valueArg.argw);
+        sljit_emit_op2(compiler, SLJIT_MUL, valueReg, 0, valueReg, 0, SLJIT_IMM, byteMask);
+    }
+
+    emitInlinedMemoryMove(compiler, false, valueReg, valueReg, baseReg, 0, size);
+}
+
+static void emitMemoryCopyInlined(sljit_compiler* compiler, Instruction* instr)
+{
+    Operand* params = instr->operands();
+    sljit_u32 size = instr->asExtended()->value().inlinedSize;
+    MemoryCopy* memoryCopy = reinterpret_cast<MemoryCopy*>(instr->byteCode());
+    sljit_s32 dstReg = instr->requiredReg(0);
+    sljit_s32 srcReg = instr->requiredReg(1);
+    sljit_s32 tmpReg = instr->requiredReg(2);
+
+    MemAddress dstAddr(MemAddress::AbsoluteAddress, dstReg, srcReg, 0);
+    dstAddr.check(compiler, params, 0, size, memoryCopy->dstMemIndex());
+
+    if (dstAddr.memArg.arg == 0) {
+        return;
+    }
+
+    MemAddress srcAddr(MemAddress::AbsoluteAddress, srcReg, tmpReg, 0);
+    srcAddr.check(compiler, params + 1, 0, size, memoryCopy->srcMemIndex());
+
+    if (srcAddr.memArg.arg == 0) {
+        return;
+    }
+
+    // Everything is loaded before the first store, so
+    // overlapping source and destination ranges work.
+    sljit_u32 offset = 0;
+
+    if (size >= 16) {
+        sljit_emit_simd_mov(compiler, SLJIT_SIMD_LOAD | SLJIT_SIMD_REG_128 | SLJIT_SIMD_ELEM_128, SLJIT_TMP_DEST_FREG, SLJIT_MEM1(srcReg), 0);
+        offset = 16;
+    }
+
+    if (offset < size) {
+        emitInlinedMemoryMove(compiler, true, SLJIT_TMP_DEST_REG, tmpReg, srcReg, static_cast<sljit_sw>(offset), size - offset);
+    }
+
+    if (size >= 16) {
+        sljit_emit_simd_mov(compiler, SLJIT_SIMD_STORE | SLJIT_SIMD_REG_128 | SLJIT_SIMD_ELEM_128, SLJIT_TMP_DEST_FREG, SLJIT_MEM1(dstReg), 0);
+    }
+
+    if (offset < size) {
+        emitInlinedMemoryMove(compiler, false, SLJIT_TMP_DEST_REG, tmpReg, dstReg, static_cast<sljit_sw>(offset), size - offset);
+    }
+}
+
+#endif /* SLJIT_CONFIG_X86_64 || SLJIT_CONFIG_ARM_64 */
+
 static void emitMemory(sljit_compiler* compiler, Instruction* instr)
 {
     CompileContext* context = CompileContext::get(compiler);
@@ -214,6 +352,18 @@ static void emitMemory(sljit_compiler* compiler, Instruction* instr)
     case ByteCode::MemoryCopyM64Opcode:
     case ByteCode::MemoryCopyM64M32Opcode:
     case ByteCode::MemoryCopyM32M64Opcode: {
+#if (defined SLJIT_CONFIG_X86_64 && SLJIT_CONFIG_X86_64) || (defined SLJIT_CONFIG_ARM_64 && SLJIT_CONFIG_ARM_64)
+        if (!(instr->info() & Instruction::kIsCallback)) {
+            if (opcode == ByteCode::MemoryFillOpcode) {
+                emitMemoryFillInlined(compiler, instr);
+            } else {
+                ASSERT(opcode == ByteCode::MemoryCopyOpcode);
+                emitMemoryCopyInlined(compiler, instr);
+            }
+            return;
+        }
+#endif /* SLJIT_CONFIG_X86_64 || SLJIT_CONFIG_ARM_64 */
+
         ASSERT(instr->info() & Instruction::kIsCallback);
 
 #if (defined SLJIT_32BIT_ARCHITECTURE && SLJIT_32BIT_ARCHITECTURE)
@@ -61,6 +61,8 @@ public:
 
     uint8_t getSavedRegCount() { return static_cast<uint8_t>(m_usedSavedRegisters - m_savedStartIndex); }
 
+    void useSpillWeights(VariableList* variableList) { m_variableList = variableList; }
+
     uint8_t toCPUReg(uint8_t reg, uint8_t scratchBase, uint8_t savedBase);
     bool check(uint8_t reg, uint16_t constraints);
     void freeUnusedRegisters(size_t id);
@@ -90,6 +92,11 @@ private:
     static const size_t kReservedReg = 0;
     static const size_t kUnassignedReg = ~(size_t)0;
 
+    uint64_t spillWeight(VariableList::Variable* variable)
+    {
+        return m_variableList->spillWeights[static_cast<size_t>(variable - m_variableList->variables.data())];
+    }
+
     struct RegisterInfo {
         RegisterInfo()
             : rangeEnd(kUnassignedReg)
@@ -108,6 +115,10 @@ private:
 
     // Allocated registers.
     std::vector<RegisterInfo> m_registers;
+    // When set, the variable with the lowest spill
+    // weight is moved into memory instead of the
+    // variable with the farthest range end.
+    VariableList* m_variableList;
 };
 
 class RegisterFile {
@@ -208,6 +219,15 @@ public:
         m_integerSet.allocateRegister(variable);
     }
 
+    void useSpillWeights(VariableList* variableList)
+    {
+        m_integerSet.useSpillWeights(variableList);
+        m_floatSet.useSpillWeights(variableList);
+#if (defined SLJIT_SEPARATE_VECTOR_REGISTERS && SLJIT_SEPARATE_VECTOR_REGISTERS)
+        m_vectorSet.useSpillWeights(variableList);
+#endif /* SLJIT_SEPARATE_VECTOR_REGISTERS */
+    }
+
     void freeUnusedRegisters(size_t id)
     {
         m_integerSet.freeUnusedRegisters(id);
@@ -231,6 +251,7 @@ RegisterSet::RegisterSet(uint32_t numberOfScratchRegs, uint32_t numberOfSavedReg
     : m_regStatus(isInteger ? kIsInteger : 0)
     , m_savedStartIndex(numberOfScratchRegs)
     , m_usedSavedRegisters(numberOfScratchRegs)
+    , m_variableList(nullptr)
 {
     m_registers.resize(numberOfScratchRegs + numberOfSavedRegs);
 }
@@ -284,6 +305,8 @@ uint8_t RegisterSet::allocateRegister(VariableList::Variable* variable)
 {
     size_t maxRangeEnd = 0;
     size_t maxRangeIndex = 0;
+    uint64_t minWeight = ~(uint64_t)0;
+    size_t minWeightIndex = 0;
     uint16_t constraints = variable != nullptr ? variable->info : 0;
     size_t size = m_registers.size();
     size_t i = 0;
@@ -310,13 +333,29 @@ uint8_t RegisterSet::allocateRegister(VariableList::Variable* variable)
             maxRangeIndex = i;
         }
 
+        if (m_variableList != nullptr && m_registers[i].rangeEnd != kReservedReg) {
+            uint64_t weight = spillWeight(m_registers[i].variable);
+
+            if (weight < minWeight) {
+                minWeight = weight;
+                minWeightIndex = i;
+            }
+        }
+
         i++;
     }
 
     if (i == size) {
         ASSERT(maxRangeEnd != 0 || variable != nullptr);
 
-        if (variable != nullptr && variable->rangeEnd >= maxRangeEnd) {
+        if (m_variableList != nullptr) {
+            // Hot variables (e.g. used in inner loops) are kept in registers.
+            if (variable != nullptr && (maxRangeEnd == 0 || spillWeight(variable) <= minWeight)) {
+                return VariableList::kUnusedReg;
+            }
+
+            maxRangeIndex = minWeightIndex;
+        } else if (variable != nullptr && variable->rangeEnd >= maxRangeEnd) {
             return VariableList::kUnusedReg;
         }
 
@@ -637,6 +676,86 @@ bool RegisterFile::reuseResult(uint8_t type, VariableList::Variable** reusableRe
     return false;
 }
 
+static void computeSpillWeights(InstructionListItem* first, VariableList* variableList)
+{
+    // Each nesting level multiplies the weight of a use by 8.
+    const uint32_t maxLoopDepth = 6;
+    const uint32_t weightShift = 16;
+    size_t lastId = 0;
+
+    for (InstructionListItem* item = first; item != nullptr; item = item->next()) {
+        lastId = item->id();
+    }
+
+    // A label is a loop header, when it is the target of a
+    // backward branch. The loop ends at the last such branch.
+    std::vector<int32_t> depthChange(lastId + 2, 0);
+
+    for (InstructionListItem* item = first; item != nullptr; item = item->next()) {
+        if (!item->isLabel()) {
+            continue;
+        }
+
+        Label* label = item->asLabel();
+        size_t loopEnd = 0;
+
+        for (auto it : label->branches()) {
+            if (it->id() > label->id() && it->id() > loopEnd) {
+                loopEnd = it->id();
+            }
+        }
+
+        if (loopEnd != 0) {
+            depthChange[label->id()]++;
+            depthChange[loopEnd + 1]--;
+        }
+    }
+
+    std::vector<uint64_t>& weights = variableList->spillWeights;
+    int32_t depth = 0;
+
+    weights.assign(variableList->variables.size(), 0);
+
+    for (InstructionListItem* item = first; item != nullptr; item = item->next()) {
+        depth += depthChange[item->id()];
+
+        if (item->isLabel()) {
+            continue;
+        }
+
+        Instruction* instr = item->asInstruction();
+        Operand* operand = instr->operands();
+        Operand* end = operand + instr->paramCount() + instr->resultCount();
+        uint32_t loopDepth = static_cast<uint32_t>(depth) < maxLoopDepth ? static_cast<uint32_t>(depth) : maxLoopDepth;
+        uint64_t useWeight = static_cast<uint64_t>(1) << (3 * loopDepth);
+
+        while (operand < end) {
+            if (!(variableList->variables[*operand].info & VariableList::kIsImmediate)) {
+                weights[*operand] += useWeight;
+            }
+            operand++;
+        }
+    }
+
+    size_t size = variableList->variables.size();
+    for (size_t i = 0; i < size; i++) {
+        VariableList::Variable& variable = variableList->variables[i];
+
+        if (variable.info & (VariableList::kIsMerged | VariableList::kIsImmediate)) {
+            continue;
+        }
+
+        // Long ranges with few uses are cheap to keep in memory.
+        size_t length = 1;
+
+        if (variable.rangeEnd > variable.u.rangeStart) {
+            length += variable.rangeEnd - variable.u.rangeStart;
+        }
+
+        weights[i] = (weights[i] << weightShift) / length;
+    }
+}
+
 void JITCompiler::allocateRegisters()
 {
     if (m_variableList == nullptr) {
@@ -658,6 +777,11 @@ void JITCompiler::allocateRegisters()
 
     RegisterFile regs(numberOfscratchRegs, numberOfsavedRegs);
 
+    if (JITFlags() & JITFlagValue::linearScanRegAlloc) {
+        computeSpillWeights(m_first, m_variableList);
+        regs.useSpillWeights(m_variableList);
+    }
+
     size_t variableListParamCount = m_variableList->paramCount;
     for (size_t i = 0; i < variableListParamCount; i++) {
         VariableList::Variable* variable = m_variableList->variables.data() + i;
@@ -240,7 +240,9 @@ static void throwWithArgs(Throw* throwTag, uint8_t* bp, ExecutionContext* contex
     }
 
     context->error = ExecutionContext::CapturedException;
-    context->capturedException = Exception::create(context->state, tag, std::move(userExceptionData)).release();
+    // The program counters of the interpreter frames are recorded
+    // when the exception leaves the JIT code.
+    context->capturedException = Exception::create(tag, std::move(userExceptionData)).release();
 }
 
 static void emitThrow(sljit_compiler* compiler, Instruction* instr)
@@ -17,6 +17,7 @@
 
 #include "parser/WASMParser.h"
 #include "interpreter/ByteCode.h"
+#include "interpreter/ByteCodeOptimizer.h"
 #include "runtime/GCArray.h"
 #include "runtime/Module.h"
 #include "runtime/Store.h"
@@ -668,6 +669,7 @@ private:
     static const size_t s_noI32Eqz = SIZE_MAX - sizeof(Walrus::I32Eqz);
     size_t m_lastI32EqzPos;
     bool m_useJIT;
+    bool m_optimizeByteCode;
 
     Walrus::FunctionType* getFunctionType(Index index)
     {
@@ -880,7 +882,7 @@ private:
     }
 
 public:
-    WASMBinaryReader(Walrus::TypeStore& typeStore, bool useJIT = false)
+    WASMBinaryReader(Walrus::TypeStore& typeStore, bool useJIT = false, bool optimizeByteCode = false)
         : m_readerOffsetPointer(nullptr)
         , m_readerDataPointer(nullptr)
         , m_codeEndOffset(0)
@@ -897,6 +899,7 @@ public:
         , m_preprocessData(*this)
         , m_lastI32EqzPos(s_noI32Eqz)
         , m_useJIT(useJIT)
+        , m_optimizeByteCode(optimizeByteCode)
     {
     }
 
@@ -1003,11 +1006,24 @@ public:
 
         ASSERT(index == m_result.m_compositeTypes.size());
         Walrus::StructType* type = new Walrus::StructType(fields, supertypes->is_final_sub_type, toSubType(supertypes));
-        if (!type->initialize()) {
+        // Super types are defined before their sub types.
+        Walrus::StructType* superType = nullptr;
+        if (supertypes->sub_type_count > 0 && supertypes->sub_types[0] < index
+            && m_result.m_compositeTypes[supertypes->sub_types[0]]->kind() == Walrus::ObjectType::StructKind) {
+            superType = m_result.m_compositeTypes[supertypes->sub_types[0]]->asStruct();
+        }
+
+        if (!type->initialize(superType)) {
             delete type;
             return false;
         }
 
+#if !defined(NDEBUG)
+        if (getenv("DUMP_STRUCT_LAYOUT") && strlen(getenv("DUMP_STRUCT_LAYOUT"))) {
+            printf("struct type %u: size %u, %u bytes saved\n", index, type->structSize(), type->savedBytes());
+        }
+#endif
+
         m_result.m_compositeTypes.push_back(type);
         if (index < m_recursiveTypeEnd && index > m_recursiveTypeStart) {
             Walrus::TypeStore::ConnectTypes(m_result.m_compositeTypes, index);
@@ -1415,6 +1431,10 @@ public:
 
         m_currentByteCode.clear();
         m_currentFunction->m_catchInfo.clear();
+#ifdef ENABLE_GC
+        m_currentFunction->m_stackMaps.clear();
+        m_currentFunction->m_stackMapSlots.clear();
+#endif
         m_blockInfo.clear();
         m_catchInfo.clear();
 
@@ -1536,6 +1556,49 @@ public:
         return result;
     }
 
+#ifdef ENABLE_GC
+    // Records the stack slots which may hold references when the next byte code
+    // (a call or an allocation) is executed. Sites without such slots have no entry.
+    void recordStackMap()
+    {
+        if (m_preprocessData.m_inPreprocess || !m_shouldContinueToGenerateByteCode) {
+            return;
+        }
+
+        auto& stackMaps = m_currentFunction->m_stackMaps;
+        auto& slots = m_currentFunction->m_stackMapSlots;
+        uint32_t byteCodeOffset = static_cast<uint32_t>(m_currentByteCode.size());
+        size_t slotStart = slots.size();
+
+        if (stackMaps.size() > 0 && stackMaps.back().m_byteCodeOffset == byteCodeOffset) {
+            return;
+        }
+
+        for (size_t i = 0; i < m_localInfo.size(); i++) {
+            if (Walrus::Value::isRefType(m_localInfo[i].m_valueType)) {
+                slots.pushBack(static_cast<Walrus::ByteCodeStackOffset>(m_localInfo[i].m_position));
+            }
+        }
+
+        for (size_t i = 0; i < m_vmStack.size(); i++) {
+            const VMStackInfo& info = m_vmStack[i];
+
+            // Values read directly from locals are already recorded.
+            if (Walrus::Value::isRefType(info.valueType())
+                && (!info.hasValidLocalIndex() || info.position() != m_localInfo[info.localIndex()].m_position)) {
+                slots.pushBack(static_cast<Walrus::ByteCodeStackOffset>(info.position()));
+            }
+        }
+
+        if (slots.size() > slotStart) {
+            Walrus::ModuleFunction::StackMap stackMap;
+            stackMap.m_byteCodeOffset = byteCodeOffset;
+            stackMap.m_slotStart = static_cast<uint32_t>(slotStart);
+            stackMaps.pushBack(stackMap);
+        }
+    }
+#endif
+
     template <typename CodeType>
     void generateCallExpr(CodeType* code, uint16_t parameterCount, uint16_t resultCount,
                           Walrus::FunctionType* functionType)
@@ -1571,6 +1634,9 @@ public:
 
     virtual void OnCallExpr(uint32_t index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         auto functionType = m_result.m_functions[index]->functionType();
         auto callPos = m_currentByteCode.size();
         auto parameterCount = computeFunctionParameterOrResultOffsetCount(functionType->param());
@@ -1586,6 +1652,9 @@ public:
 
     virtual void OnCallIndirectExpr(Index sigIndex, Index tableIndex) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         ASSERT(peekVMStackValueType() == Walrus::Value::I32);
         auto functionType = getFunctionType(sigIndex);
         auto callPos = m_currentByteCode.size();
@@ -1602,6 +1671,9 @@ public:
 
     virtual void OnCallRefExpr(Type sig_type) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         ASSERT(Walrus::Value::isRefType(peekVMStackValueType()));
         auto functionType = getFunctionType(sig_type.GetReferenceIndex());
         auto callPos = m_currentByteCode.size();
@@ -1623,6 +1695,9 @@ public:
             generateFunctionReturnCode();
             return;
         }
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         auto functionType = m_result.m_functions[index]->functionType();
         auto callPos = m_currentByteCode.size();
         auto parameterCount = computeFunctionParameterOrResultOffsetCount(functionType->param());
@@ -1645,6 +1720,9 @@ public:
             generateFunctionReturnCode();
             return;
         }
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         auto functionType = getFunctionType(sigIndex);
         auto callPos = m_currentByteCode.size();
         auto parameterCount = computeFunctionParameterOrResultOffsetCount(functionType->param());
@@ -1667,6 +1745,9 @@ public:
             generateFunctionReturnCode();
             return;
         }
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         auto functionType = getFunctionType(sig_type.GetReferenceIndex());
         auto callPos = m_currentByteCode.size();
         auto parameterCount = computeFunctionParameterOrResultOffsetCount(functionType->param());
@@ -3175,6 +3256,9 @@ public:
 
     virtual void OnArrayNewExpr(Index type_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::ArrayType* typeInfo = m_result.m_compositeTypes[type_index]->asArray();
         ASSERT(peekVMStackValueType() == Walrus::Value::Type::I32);
         auto src1 = popVMStack();
@@ -3185,6 +3269,9 @@ public:
 
     virtual void OnArrayNewDefaultExpr(Index type_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::ArrayType* typeInfo = m_result.m_compositeTypes[type_index]->asArray();
         ASSERT(peekVMStackValueType() == Walrus::Value::Type::I32);
         auto src = popVMStack();
@@ -3194,6 +3281,9 @@ public:
 
     virtual void OnArrayNewFixedExpr(Index type_index, Index count) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::ArrayType* typeInfo = m_result.m_compositeTypes[type_index]->asArray();
         auto pos = m_currentByteCode.size();
 
@@ -3203,7 +3293,7 @@ public:
         ASSERT(m_currentByteCode.size() % sizeof(void*) == 0);
         Walrus::ArrayNewFixed* code = peekByteCode<Walrus::ArrayNewFixed>(pos);
         for (size_t i = 0; i < count; i++) {
-            ASSERT(peekVMStackValueType() == toDebugType(typeInfo->field().stackType()));
+            ASSERT(toDebugType(peekVMStackValueType()) == toDebugType(typeInfo->field().stackType()));
             code->dataOffsets()[count - i - 1] = popVMStack();
         }
 
@@ -3212,6 +3302,9 @@ public:
 
     virtual void OnArrayNewDataExpr(Index type_index, Index data_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::ArrayType* typeInfo = m_result.m_compositeTypes[type_index]->asArray();
         ASSERT(peekVMStackValueType() == Walrus::Value::Type::I32);
         auto src1 = popVMStack();
@@ -3223,6 +3316,9 @@ public:
 
     virtual void OnArrayNewElemExpr(Index type_index, Index elem_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::ArrayType* typeInfo = m_result.m_compositeTypes[type_index]->asArray();
         ASSERT(peekVMStackValueType() == Walrus::Value::Type::I32);
         auto src1 = popVMStack();
@@ -3341,6 +3437,9 @@ public:
 
     virtual void OnStructNewExpr(Index type_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::StructType* typeInfo = m_result.m_compositeTypes[type_index]->asStruct();
         auto pos = m_currentByteCode.size();
 
@@ -3351,7 +3450,7 @@ public:
         ASSERT(m_currentByteCode.size() % sizeof(void*) == 0);
         Walrus::StructNew* code = peekByteCode<Walrus::StructNew>(pos);
         for (size_t i = 0; i < fields.size(); i++) {
-            ASSERT(peekVMStackValueType() == toDebugType(fields.types()[fields.size() - i - 1].stackType()));
+            ASSERT(toDebugType(peekVMStackValueType()) == toDebugType(fields.types()[fields.size() - i - 1].stackType()));
             code->dataOffsets()[fields.size() - i - 1] = popVMStack();
         }
 
@@ -3360,6 +3459,9 @@ public:
 
     virtual void OnStructNewDefaultExpr(Index type_index) override
     {
+#ifdef ENABLE_GC
+        recordStackMap();
+#endif
         const Walrus::StructType* typeInfo = m_result.m_compositeTypes[type_index]->asStruct();
         auto dst = computeExprResultPosition(Walrus::Value::Type::DefinedRef);
         pushByteCode(Walrus::StructNewDefault(typeInfo, dst), WASMOpcode::StructNewDefaultOpcode);
@@ -3515,6 +3617,24 @@ public:
         }
 
         m_lastI32EqzPos = s_noI32Eqz;
+#ifdef ENABLE_GC
+        m_currentFunction->m_hasStackMaps = true;
+#endif
+
+        // The optimizer cannot track values flowing into catch blocks.
+        if (m_optimizeByteCode && !m_currentFunction->m_hasTryCatch && m_currentFunction->m_catchInfo.empty()) {
+            Walrus::ByteCodeOptimizer optimizer(m_currentByteCode, m_currentFunctionType->paramStackSize(), m_currentFunction->m_requiredStackSize);
+            if (optimizer.optimize()) {
+                m_currentFunction->m_requiredStackSize = optimizer.requiredStackSize();
+#ifdef ENABLE_GC
+                // Stack slots might be reassigned, frames are scanned conservatively.
+                m_currentFunction->m_hasStackMaps = false;
+                m_currentFunction->m_stackMaps.clear();
+                m_currentFunction->m_stackMapSlots.clear();
+#endif
+            }
+        }
+
 #if !defined(NDEBUG)
         if (getenv("DUMP_BYTECODE") && strlen(getenv("DUMP_BYTECODE"))) {
             m_currentFunction->dumpByteCode(m_currentByteCode);
@@ -4001,7 +4121,7 @@ void WASMParsingResult::clear()
 
 std::pair<Optional<Module*>, std::string> WASMParser::parseBinary(Store* store, const std::string& filename, const uint8_t* data, size_t len, const uint32_t JITFlags, const uint32_t featureFlags)
 {
-    wabt::WASMBinaryReader delegate(store->getTypeStore(), JITFlags & JITFlagValue::useJIT);
+    wabt::WASMBinaryReader delegate(store->getTypeStore(), JITFlags & JITFlagValue::useJIT, JITFlags & JITFlagValue::optimizeByteCode);
 
     std::string error = ReadWasmBinary(filename, data, len, &delegate, featureFlags);
 
@@ -4019,7 +4139,8 @@ std::pair<Optional<Module*>, std::string> WASMParser::parseBinary(Store* store,
         return std::make_pair(nullptr, error);
     }
 
-    Module* module = new Module(store, delegate.parsingResult());
+    Module* module = new Module(store->engine(), delegate.parsingResult());
+    store->appendModule(module);
 #if defined(WALRUS_ENABLE_JIT)
     if (JITFlags & JITFlagValue::useJIT) {
         module->jitCompile(nullptr, 0, JITFlags);
@@ -34,311 +34,61 @@ static void throwException(ExecutionState& state, const char* message)
     Trap::throwException(state, stringMessage);
 }
 
-enum Utf8Consts : uint8_t {
-    Utf8Len2 = 0xc0,
-    Utf8Len2Mask = 0x1f,
-    Utf8Len3 = 0xe0,
-    Utf8Len3Mask = 0x0f,
-    Utf8Len4 = 0xf0,
-    Utf8Len4Mask = 0x07,
-    Utf8Cont = 0x80,
-    Utf8ContMask = 0x3f,
-    Utf8ContShift1 = 6,
-    Utf8ContShift2 = 12,
-    Utf8ContShift3 = 18,
-
-    // The F and S postfix represents a two byte sequence, where the first byte is fixed.
-    Utf8Len2Start = 0xc2,
-    Utf8Latin1End = 0xc4,
-    Utf8Len3StartF = 0xe0,
-    Utf8Len3StartS = 0xa0,
-    Utf8SurrogateStartF = 0xed,
-    Utf8SurrogateStartS = 0xa0,
-    Utf8Len4StartF = 0xf0,
-    Utf8Len4StartS = 0xc0,
-    Utf8Len4EndF = 0xf4,
-    Utf8Len4EndS = 0x8f,
-};
-
-enum Utf16Consts : uint16_t {
-    Utf16HighSurrogate = 0xd800,
-    Utf16LowSurrogate = 0xdc00,
-    Utf16SurrogateEnd = 0xdfff,
-    Utf16SurrogateMask = 0x3ff,
-    Utf16ContShift = 10,
-};
-
-enum UtfLimits : uint32_t {
-    UtfChar1Limit = 0x80,
-    UtfCharL1Limit = 0x100,
-    UtfChar2Limit = 0x800,
-    UtfChar3Limit = 0x10000,
-    UtfChar4Limit = 0x110000,
-};
-
 bool CanonOptions::UtfData::validateUtfString()
 {
     ASSERT(m_type != UtfData::Latin1);
 
     if (UNLIKELY(m_type == UtfData::Utf16)) {
-        const uint16_t* buffer = reinterpret_cast<const uint16_t*>(m_buffer);
-        const uint16_t* end = buffer + m_length;
-        uint32_t charL1 = 0;
-        uint32_t char2 = 0;
-        uint32_t char3 = 0;
-        uint32_t char4 = 0;
-
-        while (buffer < end) {
-            uint16_t chr = *buffer;
-
-            if (chr < Utf16HighSurrogate || chr > Utf16SurrogateEnd) {
-                if (chr < UtfChar2Limit) {
-                    if (chr >= UtfChar1Limit) {
-                        charL1++;
-                    }
-                } else if (chr < 0x800) {
-                    char2++;
-                } else {
-                    char3++;
-                }
-                buffer++;
-            } else {
-                if (chr >= Utf16LowSurrogate
-                    || buffer >= end
-                    || buffer[1] < Utf16LowSurrogate
-                    || buffer[1] > Utf16SurrogateEnd) {
-                    return false;
-                }
-
-                char4++;
-                buffer += 2;
-            }
-        }
-
-        m_charL1 = charL1;
-        m_char2 = char2;
-        m_char3 = char3;
-        m_char4 = char4;
-        return true;
+        return Unicode::kernels().validateUtf16(reinterpret_cast<const uint16_t*>(m_buffer), m_length, &m_counts);
     }
-
-    const uint8_t* buffer = m_buffer;
-    const uint8_t* end = buffer + m_length;
-    uint32_t charL1 = 0;
-    uint32_t char2 = 0;
-    uint32_t char3 = 0;
-    uint32_t char4 = 0;
-
-    while (buffer < end) {
-        uint8_t chr = *buffer;
-        if (chr <= Utf8Cont) {
-            buffer++;
-        } else if (chr < Utf8Len3) {
-            if (chr < Utf8Len2 // Continuation byte.
-                || end - buffer < 2
-                || (buffer[1] & ~Utf8ContMask) != Utf8Cont
-                || chr < Utf8Len2Start) {
-                return false;
-            }
-
-            if (chr < Utf8Latin1End) {
-                charL1++;
-            } else {
-                char2++;
-            }
-            buffer += 2;
-        } else if (chr < Utf8Len4) {
-            if (end - buffer < 3
-                || (buffer[1] & ~Utf8ContMask) != Utf8Cont
-                || (buffer[2] & ~Utf8ContMask) != Utf8Cont
-                || (chr == Utf8Len3StartF && buffer[1] < Utf8Len3StartS)
-                || (chr == Utf8SurrogateStartF && buffer[1] >= Utf8SurrogateStartS)) {
-                return false;
-            }
-
-            buffer += 3;
-            char3++;
-        } else {
-            if (chr > Utf8Len4EndF
-                || end - buffer < 4
-                || (buffer[1] & ~Utf8ContMask) != Utf8Cont
-                || (buffer[2] & ~Utf8ContMask) != Utf8Cont
-                || (buffer[3] & ~Utf8ContMask) != Utf8Cont
-                || (chr == Utf8Len4StartF && buffer[1] < Utf8Len4StartS)
-                || (chr == Utf8Len4EndF && buffer[1] > Utf8Len4EndS)) {
-                return false;
-            }
-
-            buffer += 4;
-            char4++;
-        }
-    }
-
-    m_charL1 = charL1;
-    m_char2 = char2;
-    m_char3 = char3;
-    m_char4 = char4;
-    return true;
+    return Unicode::kernels().validateUtf8(m_buffer, m_length, &m_counts);
 }
 
 void CanonOptions::UtfData::utf8ComputeL1()
 {
     ASSERT(m_type == UtfData::Latin1);
-    if (m_char2 == 1) {
+    if (m_hasLatin1Counts) {
         return;
     }
 
-    const uint8_t* buffer = m_buffer;
-    const uint8_t* end = buffer + m_length;
-    uint32_t charL1 = 0;
-
-    while (buffer < end) {
-        if (*buffer++ >= UtfChar1Limit) {
-            charL1++;
-        }
-    }
-    m_charL1 = charL1;
-    m_char2 = 1;
+    m_counts.charL1 = static_cast<uint32_t>(Unicode::kernels().countLatin1NonAscii(m_buffer, m_length));
+    m_hasLatin1Counts = true;
 }
 
 void CanonOptions::UtfData::toUtf8String(uint8_t* dstBuffer)
 {
-#if !defined(NDEBUG)
-    uint8_t* start = dstBuffer;
-#endif
     ASSERT(m_type != UtfData::Utf8);
 
     if (m_type == UtfData::Latin1) {
-        const uint8_t* buffer = m_buffer;
-        const uint8_t* end = buffer + m_length;
-
-        while (buffer < end) {
-            uint8_t chr = *buffer++;
-            if (chr < Utf8Cont) {
-                *dstBuffer++ = chr;
-            } else {
-                dstBuffer[0] = static_cast<uint8_t>(Utf8Len2 | (chr >> Utf8ContShift1));
-                dstBuffer[1] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
-                dstBuffer += 2;
-            }
-        }
-        ASSERT(static_cast<size_t>(dstBuffer - start) == utf8Length());
-        return;
-    }
-
-    const uint16_t* buffer = reinterpret_cast<const uint16_t*>(m_buffer);
-    const uint16_t* end = buffer + m_length;
-
-    while (buffer < end) {
-        uint16_t chr = *buffer;
-
-        if (chr < Utf16HighSurrogate || chr > Utf16SurrogateEnd) {
-            if (chr < UtfChar1Limit) {
-                *dstBuffer++ = static_cast<uint8_t>(chr);
-            } else if (chr < UtfChar2Limit) {
-                dstBuffer[0] = static_cast<uint8_t>(Utf8Len2 | (chr >> Utf8ContShift1));
-                dstBuffer[1] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
-                dstBuffer += 2;
-            } else {
-                dstBuffer[0] = static_cast<uint8_t>(Utf8Len3 | (chr >> Utf8ContShift2));
-                dstBuffer[1] = static_cast<uint8_t>(Utf8Cont | ((chr >> Utf8ContShift1) & Utf8ContMask));
-                dstBuffer[2] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
-                dstBuffer += 3;
-            }
-            buffer++;
-        } else {
-            uint32_t chr32 = (static_cast<uint32_t>(chr & Utf16SurrogateMask) << Utf16ContShift) + static_cast<uint32_t>(buffer[1] & Utf16SurrogateMask) + UtfChar3Limit;
-            dstBuffer[0] = static_cast<uint8_t>(Utf8Len4 | (chr >> Utf8ContShift3));
-            dstBuffer[1] = static_cast<uint8_t>(Utf8Cont | ((chr >> Utf8ContShift2) & Utf8ContMask));
-            dstBuffer[2] = static_cast<uint8_t>(Utf8Cont | ((chr >> Utf8ContShift1) & Utf8ContMask));
-            dstBuffer[3] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
-            dstBuffer += 4;
-            buffer += 2;
-        }
+        Unicode::kernels().latin1ToUtf8(m_buffer, m_length, dstBuffer);
+    } else {
+        Unicode::kernels().utf16ToUtf8(reinterpret_cast<const uint16_t*>(m_buffer), m_length, dstBuffer);
     }
-    ASSERT(static_cast<size_t>(dstBuffer - start) == utf8Length());
 }
 
 void CanonOptions::UtfData::toUtf16String(uint16_t* dstBuffer)
 {
-#if !defined(NDEBUG)
-    uint16_t* start = dstBuffer;
-#endif
-    const uint8_t* buffer = m_buffer;
-    const uint8_t* end = buffer + m_length;
     ASSERT(m_type != UtfData::Utf16);
 
-    if (m_type == UtfData::Latin1) {
-        while (buffer < end) {
-            *dstBuffer++ = *buffer++;
-        }
-        ASSERT(static_cast<size_t>(dstBuffer - start) == utf8Length());
-        return;
-    }
-
-    while (buffer < end) {
-        uint16_t chr;
-        uint8_t byte = *buffer;
-
-        if (byte < UtfChar1Limit) {
-            chr = byte;
-            buffer++;
-        } else if (byte < Utf8Len2) {
-            chr = static_cast<uint16_t>((byte & Utf8Len2Mask) << Utf8ContShift1);
-            chr |= static_cast<uint16_t>(buffer[1] & Utf8ContMask);
-            buffer += 2;
-        } else if (byte < Utf8Len3) {
-            chr = static_cast<uint16_t>((byte & Utf8Len3Mask) << Utf8ContShift2);
-            chr |= static_cast<uint16_t>((buffer[1] & Utf8ContMask) << Utf8ContShift1);
-            chr |= static_cast<uint16_t>(buffer[2] & Utf8ContMask);
-            buffer += 3;
-        } else {
-            uint32_t chr32 = static_cast<uint32_t>((byte & Utf8Len4Mask) << Utf8ContShift3);
-            chr32 |= static_cast<uint32_t>((buffer[1] & Utf8ContMask) << Utf8ContShift2);
-            chr32 |= static_cast<uint32_t>((buffer[2] & Utf8ContMask) << Utf8ContShift1);
-            chr32 |= static_cast<uint32_t>(buffer[3] & Utf8ContMask);
-            chr = static_cast<uint16_t>(Utf16LowSurrogate | (chr32 & Utf16SurrogateMask));
-            *dstBuffer++ = static_cast<uint16_t>(Utf16HighSurrogate | (chr32 >> Utf16ContShift));
-        }
-
-        *dstBuffer++ = chr;
+    // ASCII is a subset of Latin1, and the Latin1 kernel is vectorized.
+    if (m_type == UtfData::Latin1 || (m_counts.charL1 == 0 && isLatin1())) {
+        Unicode::kernels().latin1ToUtf16(m_buffer, m_length, dstBuffer);
+    } else {
+        Unicode::kernels().utf8ToUtf16(m_buffer, m_length, dstBuffer);
     }
 }
 
 void CanonOptions::UtfData::toLatin1String(uint8_t* dstBuffer)
 {
-#if !defined(NDEBUG)
-    uint8_t* start = dstBuffer;
-#endif
-    const uint8_t* buffer = m_buffer;
     ASSERT(m_type != UtfData::Latin1);
 
     if (m_type == UtfData::Utf16) {
-        const uint8_t* end = buffer + (m_length << 1);
-
-        while (buffer < end) {
-            *dstBuffer++ = *buffer;
-            buffer += 2;
-        }
-        ASSERT(static_cast<size_t>(dstBuffer - start) == latin1Length());
-        return;
-    }
-
-    const uint8_t* end = buffer + m_length;
-
-    while (buffer < end) {
-        uint8_t chr;
-        uint8_t byte = *buffer;
-        if (byte < UtfChar1Limit) {
-            chr = byte;
-            buffer++;
-        } else {
-            chr = static_cast<uint8_t>((byte << Utf8ContShift1) | (buffer[1] & Utf8ContMask));
-            buffer += 2;
-        }
-        *dstBuffer++ = chr;
+        Unicode::kernels().utf16ToLatin1(reinterpret_cast<const uint16_t*>(m_buffer), m_length, dstBuffer);
+    } else if (m_counts.charL1 == 0) {
+        memcpy(dstBuffer, m_buffer, m_length);
+    } else {
+        Unicode::kernels().utf8ToLatin1(m_buffer, m_length, dstBuffer);
     }
-    ASSERT(static_cast<size_t>(dstBuffer - start) == latin1Length());
 }
 
 void CanonOptions::memoryCheckRange32(ExecutionState& state, uint32_t align, uint32_t start, uint32_t size)
@@ -365,21 +115,21 @@ void CanonOptions::memoryCheckRange64(ExecutionState& state, uint64_t align, uin
     throwException(state, align != 0 ? "incorrectly aligned memory area" : "out of bounds memory area");
 }
 
-uint32_t CanonOptions::memoryMalloc32(ExecutionState& state, uint32_t align, uint32_t size)
+uint32_t CanonOptions::memoryRealloc32(ExecutionState& state, uint32_t start, uint32_t oldSize, uint32_t align, uint32_t newSize)
 {
     ASSERT(!memory()->is64() && realloc() != nullptr && align <= 8 && (align & (align - 1)) == 0);
 
     Value argv[4];
     Value result;
-    argv[0] = Value(static_cast<int32_t>(0));
-    argv[1] = Value(static_cast<int32_t>(0));
+    argv[0] = Value(static_cast<int32_t>(start));
+    argv[1] = Value(static_cast<int32_t>(oldSize));
     argv[2] = Value(static_cast<int32_t>(align));
-    argv[3] = Value(static_cast<int32_t>(size));
+    argv[3] = Value(static_cast<int32_t>(newSize));
 
     // Should trap on an error (unreachable).
     realloc()->call(state, argv, &result);
-    uint32_t start = static_cast<uint32_t>(result.asI32());
-    memoryCheckRange32(state, align, start, size);
+    start = static_cast<uint32_t>(result.asI32());
+    memoryCheckRange32(state, align, start, newSize);
     return start;
 }
 
@@ -527,6 +277,9 @@ uint64_t CanonOptions::storeString(ExecutionState& state, UtfData& utfData, uint
 
     if (copy) {
         *length = utfData.length();
+        if (encoding() == ComponentCanonOptions::Latin1Utf16 && utfData.type() == UtfData::Utf16) {
+            *length |= Utf16Tag32;
+        }
         memcpy(ptr, utfData.buffer(), byteLength);
         return start;
     }
@@ -561,16 +314,11 @@ uint64_t CanonOptions::storeLatin1String(ExecutionState& state, const uint8_t* s
     uint32_t codeUnitLength = *length;
     uint32_t byteLength = codeUnitLength;
     uint32_t align = 2;
-    const uint8_t* end = src + codeUnitLength;
 
     switch (encoding()) {
     case ComponentCanonOptions::Utf8:
         align = 1;
-        for (const uint8_t* ptr = src; ptr < end; ptr++) {
-            if (*ptr >= UtfChar1Limit) {
-                byteLength++;
-            }
-        }
+        byteLength += static_cast<uint32_t>(Unicode::kernels().countLatin1NonAscii(src, codeUnitLength));
         *length = byteLength;
         break;
     case ComponentCanonOptions::Utf16:
@@ -601,24 +349,10 @@ uint64_t CanonOptions::storeLatin1String(ExecutionState& state, const uint8_t* s
         if (byteLength == codeUnitLength) {
             break;
         }
-
-        while (src < end) {
-            if (*src < UtfChar1Limit) {
-                *ptr++ = *src;
-            } else {
-                ptr[0] = static_cast<uint8_t>(Utf8Len2 | (*src >> Utf8ContShift1));
-                ptr[1] = static_cast<uint8_t>(Utf8Cont | (*src & Utf8ContMask));
-                ptr += 2;
-            }
-            src++;
-        }
+        Unicode::kernels().latin1ToUtf8(src, codeUnitLength, ptr);
         return start;
     case ComponentCanonOptions::Utf16:
-        while (src < end) {
-            ptr[0] = *src++;
-            ptr[1] = 0;
-            ptr += 2;
-        }
+        Unicode::kernels().latin1ToUtf16(src, codeUnitLength, reinterpret_cast<uint16_t*>(ptr));
         return start;
     default:
         ASSERT(byteLength == codeUnitLength);
@@ -628,13 +362,622 @@ uint64_t CanonOptions::storeLatin1String(ExecutionState& state, const uint8_t* s
     return start;
 }
 
+ComponentAdapter::~ComponentAdapter()
+{
+    for (auto it : m_layouts) {
+        delete it;
+    }
+}
+
+ComponentAdapter* ComponentAdapter::create(CanonOptions* callerOptions, LiftedCoreFunction* callee)
+{
+    CanonOptions* calleeOptions = callee->options();
+    ComponentTypeFunc* funcType = callee->funcType();
+
+    if (funcType->kind() != ComponentRefCounted::FuncKind || callerOptions->isAsync() || calleeOptions->isAsync()) {
+        return nullptr;
+    }
+
+    ComponentAdapter* adapter = new ComponentAdapter(callerOptions, callee);
+    bool hasMemory = callerOptions->memory() != nullptr && calleeOptions->memory() != nullptr;
+
+    if (hasMemory) {
+        if (callerOptions->memory()->is64() != calleeOptions->memory()->is64()) {
+            delete adapter;
+            return nullptr;
+        }
+        adapter->m_is64 = callerOptions->memory()->is64();
+    }
+
+    bool success = true;
+    for (auto& param : funcType->params()) {
+        if (!adapter->appendFlat(param.type, adapter->m_flatParamCount, &adapter->m_paramTransfers)) {
+            success = false;
+            break;
+        }
+    }
+
+    if (success && funcType->result().type() != ComponentTypeRef::TypeNone) {
+        TransferList resultTransfers;
+        success = adapter->appendFlat(funcType->result(), adapter->m_flatResultCount, &resultTransfers);
+    }
+
+    if (success && adapter->m_flatParamCount > MaxFlatParams) {
+        adapter->m_paramLayout = adapter->createTupleLayout(funcType->params());
+        success = adapter->m_paramLayout != nullptr;
+    }
+
+    if (success && adapter->m_flatResultCount > MaxFlatResults) {
+        adapter->m_resultLayout = adapter->createLayout(funcType->result());
+        success = adapter->m_resultLayout != nullptr;
+    }
+
+    if (success && !hasMemory) {
+        success = adapter->m_paramTransfers.empty() && adapter->m_paramLayout == nullptr && adapter->m_resultLayout == nullptr;
+    }
+
+    if (!success) {
+        delete adapter;
+        return nullptr;
+    }
+    return adapter;
+}
+
+static ComponentTypeRef::Type resolveValueType(const ComponentTypeRef& type)
+{
+    if (type.type() == ComponentTypeRef::TypeIndex && type.ref()->isValueType()) {
+        return type.ref()->asValueType()->type();
+    }
+    return type.type();
+}
+
+static void collectCaseTypes(ComponentRefCounted* target, std::vector<const ComponentTypeRef*>& cases)
+{
+    switch (target->kind()) {
+    case ComponentRefCounted::VariantKind:
+        for (auto& item : target->asTypeItems()->items()) {
+            cases.push_back(&item.type);
+        }
+        break;
+    case ComponentRefCounted::OptionKind:
+        cases.push_back(&target->asValueTypeRef()->type());
+        break;
+    default:
+        ASSERT(target->kind() == ComponentRefCounted::ResultKind);
+        cases.push_back(&target->asTypeResult()->result());
+        cases.push_back(&target->asTypeResult()->error());
+        break;
+    }
+}
+
+bool ComponentAdapter::appendFlat(const ComponentTypeRef& type, uint32_t& index, TransferList* transfers)
+{
+    switch (resolveValueType(type)) {
+    case ComponentTypeRef::String:
+        if (transfers == nullptr) {
+            return false;
+        }
+        transfers->push_back(Transfer{ Transfer::String, index, nullptr });
+        index += 2;
+        return true;
+    case ComponentTypeRef::ErrorContext:
+        // Handles are not transferred between instances.
+        return false;
+    case ComponentTypeRef::TypeIndex:
+        break;
+    default:
+        index++;
+        return true;
+    }
+
+    ComponentRefCounted* target = type.ref();
+
+    switch (target->kind()) {
+    case ComponentRefCounted::RecordKind:
+        for (auto& item : target->asTypeItems()->items()) {
+            if (!appendFlat(item.type, index, transfers)) {
+                return false;
+            }
+        }
+        return true;
+    case ComponentRefCounted::TupleKind:
+        for (auto& item : target->asTypeTuple()->items()) {
+            if (!appendFlat(item, index, transfers)) {
+                return false;
+            }
+        }
+        return true;
+    case ComponentRefCounted::ListFixedKind:
+        for (uint32_t i = target->asTypeListFixed()->size(); i > 0; i--) {
+            if (!appendFlat(target->asTypeListFixed()->type(), index, transfers)) {
+                return false;
+            }
+        }
+        return true;
+    case ComponentRefCounted::ListKind: {
+        if (transfers == nullptr) {
+            return false;
+        }
+
+        const Layout* element = createLayout(target->asValueTypeRef()->type());
+        if (element == nullptr) {
+            return false;
+        }
+        transfers->push_back(Transfer{ Transfer::List, index, element });
+        index += 2;
+        return true;
+    }
+    case ComponentRefCounted::VariantKind:
+    case ComponentRefCounted::OptionKind:
+    case ComponentRefCounted::ResultKind: {
+        std::vector<const ComponentTypeRef*> cases;
+        collectCaseTypes(target, cases);
+
+        // Payloads are copied as is, so they cannot contain strings or lists.
+        uint32_t payloadCount = 0;
+        for (auto it : cases) {
+            uint32_t count = 0;
+            if (it->type() != ComponentTypeRef::TypeNone && !appendFlat(*it, count, nullptr)) {
+                return false;
+            }
+            if (payloadCount < count) {
+                payloadCount = count;
+            }
+        }
+        index += 1 + payloadCount;
+        return true;
+    }
+    case ComponentRefCounted::EnumKind:
+        index++;
+        return true;
+    case ComponentRefCounted::FlagsKind:
+        index++;
+        return target->asTypeLabels()->labels().size() <= 32;
+    default:
+        // Resources, streams and futures.
+        return false;
+    }
+}
+
+static uint32_t alignLayoutOffset(uint64_t offset, uint32_t alignment)
+{
+    return static_cast<uint32_t>((offset + (alignment - 1)) & ~static_cast<uint64_t>(alignment - 1));
+}
+
+static uint32_t discriminantSize(size_t count)
+{
+    if (count <= 0x100) {
+        return 1;
+    }
+    return count <= 0x10000 ? 2 : 4;
+}
+
+bool ComponentAdapter::appendLayout(const ComponentTypeRef& type, uint32_t& offset, uint32_t& alignment, TransferList* transfers)
+{
+    uint32_t size;
+    uint32_t typeAlignment;
+
+    switch (resolveValueType(type)) {
+    case ComponentTypeRef::Bool:
+    case ComponentTypeRef::S8:
+    case ComponentTypeRef::U8:
+        size = 1;
+        break;
+    case ComponentTypeRef::S16:
+    case ComponentTypeRef::U16:
+        size = 2;
+        break;
+    case ComponentTypeRef::S32:
+    case ComponentTypeRef::U32:
+    case ComponentTypeRef::F32:
+    case ComponentTypeRef::Char:
+        size = 4;
+        break;
+    case ComponentTypeRef::S64:
+    case ComponentTypeRef::U64:
+    case ComponentTypeRef::F64:
+        size = 8;
+        break;
+    case ComponentTypeRef::String:
+        if (transfers == nullptr) {
+            return false;
+        }
+        typeAlignment = m_is64 ? 8 : 4;
+        offset = alignLayoutOffset(offset, typeAlignment);
+        transfers->push_back(Transfer{ Transfer::String, offset, nullptr });
+        offset += typeAlignment * 2;
+        if (alignment < typeAlignment) {
+            alignment = typeAlignment;
+        }
+        return true;
+    case ComponentTypeRef::TypeIndex:
+        size = 0;
+        break;
+    default:
+        return false;
+    }
+
+    if (size > 0) {
+        offset = alignLayoutOffset(offset, size);
+        offset += size;
+        if (alignment < size) {
+            alignment = size;
+        }
+        return true;
+    }
+
+    ComponentRefCounted* target = type.ref();
+    uint64_t start = 0;
+    uint64_t end = 0;
+    typeAlignment = 1;
+    TransferList itemTransfers;
+    TransferList* targetTransfers = transfers != nullptr ? &itemTransfers : nullptr;
+
+    switch (target->kind()) {
+    case ComponentRefCounted::RecordKind:
+    case ComponentRefCounted::TupleKind:
+    case ComponentRefCounted::ListFixedKind: {
+        // Items are laid out relative to the start of the record.
+        uint32_t itemOffset = 0;
+        if (target->kind() == ComponentRefCounted::RecordKind) {
+            for (auto& item : target->asTypeItems()->items()) {
+                if (!appendLayout(item.type, itemOffset, typeAlignment, targetTransfers)) {
+                    return false;
+                }
+            }
+        } else if (target->kind() == ComponentRefCounted::TupleKind) {
+            for (auto& item : target->asTypeTuple()->items()) {
+                if (!appendLayout(item, itemOffset, typeAlignment, targetTransfers)) {
+                    return false;
+                }
+            }
+        } else {
+            for (uint32_t i = target->asTypeListFixed()->size(); i > 0; i--) {
+                if (!appendLayout(target->asTypeListFixed()->type(), itemOffset, typeAlignment, targetTransfers)) {
+                    return false;
+                }
+                if (itemOffset > std::numeric_limits<uint32_t>::max() / 2) {
+                    return false;
+                }
+            }
+        }
+        end = itemOffset;
+        break;
+    }
+    case ComponentRefCounted::ListKind: {
+        if (transfers == nullptr) {
+            return false;
+        }
+
+        const Layout* element = createLayout(target->asValueTypeRef()->type());
+        if (element == nullptr) {
+            return false;
+        }
+        typeAlignment = m_is64 ? 8 : 4;
+        itemTransfers.push_back(Transfer{ Transfer::List, 0, element });
+        end = typeAlignment * 2;
+        break;
+    }
+    case ComponentRefCounted::VariantKind:
+    case ComponentRefCounted::OptionKind:
+    case ComponentRefCounted::ResultKind: {
+        std::vector<const ComponentTypeRef*> cases;
+        collectCaseTypes(target, cases);
+
+        uint32_t payloadSize = 0;
+        for (auto it : cases) {
+            uint32_t caseSize = 0;
+            if (it->type() != ComponentTypeRef::TypeNone && !appendLayout(*it, caseSize, typeAlignment, nullptr)) {
+                return false;
+            }
+            if (payloadSize < caseSize) {
+                payloadSize = caseSize;
+            }
+        }
+
+        uint32_t discriminant = discriminantSize(cases.size());
+        if (typeAlignment < discriminant) {
+            typeAlignment = discriminant;
+        }
+        end = static_cast<uint64_t>(alignLayoutOffset(discriminant, typeAlignment)) + payloadSize;
+        break;
+    }
+    case ComponentRefCounted::EnumKind:
+        end = typeAlignment = discriminantSize(target->asTypeLabels()->labels().size());
+        break;
+    case ComponentRefCounted::FlagsKind: {
+        size_t count = target->asTypeLabels()->labels().size();
+        if (count > 32) {
+            return false;
+        }
+        if (count > 0) {
+            end = typeAlignment = count <= 8 ? 1 : (count <= 16 ? 2 : 4);
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+
+    start = alignLayoutOffset(offset, typeAlignment);
+    end = start + alignLayoutOffset(end, typeAlignment);
+    if (end > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    for (auto& it : itemTransfers) {
+        it.offset += static_cast<uint32_t>(start);
+        transfers->push_back(it);
+    }
+
+    offset = static_cast<uint32_t>(end);
+    if (alignment < typeAlignment) {
+        alignment = typeAlignment;
+    }
+    return true;
+}
+
+const ComponentAdapter::Layout* ComponentAdapter::createLayout(const ComponentTypeRef& type)
+{
+    Layout* layout = new Layout();
+    m_layouts.push_back(layout);
+
+    layout->size = 0;
+    layout->alignment = 1;
+    if (!appendLayout(type, layout->size, layout->alignment, &layout->transfers)) {
+        return nullptr;
+    }
+    return layout;
+}
+
+const ComponentAdapter::Layout* ComponentAdapter::createTupleLayout(std::vector<ComponentTypeFunc::Param>& params)
+{
+    Layout* layout = new Layout();
+    m_layouts.push_back(layout);
+
+    layout->size = 0;
+    layout->alignment = 1;
+    for (auto& param : params) {
+        if (!appendLayout(param.type, layout->size, layout->alignment, &layout->transfers)) {
+            return nullptr;
+        }
+    }
+
+    uint64_t size = alignLayoutOffset(layout->size, layout->alignment);
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        return nullptr;
+    }
+    layout->size = static_cast<uint32_t>(size);
+    return layout;
+}
+
+uint64_t ComponentAdapter::pointerValue(const Value& value) const
+{
+    if (m_is64) {
+        return static_cast<uint64_t>(value.asI64());
+    }
+    return static_cast<uint32_t>(value.asI32());
+}
+
+Value ComponentAdapter::toPointerValue(uint64_t value) const
+{
+    if (m_is64) {
+        return Value(static_cast<int64_t>(value));
+    }
+    return Value(static_cast<int32_t>(value));
+}
+
+static void checkRange(ExecutionState& state, CanonOptions* options, uint32_t alignment, uint64_t start, uint64_t size)
+{
+    if (options->memory()->is64()) {
+        options->memoryCheckRange64(state, alignment, start, size);
+    } else {
+        options->memoryCheckRange32(state, alignment, static_cast<uint32_t>(start), static_cast<uint32_t>(size));
+    }
+}
+
+uint64_t ComponentAdapter::allocate(ExecutionState& state, CanonOptions* options, uint32_t alignment, uint64_t size)
+{
+    if (options->realloc() == nullptr) {
+        throwException(state, "realloc is not defined");
+    }
+
+    if (m_is64) {
+        return options->memoryMalloc64(state, alignment, size);
+    }
+    return options->memoryMalloc32(state, alignment, static_cast<uint32_t>(size));
+}
+
+uint64_t ComponentAdapter::transferString(ExecutionState& state, CanonOptions* src, CanonOptions* dst, uint64_t start, uint64_t& length)
+{
+    if (src->encoding() != dst->encoding()) {
+        CanonOptions::UtfData utfData;
+        src->validateString(state, start, length, &utfData);
+
+        uint32_t newLength;
+        uint64_t result = dst->storeString(state, utfData, &newLength);
+        length = newLength;
+        if (m_is64 && (newLength & CanonOptions::Utf16Tag32) != 0) {
+            length = (newLength ^ CanonOptions::Utf16Tag32) | CanonOptions::Utf16Tag64;
+        }
+        return result;
+    }
+
+    // Strings with the same encoding are copied without validation.
+    uint64_t tag = 0;
+    uint32_t shift = 0;
+    uint32_t alignment = 1;
+
+    switch (src->encoding()) {
+    case ComponentCanonOptions::Utf8:
+        break;
+    case ComponentCanonOptions::Utf16:
+        shift = 1;
+        alignment = 2;
+        break;
+    default:
+        ASSERT(src->encoding() == ComponentCanonOptions::Latin1Utf16);
+        tag = m_is64 ? CanonOptions::Utf16Tag64 : CanonOptions::Utf16Tag32;
+        alignment = 2;
+        if ((length & tag) != 0) {
+            shift = 1;
+        }
+        break;
+    }
+
+    uint64_t codeUnits = length & ~tag;
+    if (codeUnits > (Component::MaxStringByteLength >> shift)) {
+        throwException(state, "Input string too large");
+    }
+
+    uint64_t byteLength = codeUnits << shift;
+    checkRange(state, src, alignment, start, byteLength);
+
+    uint64_t dstStart = allocate(state, dst, alignment, byteLength);
+    memcpy(dst->memory()->buffer() + dstStart, src->memory()->buffer() + start, byteLength);
+    return dstStart;
+}
+
+uint64_t ComponentAdapter::transferList(ExecutionState& state, CanonOptions* src, CanonOptions* dst, const Layout* element, uint64_t start, uint64_t length)
+{
+    if (element->size > 0 && length > std::numeric_limits<uint32_t>::max() / element->size) {
+        throwException(state, "list too large");
+    }
+
+    uint64_t byteLength = length * element->size;
+    checkRange(state, src, element->alignment, start, byteLength);
+
+    // The elements are copied at once, and only their
+    // strings and lists are copied one by one.
+    uint64_t dstStart = allocate(state, dst, element->alignment, byteLength);
+    memcpy(dst->memory()->buffer() + dstStart, src->memory()->buffer() + start, byteLength);
+
+    if (!element->transfers.empty()) {
+        for (uint64_t i = 0; i < length; i++) {
+            uint64_t offset = i * element->size;
+            transferMemory(state, src, dst, element->transfers, start + offset, dstStart + offset);
+        }
+    }
+    return dstStart;
+}
+
+void ComponentAdapter::transferMemory(ExecutionState& state, CanonOptions* src, CanonOptions* dst, const TransferList& transfers, uint64_t srcStart, uint64_t dstStart)
+{
+    for (auto& transfer : transfers) {
+        uint8_t* srcPointer = src->memory()->buffer() + srcStart + transfer.offset;
+        uint64_t start;
+        uint64_t length;
+
+        if (m_is64) {
+            memcpy(&start, srcPointer, sizeof(uint64_t));
+            memcpy(&length, srcPointer + sizeof(uint64_t), sizeof(uint64_t));
+        } else {
+            uint32_t values[2];
+            memcpy(values, srcPointer, sizeof(values));
+            start = values[0];
+            length = values[1];
+        }
+
+        if (transfer.kind == Transfer::String) {
+            start = transferString(state, src, dst, start, length);
+        } else {
+            start = transferList(state, src, dst, transfer.element, start, length);
+        }
+
+        // The memory might be reallocated by the transfer.
+        uint8_t* dstPointer = dst->memory()->buffer() + dstStart + transfer.offset;
+        if (m_is64) {
+            memcpy(dstPointer, &start, sizeof(uint64_t));
+            memcpy(dstPointer + sizeof(uint64_t), &length, sizeof(uint64_t));
+        } else {
+            uint32_t values[2] = { static_cast<uint32_t>(start), static_cast<uint32_t>(length) };
+            memcpy(dstPointer, values, sizeof(values));
+        }
+    }
+}
+
+void ComponentAdapter::call(ExecutionState& state, Value* argv, Value* result)
+{
+    CanonOptions* calleeOptions = m_callee->options();
+    ComponentInstance* calleeInstance = calleeOptions->instance();
+    Value calleeArgv[MaxFlatParams];
+    Value calleeResult[MaxFlatResults];
+
+    if (m_paramLayout == nullptr) {
+        for (uint32_t i = 0; i < m_flatParamCount; i++) {
+            calleeArgv[i] = argv[i];
+        }
+
+        for (auto& transfer : m_paramTransfers) {
+            uint64_t start = pointerValue(argv[transfer.offset]);
+            uint64_t length = pointerValue(argv[transfer.offset + 1]);
+
+            if (transfer.kind == Transfer::String) {
+                start = transferString(state, m_callerOptions, calleeOptions, start, length);
+            } else {
+                start = transferList(state, m_callerOptions, calleeOptions, transfer.element, start, length);
+            }
+
+            calleeArgv[transfer.offset] = toPointerValue(start);
+            calleeArgv[transfer.offset + 1] = toPointerValue(length);
+        }
+    } else {
+        // Parameters are passed in memory.
+        uint64_t srcStart = pointerValue(argv[0]);
+        checkRange(state, m_callerOptions, m_paramLayout->alignment, srcStart, m_paramLayout->size);
+
+        uint64_t dstStart = allocate(state, calleeOptions, m_paramLayout->alignment, m_paramLayout->size);
+        memcpy(calleeOptions->memory()->buffer() + dstStart, m_callerOptions->memory()->buffer() + srcStart, m_paramLayout->size);
+        transferMemory(state, m_callerOptions, calleeOptions, m_paramLayout->transfers, srcStart, dstStart);
+        calleeArgv[0] = toPointerValue(dstStart);
+    }
+
+    {
+        Store::ComponentContext context(calleeInstance->store(), calleeInstance);
+        m_callee->function()->call(state, calleeArgv, calleeResult);
+    }
+
+    if (m_resultLayout == nullptr) {
+        if (m_flatResultCount > 0) {
+            result[0] = calleeResult[0];
+        }
+    } else {
+        // The address of the result is passed after the parameters.
+        uint64_t dstStart = pointerValue(argv[m_paramLayout != nullptr ? 1 : m_flatParamCount]);
+        uint64_t srcStart = pointerValue(calleeResult[0]);
+
+        checkRange(state, calleeOptions, m_resultLayout->alignment, srcStart, m_resultLayout->size);
+        checkRange(state, m_callerOptions, m_resultLayout->alignment, dstStart, m_resultLayout->size);
+        memcpy(m_callerOptions->memory()->buffer() + dstStart, calleeOptions->memory()->buffer() + srcStart, m_resultLayout->size);
+        transferMemory(state, calleeOptions, m_callerOptions, m_resultLayout->transfers, srcStart, dstStart);
+    }
+
+    if (calleeOptions->postReturn() != nullptr) {
+        Store::ComponentContext context(calleeInstance->store(), calleeInstance);
+        calleeOptions->postReturn()->call(state, calleeResult, nullptr);
+    }
+}
+
 LoweredFunction* LoweredFunction::createLoweredFunction(const FunctionType* functionType, LiftedFunction* liftedFunction, CanonOptions* options)
 {
     LoweredFunction* func = new LoweredFunction(functionType, liftedFunction, options);
+    if (liftedFunction->kind() == LiftedFunction::CoreFunctionKind) {
+        // Created once, when the function is lowered.
+        func->m_adapter = ComponentAdapter::create(options, liftedFunction->asLiftedCoreFunction());
+        func->m_ownsFunctionType = true;
+    }
     options->instance()->store()->appendExtern(func);
     return func;
 }
 
+LoweredFunction::~LoweredFunction()
+{
+    delete m_adapter;
+    if (m_ownsFunctionType) {
+        TypeStore::ReleaseRef(functionType()->subTypeList());
+    }
+}
+
 void LoweredFunction::call(ExecutionState& state, Value* argv, Value* result)
 {
 #ifdef ENABLE_WASI
@@ -644,7 +987,10 @@ void LoweredFunction::call(ExecutionState& state, Value* argv, Value* result)
     }
 #endif
 
-    ASSERT(0);
+    if (m_adapter == nullptr) {
+        throwException(state, "unsupported component function call");
+    }
+    m_adapter->call(state, argv, result);
 }
 
 CanonFunction* CanonFunction::createCanonFunction(Store* store, const FunctionType* functionType, Type type)
@@ -1220,7 +1566,7 @@ void ComponentInstance::coreInstantiate(ExecutionState& state, Component* compon
         imports.push_back(value);
     }
 
-    m_coreInstances.push_back(module->instantiate(state, imports));
+    m_coreInstances.push_back(module->instantiate(state, store(), imports));
 }
 
 void ComponentInstance::aliasExport(ComponentAliasExport* alias)
@@ -1314,7 +1660,7 @@ void ComponentInstance::aliasInline(ComponentAliasInline* alias)
 void ComponentInstance::liftFunction(std::vector<CanonOptions*>& canonOptions, ComponentCanonLift* lift)
 {
     CanonOptions* options = canonOptions[lift->options()];
-    m_funcs.push_back(new LiftedCoreFunction(m_coreFuncs[lift->coreFuncIndex()], options));
+    m_funcs.push_back(new LiftedCoreFunction(m_coreFuncs[lift->coreFuncIndex()], options, lift->funcType()));
 }
 
 void ComponentInstance::lowerFunction(std::vector<CanonOptions*>& canonOptions, ComponentCanonLower* lower)
@@ -1328,7 +1674,9 @@ void ComponentInstance::lowerFunction(std::vector<CanonOptions*>& canonOptions,
         return;
     }
 #endif /* ENABLE_WASI */
-    m_coreFuncs.push_back(LoweredFunction::createLoweredFunction(func->asLiftedCoreFunction()->function()->functionType(), func, options));
+    // The core type of the callee differs when the results are returned in memory.
+    bool is64 = options->memory() != nullptr && options->memory()->is64();
+    m_coreFuncs.push_back(LoweredFunction::createLoweredFunction(func->asLiftedCoreFunction()->funcType()->createFunctionType(m_store, is64), func, options));
 }
 
 ComponentInstance* ComponentInstance::InstantiateContext::instantiate(Component* component, ComponentInstance* parent, ComponentInstantiate* arg)
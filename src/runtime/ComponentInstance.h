@@ -19,6 +19,7 @@
 
 #include "runtime/Component.h"
 #include "runtime/Function.h"
+#include "util/Unicode.h"
 
 namespace Walrus {
 
@@ -41,11 +42,7 @@ public:
             : m_buffer(nullptr)
             , m_length(0)
             , m_type(Utf8)
-            , m_codepoint(0)
-            , m_charL1(0)
-            , m_char2(0)
-            , m_char3(0)
-            , m_char4(0)
+            , m_hasLatin1Counts(false)
         {
         }
 
@@ -74,17 +71,17 @@ public:
         bool isLatin1()
         {
             ASSERT(m_type != Latin1);
-            return m_char2 == 0 && m_char3 == 0 && m_char4 == 0;
+            return m_counts.char2 == 0 && m_counts.char3 == 0 && m_counts.char4 == 0;
         }
 
         size_t utf8Length()
         {
             ASSERT(m_type != Utf8);
             if (m_type == Latin1) {
-                ASSERT(m_char2 == 1);
-                return m_length + m_charL1;
+                utf8ComputeL1();
+                return m_length + m_counts.charL1;
             }
-            return m_length + (m_charL1 + m_char2) + ((m_char3 + m_char4) * 2);
+            return m_length + (m_counts.charL1 + m_counts.char2) + ((m_counts.char3 + m_counts.char4) * 2);
         }
 
         size_t utf16Length()
@@ -93,7 +90,7 @@ public:
             if (m_type == Latin1) {
                 return m_length;
             }
-            return m_length - (m_charL1 + m_char2) - ((m_char3 + m_char4) * 2);
+            return m_length - (m_counts.charL1 + m_counts.char2) - ((m_counts.char3 + m_counts.char4) * 2);
         }
 
         size_t latin1Length()
@@ -102,7 +99,7 @@ public:
             if (m_type == Utf16) {
                 return m_length;
             }
-            return m_length - m_charL1;
+            return m_length - m_counts.charL1;
         }
 
         bool validateUtfString();
@@ -114,14 +111,11 @@ public:
     private:
         const uint8_t* m_buffer;
         uint32_t m_length;
-        // Stats are not computed for Latin1 strings.
         Type m_type;
-        // Number of character encoded as an 1..4 byte long UTF8 sequence
-        uint32_t m_codepoint;
-        uint32_t m_charL1; // < 0x100 (Latin1 limit)
-        uint32_t m_char2; // < 0x800 (set to 1 for Latin1 strings after calling utf8ComputeL1)
-        uint32_t m_char3; // < 0x10000
-        uint32_t m_char4; // < 0x110000
+        bool m_hasLatin1Counts;
+        // Computed by validateUtfString. Only charL1 is
+        // computed for Latin1 strings by utf8ComputeL1.
+        UnicodeCounts m_counts;
     };
 
     CanonOptions(ComponentInstance* instance, ComponentCanonOptions::StringEncoding encoding, bool isAsync,
@@ -173,7 +167,12 @@ public:
 
     void memoryCheckRange32(ExecutionState& state, uint32_t align, uint32_t start, uint32_t size);
     void memoryCheckRange64(ExecutionState& state, uint64_t align, uint64_t start, uint64_t size);
-    uint32_t memoryMalloc32(ExecutionState& state, uint32_t align, uint32_t size);
+    uint32_t memoryMalloc32(ExecutionState& state, uint32_t align, uint32_t size)
+    {
+        return memoryRealloc32(state, 0, 0, align, size);
+    }
+
+    uint32_t memoryRealloc32(ExecutionState& state, uint32_t start, uint32_t oldSize, uint32_t align, uint32_t newSize);
     uint64_t memoryMalloc64(ExecutionState& state, uint64_t align, uint64_t size);
 
     void validateString(ExecutionState& state, uint64_t start, uint64_t length, UtfData* utfData);
@@ -247,10 +246,11 @@ private:
 
 class LiftedCoreFunction : public LiftedFunction {
 public:
-    LiftedCoreFunction(Function* function, CanonOptions* options)
+    LiftedCoreFunction(Function* function, CanonOptions* options, ComponentTypeFunc* funcType)
         : LiftedFunction()
         , m_function(function)
         , m_options(options)
+        , m_funcType(funcType)
     {
     }
 
@@ -269,15 +269,98 @@ public:
         return m_options;
     }
 
+    ComponentTypeFunc* funcType() const
+    {
+        return m_funcType;
+    }
+
 private:
     Function* m_function;
     CanonOptions* m_options;
+    ComponentTypeFunc* m_funcType;
+};
+
+// Calls a lifted core function of another component instance. The component
+// function type is only processed once, when the adapter is created, and the
+// adapter only keeps the locations of strings and lists, which must be copied
+// between the linear memories. Everything else is copied as is.
+class ComponentAdapter {
+public:
+    ~ComponentAdapter();
+
+    // Returns with nullptr if the function type is not supported.
+    static ComponentAdapter* create(CanonOptions* callerOptions, LiftedCoreFunction* callee);
+
+    void call(ExecutionState& state, Value* argv, Value* result);
+
+private:
+    static constexpr uint32_t MaxFlatParams = 16;
+    static constexpr uint32_t MaxFlatResults = 1;
+
+    struct Layout;
+
+    struct Transfer {
+        enum Kind : uint8_t {
+            String,
+            List,
+        };
+
+        Kind kind;
+        // Index of the flat value, or byte offset in memory.
+        uint32_t offset;
+        const Layout* element;
+    };
+
+    typedef std::vector<Transfer> TransferList;
+
+    struct Layout {
+        uint32_t size;
+        uint32_t alignment;
+        TransferList transfers;
+    };
+
+    ComponentAdapter(CanonOptions* callerOptions, LiftedCoreFunction* callee)
+        : m_callerOptions(callerOptions)
+        , m_callee(callee)
+        , m_is64(false)
+        , m_flatParamCount(0)
+        , m_flatResultCount(0)
+        , m_paramLayout(nullptr)
+        , m_resultLayout(nullptr)
+    {
+    }
+
+    bool appendFlat(const ComponentTypeRef& type, uint32_t& index, TransferList* transfers);
+    bool appendLayout(const ComponentTypeRef& type, uint32_t& offset, uint32_t& alignment, TransferList* transfers);
+    const Layout* createLayout(const ComponentTypeRef& type);
+    const Layout* createTupleLayout(std::vector<ComponentTypeFunc::Param>& params);
+
+    uint64_t pointerValue(const Value& value) const;
+    Value toPointerValue(uint64_t value) const;
+    uint64_t transferString(ExecutionState& state, CanonOptions* src, CanonOptions* dst, uint64_t start, uint64_t& length);
+    uint64_t transferList(ExecutionState& state, CanonOptions* src, CanonOptions* dst, const Layout* element, uint64_t start, uint64_t length);
+    void transferMemory(ExecutionState& state, CanonOptions* src, CanonOptions* dst, const TransferList& transfers, uint64_t srcStart, uint64_t dstStart);
+    uint64_t allocate(ExecutionState& state, CanonOptions* options, uint32_t alignment, uint64_t size);
+
+    CanonOptions* m_callerOptions;
+    LiftedCoreFunction* m_callee;
+    bool m_is64;
+    uint32_t m_flatParamCount;
+    uint32_t m_flatResultCount;
+    // Used when the values are passed as flat values.
+    TransferList m_paramTransfers;
+    // Used when the values are passed in memory.
+    const Layout* m_paramLayout;
+    const Layout* m_resultLayout;
+    std::vector<Layout*> m_layouts;
 };
 
 class LoweredFunction : public NativeFunction {
 public:
     static LoweredFunction* createLoweredFunction(const FunctionType* functionType, LiftedFunction* liftedFunction, CanonOptions* options);
 
+    virtual ~LoweredFunction();
+
     virtual Kind kind() const override
     {
         return LoweredFunctionKind;
@@ -295,11 +378,15 @@ private:
         : NativeFunction(functionType)
         , m_liftedFunction(liftedFunction)
         , m_options(options)
+        , m_adapter(nullptr)
+        , m_ownsFunctionType(false)
     {
     }
 
     LiftedFunction* m_liftedFunction;
     CanonOptions* m_options;
+    ComponentAdapter* m_adapter;
+    bool m_ownsFunctionType;
 };
 
 class CanonFunction : public NativeFunction {
@@ -354,6 +441,9 @@ public:
         ResourceWasiTerminalKind,
         ResourceWasiFileKind,
         ResourceWasiDirectoryKind,
+        ResourceWasiErrorKind,
+        ResourceWasiNetworkKind,
+        ResourceWasiTcpSocketKind,
 #endif /* ENABLE_WASI */
     };
 
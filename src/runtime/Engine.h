@@ -17,9 +17,72 @@
 #ifndef __WalrusEngine__
 #define __WalrusEngine__
 
+#include "runtime/TypeStore.h"
+
 namespace Walrus {
 
+// Settings shared by all stores of an engine, zero values keep the defaults.
+struct EngineOptions {
+    EngineOptions()
+        : jitFlags(0)
+        , featureFlags(0)
+        , memoryReservedSize(0)
+        , memoryFlags(0)
+    {
+    }
+
+    // Passed to WASMParser::parseBinary (see JITFlagValue and wabt::FeatureFlagValue).
+    uint32_t jitFlags;
+    uint32_t featureFlags;
+    // Address space reserved for a new linear memory, growing within it
+    // never copies the memory. Only used when linear memories are mapped.
+    uint64_t memoryReservedSize;
+    // See MemoryFlagValue.
+    uint32_t memoryFlags;
+};
+
+// Modules and their types belong to the engine, so a module parsed by
+// one store can be instantiated by the other stores of the same engine
+// without parsing or compiling it again (see Store::appendModule). The
+// stores share these structures without locking, so the stores of an
+// engine must be used by one thread at a time. Use separate engines
+// for stores running in parallel. The engine is reference counted,
+// the stores and the modules hold a reference to it.
 class Engine {
+public:
+    explicit Engine(const EngineOptions& options = EngineOptions())
+        : m_options(options)
+        , m_refCount(1)
+    {
+    }
+
+    void addRef()
+    {
+        m_refCount++;
+    }
+
+    void releaseRef()
+    {
+        ASSERT(m_refCount > 0);
+        if (--m_refCount == 0) {
+            delete this;
+        }
+    }
+
+    const EngineOptions& options() const
+    {
+        return m_options;
+    }
+
+    TypeStore& typeStore()
+    {
+        return m_typeStore;
+    }
+
+private:
+    EngineOptions m_options;
+    size_t m_refCount;
+    TypeStore m_typeStore;
 };
 
 } // namespace Walrus
@@ -20,7 +20,20 @@
 namespace Walrus {
 
 Exception::Exception(ExecutionState& state)
+    : m_trapCode(NoTrap)
+    , m_hasProgramCounterInfo(false)
 {
+    recordProgramCounters(state);
+}
+
+void Exception::recordProgramCounters(ExecutionState& state)
+{
+    if (m_hasProgramCounterInfo) {
+        return;
+    }
+
+    m_hasProgramCounterInfo = true;
+
     Optional<ExecutionState*> s = &state;
 
     while (s) {
@@ -30,4 +43,89 @@ Exception::Exception(ExecutionState& state)
         s = s->m_parent;
     }
 }
+
+void Exception::formatTrapMessage()
+{
+    switch (m_trapCode) {
+    case CallStackExhausted:
+        m_message = "call stack exhausted";
+        return;
+    case IntegerDivideByZero:
+        m_message = "integer divide by zero";
+        return;
+    case IntegerOverflow:
+        m_message = "integer overflow";
+        return;
+    case InvalidConversionToInteger:
+        m_message = "invalid conversion to integer";
+        return;
+    case UnreachableExecuted:
+        m_message = "unreachable executed";
+        return;
+    case OutOfBoundsMemoryAccess:
+        m_message = "out of bounds memory access";
+        return;
+    case OutOfBoundsMemoryAccessAt:
+        m_message = "out of bounds memory access: access at ";
+        m_message += std::to_string(m_trapDetail[0]);
+        m_message += "+";
+        m_message += std::to_string(m_trapDetail[1]);
+        return;
+    case OutOfBoundsTableAccess:
+        m_message = "out of bounds table access";
+        return;
+    case OutOfBoundsArrayAccess:
+        m_message = "out of bounds array access";
+        return;
+    case UndefinedElement:
+        m_message = "undefined element";
+        return;
+    case UninitializedElement:
+        m_message = "uninitialized element";
+        return;
+    case UninitializedElementAt:
+        m_message = "uninitialized element " + std::to_string(m_trapDetail[0]);
+        return;
+    case IndirectCallTypeMismatch:
+        m_message = "indirect call type mismatch";
+        return;
+    case CallByReferenceTypeMismatch:
+        m_message = "call by reference type mismatch";
+        return;
+    case TypeMismatch:
+        m_message = "type mismatch";
+        return;
+    case NullReference:
+        m_message = "null reference";
+        return;
+    case NullFunctionReference:
+        m_message = "null function reference";
+        return;
+    case NullI31Reference:
+        m_message = "null i31 reference";
+        return;
+    case NullArrayReference:
+        m_message = "null array reference";
+        return;
+    case NullStructureReference:
+        m_message = "null structure reference";
+        return;
+    case CastFailure:
+        m_message = "cast failure";
+        return;
+    case MemoryAllocationFailed:
+        m_message = "memory allocation failed";
+        return;
+    case UnalignedAtomic:
+        m_message = "unaligned atomic";
+        return;
+    case ExpectedSharedMemory:
+        m_message = "expected shared memory";
+        return;
+    default:
+        m_message = "unknown exception";
+        return;
+    }
+}
+
 } // namespace Walrus
@@ -26,6 +26,39 @@ class Tag;
 
 class Exception {
 public:
+    // Traps are stored as a code, and their message
+    // is only formatted when it is requested.
+    enum TrapCode : uint8_t {
+        NoTrap,
+        CallStackExhausted,
+        IntegerDivideByZero,
+        IntegerOverflow,
+        InvalidConversionToInteger,
+        UnreachableExecuted,
+        OutOfBoundsMemoryAccess,
+        // Detail: access offset and size.
+        OutOfBoundsMemoryAccessAt,
+        OutOfBoundsTableAccess,
+        OutOfBoundsArrayAccess,
+        UndefinedElement,
+        UninitializedElement,
+        // Detail: element index.
+        UninitializedElementAt,
+        IndirectCallTypeMismatch,
+        CallByReferenceTypeMismatch,
+        TypeMismatch,
+        NullReference,
+        NullFunctionReference,
+        NullI31Reference,
+        NullArrayReference,
+        NullStructureReference,
+        CastFailure,
+        MemoryAllocationFailed,
+        UnalignedAtomic,
+        ExpectedSharedMemory,
+        UnknownException,
+    };
+
     static std::unique_ptr<Exception> create(const std::string& m)
     {
         return std::unique_ptr<Exception>(new Exception(m));
@@ -41,9 +74,26 @@ public:
         return std::unique_ptr<Exception>(new Exception(state, tag, std::move(userExceptionData)));
     }
 
+    // The program counters are recorded later by recordProgramCounters().
+    static std::unique_ptr<Exception> create(Tag* tag, Vector<uint8_t>&& userExceptionData)
+    {
+        return std::unique_ptr<Exception>(new Exception(tag, std::move(userExceptionData)));
+    }
+
+    // Traps cannot be caught by wasm code, so program counters are not recorded.
+    static std::unique_ptr<Exception> create(TrapCode trapCode, uint64_t detail1 = 0, uint64_t detail2 = 0)
+    {
+        return std::unique_ptr<Exception>(new Exception(trapCode, detail1, detail2));
+    }
+
     bool isBuiltinException()
     {
-        return !m_message.empty();
+        return m_trapCode != NoTrap || !m_message.empty();
+    }
+
+    TrapCode trapCode() const
+    {
+        return m_trapCode;
     }
 
     bool isUserException()
@@ -53,6 +103,9 @@ public:
 
     std::string& message()
     {
+        if (m_trapCode != NoTrap && m_message.empty()) {
+            formatTrapMessage();
+        }
         return m_message;
     }
 
@@ -66,13 +119,35 @@ public:
         return m_userExceptionData;
     }
 
+    // Records the program counters of the interpreter frames, if they
+    // are not recorded yet. The frames must be alive at this point.
+    void recordProgramCounters(ExecutionState& state);
+
 private:
     friend class Interpreter;
     Exception(const std::string& message)
         : m_message(message)
+        , m_trapCode(NoTrap)
+        , m_hasProgramCounterInfo(false)
+    {
+    }
+
+    Exception(Tag* tag, Vector<uint8_t>&& userExceptionData)
+        : m_tag(tag)
+        , m_userExceptionData(std::move(userExceptionData))
+        , m_trapCode(NoTrap)
+        , m_hasProgramCounterInfo(false)
     {
     }
 
+    Exception(TrapCode trapCode, uint64_t detail1, uint64_t detail2)
+        : m_trapCode(trapCode)
+        , m_hasProgramCounterInfo(true)
+    {
+        m_trapDetail[0] = detail1;
+        m_trapDetail[1] = detail2;
+    }
+
     Exception(ExecutionState& state);
     Exception(ExecutionState& state, const std::string& message)
         : Exception(state)
@@ -87,10 +162,15 @@ private:
         m_userExceptionData = std::move(userExceptionData);
     }
 
+    void formatTrapMessage();
+
     std::string m_message;
     Optional<Tag*> m_tag;
     Vector<uint8_t> m_userExceptionData;
     Vector<std::pair<ExecutionState*, size_t>> m_programCounterInfo;
+    TrapCode m_trapCode;
+    bool m_hasProgramCounterInfo;
+    uint64_t m_trapDetail[2];
 };
 
 } // namespace Walrus
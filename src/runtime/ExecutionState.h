@@ -30,10 +30,26 @@ public:
     friend class Trap;
     friend class Interpreter;
 
+    // Traps of wasm code are not thrown. They are stored in the trap
+    // status of the call chain, which is provided by Trap::run().
+    struct TrapStatus {
+        TrapStatus()
+            : trapCode(0)
+        {
+            detail[0] = 0;
+            detail[1] = 0;
+        }
+
+        // Exception::TrapCode
+        uint8_t trapCode;
+        uint64_t detail[2];
+    };
+
     ExecutionState(ExecutionState& parent)
         : m_parent(&parent)
         , m_currentFunction(nullptr)
         , m_stackLimit(parent.m_stackLimit)
+        , m_trapStatus(parent.m_trapStatus)
     {
     }
 
@@ -41,6 +57,7 @@ public:
         : m_parent(&parent)
         , m_currentFunction(currentFunction)
         , m_stackLimit(parent.m_stackLimit)
+        , m_trapStatus(parent.m_trapStatus)
     {
     }
 
@@ -54,11 +71,26 @@ public:
         return m_stackLimit;
     }
 
+    // Stores a trap, which is returned to the callers as a status.
+    void setTrap(uint8_t trapCode, uint64_t detail1 = 0, uint64_t detail2 = 0)
+    {
+        ASSERT(m_trapStatus != nullptr && trapCode != 0);
+        m_trapStatus->trapCode = trapCode;
+        m_trapStatus->detail[0] = detail1;
+        m_trapStatus->detail[1] = detail2;
+    }
+
+    bool hasTrap() const
+    {
+        return m_trapStatus != nullptr && m_trapStatus->trapCode != 0;
+    }
+
 private:
     friend class ByteCodeTable;
-    ExecutionState()
+    ExecutionState(TrapStatus* trapStatus = nullptr)
         : m_parent(nullptr)
         , m_currentFunction(nullptr)
+        , m_trapStatus(trapStatus)
     {
         m_stackLimit = (size_t)currentStackPointer();
 
@@ -72,6 +104,7 @@ private:
     Optional<ExecutionState*> m_parent;
     Optional<Function*> m_currentFunction;
     size_t m_stackLimit;
+    TrapStatus* m_trapStatus;
     Optional<size_t*> m_programCounterPointer;
 };
 
@@ -34,6 +34,58 @@ Function::Function(const FunctionType* functionType)
 {
 }
 
+static uint64_t readSlot(Value::Type type, const uint8_t* memory)
+{
+    if (type == Value::I64 || type == Value::F64) {
+        uint64_t slot;
+        memcpy(&slot, memory, sizeof(uint64_t));
+        return slot;
+    }
+
+    ASSERT(type == Value::I32 || type == Value::F32);
+    uint32_t slot;
+    memcpy(&slot, memory, sizeof(uint32_t));
+    return slot;
+}
+
+static void writeSlot(Value::Type type, uint8_t* memory, uint64_t slot)
+{
+    if (type == Value::I64 || type == Value::F64) {
+        memcpy(memory, &slot, sizeof(uint64_t));
+        return;
+    }
+
+    ASSERT(type == Value::I32 || type == Value::F32);
+    uint32_t value = static_cast<uint32_t>(slot);
+    memcpy(memory, &value, sizeof(uint32_t));
+}
+
+bool Function::callWithSlots(ExecutionState& state, uint64_t* slots)
+{
+    const FunctionType* ft = functionType();
+    size_t valueBufferSize = std::max(ft->paramStackSize(), ft->resultStackSize());
+    ALLOCA(uint8_t, valueBuffer, valueBufferSize);
+    const TypeVector::Types& paramTypeInfo = ft->param().types();
+    const TypeVector::Types& resultTypeInfo = ft->result().types();
+
+    uint8_t* buffer = valueBuffer;
+    for (size_t i = 0; i < paramTypeInfo.size(); i++) {
+        writeSlot(paramTypeInfo[i], buffer, slots[i]);
+        buffer += valueStackAllocatedSize(paramTypeInfo[i]);
+    }
+
+    if (UNLIKELY(!interpreterCall(state, valueBuffer, ft->callOffsets(), ft->paramStackSize() / sizeof(size_t), ft->resultStackSize() / sizeof(size_t)))) {
+        return false;
+    }
+
+    buffer = valueBuffer;
+    for (size_t i = 0; i < resultTypeInfo.size(); i++) {
+        slots[i] = readSlot(resultTypeInfo[i], buffer);
+        buffer += valueStackAllocatedSize(resultTypeInfo[i]);
+    }
+    return true;
+}
+
 DefinedFunction* DefinedFunction::createDefinedFunction(Store* store,
                                                         Instance* instance,
                                                         ModuleFunction* moduleFunction)
@@ -52,56 +104,53 @@ DefinedFunction::DefinedFunction(Instance* instance,
 }
 
 void DefinedFunction::call(ExecutionState& state, Value* argv, Value* result)
+{
+    if (UNLIKELY(!tryCall(state, argv, result))) {
+        // Host code expects that traps are thrown.
+        Trap::throwTrap(state);
+    }
+}
+
+bool DefinedFunction::tryCall(ExecutionState& state, Value* argv, Value* result)
 {
     const FunctionType* ft = functionType();
     size_t valueBufferSize = std::max(ft->paramStackSize(), ft->resultStackSize());
     ALLOCA(uint8_t, valueBuffer, valueBufferSize);
     uint16_t parameterOffsetSize = ft->paramStackSize() / sizeof(size_t);
     uint16_t resultOffsetSize = ft->resultStackSize() / sizeof(size_t);
-    ALLOCA(uint16_t, offsetBuffer, (parameterOffsetSize + resultOffsetSize) * sizeof(uint16_t));
     const TypeVector::Types& paramTypeInfo = ft->param().types();
     const TypeVector::Types& resultTypeInfo = ft->result().types();
 
+    // Parameters and results are stored consecutively, so their
+    // offsets are provided by the precomputed table of the type.
     size_t argc = paramTypeInfo.size();
     uint8_t* paramBuffer = valueBuffer;
-    size_t offsetIndex = 0;
     for (size_t i = 0; i < argc; i++) {
         ASSERT(Value::isRefType(paramTypeInfo[i]) ? argv[i].isRef() : argv[i].type() == paramTypeInfo[i]);
         argv[i].writeToMemory(paramBuffer);
-        size_t stackAllocatedSize = valueStackAllocatedSize(paramTypeInfo[i]);
-        for (size_t j = 0; j < stackAllocatedSize; j += sizeof(size_t)) {
-            offsetBuffer[offsetIndex++] = reinterpret_cast<size_t>(paramBuffer) - reinterpret_cast<size_t>(valueBuffer) + j;
-        }
-        paramBuffer += stackAllocatedSize;
+        paramBuffer += valueStackAllocatedSize(paramTypeInfo[i]);
     }
-    ASSERT(offsetIndex == parameterOffsetSize);
+    ASSERT(static_cast<size_t>(paramBuffer - valueBuffer) == ft->paramStackSize());
 
-    size_t resultOffset = 0;
-    for (size_t i = 0; i < resultTypeInfo.size(); i++) {
-        size_t stackAllocatedSize = valueStackAllocatedSize(resultTypeInfo[i]);
-        for (size_t j = 0; j < stackAllocatedSize; j += sizeof(size_t)) {
-            offsetBuffer[offsetIndex++] = resultOffset + j;
-        }
-        resultOffset += stackAllocatedSize;
+    if (UNLIKELY(!interpreterCall(state, valueBuffer, ft->callOffsets(), parameterOffsetSize, resultOffsetSize))) {
+        return false;
     }
-    ASSERT(offsetIndex == parameterOffsetSize + resultOffsetSize);
-    interpreterCall(state, valueBuffer, offsetBuffer, parameterOffsetSize, resultOffsetSize);
 
-    size_t resultOffsetIndex = 0;
+    uint8_t* resultBuffer = valueBuffer;
     for (size_t i = 0; i < resultTypeInfo.size(); i++) {
-        result[i] = Value(resultTypeInfo[i], valueBuffer + offsetBuffer[resultOffsetIndex + parameterOffsetSize]);
-        size_t stackAllocatedSize = valueStackAllocatedSize(resultTypeInfo[i]);
-        resultOffsetIndex += stackAllocatedSize / sizeof(size_t);
+        result[i] = Value(resultTypeInfo[i], resultBuffer);
+        resultBuffer += valueStackAllocatedSize(resultTypeInfo[i]);
     }
+    return true;
 }
 
-void DefinedFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+bool DefinedFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
                                       uint16_t parameterOffsetCount, uint16_t resultOffsetCount)
 {
-    Interpreter::callInterpreter(state, this, bp, offsets, parameterOffsetCount, resultOffsetCount);
+    return Interpreter::callInterpreter(state, this, bp, offsets, parameterOffsetCount, resultOffsetCount);
 }
 
-void NativeFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+bool NativeFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
                                      uint16_t parameterOffsetCount, uint16_t resultOffsetCount)
 {
     const FunctionType* ft = functionType();
@@ -125,6 +174,7 @@ void NativeFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCod
         resultVector[i].writeToMemory(bp + offsets[offsetIndex]);
         offsetIndex += valueFunctionCopyCount(resultTypeInfo[i]);
     }
+    return true;
 }
 
 ImportedFunction* ImportedFunction::createImportedFunction(Store* store,
@@ -146,6 +196,70 @@ void ImportedFunction::call(ExecutionState& state, Value* argv, Value* result)
     m_callback(newState, argv, result, m_data);
 }
 
+ImportedSlotFunction* ImportedSlotFunction::createImportedSlotFunction(Store* store,
+                                                                       FunctionType* functionType,
+                                                                       ImportedSlotFunctionCallback callback,
+                                                                       void* data)
+{
+    ImportedSlotFunction* func = new ImportedSlotFunction(functionType,
+                                                          callback,
+                                                          data);
+    store->appendExtern(func);
+    return func;
+}
+
+void ImportedSlotFunction::call(ExecutionState& state, Value* argv, Value* result)
+{
+    const FunctionType* ft = functionType();
+    const TypeVector::Types& paramTypeInfo = ft->param().types();
+    const TypeVector::Types& resultTypeInfo = ft->result().types();
+    ALLOCA(uint64_t, slots, std::max(paramTypeInfo.size(), resultTypeInfo.size()) * sizeof(uint64_t));
+    uint8_t buffer[sizeof(uint64_t)];
+
+    for (size_t i = 0; i < paramTypeInfo.size(); i++) {
+        argv[i].writeToMemory(buffer);
+        slots[i] = readSlot(paramTypeInfo[i], buffer);
+    }
+
+    ExecutionState newState(state, this);
+    CHECK_STACK_LIMIT(newState);
+    m_slotCallback(newState, slots, m_data);
+
+    for (size_t i = 0; i < resultTypeInfo.size(); i++) {
+        writeSlot(resultTypeInfo[i], buffer, slots[i]);
+        result[i] = Value(resultTypeInfo[i], buffer);
+    }
+}
+
+bool ImportedSlotFunction::interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+                                           uint16_t parameterOffsetCount, uint16_t resultOffsetCount)
+{
+    const FunctionType* ft = functionType();
+    const TypeVector::Types& paramTypeInfo = ft->param().types();
+    const TypeVector::Types& resultTypeInfo = ft->result().types();
+    ALLOCA(uint64_t, slots, std::max(paramTypeInfo.size(), resultTypeInfo.size()) * sizeof(uint64_t));
+
+    // The slots are copied directly, since all types are numeric.
+    size_t offsetIndex = 0;
+    for (size_t i = 0; i < paramTypeInfo.size(); i++) {
+        slots[i] = readSlot(paramTypeInfo[i], bp + offsets[offsetIndex]);
+        offsetIndex += valueFunctionCopyCount(paramTypeInfo[i]);
+    }
+
+    ExecutionState newState(state, this);
+    if (IS_STACK_LIMIT_REACHED(newState)) {
+        state.setTrap(Exception::CallStackExhausted);
+        return false;
+    }
+    m_slotCallback(newState, slots, m_data);
+
+    for (size_t i = 0; i < resultTypeInfo.size(); i++) {
+        writeSlot(resultTypeInfo[i], bp + offsets[offsetIndex], slots[i]);
+        offsetIndex += valueFunctionCopyCount(resultTypeInfo[i]);
+    }
+    return true;
+}
+
 WasiFunction* WasiFunction::createWasiFunction(Store* store,
                                                FunctionType* functionType,
                                                WasiFunctionCallback callback)
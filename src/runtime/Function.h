@@ -23,17 +23,16 @@
 #include "runtime/Object.h"
 
 #ifdef STACK_GROWS_DOWN
-#define CHECK_STACK_LIMIT(state)                                        \
-    if (UNLIKELY(state.stackLimit() > (size_t)currentStackPointer())) { \
-        Trap::throwException(state, "call stack exhausted");            \
-    }
+#define IS_STACK_LIMIT_REACHED(state) UNLIKELY(state.stackLimit() > (size_t)currentStackPointer())
 #else
-#define CHECK_STACK_LIMIT(state)                                        \
-    if (UNLIKELY(state.stackLimit() < (size_t)currentStackPointer())) { \
-        Trap::throwException(state, "call stack exhausted");            \
-    }
+#define IS_STACK_LIMIT_REACHED(state) UNLIKELY(state.stackLimit() < (size_t)currentStackPointer())
 #endif
 
+#define CHECK_STACK_LIMIT(state)                             \
+    if (IS_STACK_LIMIT_REACHED(state)) {                     \
+        Trap::throwException(Exception::CallStackExhausted); \
+    }
+
 
 namespace Walrus {
 
@@ -62,10 +61,23 @@ public:
 
     virtual Kind kind() const = 0;
     virtual void call(ExecutionState& state, Value* argv, Value* result) = 0;
-    virtual void interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+    // Same as call(), except that traps of wasm code are not thrown. They are stored
+    // in the state, false is returned, and Trap::run() reports them after the runner.
+    virtual bool tryCall(ExecutionState& state, Value* argv, Value* result)
+    {
+        call(state, argv, result);
+        return true;
+    }
+    // Returns false if a trap is stored in the state.
+    virtual bool interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
                                  uint16_t parameterOffsetCount, uint16_t resultOffsetCount)
         = 0;
 
+    // Calls a function which has only numeric parameter and result types. Each
+    // value is stored in a 64 bit slot, and the results replace the parameters.
+    // Traps are returned in the same way as tryCall().
+    bool callWithSlots(ExecutionState& state, uint64_t* slots);
+
     DefinedFunction* asDefinedFunction()
     {
         ASSERT(kind() == DefinedFunctionKind);
@@ -107,7 +119,8 @@ public:
     }
 
     virtual void call(ExecutionState& state, Value* argv, Value* result) override;
-    virtual void interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+    virtual bool tryCall(ExecutionState& state, Value* argv, Value* result) override;
+    virtual bool interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
                                  uint16_t parameterOffsetCount, uint16_t resultOffsetCount) override;
 
 protected:
@@ -120,7 +133,7 @@ protected:
 
 class NativeFunction : public Function {
 public:
-    virtual void interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+    virtual bool interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
                                  uint16_t parameterOffsetCount, uint16_t resultOffsetCount) override;
 
 protected:
@@ -160,6 +173,34 @@ protected:
     void* m_data;
 };
 
+// Host function with numeric parameter and result types, which receives
+// its parameters and returns its results in 64 bit slots. Calls from wasm
+// code copy the slots from the value stack without creating Value objects.
+class ImportedSlotFunction : public ImportedFunction {
+public:
+    typedef std::function<void(ExecutionState& state, uint64_t* slots, void* data)> ImportedSlotFunctionCallback;
+
+    static ImportedSlotFunction* createImportedSlotFunction(Store* store,
+                                                            FunctionType* functionType,
+                                                            ImportedSlotFunctionCallback callback,
+                                                            void* data);
+
+    virtual void call(ExecutionState& state, Value* argv, Value* result) override;
+    virtual bool interpreterCall(ExecutionState& state, uint8_t* bp, ByteCodeStackOffset* offsets,
+                                 uint16_t parameterOffsetCount, uint16_t resultOffsetCount) override;
+
+protected:
+    ImportedSlotFunction(FunctionType* functionType,
+                         ImportedSlotFunctionCallback callback,
+                         void* data)
+        : ImportedFunction(functionType, nullptr, data)
+        , m_slotCallback(callback)
+    {
+    }
+
+    ImportedSlotFunctionCallback m_slotCallback;
+};
+
 class WasiFunction : public NativeFunction {
 public:
     typedef std::function<void(ExecutionState& state, Value* argv, Value* result, Instance* instance)> WasiFunctionCallback;
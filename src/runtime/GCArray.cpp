@@ -27,11 +27,6 @@
 namespace Walrus {
 
 #ifdef ENABLE_GC
-static void GC_CALLBACK arrayFinalizer(void* /* ignored ptr */, void* subTypeList)
-{
-    TypeStore::ReleaseRef(reinterpret_cast<const CompositeType**>(subTypeList));
-}
-
 static inline uint32_t getAlignedStartOffset(uint32_t size)
 {
     return (static_cast<uint32_t>(sizeof(GCArray)) + (size - 1)) & ~(size - 1);
@@ -58,7 +53,7 @@ GCArray* GCArray::arrayNew(uint32_t length, const ArrayType* type, uint8_t* valu
     }
 
     uint32_t totalSize = getAlignedTotalSize(startOffset + (length << log2Size));
-    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GC_MALLOC(totalSize) : GC_MALLOC_ATOMIC(totalSize));
+    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GCObjectCache::current()->allocate(totalSize) : GC_MALLOC_ATOMIC(totalSize));
     if (UNLIKELY(result == nullptr)) {
         return result;
     }
@@ -86,8 +81,6 @@ GCArray* GCArray::arrayNew(uint32_t length, const ArrayType* type, uint8_t* valu
         memcpy(dst + currentSize, dst, size - currentSize);
     }
 
-    TypeStore::AddRef(type);
-    GC_REGISTER_FINALIZER_NO_ORDER(result, arrayFinalizer, type->subTypeList(), nullptr, nullptr);
     return result;
 #else // !ENABLE_GC
     return nullptr;
@@ -109,7 +102,7 @@ GCArray* GCArray::arrayNewDefault(uint32_t length, const ArrayType* type)
     }
 
     uint32_t totalSize = getAlignedTotalSize(startOffset + (length << log2Size));
-    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GC_MALLOC(totalSize) : GC_MALLOC_ATOMIC(totalSize));
+    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GCObjectCache::current()->allocate(totalSize) : GC_MALLOC_ATOMIC(totalSize));
     if (UNLIKELY(result == nullptr)) {
         return result;
     }
@@ -119,8 +112,6 @@ GCArray* GCArray::arrayNewDefault(uint32_t length, const ArrayType* type)
 
     memset(reinterpret_cast<uint8_t*>(result) + startOffset, 0, length << log2Size);
 
-    TypeStore::AddRef(type);
-    GC_REGISTER_FINALIZER_NO_ORDER(result, arrayFinalizer, type->subTypeList(), nullptr, nullptr);
     return result;
 #else // !ENABLE_GC
     return nullptr;
@@ -143,7 +134,7 @@ GCArray* GCArray::arrayNewFixed(uint32_t length, const ArrayType* type, ByteCode
     }
 
     uint32_t totalSize = getAlignedTotalSize(startOffset + (length << log2Size));
-    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GC_MALLOC(totalSize) : GC_MALLOC_ATOMIC(totalSize));
+    GCArray* result = reinterpret_cast<GCArray*>(Value::isRefType(valueType) ? GCObjectCache::current()->allocate(totalSize) : GC_MALLOC_ATOMIC(totalSize));
     if (UNLIKELY(result == nullptr)) {
         return result;
     }
@@ -189,8 +180,6 @@ GCArray* GCArray::arrayNewFixed(uint32_t length, const ArrayType* type, ByteCode
         break;
     }
 
-    TypeStore::AddRef(type);
-    GC_REGISTER_FINALIZER_NO_ORDER(result, arrayFinalizer, type->subTypeList(), nullptr, nullptr);
     return result;
 #else // !ENABLE_GC
     return nullptr;
@@ -228,8 +217,6 @@ GCArray* GCArray::arrayNewData(uint32_t offset, uint32_t size, const ArrayType*
 
     memcpy(reinterpret_cast<uint8_t*>(result) + startOffset, data->data() + offset, size << log2Size);
 
-    TypeStore::AddRef(type);
-    GC_REGISTER_FINALIZER_NO_ORDER(result, arrayFinalizer, type->subTypeList(), nullptr, nullptr);
     return result;
 #else // !ENABLE_GC
     return nullptr;
@@ -253,7 +240,7 @@ GCArray* GCArray::arrayNewElem(uint32_t offset, uint32_t size, const ArrayType*
     }
 
     uint32_t totalSize = getAlignedTotalSize(startOffset + (size * sizeof(void*)));
-    GCArray* result = reinterpret_cast<GCArray*>(GC_MALLOC(totalSize));
+    GCArray* result = reinterpret_cast<GCArray*>(GCObjectCache::current()->allocate(totalSize));
     if (UNLIKELY(result == nullptr)) {
         return result;
     }
@@ -263,12 +250,20 @@ GCArray* GCArray::arrayNewElem(uint32_t offset, uint32_t size, const ArrayType*
 
     memcpy(reinterpret_cast<uint8_t*>(result) + startOffset, elem->elements() + offset, size * sizeof(void*));
 
-    TypeStore::AddRef(type);
-    GC_REGISTER_FINALIZER_NO_ORDER(result, arrayFinalizer, type->subTypeList(), nullptr, nullptr);
     return result;
 #else // !ENABLE_GC
     return nullptr;
 #endif // ENABLE_GC
 }
 
+uintptr_t GCArray::virtualTablePointer()
+{
+    GCArray object;
+    uintptr_t result;
+
+    // The virtual table pointer is the first word of the object.
+    memcpy(&result, &object, sizeof(uintptr_t));
+    return result;
+}
+
 } // namespace Walrus
@@ -42,6 +42,8 @@ public:
     static GCArray* arrayNewFixed(uint32_t length, const ArrayType* type, ByteCodeStackOffset* offsets, uint8_t* bp);
     static GCArray* arrayNewData(uint32_t offset, uint32_t size, const ArrayType* type, DataSegment* data);
     static GCArray* arrayNewElem(uint32_t offset, uint32_t size, const ArrayType* type, ElementSegment* elem);
+    // Used by the JIT compiler to initialize objects without calls.
+    static uintptr_t virtualTablePointer();
 
     uint32_t length() const
     {
@@ -144,6 +146,12 @@ public:
     }
 
 private:
+    GCArray()
+        : GCBase(nullptr)
+        , m_length(0)
+    {
+    }
+
     GCArray(const ArrayType* type, uint32_t length)
         : GCBase(type->subTypeList())
         , m_length(length)
@@ -25,6 +25,40 @@
 namespace Walrus {
 
 #ifdef ENABLE_GC
+static MAY_THREAD_LOCAL GCObjectCache* s_currentObjectCache;
+
+GCObjectCache* GCObjectCache::current()
+{
+    if (UNLIKELY(s_currentObjectCache == nullptr)) {
+        // The free lists must be visible to the collector,
+        // otherwise the preallocated objects are reclaimed.
+        s_currentObjectCache = reinterpret_cast<GCObjectCache*>(GC_MALLOC_UNCOLLECTABLE(sizeof(GCObjectCache)));
+    }
+    return s_currentObjectCache;
+}
+
+void* GCObjectCache::allocate(size_t size)
+{
+    if (size > MaxObjectSize) {
+        return GC_MALLOC(size);
+    }
+
+    size_t index = sizeClass(size);
+    void* result = m_freeLists[index];
+
+    if (result == nullptr) {
+        result = GC_malloc_many((index + 1) * Granularity);
+        if (UNLIKELY(result == nullptr)) {
+            return nullptr;
+        }
+    }
+
+    // Objects are linked through their first word, the rest is cleared.
+    m_freeLists[index] = GC_NEXT(result);
+    GC_NEXT(result) = nullptr;
+    return result;
+}
+
 void GCBase::addRef()
 {
     objectTypeInfo()->getRecursiveType()->typeStore()->addRef(this);
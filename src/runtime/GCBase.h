@@ -21,7 +21,39 @@
 
 namespace Walrus {
 
+#ifdef ENABLE_GC
+// Thread local lists of preallocated objects, one for each small size
+// class. Popping an object from these lists is cheap enough to be
+// inlined by the JIT compiler. Empty lists are refilled by the collector.
+class GCObjectCache {
+public:
+    static constexpr size_t Granularity = 16;
+    static constexpr size_t SizeClassCount = 16;
+    static constexpr size_t MaxObjectSize = Granularity * SizeClassCount;
+
+    static GCObjectCache* current();
+
+    static size_t sizeClass(size_t size)
+    {
+        ASSERT(size > 0 && size <= MaxObjectSize);
+        return (size - 1) / Granularity;
+    }
+
+    static size_t freeListOffset(size_t sizeClass)
+    {
+        return offsetof(GCObjectCache, m_freeLists) + sizeClass * sizeof(void*);
+    }
+
+    // The returned memory is cleared, and scanned by the collector.
+    void* allocate(size_t size);
+
+private:
+    void* m_freeLists[SizeClassCount];
+};
+#endif
+
 class GCBase : public Object {
+    friend class JITFieldAccessor;
     friend class TypeStore;
 
 public:
@@ -29,6 +29,8 @@ class GCStruct : public GCBase {
 public:
     static GCStruct* structNew(const StructType* type, ByteCodeStackOffset* offsets, uint8_t* bp);
     static GCStruct* structNewDefault(const StructType* type);
+    // Used by the JIT compiler to initialize objects without calls.
+    static uintptr_t virtualTablePointer();
 
     static inline void set(uint8_t* dst, uint8_t* src, Value::Type type)
     {
@@ -93,6 +95,11 @@ public:
     }
 
 private:
+    GCStruct()
+        : GCBase(nullptr)
+    {
+    }
+
     GCStruct(const StructType* type)
         : GCBase(type->subTypeList())
     {
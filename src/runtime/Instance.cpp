@@ -62,7 +62,7 @@ void ElementSegment::drop()
     }
 }
 
-Instance* Instance::newInstance(Module* module)
+Instance* Instance::newInstance(Module* module, Store* store)
 {
     // Must follow the order in Module::instantiate.
 
@@ -82,7 +82,7 @@ Instance* Instance::newInstance(Module* module)
     void* result = malloc(alignedSize() + totalSize);
 
     // Placement new.
-    new (result) Instance(module);
+    new (result) Instance(module, store);
 
     // Initialize data.
     return reinterpret_cast<Instance*>(result);
@@ -95,16 +95,17 @@ void Instance::freeInstance(Instance* instance)
     free(reinterpret_cast<void*>(instance));
 }
 
-Instance::Instance(Module* module)
+Instance::Instance(Module* module, Store* store)
     : Object(GET_GLOBAL_TYPE_INFO(instanceTypeInfo))
     , m_module(module)
+    , m_store(store)
     , m_memories(nullptr)
     , m_globals(nullptr)
     , m_tables(nullptr)
     , m_functions(nullptr)
     , m_tags(nullptr)
 {
-    module->store()->appendInstance(this);
+    store->appendInstance(this);
 }
 
 Instance::~Instance()
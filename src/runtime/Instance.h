@@ -97,7 +97,7 @@ class Instance : public Object {
 public:
     typedef Vector<Instance*, std::allocator<Instance*>> InstanceVector;
 
-    static Instance* newInstance(Module* module);
+    static Instance* newInstance(Module* module, Store* store);
     static void freeInstance(Instance* instance);
 
     static size_t alignedSize()
@@ -111,6 +111,8 @@ public:
     }
 
     Module* module() const { return m_module; }
+    // Modules can be instantiated by multiple stores.
+    Store* store() const { return m_store; }
 
     Function* function(uint32_t index) const
     {
@@ -156,10 +158,11 @@ public:
     const Function* const* functions() { return m_functions; }
 
 private:
-    Instance(Module* module);
+    Instance(Module* module, Store* store);
     ~Instance();
 
     Module* m_module;
+    Store* m_store;
 
     // The initialization in Module::instantiate and Instance::newInstance must follow this order.
     // Ordered in use frequency order.
@@ -17,11 +17,17 @@
 #include "Walrus.h"
 
 #include "runtime/JITExec.h"
+#include "runtime/Exception.h"
+#include "runtime/Function.h"
 #include "runtime/Instance.h"
 #include "runtime/Module.h"
 #include "runtime/Trap.h"
 #include "runtime/Value.h"
 
+#ifdef ENABLE_GC
+#include "GCUtil.h"
+#endif /* ENABLE_GC */
+
 namespace Walrus {
 
 ByteCodeStackOffset* JITFunction::call(ExecutionState& state, Instance* instance, uint8_t* bp) const
@@ -36,86 +42,131 @@ ByteCodeStackOffset* JITFunction::call(ExecutionState& state, Instance* instance
     if (context.error != ExecutionContext::NoError) {
         switch (context.error) {
         case ExecutionContext::CapturedException:
+            context.capturedException->recordProgramCounters(state);
             throw std::unique_ptr<Exception>(context.capturedException);
+        case ExecutionContext::InterpreterTrapError:
+            // The trap is already stored in the state.
+            return nullptr;
         case ExecutionContext::OutOfStackError:
-            Trap::throwException(state, "call stack exhausted");
-            return resultOffsets;
+            state.setTrap(Exception::CallStackExhausted);
+            return nullptr;
         case ExecutionContext::DivideByZeroError:
-            Trap::throwException(state, "integer divide by zero");
-            return resultOffsets;
+            state.setTrap(Exception::IntegerDivideByZero);
+            return nullptr;
         case ExecutionContext::IntegerOverflowError:
-            Trap::throwException(state, "integer overflow");
-            return resultOffsets;
+            state.setTrap(Exception::IntegerOverflow);
+            return nullptr;
         case ExecutionContext::TypeMismatchError:
-            Trap::throwException(state, "type mismatch");
-            return resultOffsets;
+            state.setTrap(Exception::TypeMismatch);
+            return nullptr;
         case ExecutionContext::AllocationError:
-            Trap::throwException(state, "memory allocation failed");
-            return resultOffsets;
+            state.setTrap(Exception::MemoryAllocationFailed);
+            return nullptr;
         case ExecutionContext::OutOfBoundsArrayAccessError:
             COMPILE_ASSERT(ExecutionContext::AllocationError + 1 == ExecutionContext::OutOfBoundsArrayAccessError,
                            "AllocationError and OutOfBoundsArrayAccessError errors must follow each other");
-            Trap::throwException(state, "out of bounds array access");
-            return resultOffsets;
+            state.setTrap(Exception::OutOfBoundsArrayAccess);
+            return nullptr;
         case ExecutionContext::OutOfBoundsMemAccessError:
             COMPILE_ASSERT(ExecutionContext::AllocationError + 2 == ExecutionContext::OutOfBoundsMemAccessError,
                            "AllocationError and OutOfBoundsMemAccessError errors must follow each other");
-            Trap::throwException(state, "out of bounds memory access");
-            return resultOffsets;
+            state.setTrap(Exception::OutOfBoundsMemoryAccess);
+            return nullptr;
         case ExecutionContext::OutOfBoundsTableAccessError:
             COMPILE_ASSERT(ExecutionContext::AllocationError + 3 == ExecutionContext::OutOfBoundsTableAccessError,
                            "AllocationError and OutOfBoundsTableAccessError errors must follow each other");
-            Trap::throwException(state, "out of bounds table access");
-            return resultOffsets;
+            state.setTrap(Exception::OutOfBoundsTableAccess);
+            return nullptr;
         case ExecutionContext::NullReferenceError:
-            Trap::throwException(state, "null reference");
-            return resultOffsets;
+            state.setTrap(Exception::NullReference);
+            return nullptr;
         case ExecutionContext::NullFunctionReferenceError:
-            Trap::throwException(state, "null function reference");
-            return resultOffsets;
+            state.setTrap(Exception::NullFunctionReference);
+            return nullptr;
         case ExecutionContext::NullI31ReferenceError:
-            Trap::throwException(state, "null i31 reference");
-            return resultOffsets;
+            state.setTrap(Exception::NullI31Reference);
+            return nullptr;
         case ExecutionContext::NullArrayReferenceError:
-            Trap::throwException(state, "null array reference");
-            return resultOffsets;
+            state.setTrap(Exception::NullArrayReference);
+            return nullptr;
         case ExecutionContext::NullStructReferenceError:
-            Trap::throwException(state, "null structure reference");
-            return resultOffsets;
+            state.setTrap(Exception::NullStructureReference);
+            return nullptr;
         case ExecutionContext::UndefinedElementError:
-            Trap::throwException(state, "undefined element");
-            return resultOffsets;
+            state.setTrap(Exception::UndefinedElement);
+            return nullptr;
         case ExecutionContext::UninitializedElementError:
-            Trap::throwException(state, "uninitialized element");
-            return resultOffsets;
+            state.setTrap(Exception::UninitializedElement);
+            return nullptr;
         case ExecutionContext::IndirectCallTypeMismatchError:
-            Trap::throwException(state, "indirect call type mismatch");
-            return resultOffsets;
+            state.setTrap(Exception::IndirectCallTypeMismatch);
+            return nullptr;
         case ExecutionContext::CallRefTypeMismatchError:
-            Trap::throwException(state, "call by reference type mismatch");
-            return resultOffsets;
+            state.setTrap(Exception::CallByReferenceTypeMismatch);
+            return nullptr;
         case ExecutionContext::CastFailureError:
-            Trap::throwException(state, "cast failure");
-            return resultOffsets;
+            state.setTrap(Exception::CastFailure);
+            return nullptr;
         case ExecutionContext::InvalidConversionToIntegerError:
-            Trap::throwException(state, "invalid conversion to integer");
-            return resultOffsets;
+            state.setTrap(Exception::InvalidConversionToInteger);
+            return nullptr;
         case ExecutionContext::UnreachableError:
-            Trap::throwException(state, "unreachable executed");
-            return resultOffsets;
+            state.setTrap(Exception::UnreachableExecuted);
+            return nullptr;
         case ExecutionContext::UnalignedAtomicError:
-            Trap::throwException(state, "unaligned atomic");
-            return resultOffsets;
+            state.setTrap(Exception::UnalignedAtomic);
+            return nullptr;
         case ExecutionContext::ExpectedSharedMemError:
-            Trap::throwException(state, "expected shared memory");
-            return resultOffsets;
+            state.setTrap(Exception::ExpectedSharedMemory);
+            return nullptr;
         default:
-            Trap::throwException(state, "unknown exception");
-            return resultOffsets;
+            state.setTrap(Exception::UnknownException);
+            return nullptr;
         }
     }
 
     return resultOffsets;
 }
 
+ExecutionContext::ErrorCodes JITFunction::callFromJIT(ExecutionContext* callerContext, DefinedFunction* function, uint8_t* bp, ByteCodeStackOffset* offsets,
+                                                      uint16_t parameterOffsetCount, uint16_t resultOffsetCount) const
+{
+    ASSERT(m_exportEntry);
+
+    ExecutionState newState(callerContext->state, function);
+
+#ifdef STACK_GROWS_DOWN
+    if (UNLIKELY(newState.stackLimit() > (size_t)currentStackPointer())) {
+#else
+    if (UNLIKELY(newState.stackLimit() < (size_t)currentStackPointer())) {
+#endif
+        callerContext->error = ExecutionContext::OutOfStackError;
+        return ExecutionContext::OutOfStackError;
+    }
+
+    ModuleFunction* moduleFunction = function->moduleFunction();
+    ALLOCA(uint8_t, functionStackBase, moduleFunction->requiredStackSize());
+
+    for (size_t i = 0; i < parameterOffsetCount; i++) {
+        reinterpret_cast<size_t*>(functionStackBase)[i] = *reinterpret_cast<size_t*>(bp + offsets[i]);
+    }
+
+    ExecutionContext context(m_module->instanceConstData(), newState, function->instance());
+    ByteCodeStackOffset* resultOffsets = m_module->exportCall()(&context, functionStackBase, m_exportEntry);
+
+    if (UNLIKELY(context.error != ExecutionContext::NoError)) {
+        // Both traps and captured exceptions are unwound by the caller.
+        callerContext->error = context.error;
+        callerContext->capturedException = context.capturedException;
+        return context.error;
+    }
+
+    offsets += parameterOffsetCount;
+    for (size_t i = 0; i < resultOffsetCount; i++) {
+        *reinterpret_cast<size_t*>(bp + offsets[i]) = *reinterpret_cast<size_t*>(functionStackBase + resultOffsets[i]);
+    }
+
+    return ExecutionContext::NoError;
+}
+
 } // namespace Walrus
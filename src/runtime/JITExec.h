@@ -18,6 +18,7 @@
 #define __WalrusJITExec__
 
 #include "interpreter/ByteCode.h"
+#include "runtime/GCBase.h"
 #include "runtime/Instance.h"
 #include "runtime/Memory.h"
 
@@ -25,6 +26,7 @@ namespace Walrus {
 
 class Exception;
 class Memory;
+class DefinedFunction;
 class InstanceConstData;
 
 struct ExecutionContext {
@@ -54,6 +56,7 @@ struct ExecutionContext {
         UnreachableError,
         UnalignedAtomicError,
         ExpectedSharedMemError,
+        InterpreterTrapError, // Trap is stored in the state by the interpreter.
 
         // These three in this order must be the last items of the list.
         GenericTrap, // Error code received in SLJIT_R0.
@@ -66,6 +69,9 @@ struct ExecutionContext {
         , state(state)
         , instance(instance)
         , capturedException(nullptr)
+#ifdef ENABLE_GC
+        , gcObjectCache(GCObjectCache::current())
+#endif
         , error(NoError)
     {
     }
@@ -81,6 +87,9 @@ struct ExecutionContext {
     ExecutionState& state;
     Instance* instance;
     Exception* capturedException;
+#ifdef ENABLE_GC
+    GCObjectCache* gcObjectCache;
+#endif
     ErrorCodes error;
 };
 
@@ -133,6 +142,10 @@ public:
 
     bool isCompiled() const { return m_exportEntry != nullptr; }
     ByteCodeStackOffset* call(ExecutionState& state, Instance* instance, uint8_t* bp) const;
+    // Called by JIT code. Errors and exceptions are passed to the context of
+    // the caller, so propagating them never enters the C++ exception runtime.
+    ExecutionContext::ErrorCodes callFromJIT(ExecutionContext* callerContext, DefinedFunction* function, uint8_t* bp, ByteCodeStackOffset* offsets,
+                                             uint16_t parameterOffsetCount, uint16_t resultOffsetCount) const;
 
 private:
     void* m_exportEntry;
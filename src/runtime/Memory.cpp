@@ -20,30 +20,94 @@
 #include "runtime/Trap.h"
 #include "runtime/Instance.h"
 #include "runtime/Module.h"
+#include "runtime/Engine.h"
 
 #if defined(OS_POSIX)
 #define WALRUS_USE_MMAP
 #include <sys/mman.h>
+#include <unistd.h>
 #endif
 
 namespace Walrus {
 
 DEFINE_GLOBAL_TYPE_INFO(memoryTypeInfo, MemoryKind);
 
+#if defined(WALRUS_USE_MMAP)
+static const uint64_t s_hugePageSize = 2 * 1024 * 1024;
+
+static uint8_t* reserveMemory(uint64_t size, uint32_t flags)
+{
+    if (!(flags & MemoryFlagValue::memoryHugePages)) {
+        void* buffer = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return buffer != MAP_FAILED ? reinterpret_cast<uint8_t*>(buffer) : nullptr;
+    }
+
+    // Huge pages are only used for aligned ranges, so the
+    // mapping is extended, then the unaligned ends are removed.
+    uint64_t mappedSize = size + s_hugePageSize;
+    void* buffer = mmap(NULL, mappedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        return nullptr;
+    }
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(buffer);
+    uintptr_t alignedStart = (start + s_hugePageSize - 1) & ~static_cast<uintptr_t>(s_hugePageSize - 1);
+    uintptr_t end = start + mappedSize;
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t alignedEnd = (alignedStart + size + pageSize - 1) & ~(pageSize - 1);
+
+    if (alignedStart > start) {
+        munmap(buffer, alignedStart - start);
+    }
+    if (end > alignedEnd) {
+        munmap(reinterpret_cast<void*>(alignedEnd), end - alignedEnd);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    // Fails when transparent huge pages are disabled, which is not an error.
+    madvise(reinterpret_cast<void*>(alignedStart), size, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<uint8_t*>(alignedStart);
+}
+
+static void commitMemory(uint8_t* start, uint64_t size, uint32_t flags)
+{
+    mprotect(start, size, (PROT_READ | PROT_WRITE));
+
+    if (!(flags & MemoryFlagValue::memoryPrefault) || size == 0) {
+        return;
+    }
+
+    // MAP_POPULATE cannot be used, since the reservation is not accessible.
+#if defined(MADV_POPULATE_WRITE)
+    if (madvise(start, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+
+    // Kernels before 5.14 are forced to allocate the pages by writing them.
+    uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    for (uint64_t offset = 0; offset < size; offset += pageSize) {
+        *reinterpret_cast<volatile uint8_t*>(start + offset) = 0;
+    }
+}
+#endif
+
 Memory* Memory::createMemory(Store* store, uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isShared, bool is64)
 {
-    Memory* mem = new Memory(initialSizeInByte, maximumSizeInByte, isShared, is64);
+    Memory* mem = new Memory(initialSizeInByte, maximumSizeInByte, isShared, is64, store->engine()->options());
     store->appendExtern(mem);
     return mem;
 }
 
-Memory::Memory(uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isShared, bool is64)
+Memory::Memory(uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isShared, bool is64, const EngineOptions& options)
     : Extern(GET_GLOBAL_TYPE_INFO(memoryTypeInfo))
     , m_sizeInByte(initialSizeInByte)
     , m_reservedSizeInByte(0)
     , m_maximumSizeInByte(maximumSizeInByte)
     , m_buffer(nullptr)
     , m_targetBuffers(nullptr)
+    , m_flags(options.memoryFlags)
     , m_isShared(isShared)
     , m_is64(is64)
 {
@@ -56,16 +120,19 @@ Memory::Memory(uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isSh
 #ifndef WALRUS_64_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE
 #define WALRUS_64_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE (1024 * 1024 * 512)
 #endif
-        uint64_t initialReservedSize =
+        uint64_t initialReservedSize = options.memoryReservedSize;
+        if (initialReservedSize == 0) {
+            initialReservedSize =
 #if defined(WALRUS_32)
-            WALRUS_32_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE;
+                WALRUS_32_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE;
 #else
-            WALRUS_64_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE;
+                WALRUS_64_MEMORY_INITIAL_MMAP_RESERVED_ADDRESS_SIZE;
 #endif
+        }
         m_reservedSizeInByte = std::min(std::max(initialReservedSize, initialSizeInByte), m_maximumSizeInByte);
-        m_buffer = reinterpret_cast<uint8_t*>(mmap(NULL, m_reservedSizeInByte, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-        RELEASE_ASSERT(MAP_FAILED != m_buffer);
-        mprotect(m_buffer, initialSizeInByte, (PROT_READ | PROT_WRITE));
+        m_buffer = reserveMemory(m_reservedSizeInByte, m_flags);
+        RELEASE_ASSERT(m_buffer);
+        commitMemory(m_buffer, initialSizeInByte, m_flags);
     } else {
         m_reservedSizeInByte = 0;
         m_buffer = nullptr;
@@ -95,15 +162,15 @@ bool Memory::grow(uint64_t growSizeInByte)
     if (newSizeInByte > m_sizeInByte && newSizeInByte <= m_maximumSizeInByte) {
 #if defined(WALRUS_USE_MMAP)
         if (newSizeInByte <= m_reservedSizeInByte) {
-            mprotect(m_buffer + m_sizeInByte, growSizeInByte, (PROT_READ | PROT_WRITE));
+            commitMemory(m_buffer + m_sizeInByte, growSizeInByte, m_flags);
             m_sizeInByte = newSizeInByte;
         } else {
             auto newReservedSizeInByte = std::min(newSizeInByte * 2, m_maximumSizeInByte);
-            auto newBuffer = reinterpret_cast<uint8_t*>(mmap(NULL, newReservedSizeInByte, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-            if (MAP_FAILED == newBuffer) {
+            auto newBuffer = reserveMemory(newReservedSizeInByte, m_flags);
+            if (newBuffer == nullptr) {
                 return false;
             }
-            mprotect(newBuffer, newSizeInByte, (PROT_READ | PROT_WRITE));
+            commitMemory(newBuffer, newSizeInByte, m_flags);
 
             // Slower copy than memcpy, but reduces the memory peak increase.
             uint64_t* bufferEnd = reinterpret_cast<uint64_t*>(m_buffer + m_sizeInByte);
@@ -172,11 +239,13 @@ bool Memory::grow(uint64_t growSizeInByte)
 
 void Memory::throwRangeException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const
 {
-    std::string str = "out of bounds memory access: access at ";
-    str += std::to_string(offset + addend);
-    str += "+";
-    str += std::to_string(size);
-    Trap::throwException(state, str);
+    Trap::throwException(Exception::OutOfBoundsMemoryAccessAt, static_cast<uint32_t>(offset + addend), size);
+}
+
+bool Memory::setRangeTrap(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const
+{
+    state.setTrap(Exception::OutOfBoundsMemoryAccessAt, static_cast<uint32_t>(offset + addend), size);
+    return false;
 }
 
 template <class T>
@@ -207,53 +276,43 @@ private:
     T* _ptr;
 };
 
-void Memory::init(ExecutionState& state, DataSegment* source, uint64_t dstStart, uint32_t srcStart, uint32_t srcSize)
+bool Memory::init(ExecutionState& state, DataSegment* source, uint64_t dstStart, uint32_t srcStart, uint32_t srcSize)
 {
-    if (!is64()) {
-        checkAccess(state, dstStart, srcSize);
-    } else {
-        checkAccessM64(state, dstStart, srcSize);
+    if (!(is64() ? checkAccessM64(dstStart, srcSize) : checkAccess(dstStart, srcSize))) {
+        return setRangeTrap(state, dstStart, 0, srcSize);
     }
 
     if (srcStart >= source->sizeInByte() || srcStart + srcSize > source->sizeInByte()) {
-        throwRangeException(state, srcStart, srcStart + srcSize, srcSize);
+        return setRangeTrap(state, srcStart, srcStart + srcSize, srcSize);
     }
 
     this->initMemory(source, dstStart, srcStart, srcSize);
+    return true;
 }
 
-void Memory::copy(ExecutionState& state, uint64_t dstStart, uint64_t srcStart, uint64_t size, Memory* dstMem)
+bool Memory::copy(ExecutionState& state, uint64_t dstStart, uint64_t srcStart, uint64_t size, Memory* dstMem)
 {
-    if (!is64()) {
-        checkAccess(state, srcStart, size);
-    } else {
-        checkAccessM64(state, srcStart, size);
+    if (!(is64() ? checkAccessM64(srcStart, size) : checkAccess(srcStart, size))) {
+        return setRangeTrap(state, srcStart, 0, size);
     }
 
-    if (dstMem == nullptr) {
-        if (!is64()) {
-            checkAccess(state, dstStart, size);
-        } else {
-            checkAccessM64(state, dstStart, size);
-        }
-    } else if (!dstMem->is64()) {
-        dstMem->checkAccess(state, dstStart, size);
-    } else {
-        dstMem->checkAccessM64(state, dstStart, size);
+    Memory* target = dstMem != nullptr ? dstMem : this;
+    if (!(target->is64() ? target->checkAccessM64(dstStart, size) : target->checkAccess(dstStart, size))) {
+        return setRangeTrap(state, dstStart, 0, size);
     }
 
     this->copyMemory(dstMem, dstStart, srcStart, size);
+    return true;
 }
 
-void Memory::fill(ExecutionState& state, uint64_t start, uint8_t value, uint64_t size)
+bool Memory::fill(ExecutionState& state, uint64_t start, uint8_t value, uint64_t size)
 {
-    if (!is64()) {
-        checkAccess(state, start, size);
-    } else {
-        checkAccessM64(state, start, size);
+    if (!(is64() ? checkAccessM64(start, size) : checkAccess(start, size))) {
+        return setRangeTrap(state, start, 0, size);
     }
 
     this->fillMemory(start, value, size);
+    return true;
 }
 
 void Memory::initMemory(DataSegment* source, size_t dstStart, uint32_t srcStart, uint32_t srcSize)
@@ -333,7 +392,7 @@ void Memory::checkAtomicAccess(ExecutionState& state, uint32_t offset, uint32_t
 {
     checkAccess(state, offset, size, addend);
     if (UNLIKELY((offset + addend) % size != 0)) {
-        Trap::throwException(state, "unaligned atomic");
+        Trap::throwException(Exception::UnalignedAtomic);
     }
 }
 
@@ -341,12 +400,12 @@ void Memory::checkAtomicAccessM64(ExecutionState& state, uint64_t offset, uint64
 {
     checkAccessM64(state, offset, size, addend);
     if (UNLIKELY((offset + addend) % size != 0)) {
-        Trap::throwException(state, "unaligned atomic");
+        Trap::throwException(Exception::UnalignedAtomic);
     }
 }
 
 void Memory::throwUnsharedMemoryException(ExecutionState& state) const
 {
-    Trap::throwException(state, "expected shared memory");
+    Trap::throwException(Exception::ExpectedSharedMemory);
 }
 } // namespace Walrus
@@ -27,6 +27,14 @@ namespace Walrus {
 
 class Store;
 class DataSegment;
+struct EngineOptions;
+
+enum MemoryFlagValue : uint32_t {
+    // Align the reservation to huge pages and ask the kernel to use them.
+    memoryHugePages = 1 << 0,
+    // Populate the pages when they become accessible, instead of on first access.
+    memoryPrefault = 1 << 1,
+};
 
 class Memory : public Extern {
     friend class JITCompiler;
@@ -396,9 +404,10 @@ public:
 
 #endif
 
-    void init(ExecutionState& state, DataSegment* source, uint64_t dstStart, uint32_t srcStart, uint32_t srcSize);
-    void copy(ExecutionState& state, uint64_t dstStart, uint64_t srcStart, uint64_t size, Memory* dstMem = nullptr);
-    void fill(ExecutionState& state, uint64_t start, uint8_t value, uint64_t size);
+    // Bulk operations of the interpreter. Returns false if a trap is stored in the state.
+    bool init(ExecutionState& state, DataSegment* source, uint64_t dstStart, uint32_t srcStart, uint32_t srcSize);
+    bool copy(ExecutionState& state, uint64_t dstStart, uint64_t srcStart, uint64_t size, Memory* dstMem = nullptr);
+    bool fill(ExecutionState& state, uint64_t start, uint8_t value, uint64_t size);
 
     inline bool checkAccess(uint32_t offset, uint32_t size, uint32_t addend = 0) const
     {
@@ -424,9 +433,10 @@ public:
     void fillMemory(size_t start, uint8_t value, size_t size);
 
 private:
-    Memory(uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isShared, bool is64);
+    Memory(uint64_t initialSizeInByte, uint64_t maximumSizeInByte, bool isShared, bool is64, const EngineOptions& options);
 
     void throwRangeException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const;
+    bool setRangeTrap(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const;
 
     inline void checkAccess(ExecutionState& state, uint32_t offset, uint32_t size, uint32_t addend = 0) const
     {
@@ -476,6 +486,7 @@ private:
     uint64_t m_maximumSizeInByte;
     uint8_t* m_buffer;
     TargetBuffer* m_targetBuffers;
+    uint32_t m_flags;
     bool m_isShared;
     bool m_is64;
 };
@@ -16,6 +16,7 @@
 #include "Walrus.h"
 
 #include "runtime/Store.h"
+#include "runtime/Engine.h"
 #include "runtime/Module.h"
 #include "runtime/Instance.h"
 #include "runtime/Function.h"
@@ -38,15 +39,19 @@ ModuleFunction::ModuleFunction(FunctionType* functionType)
     : m_hasTryCatch(false)
     , m_requiredStackSize(std::max(functionType->paramStackSize(), functionType->resultStackSize()))
     , m_functionType(functionType)
+#ifdef ENABLE_GC
+    , m_hasStackMaps(false)
+#endif
 #if defined(WALRUS_ENABLE_JIT)
     , m_jitFunction(nullptr)
 #endif
 {
 }
 
-Module::Module(Store* store, WASMParsingResult& result)
+Module::Module(Engine* engine, WASMParsingResult& result)
     : Object(GET_GLOBAL_TYPE_INFO(moduleTypeInfo))
-    , m_store(store)
+    , m_engine(engine)
+    , m_refCount(0)
     , m_seenStartAttribute(result.m_seenStartAttribute)
     , m_version(result.m_version)
     , m_start(result.m_start)
@@ -64,7 +69,7 @@ Module::Module(Store* store, WASMParsingResult& result)
     , m_jitModule(nullptr)
 #endif
 {
-    store->appendModule(this);
+    m_engine->addRef();
 }
 
 ModuleFunction::~ModuleFunction()
@@ -76,9 +81,60 @@ ModuleFunction::~ModuleFunction()
 #endif
 }
 
+#ifdef ENABLE_GC
+const ByteCodeStackOffset* ModuleFunction::findStackMap(size_t byteCodeOffset, size_t& slotCount) const
+{
+    if (!m_hasStackMaps) {
+        return nullptr;
+    }
+
+    size_t start = 0;
+    size_t end = m_stackMaps.size();
+
+    while (start < end) {
+        size_t mid = (start + end) >> 1;
+
+        if (m_stackMaps[mid].m_byteCodeOffset < byteCodeOffset) {
+            start = mid + 1;
+        } else if (m_stackMaps[mid].m_byteCodeOffset > byteCodeOffset) {
+            end = mid;
+        } else {
+            size_t slotStart = m_stackMaps[mid].m_slotStart;
+            size_t slotEnd = (mid + 1 < m_stackMaps.size()) ? m_stackMaps[mid + 1].m_slotStart : m_stackMapSlots.size();
+            slotCount = slotEnd - slotStart;
+            return m_stackMapSlots.data() + slotStart;
+        }
+    }
+
+    // Safepoints without references have no entries.
+    static const ByteCodeStackOffset emptyStackMap[1] = { 0 };
+
+    switch (reinterpret_cast<const ByteCode*>(m_byteCode.data() + byteCodeOffset)->opcode()) {
+    case ByteCode::CallOpcode:
+    case ByteCode::CallIndirectOpcode:
+    case ByteCode::CallRefOpcode:
+    case ByteCode::ReturnCallOpcode:
+    case ByteCode::ReturnCallIndirectOpcode:
+    case ByteCode::ReturnCallRefOpcode:
+    case ByteCode::ArrayNewOpcode:
+    case ByteCode::ArrayNewDefaultOpcode:
+    case ByteCode::ArrayNewFixedOpcode:
+    case ByteCode::ArrayNewDataOpcode:
+    case ByteCode::ArrayNewElemOpcode:
+    case ByteCode::StructNewOpcode:
+    case ByteCode::StructNewDefaultOpcode:
+        slotCount = 0;
+        return emptyStackMap;
+    default:
+        return nullptr;
+    }
+}
+#endif
+
 Module::~Module()
 {
-    // Types are freed by the type store.
+    // Types are shared with other modules, and freed by the type store.
+    m_engine->typeStore().releaseTypes(m_compositeTypes);
 
     for (size_t i = 0; i < m_imports.size(); i++) {
         delete m_imports[i];
@@ -121,11 +177,13 @@ Module::~Module()
         delete m_jitModule;
     }
 #endif
+
+    m_engine->releaseRef();
 }
 
-Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports)
+Instance* Module::instantiate(ExecutionState& state, Store* store, const ExternVector& imports)
 {
-    Instance* instance = Instance::newInstance(this);
+    Instance* instance = Instance::newInstance(this, store);
 
     void** references = instance->alignedEnd();
 
@@ -236,7 +294,7 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
 
     // init defined function
     while (funcIndex < m_functions.size()) {
-        instance->m_functions[funcIndex] = DefinedFunction::createDefinedFunction(m_store, instance, function(funcIndex));
+        instance->m_functions[funcIndex] = DefinedFunction::createDefinedFunction(store, instance, function(funcIndex));
         funcIndex++;
     }
 
@@ -264,20 +322,20 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
             initValue = data.initValue;
         }
 
-        instance->m_tables[tableIndex] = Table::createTable(m_store, tableType->type(), tableType->initialSize(), tableType->maximumSize(), initValue);
+        instance->m_tables[tableIndex] = Table::createTable(store, tableType->type(), tableType->initialSize(), tableType->maximumSize(), initValue);
         tableIndex++;
     }
 
     // init memory
     while (memIndex < m_memoryTypes.size()) {
-        instance->m_memories[memIndex] = Memory::createMemory(m_store, m_memoryTypes[memIndex]->initialSize() * Memory::s_memoryPageSize, m_memoryTypes[memIndex]->maximumSize() * Memory::s_memoryPageSize,
+        instance->m_memories[memIndex] = Memory::createMemory(store, m_memoryTypes[memIndex]->initialSize() * Memory::s_memoryPageSize, m_memoryTypes[memIndex]->maximumSize() * Memory::s_memoryPageSize,
                                                               m_memoryTypes[memIndex]->isShared(), m_memoryTypes[memIndex]->is64());
         memIndex++;
     }
 
     // init tag
     while (tagIndex < m_tagTypes.size()) {
-        instance->m_tags[tagIndex] = Tag::createTag(m_store, m_tagTypes[tagIndex]->functionType());
+        instance->m_tags[tagIndex] = Tag::createTag(store, m_tagTypes[tagIndex]->functionType());
         tagIndex++;
     }
 
@@ -289,7 +347,7 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     // init global
     while (globIndex < m_globalTypes.size()) {
         GlobalType* globalType = m_globalTypes[globIndex];
-        instance->m_globals[globIndex] = Global::createGlobal(m_store, Value(globalType->type()), globalType->type());
+        instance->m_globals[globIndex] = Global::createGlobal(store, Value(globalType->type()), globalType->type());
 
         if (globalType->function()) {
             struct RunData {
@@ -359,12 +417,12 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
             }
 
             if (UNLIKELY(elem->tableIndex() >= numberOfTableTypes())) {
-                Trap::throwException(state, "out of bounds table access");
+                Trap::throwException(Exception::OutOfBoundsTableAccess);
             }
 
             uint32_t size = instance->m_tables[elem->tableIndex()]->size();
             if (UNLIKELY(offset > size || (size - offset) < elem->exprFunctions().size())) {
-                Trap::throwException(state, "out of bounds table access");
+                Trap::throwException(Exception::OutOfBoundsTableAccess);
             }
 
             instance->m_tables[elem->tableIndex()]->initTable(instance->m_elementSegments + i, offset, 0, exprs.size());
@@ -397,7 +455,7 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
                 if (m->sizeInByte() >= initData.size() && (offset.asI32() + initData.size()) <= m->sizeInByte() && offset.asI32() >= 0) {
                     memcpyEndianAware(m->buffer(), initData.data(), m->sizeInByte(), initData.size(), offset.asI32(), 0, initData.size());
                 } else {
-                    Trap::throwException(state, "out of bounds memory access");
+                    Trap::throwException(Exception::OutOfBoundsMemoryAccess);
                 }
             }
         },
@@ -426,6 +484,33 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     return instance;
 }
 
+ByteCodeStatistics Module::byteCodeStatistics() const
+{
+    ByteCodeStatistics statistics;
+
+    for (size_t i = 0; i < m_functions.size(); i++) {
+        ModuleFunction* function = m_functions[i];
+        const uint8_t* byteCode = function->byteCode();
+        size_t size = function->byteCodeSize();
+
+        // Imported functions have no byte code.
+        if (size == 0) {
+            continue;
+        }
+
+        statistics.functionCount++;
+        statistics.byteCodeSize += size;
+
+        size_t idx = 0;
+        while (idx < size) {
+            idx += reinterpret_cast<const ByteCode*>(byteCode + idx)->getSize();
+            statistics.instructionCount++;
+        }
+    }
+
+    return statistics;
+}
+
 #if !defined(NDEBUG)
 
 static const char* typeName(Value::Type v)
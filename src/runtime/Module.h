@@ -28,6 +28,7 @@ class WASMComponentBinaryReader;
 namespace Walrus {
 
 class Store;
+class Engine;
 class Module;
 class Instance;
 class JITFunction;
@@ -40,6 +41,8 @@ enum JITFlagValue : uint32_t {
     JITVerbose = 1 << 1,
     JITVerboseColor = 1 << 2,
     disableRegAlloc = 1 << 3,
+    optimizeByteCode = 1 << 4,
+    linearScanRegAlloc = 1 << 5,
 };
 
 enum class SegmentMode {
@@ -212,6 +215,18 @@ public:
         uint32_t m_tagIndex;
     };
 
+#ifdef ENABLE_GC
+    // Stack slots which may hold references at a safepoint (calls and
+    // allocations). Slots of the map end where the slots of the next map start.
+    // Only interpreter frames moved to the heap by tail calls are scanned with
+    // these maps, other interpreter frames and JIT frames are conservatively
+    // scanned as part of the C stack.
+    struct StackMap {
+        uint32_t m_byteCodeOffset;
+        uint32_t m_slotStart;
+    };
+#endif
+
     ModuleFunction(FunctionType* functionType);
     ~ModuleFunction();
 
@@ -241,6 +256,12 @@ public:
         return m_catchInfo;
     }
 
+#ifdef ENABLE_GC
+    // Returns with nullptr if byteCodeOffset is not a safepoint, or the
+    // function has no stack maps.
+    const ByteCodeStackOffset* findStackMap(size_t byteCodeOffset, size_t& slotCount) const;
+#endif
+
 #if defined(WALRUS_ENABLE_JIT)
     void setJITFunction(JITFunction* jitFunction)
     {
@@ -265,6 +286,12 @@ private:
     Vector<std::pair<Value, size_t>, std::allocator<std::pair<Value, size_t>>> m_constantDebugData;
 #endif
     Vector<CatchInfo, std::allocator<CatchInfo>> m_catchInfo;
+#ifdef ENABLE_GC
+    // False when the byte code has no stack maps, e.g. it is optimized.
+    bool m_hasStackMaps;
+    Vector<StackMap, std::allocator<StackMap>> m_stackMaps;
+    Vector<ByteCodeStackOffset, std::allocator<ByteCodeStackOffset>> m_stackMapSlots;
+#endif
 #if defined(WALRUS_ENABLE_JIT)
     JITFunction* m_jitFunction;
 #endif
@@ -349,6 +376,20 @@ private:
     Vector<ModuleFunction*> m_exprFunctions;
 };
 
+// Memory used by the byte code of the functions of a module.
+struct ByteCodeStatistics {
+    ByteCodeStatistics()
+        : functionCount(0)
+        , instructionCount(0)
+        , byteCodeSize(0)
+    {
+    }
+
+    size_t functionCount;
+    size_t instructionCount;
+    size_t byteCodeSize;
+};
+
 class Module : public Object {
     friend class wabt::WASMBinaryReader;
     friend class wabt::WASMComponentBinaryReader;
@@ -356,11 +397,26 @@ class Module : public Object {
     friend class Store;
 
 public:
-    Module(Store* store, WASMParsingResult& result);
+    Module(Engine* engine, WASMParsingResult& result);
 
-    Store* store() const
+    Engine* engine() const
     {
-        return m_store;
+        return m_engine;
+    }
+
+    // Modules are immutable after parsing, and they are shared by
+    // the stores which instantiate them (see Store::appendModule).
+    void addRef()
+    {
+        m_refCount++;
+    }
+
+    void releaseRef()
+    {
+        ASSERT(m_refCount > 0);
+        if (--m_refCount == 0) {
+            delete this;
+        }
     }
 
     size_t numberOfFunctions()
@@ -452,7 +508,10 @@ public:
 
     void postParsing();
 
-    Instance* instantiate(ExecutionState& state, const ExternVector& imports);
+    ByteCodeStatistics byteCodeStatistics() const;
+
+    // The store must have the module appended to it.
+    Instance* instantiate(ExecutionState& state, Store* store, const ExternVector& imports);
 
 #if defined(WALRUS_ENABLE_JIT)
     /* Passing 0 as functionsLength compiles all functions. */
@@ -462,7 +521,8 @@ public:
 private:
     ~Module();
 
-    Store* m_store;
+    Engine* m_engine;
+    size_t m_refCount;
     bool m_seenStartAttribute;
     uint32_t m_version;
     uint32_t m_start;
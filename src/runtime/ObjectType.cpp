@@ -74,44 +74,146 @@ bool FunctionType::equals(const FunctionType* other, bool isSubType) const
     return true;
 }
 
-bool StructType::initialize()
+static uint32_t structFieldSize(Value::Type type)
 {
+    if (type == Value::I8) {
+        return 1;
+    } else if (type == Value::I16) {
+        return 2;
+    }
+    return static_cast<uint32_t>(valueSize(type));
+}
+
+static uint64_t alignStructOffset(uint64_t offset, uint32_t size)
+{
+    return (offset + (size - 1)) & ~static_cast<uint64_t>(size - 1);
+}
+
+bool StructType::inheritsLayout(const StructType* superType) const
+{
+    size_t superFieldCount = superType->fields().size();
+
+    if (superFieldCount > fields().size()) {
+        return false;
+    }
+
+    const MutableTypeVector::Types& fieldTypes = fields().types();
+    const MutableTypeVector::Types& superFieldTypes = superType->fields().types();
+    for (size_t i = 0; i < superFieldCount; i++) {
+        if (structFieldSize(fieldTypes[i].type()) != structFieldSize(superFieldTypes[i].type())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StructType::initialize(const StructType* superType)
+{
+    struct FieldHole {
+        uint64_t start;
+        uint64_t end;
+    };
+
     size_t fieldCount = fields().size();
     m_fieldOffsets.reserve(fieldCount);
 
-    uint32_t offset = sizeof(GCStruct);
+    const MutableTypeVector::Types& fieldTypes = fields().types();
+    Vector<FieldHole, std::allocator<FieldHole>> holes;
+    size_t firstField = 0;
+    uint64_t offset = sizeof(GCStruct);
     uint32_t align = sizeof(void*);
 
-    const MutableTypeVector::Types& fieldTypes = fields().types();
-    for (size_t i = 0; i < fieldCount; i++) {
-        Value::Type type = fieldTypes[i].type();
-        uint32_t size;
-
-        if (type == Value::I8) {
-            size = 1;
-        } else if (type == Value::I16) {
-            size = 2;
-        } else {
-            size = static_cast<uint32_t>(valueSize(fieldTypes[i].type()));
+    if (superType != nullptr && inheritsLayout(superType)) {
+        // Fields of the super type must keep their offsets, since
+        // they are accessed through the offsets of the super type.
+        firstField = superType->fields().size();
+        holes.pushBack(FieldHole{ offset, superType->structSize() });
+        offset = superType->structSize();
+
+        for (size_t i = 0; i < firstField; i++) {
+            uint32_t size = structFieldSize(fieldTypes[i].type());
+            uint32_t fieldOffset = superType->fieldOffsets()[i];
+
+            if (align < size) {
+                align = size;
+            }
+
+            m_fieldOffsets[i] = fieldOffset;
+
+            for (size_t j = 0; j < holes.size(); j++) {
+                FieldHole& hole = holes[j];
+
+                if (fieldOffset >= hole.start && fieldOffset < hole.end) {
+                    if (fieldOffset + size < hole.end) {
+                        holes.pushBack(FieldHole{ fieldOffset + size, hole.end });
+                    }
+                    holes[j].end = fieldOffset;
+                    break;
+                }
+            }
         }
+    }
 
-        if (align < size) {
-            align = size;
+    // Larger fields are placed first, so padding is only needed before
+    // the first field and smaller fields are packed after each other.
+    // Unused bytes of the super type are reused by the new fields.
+    for (uint32_t size = 16; size > 0; size >>= 1) {
+        for (size_t i = firstField; i < fieldCount; i++) {
+            if (structFieldSize(fieldTypes[i].type()) != size) {
+                continue;
+            }
+
+            if (align < size) {
+                align = size;
+            }
+
+            uint64_t fieldOffset = 0;
+            for (size_t j = 0; j < holes.size(); j++) {
+                FieldHole& hole = holes[j];
+                uint64_t start = alignStructOffset(hole.start, size);
+
+                if (start + size <= hole.end) {
+                    fieldOffset = start;
+                    if (start > hole.start) {
+                        holes.pushBack(FieldHole{ hole.start, start });
+                    }
+                    holes[j].start = start + size;
+                    break;
+                }
+            }
+
+            if (fieldOffset == 0) {
+                fieldOffset = alignStructOffset(offset, size);
+                if (fieldOffset > offset) {
+                    holes.pushBack(FieldHole{ offset, fieldOffset });
+                }
+                offset = fieldOffset + size;
+
+                if (offset > std::numeric_limits<uint32_t>::max()) {
+                    return false;
+                }
+            }
+
+            m_fieldOffsets[i] = static_cast<uint32_t>(fieldOffset);
         }
+    }
 
-        uint32_t newOffset = (offset + (size - 1)) & ~(size - 1);
-        if (newOffset < offset) {
-            // Overflow check
-            return false;
-        }
+    uint64_t structSize = alignStructOffset(offset, align);
+    if (structSize > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    m_structSize = static_cast<uint32_t>(structSize);
 
-        m_fieldOffsets[i] = newOffset;
-        offset = newOffset + size;
+    // Size of the same structure when fields are stored in declaration order.
+    uint64_t declaredOffset = sizeof(GCStruct);
+    for (size_t i = 0; i < fieldCount; i++) {
+        uint32_t size = structFieldSize(fieldTypes[i].type());
+        declaredOffset = alignStructOffset(declaredOffset, size) + size;
     }
 
-    m_structSize = (offset + (align - 1)) & ~(align - 1);
-    // Overflow check
-    return m_structSize >= offset;
+    uint64_t declaredSize = alignStructOffset(declaredOffset, align);
+    m_savedBytes = declaredSize > structSize ? static_cast<uint32_t>(declaredSize - structSize) : 0;
+    return true;
 }
 
 GlobalType::GlobalType(const MutableType& type)
@@ -185,6 +185,7 @@ public:
         , m_resultStackSize(valueStackAllocatedSize(type))
     {
         m_resultTypes.setType(0, type);
+        initCallOffsets();
     }
 
     ~FunctionType()
@@ -202,8 +203,14 @@ public:
     {
         m_paramStackSize = computeStackSize(m_paramTypes);
         m_resultStackSize = computeStackSize(m_resultTypes);
+        initCallOffsets();
     }
 
+    // Stack offsets of the parameter slots followed by the result slots, when
+    // both the parameters and the results are stored from the start of a buffer.
+    // Computed once, and used when a function is called through the embedder API.
+    ByteCodeStackOffset* callOffsets() const { return const_cast<ByteCodeStackOffset*>(m_callOffsets.data()); }
+
     bool equals(const FunctionType* other, bool isSubType = false) const;
 
 private:
@@ -211,6 +218,24 @@ private:
     TypeVector m_resultTypes;
     size_t m_paramStackSize;
     size_t m_resultStackSize;
+    VectorWithFixedSize<ByteCodeStackOffset, std::allocator<ByteCodeStackOffset>> m_callOffsets;
+
+    void initCallOffsets()
+    {
+        size_t parameterOffsetSize = m_paramStackSize / sizeof(size_t);
+        size_t resultOffsetSize = m_resultStackSize / sizeof(size_t);
+
+        m_callOffsets.clear();
+        m_callOffsets.reserve(parameterOffsetSize + resultOffsetSize);
+
+        for (size_t i = 0; i < parameterOffsetSize; i++) {
+            m_callOffsets[i] = static_cast<ByteCodeStackOffset>(i * sizeof(size_t));
+        }
+
+        for (size_t i = 0; i < resultOffsetSize; i++) {
+            m_callOffsets[parameterOffsetSize + i] = static_cast<ByteCodeStackOffset>(i * sizeof(size_t));
+        }
+    }
 
     static size_t computeStackSize(const TypeVector& v)
     {
@@ -242,15 +267,22 @@ public:
         delete m_fieldTypes;
     }
 
-    bool initialize();
+    // Fields are reordered by size to reduce padding, while the
+    // fields inherited from superType keep their original offsets.
+    bool initialize(const StructType* superType);
 
     const MutableTypeVector& fields() const { return *m_fieldTypes; }
     uint32_t structSize() const { return m_structSize; }
+    // Bytes saved compared to storing the fields in declaration order.
+    uint32_t savedBytes() const { return m_savedBytes; }
     const VectorWithFixedSize<uint32_t, std::allocator<uint32_t>>& fieldOffsets() const { return m_fieldOffsets; }
 
 private:
+    bool inheritsLayout(const StructType* superType) const;
+
     MutableTypeVector* m_fieldTypes;
     uint32_t m_structSize;
+    uint32_t m_savedBytes;
     VectorWithFixedSize<uint32_t, std::allocator<uint32_t>> m_fieldOffsets;
 };
 
@@ -16,6 +16,7 @@
 #include "Walrus.h"
 
 #include "runtime/Store.h"
+#include "runtime/Engine.h"
 #include "runtime/Module.h"
 #include "runtime/Instance.h"
 #include "runtime/Component.h"
@@ -24,12 +25,16 @@
 
 #ifdef ENABLE_GC
 #include "GCUtil.h"
+#include <chrono>
 #endif /* ENABLE_GC */
 
 namespace Walrus {
 
 #ifndef NDEBUG
 size_t Extern::g_externCount;
+// Extern objects are counted globally, so they
+// can only be checked when the last store is gone.
+static size_t g_storeCount;
 #endif
 
 static const FunctionType g_defaultFunctionTypes[] = {
@@ -38,15 +43,192 @@ static const FunctionType g_defaultFunctionTypes[] = {
 #undef DEFINE_RESULT_TYPE
 };
 
+void GCStatistics::recordPause(uint64_t pauseTime)
+{
+    totalPauseTime += pauseTime;
+    if (maxPauseTime < pauseTime) {
+        maxPauseTime = pauseTime;
+    }
+
+    size_t bucket = 0;
+    uint64_t limit = 1000;
+    while (bucket < PauseHistogramSize - 1 && pauseTime >= limit) {
+        bucket++;
+        limit <<= 1;
+    }
+    pauseHistogram[bucket]++;
+}
+
+#ifdef ENABLE_GC
+static std::mutex s_gcInitLock;
+static bool s_gcInitialized;
+static GCOptions s_gcOptions;
+
+// These are only accessed while the allocation lock of the collector is held.
+Store* Store::s_firstStore;
+static bool s_hasStopWorldEvents;
+static std::chrono::steady_clock::time_point s_pauseStart;
+
+bool Store::setGCOptions(const GCOptions& options)
+{
+    std::lock_guard<std::mutex> guard(s_gcInitLock);
+    if (s_gcInitialized) {
+        return false;
+    }
+
+    s_gcOptions = options;
+    return true;
+}
+
+void Store::initializeGC()
+{
+    std::lock_guard<std::mutex> guard(s_gcInitLock);
+    if (s_gcInitialized) {
+        return;
+    }
+    s_gcInitialized = true;
+
+    if (s_gcOptions.markerThreads > 0) {
+        // Must be set before the collector is initialized.
+        GC_set_markers_count(s_gcOptions.markerThreads);
+    }
+
+    GC_INIT();
+
+    if (s_gcOptions.freeSpaceDivisor > 0) {
+        GC_set_free_space_divisor(s_gcOptions.freeSpaceDivisor);
+    }
+
+    if (s_gcOptions.maxHeapSize > 0) {
+        GC_set_max_heap_size(s_gcOptions.maxHeapSize);
+    }
+
+    if (s_gcOptions.initialHeapSize > GC_get_heap_size()) {
+        GC_expand_hp(s_gcOptions.initialHeapSize - GC_get_heap_size());
+    }
+
+    if (s_gcOptions.mode != GCOptions::Default) {
+        // Without a time limit, the incremental collector
+        // performs generational, but not incremental collections.
+        if (s_gcOptions.mode == GCOptions::Generational) {
+            GC_set_time_limit(GC_TIME_UNLIMITED);
+        }
+        GC_enable_incremental();
+    }
+
+    GC_set_on_collection_event(onCollectionEvent);
+}
+
+void* GC_CALLBACK Store::linkStore(void* data)
+{
+    Store* store = reinterpret_cast<Store*>(data);
+
+    store->m_gcBytesAtStart = GC_get_total_bytes();
+    store->m_nextStore = s_firstStore;
+    if (s_firstStore != nullptr) {
+        s_firstStore->m_prevStore = store;
+    }
+    s_firstStore = store;
+    return nullptr;
+}
+
+void* GC_CALLBACK Store::unlinkStore(void* data)
+{
+    Store* store = reinterpret_cast<Store*>(data);
+
+    if (store->m_prevStore != nullptr) {
+        store->m_prevStore->m_nextStore = store->m_nextStore;
+    } else {
+        s_firstStore = store->m_nextStore;
+    }
+
+    if (store->m_nextStore != nullptr) {
+        store->m_nextStore->m_prevStore = store->m_prevStore;
+    }
+    return nullptr;
+}
+
+void* GC_CALLBACK Store::copyStatistics(void* data)
+{
+    std::pair<const Store*, GCStatistics*>* request = reinterpret_cast<std::pair<const Store*, GCStatistics*>*>(data);
+    const Store* store = request->first;
+    GCStatistics* statistics = request->second;
+
+    *statistics = store->m_gcStatistics;
+    statistics->processBytesAllocated = GC_get_total_bytes() - store->m_gcBytesAtStart;
+    statistics->heapSize = GC_get_heap_size();
+    statistics->recursiveTypes = store->m_engine->typeStore().recursiveTypeCount();
+    return nullptr;
+}
+
+void GC_CALLBACK Store::onCollectionEvent(GC_EventType event)
+{
+    // The heap is shared, so every collection pauses all stores. Stop the
+    // world events are not reported when the collector has no thread support.
+    bool pauseEnd = false;
+
+    switch (event) {
+    case GC_EVENT_PRE_STOP_WORLD:
+        s_hasStopWorldEvents = true;
+        s_pauseStart = std::chrono::steady_clock::now();
+        return;
+    case GC_EVENT_POST_START_WORLD:
+        pauseEnd = true;
+        break;
+    case GC_EVENT_START:
+        TypeStore::onCollectionStart();
+        if (!s_hasStopWorldEvents) {
+            s_pauseStart = std::chrono::steady_clock::now();
+        }
+        return;
+    case GC_EVENT_MARK_END:
+        TypeStore::onMarkEnd();
+        return;
+    case GC_EVENT_END:
+        for (Store* store = s_firstStore; store != nullptr; store = store->m_nextStore) {
+            store->m_gcStatistics.collections++;
+        }
+        pauseEnd = !s_hasStopWorldEvents;
+        break;
+    default:
+        return;
+    }
+
+    if (pauseEnd) {
+        uint64_t pauseTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_pauseStart).count();
+
+        for (Store* store = s_firstStore; store != nullptr; store = store->m_nextStore) {
+            store->m_gcStatistics.recordPause(pauseTime);
+        }
+    }
+}
+#else /* !ENABLE_GC */
+bool Store::setGCOptions(const GCOptions&)
+{
+    return false;
+}
+#endif /* ENABLE_GC */
+
 Store::Store(Engine* engine)
     : m_engine(engine)
+#ifdef ENABLE_GC
+    , m_prevStore(nullptr)
+    , m_nextStore(nullptr)
+    , m_gcBytesAtStart(0)
+#endif
 #ifdef ENABLE_WASI
     , m_wasiData(nullptr)
+    , m_wasiContext(nullptr)
 #endif
 {
+#ifndef NDEBUG
+    g_storeCount++;
+#endif
+    m_engine->addRef();
     memset(m_definedFuncTypes, 0, sizeof(m_definedFuncTypes));
 #ifdef ENABLE_GC
-    GC_INIT();
+    initializeGC();
+    GC_call_with_alloc_lock(linkStore, this);
 #endif /* ENABLE_GC */
 }
 
@@ -65,8 +247,7 @@ Store::~Store()
     }
 
     for (size_t i = 0; i < m_modules.size(); i++) {
-        getTypeStore().releaseTypes(m_modules[i]->m_compositeTypes);
-        delete m_modules[i];
+        m_modules[i]->releaseRef();
     }
 
     for (size_t i = 0; i < m_componentInstances.size(); i++) {
@@ -88,16 +269,22 @@ Store::~Store()
     Store::finalize();
 
 #ifdef ENABLE_GC
+    GC_call_with_alloc_lock(unlinkStore, this);
     GC_gcollect_and_unmap();
     GC_invoke_finalizers();
 #endif /* ENABLE_GC */
+
+    m_engine->releaseRef();
 }
 
 void Store::finalize()
 {
 #ifndef NDEBUG
     // check if all Extern objects has been deallocated
-    ASSERT(Extern::g_externCount == 0);
+    ASSERT(g_storeCount > 0);
+    if (--g_storeCount == 0) {
+        ASSERT(Extern::g_externCount == 0);
+    }
 #endif
 }
 
@@ -106,6 +293,28 @@ FunctionType* Store::getDefaultFunctionType(Value::Type type)
     return const_cast<FunctionType*>(g_defaultFunctionTypes + static_cast<size_t>(type));
 }
 
+GCStatistics Store::gcStatistics() const
+{
+    GCStatistics statistics;
+#ifdef ENABLE_GC
+    std::pair<const Store*, GCStatistics*> request(this, &statistics);
+    GC_call_with_alloc_lock(copyStatistics, &request);
+#endif /* ENABLE_GC */
+    return statistics;
+}
+
+void Store::appendModule(Module* module)
+{
+    ASSERT(module->engine() == m_engine);
+    module->addRef();
+    m_modules.push_back(module);
+}
+
+TypeStore& Store::getTypeStore()
+{
+    return m_engine->typeStore();
+}
+
 Waiter* Store::getWaiter(void* address)
 {
     std::lock_guard<std::mutex> guard(m_waiterListLock);
@@ -306,7 +515,7 @@ FunctionType* Store::createDefinedFunctionType(DefinedFunctionType type)
 
     Vector<CompositeType*> typeList;
     typeList.push_back(functionType);
-    m_typeStore.updateTypes(typeList);
+    getTypeStore().updateTypes(typeList);
     functionType = typeList[0]->asFunction();
 
     m_definedFuncTypes[type] = functionType;
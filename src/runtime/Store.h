@@ -23,6 +23,14 @@
 #include <mutex>
 #include <condition_variable>
 
+#ifdef ENABLE_GC
+#include "GCUtil.h"
+#endif /* ENABLE_GC */
+
+#ifdef ENABLE_WASI
+struct uvwasi_s;
+#endif
+
 namespace Walrus {
 
 class Engine;
@@ -59,6 +67,65 @@ struct Waiter {
     std::vector<WaiterItem*> m_waiterItemList;
 };
 
+struct GCOptions {
+    enum Mode : uint8_t {
+        Default,
+        // Collections are split into small steps.
+        Incremental,
+        // Only recently allocated objects are marked by most collections.
+        Generational,
+    };
+
+    GCOptions()
+        : markerThreads(0)
+        , mode(Default)
+        , freeSpaceDivisor(0)
+        , initialHeapSize(0)
+        , maxHeapSize(0)
+    {
+    }
+
+    // Zero values keep the defaults of the collector.
+    uint32_t markerThreads;
+    Mode mode;
+    uint32_t freeSpaceDivisor;
+    size_t initialHeapSize;
+    size_t maxHeapSize;
+};
+
+struct GCStatistics {
+    // Pauses are counted in buckets of [2^(n-1), 2^n) milliseconds,
+    // the first bucket is below 1ms, the last one is unbounded.
+    static constexpr size_t PauseHistogramSize = 8;
+
+    GCStatistics()
+        : collections(0)
+        , totalPauseTime(0)
+        , maxPauseTime(0)
+        , processBytesAllocated(0)
+        , heapSize(0)
+        , recursiveTypes(0)
+    {
+        memset(pauseHistogram, 0, sizeof(pauseHistogram));
+    }
+
+    void recordPause(uint64_t pauseTime);
+
+    uint64_t collections;
+    // Pause times are in microseconds.
+    uint64_t totalPauseTime;
+    uint64_t maxPauseTime;
+    uint64_t pauseHistogram[PauseHistogramSize];
+    // The heap is shared by all stores, so these are process-wide values:
+    // bytes allocated by any store since this store was created, and the
+    // current size of the heap.
+    uint64_t processBytesAllocated;
+    uint64_t heapSize;
+    // Recursive type groups kept by the type store of the engine. Retired
+    // struct and array types are kept until a collection finds them unused.
+    uint64_t recursiveTypes;
+};
+
 class Store {
 public:
     enum DefinedFunctionType : uint8_t {
@@ -125,6 +192,9 @@ public:
     ~Store();
 
     static void finalize();
+    // The collector is shared by all stores, so its options must
+    // be set before the first store is created.
+    static bool setGCOptions(const GCOptions& options);
     static FunctionType* getDefaultFunctionType(Value::Type type);
 
     FunctionType* getDefinedFunctionType(DefinedFunctionType type)
@@ -135,11 +205,14 @@ public:
         return createDefinedFunctionType(type);
     }
 
-    void appendModule(Module* module)
+    Engine* engine() const
     {
-        m_modules.push_back(module);
+        return m_engine;
     }
 
+    // Modules are shared by the stores of the same engine.
+    void appendModule(Module* module);
+
     void appendInstance(Instance* instance)
     {
         m_instances.push_back(instance);
@@ -166,10 +239,7 @@ public:
         return m_instances.back();
     }
 
-    TypeStore& getTypeStore()
-    {
-        return m_typeStore;
-    }
+    TypeStore& getTypeStore();
 
     Waiter* getWaiter(void* address);
 
@@ -178,6 +248,9 @@ public:
         return m_context;
     }
 
+    // Collections and allocations since the store is created.
+    GCStatistics gcStatistics() const;
+
 #ifdef ENABLE_WASI
     WasiStoreData* wasiData() const
     {
@@ -189,13 +262,34 @@ public:
         ASSERT(m_wasiData == nullptr);
         m_wasiData = data;
     }
+
+    // State of the preview1 functions (file descriptors, arguments,
+    // environment), which is not shared with other stores.
+    uvwasi_s* wasiContext() const
+    {
+        return m_wasiContext;
+    }
+
+    void initWasiContext(uvwasi_s* context)
+    {
+        ASSERT(m_wasiContext == nullptr);
+        m_wasiContext = context;
+    }
 #endif
 
 private:
     FunctionType* createDefinedFunctionType(DefinedFunctionType type);
+#ifdef ENABLE_GC
+    static void initializeGC();
+    static void* GC_CALLBACK linkStore(void* data);
+    static void* GC_CALLBACK unlinkStore(void* data);
+    static void* GC_CALLBACK copyStatistics(void* data);
+    static void GC_CALLBACK onCollectionEvent(GC_EventType event);
+
+    static Store* s_firstStore;
+#endif
 
     Engine* m_engine;
-    TypeStore m_typeStore;
 
     FunctionType* m_definedFuncTypes[FUNC_TYPES_NUM];
 
@@ -209,8 +303,15 @@ private:
     std::vector<Waiter*> m_waiterList;
 
     ComponentContext* m_context;
+#ifdef ENABLE_GC
+    Store* m_prevStore;
+    Store* m_nextStore;
+    uint64_t m_gcBytesAtStart;
+    GCStatistics m_gcStatistics;
+#endif
 #ifdef ENABLE_WASI
     WasiStoreData* m_wasiData;
+    uvwasi_s* m_wasiContext;
 #endif
 };
 
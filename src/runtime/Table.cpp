@@ -84,42 +84,51 @@ void Table::grow(uint64_t newSize, void* val)
     m_size = newSize;
 }
 
-void Table::init(ExecutionState& state, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize)
+bool Table::init(ExecutionState& state, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize)
 {
     if (UNLIKELY((uint64_t)dstStart + (uint64_t)srcSize > (uint64_t)m_size)) {
-        throwException(state);
+        return setTrap(state, Exception::OutOfBoundsTableAccess);
     }
     if (UNLIKELY((srcStart + srcSize) > source->size())) {
-        throwException(state);
+        return setTrap(state, Exception::OutOfBoundsTableAccess);
     }
     if (UNLIKELY(!m_type.isRef())) {
-        Trap::throwException(state, "type mismatch");
+        return setTrap(state, Exception::TypeMismatch);
     }
 
     this->initTable(source, dstStart, srcStart, srcSize);
+    return true;
 }
 
-void Table::copy(ExecutionState& state, const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex)
+bool Table::copy(ExecutionState& state, const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex)
 {
     if (UNLIKELY(((uint64_t)srcIndex + (uint64_t)n > (uint64_t)srcTable->size()) || ((uint64_t)dstIndex + (uint64_t)n > (uint64_t)m_size))) {
-        throwException(state);
+        return setTrap(state, Exception::OutOfBoundsTableAccess);
     }
 
     this->copyTable(srcTable, n, srcIndex, dstIndex);
+    return true;
 }
 
-void Table::fill(ExecutionState& state, uint32_t n, void* value, uint32_t index)
+bool Table::fill(ExecutionState& state, uint32_t n, void* value, uint32_t index)
 {
     if ((uint64_t)index + (uint64_t)n > (uint64_t)m_size) {
-        throwException(state);
+        return setTrap(state, Exception::OutOfBoundsTableAccess);
     }
 
     this->fillTable(n, value, index);
+    return true;
 }
 
 void Table::throwException(ExecutionState& state) const
 {
-    Trap::throwException(state, "out of bounds table access");
+    Trap::throwException(Exception::OutOfBoundsTableAccess);
+}
+
+bool Table::setTrap(ExecutionState& state, uint8_t trapCode) const
+{
+    state.setTrap(trapCode);
+    return false;
 }
 
 void Table::initTable(ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize)
@@ -79,9 +79,10 @@ public:
     }
 
     void grow(uint64_t newSize, void* val);
-    void copy(ExecutionState& state, const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex);
-    void fill(ExecutionState& state, uint32_t n, void* value, uint32_t index);
-    void init(ExecutionState& state, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize);
+    // Bulk operations of the interpreter. Returns false if a trap is stored in the state.
+    bool copy(ExecutionState& state, const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex);
+    bool fill(ExecutionState& state, uint32_t n, void* value, uint32_t index);
+    bool init(ExecutionState& state, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize);
 
     void initTable(ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize);
     void copyTable(const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex);
@@ -91,6 +92,7 @@ private:
     Table(Type type, uint32_t initialSize, uint32_t maximumSize, void* init);
 
     void throwException(ExecutionState& state) const;
+    bool setTrap(ExecutionState& state, uint8_t trapCode) const;
 
     // Table has elements of reference type (FuncRef | ExternRef)
     Type m_type;
@@ -29,13 +29,19 @@ Trap::Trap()
 Trap::TrapResult Trap::run(void (*runner)(ExecutionState&, void*), void* data)
 {
     Trap::TrapResult r;
+    ExecutionState::TrapStatus trapStatus;
     try {
-        ExecutionState state;
+        ExecutionState state(&trapStatus);
         runner(state, data);
     } catch (std::unique_ptr<Exception>& e) {
         r.exception = std::move(e);
+        return r;
     }
 
+    // The exception is only created when a trap is returned by the runner.
+    if (UNLIKELY(trapStatus.trapCode != Exception::NoTrap)) {
+        r.exception = Exception::create(static_cast<Exception::TrapCode>(trapStatus.trapCode), trapStatus.detail[0], trapStatus.detail[1]);
+    }
     return r;
 }
 
@@ -49,6 +55,11 @@ void Trap::throwException(ExecutionState& state, const std::string& message)
     throw Exception::create(state, message);
 }
 
+void Trap::throwException(Exception::TrapCode trapCode, uint64_t detail1, uint64_t detail2)
+{
+    throw Exception::create(trapCode, detail1, detail2);
+}
+
 void Trap::throwException(ExecutionState& state, Tag* tag, Vector<uint8_t>&& userExceptionData)
 {
     throw Exception::create(state, tag, std::move(userExceptionData));
@@ -59,4 +70,13 @@ void Trap::throwException(ExecutionState& state, std::unique_ptr<Exception>&& e)
     throw std::move(e);
 }
 
+void Trap::throwTrap(ExecutionState& state)
+{
+    ASSERT(state.hasTrap());
+    ExecutionState::TrapStatus* trapStatus = state.m_trapStatus;
+    Exception::TrapCode trapCode = static_cast<Exception::TrapCode>(trapStatus->trapCode);
+    trapStatus->trapCode = Exception::NoTrap;
+    throw Exception::create(trapCode, trapStatus->detail[0], trapStatus->detail[1]);
+}
+
 } // namespace Walrus
@@ -43,8 +43,11 @@ public:
     TrapResult run(void (*runner)(ExecutionState&, void*), void* data);
     static void throwException(const std::string& message);
     static void throwException(ExecutionState& state, const std::string& message);
+    static void throwException(Exception::TrapCode trapCode, uint64_t detail1 = 0, uint64_t detail2 = 0);
     static void throwException(ExecutionState& state, Tag* tag, Vector<uint8_t>&& userExceptionData);
     static void throwException(ExecutionState& state, std::unique_ptr<Exception>&& e);
+    // Throws the trap stored in the state, and clears it.
+    static void throwTrap(ExecutionState& state);
 };
 
 } // namespace Walrus
@@ -28,11 +28,20 @@
 
 namespace Walrus {
 
+#ifdef ENABLE_GC
+// These are only accessed while the allocation lock of the collector is held,
+// or by the thread which uses the engine, see the thread restriction of Engine.
+TypeStore* TypeStore::s_firstTypeStore;
+static uint64_t s_collectionEpoch;
+static uintptr_t s_structVirtualTable;
+static uintptr_t s_arrayVirtualTable;
+#endif /* ENABLE_GC */
+
 RecursiveType* RecursiveType::create(TypeStore* typeStore, RecursiveType* next, CompositeType* firstType,
                                      size_t typeCount, size_t hashCode, size_t totalSubTypeSize)
 {
     RecursiveType* result = reinterpret_cast<RecursiveType*>(malloc(sizeof(RecursiveType) + (totalSubTypeSize - 1) * sizeof(CompositeType*)));
-    new (result) RecursiveType(typeStore, next, firstType, typeCount, hashCode);
+    new (result) RecursiveType(typeStore, next, firstType, typeCount, hashCode, totalSubTypeSize);
     return result;
 }
 
@@ -284,6 +293,10 @@ const CompositeType** TypeStore::updateRefs(CompositeType* type, const Vector<Co
 
 void TypeStore::updateTypes(Vector<CompositeType*>& types)
 {
+#ifdef ENABLE_GC
+    destroyUnusedTypes();
+#endif
+
     // Iterate through each recursive types
     size_t size = types.size();
     size_t typeCount = 0;
@@ -336,7 +349,12 @@ void TypeStore::updateTypes(Vector<CompositeType*>& types)
                 compType = next;
             } while (compType != nullptr);
 
-            ASSERT(current->m_refCount > 0);
+            // Retired types (see retireRecursiveType) have zero references.
+#ifdef ENABLE_GC
+            if (current->m_refCount == 0) {
+                reviveRecursiveType(current);
+            }
+#endif
             current->m_refCount++;
             continue;
         }
@@ -379,6 +397,25 @@ void TypeStore::updateTypes(Vector<CompositeType*>& types)
     }
 }
 
+TypeStore::~TypeStore()
+{
+#ifdef ENABLE_GC
+    if (m_isLinked) {
+        GC_call_with_alloc_lock(unlinkTypeStore, this);
+    }
+#endif
+
+    RecursiveType* current = m_first;
+
+    while (current != nullptr) {
+        RecursiveType* next = current->m_next;
+        if (current->m_refCount == 0) {
+            destroyRecursiveType(current);
+        }
+        current = next;
+    }
+}
+
 void TypeStore::destroyRecursiveType(RecursiveType* recType)
 {
     ASSERT(recType->m_refCount == 0);
@@ -405,6 +442,34 @@ void TypeStore::destroyRecursiveType(RecursiveType* recType)
     RecursiveType::destroy(recType);
 }
 
+void TypeStore::retireRecursiveType(RecursiveType* recType)
+{
+    ASSERT(recType->m_refCount == 0);
+
+#ifdef ENABLE_GC
+    // Struct and array objects only hold a pointer to their type and have
+    // no finalizers, so these types are freed after a collection finds no
+    // objects of them, see takeCensus.
+    CompositeType* current = recType->m_firstType;
+
+    do {
+        if (current->kind() != ObjectType::FunctionKind) {
+            if (!m_isLinked) {
+                GC_call_with_alloc_lock(linkTypeStore, this);
+            }
+
+            recType->m_retiredEpoch = s_collectionEpoch;
+            recType->m_unused = false;
+            m_retiredTypes.insert(findRetiredType(recType->m_subTypes), recType);
+            return;
+        }
+        current = current->getNextType();
+    } while (current != nullptr);
+#endif
+
+    destroyRecursiveType(recType);
+}
+
 void TypeStore::releaseTypes(Vector<CompositeType*>& types)
 {
     size_t size = types.size();
@@ -431,12 +496,165 @@ void TypeStore::ReleaseRef(const CompositeType** typeInfo)
     ASSERT(index > 0);
     RecursiveType* recType = typeInfo[index]->getRecursiveType();
     if (--recType->m_refCount == 0) {
-        recType->m_typeStore->destroyRecursiveType(recType);
+        recType->m_typeStore->retireRecursiveType(recType);
     }
 }
 
 #ifdef ENABLE_GC
 
+size_t TypeStore::recursiveTypeCount() const
+{
+    size_t count = 0;
+
+    for (RecursiveType* current = m_first; current != nullptr; current = current->m_next) {
+        count++;
+    }
+    return count;
+}
+
+void TypeStore::onCollectionStart()
+{
+    s_collectionEpoch++;
+}
+
+void TypeStore::onMarkEnd()
+{
+    // Types retired before the collection started have no new objects, so
+    // they are unused if none of their objects are marked. The census is
+    // only taken when there are such types.
+    bool hasCandidates = false;
+
+    for (TypeStore* typeStore = s_firstTypeStore; typeStore != nullptr; typeStore = typeStore->m_nextTypeStore) {
+        size_t size = typeStore->m_retiredTypes.size();
+
+        for (size_t i = 0; i < size; i++) {
+            RecursiveType* recType = typeStore->m_retiredTypes[i];
+
+            if (recType->m_retiredEpoch < s_collectionEpoch && !recType->m_unused) {
+                recType->m_unused = true;
+                hasCandidates = true;
+            }
+        }
+    }
+
+    if (hasCandidates) {
+        GC_enumerate_reachable_objects_inner(takeCensus, nullptr);
+    }
+}
+
+void GC_CALLBACK TypeStore::takeCensus(void* object, size_t bytes, void* data)
+{
+    UNUSED_PARAMETER(data);
+
+    if (bytes < sizeof(GCBase)) {
+        return;
+    }
+
+    uintptr_t virtualTable = *reinterpret_cast<uintptr_t*>(object);
+    if (virtualTable != s_structVirtualTable && virtualTable != s_arrayVirtualTable) {
+        return;
+    }
+
+    // Conservatively retained objects may have freed types,
+    // so only the address of the type information is used.
+    const CompositeType** typeInfo = reinterpret_cast<Object*>(object)->typeInfo();
+
+    for (TypeStore* typeStore = s_firstTypeStore; typeStore != nullptr; typeStore = typeStore->m_nextTypeStore) {
+        size_t index = typeStore->findRetiredType(typeInfo);
+
+        if (index > 0) {
+            RecursiveType* recType = typeStore->m_retiredTypes[index - 1];
+
+            if (reinterpret_cast<uintptr_t>(typeInfo) < reinterpret_cast<uintptr_t>(recType->m_subTypes + recType->m_subTypeSize)) {
+                recType->m_unused = false;
+                return;
+            }
+        }
+    }
+}
+
+void* GC_CALLBACK TypeStore::linkTypeStore(void* data)
+{
+    TypeStore* typeStore = reinterpret_cast<TypeStore*>(data);
+
+    if (s_structVirtualTable == 0) {
+        s_structVirtualTable = GCStruct::virtualTablePointer();
+        s_arrayVirtualTable = GCArray::virtualTablePointer();
+    }
+
+    typeStore->m_isLinked = true;
+    typeStore->m_nextTypeStore = s_firstTypeStore;
+    if (s_firstTypeStore != nullptr) {
+        s_firstTypeStore->m_prevTypeStore = typeStore;
+    }
+    s_firstTypeStore = typeStore;
+    return nullptr;
+}
+
+void* GC_CALLBACK TypeStore::unlinkTypeStore(void* data)
+{
+    TypeStore* typeStore = reinterpret_cast<TypeStore*>(data);
+
+    if (typeStore->m_prevTypeStore != nullptr) {
+        typeStore->m_prevTypeStore->m_nextTypeStore = typeStore->m_nextTypeStore;
+    } else {
+        s_firstTypeStore = typeStore->m_nextTypeStore;
+    }
+
+    if (typeStore->m_nextTypeStore != nullptr) {
+        typeStore->m_nextTypeStore->m_prevTypeStore = typeStore->m_prevTypeStore;
+    }
+    return nullptr;
+}
+
+size_t TypeStore::findRetiredType(const CompositeType** typeInfo) const
+{
+    // Returns with the index of the first retired type whose
+    // subtype array starts after typeInfo.
+    uintptr_t address = reinterpret_cast<uintptr_t>(typeInfo);
+    size_t low = 0;
+    size_t high = m_retiredTypes.size();
+
+    while (low < high) {
+        size_t middle = (low + high) >> 1;
+
+        if (reinterpret_cast<uintptr_t>(m_retiredTypes[middle]->m_subTypes) <= address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void TypeStore::reviveRecursiveType(RecursiveType* recType)
+{
+    size_t index = findRetiredType(recType->m_subTypes);
+
+    ASSERT(index > 0 && m_retiredTypes[index - 1] == recType);
+    m_retiredTypes.erase(index - 1);
+}
+
+void TypeStore::destroyUnusedTypes()
+{
+    size_t size = m_retiredTypes.size();
+    size_t count = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        RecursiveType* recType = m_retiredTypes[i];
+
+        if (recType->m_unused) {
+            destroyRecursiveType(recType);
+        } else {
+            m_retiredTypes[count++] = recType;
+        }
+    }
+
+    if (count < size) {
+        m_retiredTypes.erase(count, size);
+    }
+}
+
 void TypeStore::insertRootRef(GCBase* object)
 {
     if (m_rootRefsFreeListHead == NoIndex) {
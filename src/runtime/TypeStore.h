@@ -23,6 +23,10 @@
 #include "runtime/Type.h"
 #include "runtime/Value.h"
 
+#ifdef ENABLE_GC
+#include "GCUtil.h"
+#endif /* ENABLE_GC */
+
 namespace Walrus {
 
 class Module;
@@ -48,7 +52,7 @@ public:
     }
 
 private:
-    RecursiveType(TypeStore* typeStore, RecursiveType* next, CompositeType* firstType, size_t typeCount, size_t hashCode)
+    RecursiveType(TypeStore* typeStore, RecursiveType* next, CompositeType* firstType, size_t typeCount, size_t hashCode, size_t subTypeSize)
         : m_typeStore(typeStore)
         , m_next(next)
         , m_prev(nullptr)
@@ -56,6 +60,11 @@ private:
         , m_refCount(1)
         , m_typeCount(typeCount)
         , m_hashCode(hashCode)
+        , m_subTypeSize(subTypeSize)
+#ifdef ENABLE_GC
+        , m_retiredEpoch(0)
+        , m_unused(false)
+#endif
     {
     }
 
@@ -72,10 +81,18 @@ private:
     size_t m_refCount;
     size_t m_typeCount;
     size_t m_hashCode;
+    size_t m_subTypeSize;
+#ifdef ENABLE_GC
+    // See TypeStore::takeCensus.
+    uint64_t m_retiredEpoch;
+    bool m_unused;
+#endif
     // Concatenation of subtype arrays used by all types
     const CompositeType* m_subTypes[1];
 };
 
+// The type store is shared by the stores of an engine. It is not
+// locked, see the thread restriction of Engine.
 class TypeStore {
 public:
     static constexpr uintptr_t NoIndex = ~static_cast<uintptr_t>(0);
@@ -87,10 +104,15 @@ public:
         , m_refCounts(nullptr)
         , m_rootRefsSize(0)
         , m_rootRefsFreeListHead(NoIndex)
+        , m_nextTypeStore(nullptr)
+        , m_prevTypeStore(nullptr)
+        , m_isLinked(false)
 #endif
     {
     }
 
+    ~TypeStore();
+
     static void ConnectTypes(Vector<CompositeType*>& types, size_t index)
     {
         types[index - 1]->m_nextType = types[index];
@@ -100,14 +122,16 @@ public:
     void releaseTypes(Vector<CompositeType*>& types);
     void releaseTypes(CompositeTypeVector& types);
 
-    static void AddRef(const CompositeType* type)
-    {
-        type->getRecursiveType()->m_refCount++;
-    }
-
     static void ReleaseRef(const CompositeType** typeInfo);
 
 #ifdef ENABLE_GC
+    // Number of recursive type groups, including the retired ones.
+    size_t recursiveTypeCount() const;
+
+    // Called by Store::onCollectionEvent while the allocation lock is held.
+    static void onCollectionStart();
+    static void onMarkEnd();
+
     inline void addRef(GCBase* object)
     {
         if (object->m_refIndex != GCBase::UnassignedReference) {
@@ -134,17 +158,28 @@ private:
 
     static const CompositeType** updateRefs(CompositeType* type, const Vector<CompositeType*>& types, const CompositeType** nextSubType);
     void destroyRecursiveType(RecursiveType* recType);
+    void retireRecursiveType(RecursiveType* recType);
 
     void releaseRecursiveType(RecursiveType* recType)
     {
         if (--recType->m_refCount == 0) {
-            destroyRecursiveType(recType);
+            retireRecursiveType(recType);
         }
     }
 
 #ifdef ENABLE_GC
     void insertRootRef(GCBase* object);
     void deleteRootRef(GCBase* object);
+
+    size_t findRetiredType(const CompositeType** typeInfo) const;
+    void reviveRecursiveType(RecursiveType* recType);
+    void destroyUnusedTypes();
+
+    static void* GC_CALLBACK linkTypeStore(void* data);
+    static void* GC_CALLBACK unlinkTypeStore(void* data);
+    static void GC_CALLBACK takeCensus(void* object, size_t bytes, void* data);
+
+    static TypeStore* s_firstTypeStore;
 #endif
 
     RecursiveType* m_first;
@@ -154,6 +189,13 @@ private:
     size_t* m_refCounts;
     size_t m_rootRefsSize;
     size_t m_rootRefsFreeListHead;
+
+    TypeStore* m_nextTypeStore;
+    TypeStore* m_prevTypeStore;
+    bool m_isLinked;
+    // Retired recursive types which contain struct or array
+    // types, sorted by the address of their subtype arrays.
+    Vector<RecursiveType*> m_retiredTypes;
 #endif
 };
 
@@ -41,18 +41,26 @@ struct spectestseps : std::numpunct<char> {
 
 struct ParseOptions {
     std::string exportToRun;
+    uint64_t exportRunCount = 1;
+    std::string exportArgs;
     std::vector<std::string> fileNames;
+    Walrus::GCOptions gcOptions;
+    bool printGCStatistics = false;
+    Walrus::EngineOptions engineOptions;
 
     // WASI options
 #ifdef ENABLE_WASI
     std::vector<const char*> wasi_envs;
     Walrus::Wasi02DirMap wasi_dirs;
+    std::vector<std::pair<std::string, int>> wasi_sockets;
+    bool wasi_inherit_network = false;
     int argsIndex = -1;
 #endif
 };
 
 static uint32_t s_JITFlags = 0;
 static uint32_t s_FeatureFlags = 0;
+static bool s_printByteCodeStatistics = false;
 
 using namespace Walrus;
 
@@ -157,6 +165,23 @@ static ExternalValue* findExternalValue(size_t value)
     return externalValues.back();
 }
 
+static void printByteCodeStatistics(const std::string& filename, Module* module)
+{
+    ByteCodeStatistics statistics = module->byteCodeStatistics();
+
+#if defined(WALRUS_COMPACT_BYTECODE)
+    const char* encoding = "compact";
+#else
+    const char* encoding = "default";
+#endif
+    fprintf(stderr, "%s: %zu functions, %zu instructions, %zu bytes of byte code (%s encoding",
+            filename.c_str(), statistics.functionCount, statistics.instructionCount, statistics.byteCodeSize, encoding);
+    if (statistics.instructionCount > 0) {
+        fprintf(stderr, ", %.1f bytes per instruction", static_cast<double>(statistics.byteCodeSize) / statistics.instructionCount);
+    }
+    fprintf(stderr, ")\n");
+}
+
 static Trap::TrapResult executeWASM(Store* store, const std::string& filename, const std::vector<uint8_t>& src,
                                     std::map<std::string, Instance*>* registeredInstanceMap = nullptr)
 {
@@ -168,6 +193,10 @@ static Trap::TrapResult executeWASM(Store* store, const std::string& filename, c
     }
 
     auto module = parseResult.first;
+    if (s_printByteCodeStatistics) {
+        printByteCodeStatistics(filename, module.value());
+    }
+
     const auto& importTypes = module->imports();
 
     ExternVector importValues;
@@ -332,14 +361,15 @@ static Trap::TrapResult executeWASM(Store* store, const std::string& filename, c
     }
 
     struct RunData {
+        Store* store;
         Module* module;
         ExternVector& importValues;
         bool hasWasiImport;
-    } data = { module.value(), importValues, hasWasiImport };
+    } data = { store, module.value(), importValues, hasWasiImport };
     Walrus::Trap trap;
     return trap.run([](ExecutionState& state, void* d) {
         RunData* data = reinterpret_cast<RunData*>(d);
-        Instance* instance = data->module->instantiate(state, data->importValues);
+        Instance* instance = data->module->instantiate(state, data->store, data->importValues);
 
 #ifdef ENABLE_WASI
         if (data->hasWasiImport) {
@@ -363,7 +393,9 @@ static Trap::TrapResult executeWASM(Store* store, const std::string& filename, c
                     }
 
 
-                    fn->call(state, nullptr, nullptr);
+                    if (!fn->tryCall(state, nullptr, nullptr)) {
+                        return;
+                    }
                 }
             }
         }
@@ -745,7 +777,9 @@ static void executeInvokeAction(wabt::InvokeAction* action, Walrus::Function* fn
         RunData* data = reinterpret_cast<RunData*>(d);
         Walrus::ValueVector result;
         result.resize(data->fn->functionType()->result().size());
-        data->fn->call(state, data->args.data(), result.data());
+        if (!data->fn->tryCall(state, data->args.data(), result.data())) {
+            return;
+        }
         if (data->expectedResult.size()) {
             int errorIndex = -1;
 
@@ -875,6 +909,7 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
                 if (trapResult.exception) {
                     std::string& errorMessage = trapResult.exception->message();
                     printf("Error: %s\n", errorMessage.c_str());
+                    RELEASE_ASSERT_NOT_REACHED();
                 }
             }
         }
@@ -1106,7 +1141,60 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
     }
 }
 
-static void runExports(Store* store, const std::string& filename, const std::vector<uint8_t>& src, std::string& exportToRun)
+// Parses the comma separated list of numbers passed to --run-export-args.
+static bool parseExportArgs(const std::string& args, const TypeVector::Types& types, ValueVector& values)
+{
+    const char* current = args.c_str();
+
+    for (size_t i = 0; i < types.size(); i++) {
+        char* end;
+        errno = 0;
+
+        switch (types[i]) {
+        case Value::I32: {
+            long long value = strtoll(current, &end, 0);
+            if (value < INT32_MIN || value > UINT32_MAX) {
+                return false;
+            }
+            values.push_back(Value(static_cast<int32_t>(value)));
+            break;
+        }
+        case Value::I64: {
+            long long value;
+            if (*current == '-') {
+                value = strtoll(current, &end, 0);
+            } else {
+                value = static_cast<long long>(strtoull(current, &end, 0));
+            }
+            values.push_back(Value(static_cast<int64_t>(value)));
+            break;
+        }
+        case Value::F32:
+            values.push_back(Value(strtof(current, &end)));
+            break;
+        case Value::F64:
+            values.push_back(Value(strtod(current, &end)));
+            break;
+        default:
+            return false;
+        }
+
+        if (end == current || errno == ERANGE) {
+            return false;
+        }
+
+        if (i + 1 < types.size()) {
+            if (*end != ',') {
+                return false;
+            }
+            end++;
+        }
+        current = end;
+    }
+    return *current == '\0';
+}
+
+static void runExports(Store* store, const std::string& filename, const std::vector<uint8_t>& src, std::string& exportToRun, uint64_t runCount, const std::string& exportArgs)
 {
     auto parseResult = WASMParser::parseBinary(store, filename, src.data(), src.size(), s_JITFlags);
     if (!parseResult.second.empty()) {
@@ -1115,6 +1203,10 @@ static void runExports(Store* store, const std::string& filename, const std::vec
     }
 
     auto module = parseResult.first;
+    if (s_printByteCodeStatistics) {
+        printByteCodeStatistics(filename, module.value());
+    }
+
     const auto& importTypes = module->imports();
     ExternVector importValues;
     importValues.reserve(importTypes.size());
@@ -1144,15 +1236,20 @@ static void runExports(Store* store, const std::string& filename, const std::vec
     }
 
     struct RunData {
+        Store* store;
         Module* module;
         ExternVector& importValues;
         std::string* exportToRun;
-    } data = { module.value(), importValues, &exportToRun };
+        const std::string* exportArgs;
+        uint64_t runCount;
+        uint64_t runIndex;
+    } data = { store, module.value(), importValues, &exportToRun, &exportArgs, runCount, 0 };
     Walrus::Trap trap;
 
-    trap.run([](ExecutionState& state, void* d) {
+    // All calls share one execution state and trap handler.
+    auto trapResult = trap.run([](ExecutionState& state, void* d) {
         auto data = reinterpret_cast<RunData*>(d);
-        Instance* instance = data->module->instantiate(state, data->importValues);
+        Instance* instance = data->module->instantiate(state, data->store, data->importValues);
 
         for (auto&& exp : data->module->exports()) {
             if (exp->exportType() == ExportType::Function) {
@@ -1163,14 +1260,24 @@ static void runExports(Store* store, const std::string& filename, const std::vec
                 auto fn = instance->function(exp->itemIndex());
                 FunctionType* fnType = fn->asDefinedFunction()->moduleFunction()->functionType();
 
-                if (fnType->param().size() != 0) {
-                    printf("warning: function %s has params, but params are not supported\n", exp->name().c_str());
-                    return;
+                Walrus::ValueVector args;
+                if (fnType->param().size() != 0 || !data->exportArgs->empty()) {
+                    args.reserve(fnType->param().size());
+                    if (!parseExportArgs(*data->exportArgs, fnType->param().types(), args)) {
+                        fprintf(stderr, "error: --run-export-args must list a number for each of the %zu parameters of %s\n",
+                                fnType->param().size(), exp->name().c_str());
+                        return;
+                    }
                 }
 
+                // Every call of the batch receives the same arguments.
                 Walrus::ValueVector result;
                 result.resize(fnType->result().size());
-                fn->call(state, nullptr, result.data());
+                for (data->runIndex = 0; data->runIndex < data->runCount; data->runIndex++) {
+                    if (!fn->tryCall(state, args.data(), result.data())) {
+                        return;
+                    }
+                }
 
                 for (auto&& r : result) {
                     switch (r.type()) {
@@ -1198,9 +1305,76 @@ static void runExports(Store* store, const std::string& filename, const std::vec
             }
         }
     },
-             &data);
+                               &data);
+
+    if (trapResult.exception) {
+        if (runCount > 1) {
+            fprintf(stderr, "Uncaught Exception in call %" PRIu64 ": %s\n", data.runIndex, trapResult.exception->message().data());
+        } else {
+            fprintf(stderr, "Uncaught Exception: %s\n", trapResult.exception->message().data());
+        }
+    }
 }
 
+static uint64_t parseNumberArgument(int argc, const char* argv[], int& i, bool allowSizeSuffix)
+{
+    if (i + 1 == argc || argv[i + 1][0] == '-') {
+        fprintf(stderr, "error: %s requires an argument\n", argv[i]);
+        exit(1);
+    }
+
+    char* end;
+    uint64_t value = strtoull(argv[i + 1], &end, 10);
+
+    if (allowSizeSuffix) {
+        switch (*end) {
+        case 'g':
+        case 'G':
+            value <<= 10;
+            FALLTHROUGH;
+        case 'm':
+        case 'M':
+            value <<= 10;
+            FALLTHROUGH;
+        case 'k':
+        case 'K':
+            value <<= 10;
+            end++;
+            break;
+        }
+    }
+
+    if (end == argv[i + 1] || *end != '\0') {
+        fprintf(stderr, "error: invalid argument for %s: %s\n", argv[i], argv[i + 1]);
+        exit(1);
+    }
+
+    ++i;
+    return value;
+}
+
+#ifdef ENABLE_GC
+static void printGCStatistics(Store* store)
+{
+    GCStatistics statistics = store->gcStatistics();
+
+    fprintf(stderr, "GC collections: %" PRIu64 "\n", statistics.collections);
+    fprintf(stderr, "GC pause time: total %" PRIu64 "us, max %" PRIu64 "us\n", statistics.totalPauseTime, statistics.maxPauseTime);
+    for (size_t i = 0; i < GCStatistics::PauseHistogramSize; i++) {
+        if (i == 0) {
+            fprintf(stderr, "    < 1ms: %" PRIu64 "\n", statistics.pauseHistogram[i]);
+        } else if (i == GCStatistics::PauseHistogramSize - 1) {
+            fprintf(stderr, "    >= %ums: %" PRIu64 "\n", 1u << (i - 1), statistics.pauseHistogram[i]);
+        } else {
+            fprintf(stderr, "    < %ums: %" PRIu64 "\n", 1u << i, statistics.pauseHistogram[i]);
+        }
+    }
+    fprintf(stderr, "GC bytes allocated by the process: %" PRIu64 "\n", statistics.processBytesAllocated);
+    fprintf(stderr, "GC heap size: %" PRIu64 "\n", statistics.heapSize);
+    fprintf(stderr, "GC recursive types: %" PRIu64 "\n", statistics.recursiveTypes);
+}
+#endif
+
 static void parseArguments(int argc, const char* argv[], ParseOptions& options)
 {
     for (int i = 1; i < argc; i++) {
@@ -1214,9 +1388,27 @@ static void parseArguments(int argc, const char* argv[], ParseOptions& options)
                     ++i;
                     options.exportToRun = argv[i];
                     continue;
+                } else if (strcmp(argv[i], "--run-export-args") == 0) {
+                    if (i + 1 == argc) {
+                        fprintf(stderr, "error: --run-export-args requires an argument\n");
+                        exit(1);
+                    }
+                    ++i;
+                    options.exportArgs = argv[i];
+                    continue;
+                } else if (strcmp(argv[i], "--run-export-count") == 0) {
+                    options.exportRunCount = parseNumberArgument(argc, argv, i, false);
+                    if (options.exportRunCount == 0) {
+                        fprintf(stderr, "error: --run-export-count must be at least 1\n");
+                        exit(1);
+                    }
+                    continue;
                 } else if (strcmp(argv[i], "--enable-web-assembly3") == 0) {
                     s_FeatureFlags |= wabt::FeatureFlagValue::enableWebAssembly3;
                     continue;
+                } else if (strcmp(argv[i], "--optimize-bytecode") == 0) {
+                    s_JITFlags |= JITFlagValue::optimizeByteCode;
+                    continue;
 #if defined(WALRUS_ENABLE_JIT)
                 } else if (strcmp(argv[i], "--jit") == 0) {
                     s_JITFlags |= JITFlagValue::useJIT;
@@ -1230,7 +1422,42 @@ static void parseArguments(int argc, const char* argv[], ParseOptions& options)
                 } else if (strcmp(argv[i], "--jit-no-reg-alloc") == 0) {
                     s_JITFlags |= JITFlagValue::disableRegAlloc;
                     continue;
+                } else if (strcmp(argv[i], "--jit-linear-scan") == 0) {
+                    s_JITFlags |= JITFlagValue::linearScanRegAlloc;
+                    continue;
+#endif
+#ifdef ENABLE_GC
+                } else if (strcmp(argv[i], "--gc-markers") == 0) {
+                    options.gcOptions.markerThreads = static_cast<uint32_t>(parseNumberArgument(argc, argv, i, false));
+                    continue;
+                } else if (strcmp(argv[i], "--gc-incremental") == 0) {
+                    options.gcOptions.mode = GCOptions::Incremental;
+                    continue;
+                } else if (strcmp(argv[i], "--gc-generational") == 0) {
+                    options.gcOptions.mode = GCOptions::Generational;
+                    continue;
+                } else if (strcmp(argv[i], "--gc-free-space-divisor") == 0) {
+                    options.gcOptions.freeSpaceDivisor = static_cast<uint32_t>(parseNumberArgument(argc, argv, i, false));
+                    continue;
+                } else if (strcmp(argv[i], "--gc-initial-heap") == 0) {
+                    options.gcOptions.initialHeapSize = static_cast<size_t>(parseNumberArgument(argc, argv, i, true));
+                    continue;
+                } else if (strcmp(argv[i], "--gc-max-heap") == 0) {
+                    options.gcOptions.maxHeapSize = static_cast<size_t>(parseNumberArgument(argc, argv, i, true));
+                    continue;
+                } else if (strcmp(argv[i], "--gc-stats") == 0) {
+                    options.printGCStatistics = true;
+                    continue;
 #endif
+                } else if (strcmp(argv[i], "--bytecode-stats") == 0) {
+                    s_printByteCodeStatistics = true;
+                    continue;
+                } else if (strcmp(argv[i], "--memory-huge-pages") == 0) {
+                    options.engineOptions.memoryFlags |= MemoryFlagValue::memoryHugePages;
+                    continue;
+                } else if (strcmp(argv[i], "--memory-prefault") == 0) {
+                    options.engineOptions.memoryFlags |= MemoryFlagValue::memoryPrefault;
+                    continue;
                 } else if (strcmp(argv[i], "--env") == 0) {
                     if (i + 1 == argc || argv[i + 1][0] == '-') {
                         fprintf(stderr, "error: --env requires an argument\n");
@@ -1248,10 +1475,34 @@ static void parseArguments(int argc, const char* argv[], ParseOptions& options)
                     }
                     // pair of (mapped path, real_path)
 #ifdef ENABLE_WASI
-                    options.wasi_dirs.push_back(Wasi02DirMapEntry{ argv[i + 2], argv[i + 1] });
+                    options.wasi_dirs.push_back(Wasi02DirMapEntry{ argv[i + 2], argv[i + 1], nullptr });
 #endif
                     i += 2;
                     continue;
+                } else if (strcmp(argv[i], "--tcplisten") == 0) {
+                    const char* port = i + 1 < argc ? strrchr(argv[i + 1], ':') : nullptr;
+                    if (port == nullptr || port == argv[i + 1] || port[1] == '\0') {
+                        fprintf(stderr, "error: --tcplisten requires an <ADDRESS:PORT> argument\n");
+                        exit(1);
+                    }
+
+                    char* end;
+                    errno = 0;
+                    long portNumber = strtol(port + 1, &end, 10);
+                    if (!isdigit(static_cast<unsigned char>(port[1])) || *end != '\0' || errno == ERANGE || portNumber < 1 || portNumber > 65535) {
+                        fprintf(stderr, "error: invalid port for --tcplisten: %s\n", port + 1);
+                        exit(1);
+                    }
+                    ++i;
+#ifdef ENABLE_WASI
+                    options.wasi_sockets.push_back(std::make_pair(std::string(argv[i], port - argv[i]), static_cast<int>(portNumber)));
+#endif
+                    continue;
+                } else if (strcmp(argv[i], "--inherit-network") == 0) {
+#ifdef ENABLE_WASI
+                    options.wasi_inherit_network = true;
+#endif
+                    continue;
                 } else if (strcmp(argv[i], "--args") == 0) {
                     if (i + 1 == argc || argv[i + 1][0] == '-') {
                         fprintf(stderr, "error: --args requires one or more arguments\n");
@@ -1268,12 +1519,31 @@ static void parseArguments(int argc, const char* argv[], ParseOptions& options)
                     fprintf(stdout, "OPTIONS:\n");
                     fprintf(stdout, "\t--help\n\t\tShow this message then exit.\n\n");
                     fprintf(stdout, "\t--enable-web-assembly3\n\t\tEnable support for web assembly3 features.\n\n");
+                    fprintf(stdout, "\t--optimize-bytecode\n\t\tRun constant propagation, copy propagation and dead store elimination on the byte code.\n\n");
+                    fprintf(stdout, "\t--run-export <NAME>\n\t\tCall the exported function, or all of them when NAME is *.\n\n");
+                    fprintf(stdout, "\t--run-export-args <VALUES>\n\t\tComma separated arguments of the exported function, only numeric types are supported.\n\n");
+                    fprintf(stdout, "\t--run-export-count <COUNT>\n\t\tCall the exported functions COUNT times in a single batch.\n\n");
 #if defined(WALRUS_ENABLE_JIT)
                     fprintf(stdout, "\t--jit\n\t\tEnable just-in-time interpretation.\n\n");
                     fprintf(stdout, "\t--jit-verbose\n\t\tEnable verbose output for just-in-time interpretation.\n\n");
                     fprintf(stdout, "\t--jit-verbose-color\n\t\tEnable colored verbose output for just-in-time interpretation.\n\n");
+                    fprintf(stdout, "\t--jit-linear-scan\n\t\tUse loop aware spill weights for just-in-time register allocation.\n\n");
+#endif
+#ifdef ENABLE_GC
+                    fprintf(stdout, "\t--gc-markers <COUNT>\n\t\tNumber of parallel marker threads of the garbage collector.\n\n");
+                    fprintf(stdout, "\t--gc-incremental\n\t\tSplit garbage collections into small steps.\n\n");
+                    fprintf(stdout, "\t--gc-generational\n\t\tUse generational garbage collection.\n\n");
+                    fprintf(stdout, "\t--gc-free-space-divisor <N>\n\t\tGrow the heap instead of collecting until 1/N of it is free. Larger values use less memory.\n\n");
+                    fprintf(stdout, "\t--gc-initial-heap <SIZE>\n\t\tInitial size of the garbage collected heap, K, M and G suffixes are allowed.\n\n");
+                    fprintf(stdout, "\t--gc-max-heap <SIZE>\n\t\tMaximum size of the garbage collected heap, K, M and G suffixes are allowed.\n\n");
+                    fprintf(stdout, "\t--gc-stats\n\t\tPrint garbage collector statistics before exit.\n\n");
 #endif
-                    fprintf(stdout, "\t--mapdirs <HOST_DIR> <VIRTUAL_DIR>\n\t\tMap real directories to virtual ones for WASI functions to use.\n\t\tExample: ./walrus test.wasm --mapdirs this/real/directory/ this/virtual/directory\n\n");
+                    fprintf(stdout, "\t--bytecode-stats\n\t\tPrint the byte code size of each module after parsing.\n\n");
+                    fprintf(stdout, "\t--memory-huge-pages\n\t\tBack linear memories with transparent huge pages when the system allows it.\n\n");
+                    fprintf(stdout, "\t--memory-prefault\n\t\tAllocate the pages of linear memories when they are created or grown, instead of on first access.\n\n");
+                    fprintf(stdout, "\t--mapdirs <HOST_DIR> <VIRTUAL_DIR>\n\t\tMap real directories to virtual ones for WASI functions to use.\n\t\tA tar archive as HOST_DIR is mounted as an in-memory file system for WASI 0.2, and changes are not written back.\n\t\tExample: ./walrus test.wasm --mapdirs this/real/directory/ this/virtual/directory\n\n");
+                    fprintf(stdout, "\t--tcplisten <ADDRESS:PORT>\n\t\tPreopen a listening TCP socket for the WASI sock_accept, sock_recv and sock_send functions.\n\t\tExample: ./walrus test.wasm --tcplisten 127.0.0.1:8080\n\n");
+                    fprintf(stdout, "\t--inherit-network\n\t\tAllow WASI 0.2 components to bind and connect TCP sockets on the host network.\n\n");
                     fprintf(stdout, "\t--env\n\t\tShare host environment to walrus WASI.\n\n");
                     fprintf(stdout, "\t--args <MODULE_FILE_NAME> [<ARG1> <ARG2> ... <ARGN>]\n\t\tRun Webassembly module with arguments: must be followed by the name of the Webassembly module file, then optionally following arguments which are passed on to the module\n\t\tExample: ./walrus --args test.wasm 'hello' 'world' 42\n\n");
                     exit(0);
@@ -1316,21 +1586,36 @@ int main(int argc, const char* argv[])
     ProfilerStart("gperf_result");
 #endif
 
-    Engine* engine = new Engine();
-    Store* store = new Store(engine);
-
     ParseOptions options;
 
     parseArguments(argc, argv, options);
 
+    Store::setGCOptions(options.gcOptions);
+    Engine* engine = new Engine(options.engineOptions);
+    Store* store = new Store(engine);
+
 #ifdef ENABLE_WASI
     // initialize WASI
     uvwasi_t uvwasi;
     options.wasi_envs.push_back(nullptr);
 
+    std::string imageError;
+    if (!wasi02LoadImages(options.wasi_dirs, imageError)) {
+        fprintf(stderr, "error: cannot mount %s\n", imageError.c_str());
+        exit(1);
+    }
+
     std::vector<uvwasi_preopen_t> dirs;
     for (auto& dir : options.wasi_dirs) {
-        dirs.push_back({ dir.mappedPath, dir.realPath });
+        // Archives are only mounted for WASI 0.2.
+        if (dir.image == nullptr) {
+            dirs.push_back({ dir.mappedPath, dir.realPath });
+        }
+    }
+
+    std::vector<uvwasi_preopen_socket_t> sockets;
+    for (auto& socket : options.wasi_sockets) {
+        sockets.push_back({ socket.first.c_str(), socket.second });
     }
 
     uvwasi_options_t init_options;
@@ -1343,15 +1628,17 @@ int main(int argc, const char* argv[])
     init_options.envp = options.wasi_envs.data();
     init_options.preopenc = dirs.size();
     init_options.preopens = dirs.data();
-    init_options.preopen_socketc = 0;
+    init_options.preopen_socketc = sockets.size();
+    init_options.preopen_sockets = sockets.data();
     init_options.allocator = nullptr;
 
     uvwasi_errno_t err = uvwasi_init(&uvwasi, &init_options);
     assert(err == UVWASI_ESUCCESS);
 
-    WASI::initialize(&uvwasi);
+    WASI::initialize();
+    store->initWasiContext(&uvwasi);
     // Wasi 0.2
-    store->initWasiData(wasi02InitData(init_options.argc, init_options.argv, init_options.envp, options.wasi_dirs));
+    store->initWasiData(wasi02InitData(init_options.argc, init_options.argv, init_options.envp, options.wasi_dirs, options.wasi_inherit_network));
 #endif
 
     int result = 0;
@@ -1374,7 +1661,7 @@ int main(int argc, const char* argv[])
             }
             if (endsWith(filePath, "wasm")) {
                 if (!options.exportToRun.empty()) {
-                    runExports(store, filePath, buf, options.exportToRun);
+                    runExports(store, filePath, buf, options.exportToRun, options.exportRunCount, options.exportArgs);
                 } else if (wabt::ReadBinaryIsComponent(buf.data(), buf.size())) {
                     auto trapResult = executeWASMComponent(store, filePath, buf);
                     if (trapResult.exception) {
@@ -1404,10 +1691,17 @@ int main(int argc, const char* argv[])
     uvwasi_destroy(&uvwasi);
     // Wasi 0.2
     destroyWasi02Data(store->wasiData());
+    wasi02ReleaseImages(options.wasi_dirs);
 #endif
+#ifdef ENABLE_GC
+    if (options.printGCStatistics) {
+        printGCStatistics(store);
+    }
+#endif
+
     // finalize
     delete store;
-    delete engine;
+    engine->releaseRef();
     for (auto it : externalValues) {
         delete it;
     }
@@ -0,0 +1,960 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "util/Unicode.h"
+
+#if defined(CPU_X86_64) && (defined(COMPILER_GCC) || defined(COMPILER_CLANG))
+#define WALRUS_UNICODE_X86
+#include <immintrin.h>
+#elif defined(CPU_ARM64) && defined(__ARM_NEON)
+#define WALRUS_UNICODE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Walrus {
+
+enum Utf8Consts : uint8_t {
+    Utf8Len2 = 0xc0,
+    Utf8Len2Mask = 0x1f,
+    Utf8Len3 = 0xe0,
+    Utf8Len3Mask = 0x0f,
+    Utf8Len4 = 0xf0,
+    Utf8Len4Mask = 0x07,
+    Utf8Cont = 0x80,
+    Utf8ContMask = 0x3f,
+    Utf8ContShift1 = 6,
+    Utf8ContShift2 = 12,
+    Utf8ContShift3 = 18,
+
+    // The F and S postfix represents a two byte sequence, where the first byte is fixed.
+    Utf8Len2Start = 0xc2,
+    Utf8Latin1End = 0xc4,
+    Utf8Len3StartF = 0xe0,
+    Utf8Len3StartS = 0xa0,
+    Utf8SurrogateStartF = 0xed,
+    Utf8SurrogateStartS = 0xa0,
+    Utf8Len4StartF = 0xf0,
+    Utf8Len4StartS = 0x90,
+    Utf8Len4EndF = 0xf4,
+    Utf8Len4EndS = 0x8f,
+};
+
+enum Utf16Consts : uint16_t {
+    Utf16HighSurrogate = 0xd800,
+    Utf16LowSurrogate = 0xdc00,
+    Utf16SurrogateEnd = 0xdfff,
+    Utf16SurrogateMask = 0x3ff,
+    Utf16PairMask = 0xfc00,
+    Utf16AnySurrogateMask = 0xf800,
+    Utf16ContShift = 10,
+};
+
+enum UtfLimits : uint32_t {
+    UtfChar1Limit = 0x80,
+    UtfCharL1Limit = 0x100,
+    UtfChar2Limit = 0x800,
+    UtfChar3Limit = 0x10000,
+    UtfChar4Limit = 0x110000,
+};
+
+static bool validateUtf8Chars(const uint8_t*& src, const uint8_t* end, UnicodeCounts* counts)
+{
+    const uint8_t* buffer = src;
+
+    while (buffer < end) {
+        uint8_t chr = *buffer;
+        if (chr < Utf8Cont) {
+            buffer++;
+        } else if (chr < Utf8Len3) {
+            if (chr < Utf8Len2Start // Continuation byte or overlong sequence.
+                || end - buffer < 2
+                || (buffer[1] & ~Utf8ContMask) != Utf8Cont) {
+                return false;
+            }
+
+            if (chr < Utf8Latin1End) {
+                counts->charL1++;
+            } else {
+                counts->char2++;
+            }
+            buffer += 2;
+        } else if (chr < Utf8Len4) {
+            if (end - buffer < 3
+                || (buffer[1] & ~Utf8ContMask) != Utf8Cont
+                || (buffer[2] & ~Utf8ContMask) != Utf8Cont
+                || (chr == Utf8Len3StartF && buffer[1] < Utf8Len3StartS)
+                || (chr == Utf8SurrogateStartF && buffer[1] >= Utf8SurrogateStartS)) {
+                return false;
+            }
+
+            buffer += 3;
+            counts->char3++;
+        } else {
+            if (chr > Utf8Len4EndF
+                || end - buffer < 4
+                || (buffer[1] & ~Utf8ContMask) != Utf8Cont
+                || (buffer[2] & ~Utf8ContMask) != Utf8Cont
+                || (buffer[3] & ~Utf8ContMask) != Utf8Cont
+                || (chr == Utf8Len4StartF && buffer[1] < Utf8Len4StartS)
+                || (chr == Utf8Len4EndF && buffer[1] > Utf8Len4EndS)) {
+                return false;
+            }
+
+            buffer += 4;
+            counts->char4++;
+        }
+    }
+
+    src = buffer;
+    return true;
+}
+
+// Validates the characters starting before stop. The last surrogate pair may end after it.
+static bool validateUtf16Chars(const uint16_t*& src, const uint16_t* stop, const uint16_t* end, UnicodeCounts* counts)
+{
+    const uint16_t* buffer = src;
+
+    while (buffer < stop) {
+        uint16_t chr = *buffer;
+
+        if (chr < Utf16HighSurrogate || chr > Utf16SurrogateEnd) {
+            if (chr >= UtfChar1Limit) {
+                if (chr < UtfCharL1Limit) {
+                    counts->charL1++;
+                } else if (chr < UtfChar2Limit) {
+                    counts->char2++;
+                } else {
+                    counts->char3++;
+                }
+            }
+            buffer++;
+        } else {
+            if (chr >= Utf16LowSurrogate
+                || end - buffer < 2
+                || buffer[1] < Utf16LowSurrogate
+                || buffer[1] > Utf16SurrogateEnd) {
+                return false;
+            }
+
+            counts->char4++;
+            buffer += 2;
+        }
+    }
+
+    src = buffer;
+    return true;
+}
+
+// The conversion helpers below process the characters starting before
+// stop, and the last character may end after it. The input must be valid.
+
+static void latin1ToUtf8Chars(const uint8_t*& src, const uint8_t* stop, uint8_t*& dst)
+{
+    while (src < stop) {
+        uint8_t chr = *src++;
+        if (chr < UtfChar1Limit) {
+            *dst++ = chr;
+        } else {
+            dst[0] = static_cast<uint8_t>(Utf8Len2 | (chr >> Utf8ContShift1));
+            dst[1] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
+            dst += 2;
+        }
+    }
+}
+
+static void utf8ToLatin1Chars(const uint8_t*& src, const uint8_t* stop, uint8_t*& dst)
+{
+    while (src < stop) {
+        uint8_t chr = *src;
+        if (chr < UtfChar1Limit) {
+            src++;
+        } else {
+            chr = static_cast<uint8_t>((chr << Utf8ContShift1) | (src[1] & Utf8ContMask));
+            src += 2;
+        }
+        *dst++ = chr;
+    }
+}
+
+static void utf8ToUtf16Chars(const uint8_t*& src, const uint8_t* stop, uint16_t*& dst)
+{
+    while (src < stop) {
+        uint8_t byte = *src;
+
+        if (byte < UtfChar1Limit) {
+            *dst++ = byte;
+            src++;
+        } else if (byte < Utf8Len3) {
+            uint16_t chr = static_cast<uint16_t>((byte & Utf8Len2Mask) << Utf8ContShift1);
+            chr |= static_cast<uint16_t>(src[1] & Utf8ContMask);
+            *dst++ = chr;
+            src += 2;
+        } else if (byte < Utf8Len4) {
+            uint16_t chr = static_cast<uint16_t>((byte & Utf8Len3Mask) << Utf8ContShift2);
+            chr |= static_cast<uint16_t>((src[1] & Utf8ContMask) << Utf8ContShift1);
+            chr |= static_cast<uint16_t>(src[2] & Utf8ContMask);
+            *dst++ = chr;
+            src += 3;
+        } else {
+            uint32_t chr = static_cast<uint32_t>((byte & Utf8Len4Mask) << Utf8ContShift3);
+            chr |= static_cast<uint32_t>((src[1] & Utf8ContMask) << Utf8ContShift2);
+            chr |= static_cast<uint32_t>((src[2] & Utf8ContMask) << Utf8ContShift1);
+            chr |= static_cast<uint32_t>(src[3] & Utf8ContMask);
+            chr -= UtfChar3Limit;
+            dst[0] = static_cast<uint16_t>(Utf16HighSurrogate | (chr >> Utf16ContShift));
+            dst[1] = static_cast<uint16_t>(Utf16LowSurrogate | (chr & Utf16SurrogateMask));
+            dst += 2;
+            src += 4;
+        }
+    }
+}
+
+static void utf16ToUtf8Chars(const uint16_t*& src, const uint16_t* stop, uint8_t*& dst)
+{
+    while (src < stop) {
+        uint16_t chr = *src;
+
+        if (chr < Utf16HighSurrogate || chr > Utf16SurrogateEnd) {
+            if (chr < UtfChar1Limit) {
+                *dst++ = static_cast<uint8_t>(chr);
+            } else if (chr < UtfChar2Limit) {
+                dst[0] = static_cast<uint8_t>(Utf8Len2 | (chr >> Utf8ContShift1));
+                dst[1] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
+                dst += 2;
+            } else {
+                dst[0] = static_cast<uint8_t>(Utf8Len3 | (chr >> Utf8ContShift2));
+                dst[1] = static_cast<uint8_t>(Utf8Cont | ((chr >> Utf8ContShift1) & Utf8ContMask));
+                dst[2] = static_cast<uint8_t>(Utf8Cont | (chr & Utf8ContMask));
+                dst += 3;
+            }
+            src++;
+        } else {
+            uint32_t chr32 = (static_cast<uint32_t>(chr & Utf16SurrogateMask) << Utf16ContShift) + static_cast<uint32_t>(src[1] & Utf16SurrogateMask) + UtfChar3Limit;
+            dst[0] = static_cast<uint8_t>(Utf8Len4 | (chr32 >> Utf8ContShift3));
+            dst[1] = static_cast<uint8_t>(Utf8Cont | ((chr32 >> Utf8ContShift2) & Utf8ContMask));
+            dst[2] = static_cast<uint8_t>(Utf8Cont | ((chr32 >> Utf8ContShift1) & Utf8ContMask));
+            dst[3] = static_cast<uint8_t>(Utf8Cont | (chr32 & Utf8ContMask));
+            dst += 4;
+            src += 2;
+        }
+    }
+}
+
+namespace UnicodeScalar {
+
+static bool validateUtf8(const uint8_t* src, size_t length, UnicodeCounts* counts)
+{
+    *counts = UnicodeCounts();
+    return validateUtf8Chars(src, src + length, counts);
+}
+
+static bool validateUtf16(const uint16_t* src, size_t length, UnicodeCounts* counts)
+{
+    *counts = UnicodeCounts();
+    return validateUtf16Chars(src, src + length, src + length, counts);
+}
+
+static size_t countLatin1NonAscii(const uint8_t* src, size_t length)
+{
+    const uint8_t* end = src + length;
+    size_t result = 0;
+
+    while (src < end) {
+        if (*src++ >= UtfChar1Limit) {
+            result++;
+        }
+    }
+    return result;
+}
+
+static uint8_t* latin1ToUtf8(const uint8_t* src, size_t length, uint8_t* dst)
+{
+    latin1ToUtf8Chars(src, src + length, dst);
+    return dst;
+}
+
+static uint16_t* latin1ToUtf16(const uint8_t* src, size_t length, uint16_t* dst)
+{
+    const uint8_t* end = src + length;
+
+    while (src < end) {
+        *dst++ = *src++;
+    }
+    return dst;
+}
+
+static uint8_t* utf8ToLatin1(const uint8_t* src, size_t length, uint8_t* dst)
+{
+    utf8ToLatin1Chars(src, src + length, dst);
+    return dst;
+}
+
+static uint16_t* utf8ToUtf16(const uint8_t* src, size_t length, uint16_t* dst)
+{
+    utf8ToUtf16Chars(src, src + length, dst);
+    return dst;
+}
+
+static uint8_t* utf16ToLatin1(const uint16_t* src, size_t length, uint8_t* dst)
+{
+    const uint16_t* end = src + length;
+
+    while (src < end) {
+        *dst++ = static_cast<uint8_t>(*src++);
+    }
+    return dst;
+}
+
+static uint8_t* utf16ToUtf8(const uint16_t* src, size_t length, uint8_t* dst)
+{
+    utf16ToUtf8Chars(src, src + length, dst);
+    return dst;
+}
+
+} // namespace UnicodeScalar
+
+// UTF8 decoding is scalar for every instruction set: testing the input for
+// ASCII blocks made mixed input slower. ASCII input is transcoded by the
+// Latin1 kernels instead, see CanonOptions::UtfData.
+#define UNICODE_KERNELS(isa, name, ns)                                                    \
+    {                                                                                     \
+        Unicode::isa, name, ns::validateUtf8, ns::validateUtf16, ns::countLatin1NonAscii, \
+            ns::latin1ToUtf8, ns::latin1ToUtf16, UnicodeScalar::utf8ToLatin1,             \
+            UnicodeScalar::utf8ToUtf16, ns::utf16ToLatin1, ns::utf16ToUtf8                \
+    }
+
+static const Unicode::Kernels scalarKernels = UNICODE_KERNELS(Scalar, "scalar", UnicodeScalar);
+
+#if defined(WALRUS_UNICODE_X86) || defined(WALRUS_UNICODE_NEON)
+
+// Lookup tables of the UTF8 validator, each bit represents an error class:
+//   0x01: lead byte or ASCII followed by a lead byte or ASCII (too short)
+//   0x02: ASCII followed by a continuation byte (too long)
+//   0x04: overlong three byte sequence
+//   0x08: code point above 0x10ffff
+//   0x10: surrogate code point
+//   0x20: overlong two byte sequence
+//   0x40: overlong four byte sequence or code point above 0x10ffff
+//   0x80: continuation byte followed by a continuation byte
+static const uint8_t utf8FirstHighTable[16] = {
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+    0x80, 0x80, 0x80, 0x80, 0x21, 0x01, 0x15, 0x49
+};
+
+static const uint8_t utf8FirstLowTable[16] = {
+    0xe7, 0xa3, 0x83, 0x83, 0x8b, 0xcb, 0xcb, 0xcb,
+    0xcb, 0xcb, 0xcb, 0xcb, 0xcb, 0xdb, 0xcb, 0xcb
+};
+
+static const uint8_t utf8SecondHighTable[16] = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0xe6, 0xae, 0xba, 0xba, 0x01, 0x01, 0x01, 0x01
+};
+
+// Lead bytes at the end of a block which require more bytes.
+static const uint8_t utf8IncompleteLimit[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, Utf8Len4 - 1, Utf8Len3 - 1, Utf8Len2 - 1
+};
+
+// Eight code units below 0x800 are encoded to one or two bytes each, and
+// the encoded bytes are compacted by a shuffle selected by the ASCII units.
+struct Utf8Len2Shuffle {
+    uint8_t shuffle[16];
+    uint8_t length;
+};
+
+static struct Utf8Len2ShuffleTable {
+    Utf8Len2ShuffleTable()
+    {
+        for (uint32_t asciiMask = 0; asciiMask < 256; asciiMask++) {
+            Utf8Len2Shuffle& entry = entries[asciiMask];
+            uint8_t length = 0;
+
+            for (uint8_t i = 0; i < 8; i++) {
+                entry.shuffle[length++] = static_cast<uint8_t>(i * 2);
+                if (!(asciiMask & (1 << i))) {
+                    entry.shuffle[length++] = static_cast<uint8_t>(i * 2 + 1);
+                }
+            }
+
+            entry.length = length;
+            while (length < 16) {
+                entry.shuffle[length++] = 0x80;
+            }
+        }
+    }
+
+    Utf8Len2Shuffle entries[256];
+} utf8Len2ShuffleTable;
+
+#endif
+
+#if defined(WALRUS_UNICODE_X86)
+
+#if defined(COMPILER_CLANG)
+#define UNICODE_TARGET_BEGIN(target) _Pragma(target)
+#define UNICODE_TARGET_END _Pragma("clang attribute pop")
+#define UNICODE_TARGET_SSE41 "clang attribute push (__attribute__((target(\"sse4.1\"))), apply_to = function)"
+#define UNICODE_TARGET_AVX2 "clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)"
+#else
+#define UNICODE_TARGET_BEGIN(target) _Pragma("GCC push_options") _Pragma(target)
+#define UNICODE_TARGET_END _Pragma("GCC pop_options")
+#define UNICODE_TARGET_SSE41 "GCC target(\"sse4.1\")"
+#define UNICODE_TARGET_AVX2 "GCC target(\"avx2\")"
+#endif
+
+UNICODE_TARGET_BEGIN(UNICODE_TARGET_SSE41)
+
+namespace UnicodeSSE41 {
+
+typedef __m128i Vector;
+static const size_t VectorSize = sizeof(Vector);
+
+static ALWAYS_INLINE Vector vectorLoad(const void* src)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+static ALWAYS_INLINE void vectorStore(void* dst, Vector value)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+}
+
+static ALWAYS_INLINE Vector vectorZero()
+{
+    return _mm_setzero_si128();
+}
+
+static ALWAYS_INLINE Vector vectorSplat8(uint8_t value)
+{
+    return _mm_set1_epi8(static_cast<char>(value));
+}
+
+static ALWAYS_INLINE Vector vectorSplat16(uint16_t value)
+{
+    return _mm_set1_epi16(static_cast<short>(value));
+}
+
+static ALWAYS_INLINE Vector vectorTable(const uint8_t* table)
+{
+    return vectorLoad(table);
+}
+
+static ALWAYS_INLINE Vector vectorAnd(Vector left, Vector right)
+{
+    return _mm_and_si128(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorOr(Vector left, Vector right)
+{
+    return _mm_or_si128(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorXor(Vector left, Vector right)
+{
+    return _mm_xor_si128(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorShiftRight4(Vector value)
+{
+    return _mm_and_si128(_mm_srli_epi16(value, 4), _mm_set1_epi8(0x0f));
+}
+
+static ALWAYS_INLINE Vector vectorLookup(Vector table, Vector index)
+{
+    return _mm_shuffle_epi8(table, index);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious1(Vector current, Vector previous)
+{
+    return _mm_alignr_epi8(current, previous, 15);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious2(Vector current, Vector previous)
+{
+    return _mm_alignr_epi8(current, previous, 14);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious3(Vector current, Vector previous)
+{
+    return _mm_alignr_epi8(current, previous, 13);
+}
+
+static ALWAYS_INLINE Vector vectorSubSaturate8(Vector left, Vector right)
+{
+    return _mm_subs_epu8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorSub8(Vector left, Vector right)
+{
+    return _mm_sub_epi8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual8(Vector left, Vector right)
+{
+    return _mm_cmpeq_epi8(_mm_max_epu8(left, right), left);
+}
+
+static ALWAYS_INLINE Vector vectorSub16(Vector left, Vector right)
+{
+    return _mm_sub_epi16(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorEqual16(Vector left, Vector right)
+{
+    return _mm_cmpeq_epi16(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual16(Vector left, Vector right)
+{
+    return _mm_cmpeq_epi16(_mm_max_epu16(left, right), left);
+}
+
+static ALWAYS_INLINE bool vectorIsAscii(Vector value)
+{
+    return _mm_movemask_epi8(value) == 0;
+}
+
+static ALWAYS_INLINE bool vectorIsZero(Vector value)
+{
+    return _mm_testz_si128(value, value) != 0;
+}
+
+static ALWAYS_INLINE uint32_t vectorSum8(Vector value)
+{
+    Vector sum = _mm_sad_epu8(value, _mm_setzero_si128());
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 2));
+}
+
+static ALWAYS_INLINE uint32_t vectorSum16(Vector value)
+{
+    Vector mask = _mm_set1_epi32(0xffff);
+    Vector sum = _mm_add_epi32(_mm_and_si128(value, mask), _mm_srli_epi32(value, 16));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+static ALWAYS_INLINE void vectorStoreWidened(uint16_t* dst, Vector value)
+{
+    Vector zero = _mm_setzero_si128();
+    vectorStore(dst, _mm_unpacklo_epi8(value, zero));
+    vectorStore(dst + 8, _mm_unpackhi_epi8(value, zero));
+}
+
+static ALWAYS_INLINE Vector vectorNarrow(Vector low, Vector high)
+{
+    return _mm_packus_epi16(low, high);
+}
+
+// Stores eight code units below 0x800 as UTF8. Writes
+// 16 bytes, and returns with the end of the encoded data.
+static ALWAYS_INLINE uint8_t* storeUtf8Len2(uint8_t* dst, __m128i units)
+{
+    __m128i lead = _mm_or_si128(_mm_srli_epi16(units, Utf8ContShift1), _mm_set1_epi16(Utf8Len2));
+    __m128i cont = _mm_or_si128(_mm_and_si128(units, _mm_set1_epi16(Utf8ContMask)), _mm_set1_epi16(Utf8Cont));
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(~(UtfChar1Limit - 1)))), _mm_setzero_si128());
+    __m128i encoded = _mm_blendv_epi8(_mm_or_si128(lead, _mm_slli_epi16(cont, 8)), units, ascii);
+    const Utf8Len2Shuffle& entry = utf8Len2ShuffleTable.entries[_mm_movemask_epi8(_mm_packs_epi16(ascii, ascii)) & 0xff];
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(encoded, _mm_loadu_si128(reinterpret_cast<const __m128i*>(entry.shuffle))));
+    return dst + entry.length;
+}
+
+static ALWAYS_INLINE uint8_t* vectorStoreUtf8Len2(uint8_t* dst, Vector units)
+{
+    return storeUtf8Len2(dst, units);
+}
+
+#include "util/UnicodeSimdInl.h"
+
+} // namespace UnicodeSSE41
+
+UNICODE_TARGET_END
+
+UNICODE_TARGET_BEGIN(UNICODE_TARGET_AVX2)
+
+namespace UnicodeAVX2 {
+
+typedef __m256i Vector;
+static const size_t VectorSize = sizeof(Vector);
+
+static ALWAYS_INLINE Vector vectorLoad(const void* src)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+}
+
+static ALWAYS_INLINE void vectorStore(void* dst, Vector value)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+}
+
+static ALWAYS_INLINE Vector vectorZero()
+{
+    return _mm256_setzero_si256();
+}
+
+static ALWAYS_INLINE Vector vectorSplat8(uint8_t value)
+{
+    return _mm256_set1_epi8(static_cast<char>(value));
+}
+
+static ALWAYS_INLINE Vector vectorSplat16(uint16_t value)
+{
+    return _mm256_set1_epi16(static_cast<short>(value));
+}
+
+static ALWAYS_INLINE Vector vectorTable(const uint8_t* table)
+{
+    // Shuffles operate on 128 bit lanes.
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+static ALWAYS_INLINE Vector vectorAnd(Vector left, Vector right)
+{
+    return _mm256_and_si256(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorOr(Vector left, Vector right)
+{
+    return _mm256_or_si256(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorXor(Vector left, Vector right)
+{
+    return _mm256_xor_si256(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorShiftRight4(Vector value)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(value, 4), _mm256_set1_epi8(0x0f));
+}
+
+static ALWAYS_INLINE Vector vectorLookup(Vector table, Vector index)
+{
+    return _mm256_shuffle_epi8(table, index);
+}
+
+// The upper half of the previous block followed by the lower half of the current block.
+static ALWAYS_INLINE Vector vectorCrossLane(Vector current, Vector previous)
+{
+    return _mm256_permute2x128_si256(previous, current, 0x21);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious1(Vector current, Vector previous)
+{
+    return _mm256_alignr_epi8(current, vectorCrossLane(current, previous), 15);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious2(Vector current, Vector previous)
+{
+    return _mm256_alignr_epi8(current, vectorCrossLane(current, previous), 14);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious3(Vector current, Vector previous)
+{
+    return _mm256_alignr_epi8(current, vectorCrossLane(current, previous), 13);
+}
+
+static ALWAYS_INLINE Vector vectorSubSaturate8(Vector left, Vector right)
+{
+    return _mm256_subs_epu8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorSub8(Vector left, Vector right)
+{
+    return _mm256_sub_epi8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual8(Vector left, Vector right)
+{
+    return _mm256_cmpeq_epi8(_mm256_max_epu8(left, right), left);
+}
+
+static ALWAYS_INLINE Vector vectorSub16(Vector left, Vector right)
+{
+    return _mm256_sub_epi16(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorEqual16(Vector left, Vector right)
+{
+    return _mm256_cmpeq_epi16(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual16(Vector left, Vector right)
+{
+    return _mm256_cmpeq_epi16(_mm256_max_epu16(left, right), left);
+}
+
+static ALWAYS_INLINE bool vectorIsAscii(Vector value)
+{
+    return _mm256_movemask_epi8(value) == 0;
+}
+
+static ALWAYS_INLINE bool vectorIsZero(Vector value)
+{
+    return _mm256_testz_si256(value, value) != 0;
+}
+
+static ALWAYS_INLINE uint32_t reduceSum32(__m128i sum)
+{
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+static ALWAYS_INLINE uint32_t vectorSum8(Vector value)
+{
+    // Each 64 bit element of the sum is below 2048.
+    Vector sum = _mm256_sad_epu8(value, _mm256_setzero_si256());
+    return reduceSum32(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+}
+
+static ALWAYS_INLINE uint32_t vectorSum16(Vector value)
+{
+    Vector mask = _mm256_set1_epi32(0xffff);
+    Vector sum = _mm256_add_epi32(_mm256_and_si256(value, mask), _mm256_srli_epi32(value, 16));
+    return reduceSum32(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+}
+
+static ALWAYS_INLINE void vectorStoreWidened(uint16_t* dst, Vector value)
+{
+    vectorStore(dst, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(value)));
+    vectorStore(dst + 16, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(value, 1)));
+}
+
+static ALWAYS_INLINE Vector vectorNarrow(Vector low, Vector high)
+{
+    // Packing operates on 128 bit lanes, which are reordered afterwards.
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static ALWAYS_INLINE uint8_t* vectorStoreUtf8Len2(uint8_t* dst, Vector units)
+{
+    dst = UnicodeSSE41::storeUtf8Len2(dst, _mm256_castsi256_si128(units));
+    return UnicodeSSE41::storeUtf8Len2(dst, _mm256_extracti128_si256(units, 1));
+}
+
+#include "util/UnicodeSimdInl.h"
+
+} // namespace UnicodeAVX2
+
+UNICODE_TARGET_END
+
+static const Unicode::Kernels sse41Kernels = UNICODE_KERNELS(SSE41, "sse4.1", UnicodeSSE41);
+static const Unicode::Kernels avx2Kernels = UNICODE_KERNELS(AVX2, "avx2", UnicodeAVX2);
+
+#elif defined(WALRUS_UNICODE_NEON)
+
+namespace UnicodeNeon {
+
+typedef uint8x16_t Vector;
+static const size_t VectorSize = sizeof(Vector);
+
+static ALWAYS_INLINE Vector vectorLoad(const void* src)
+{
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(src));
+}
+
+static ALWAYS_INLINE void vectorStore(void* dst, Vector value)
+{
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst), value);
+}
+
+static ALWAYS_INLINE Vector vectorZero()
+{
+    return vdupq_n_u8(0);
+}
+
+static ALWAYS_INLINE Vector vectorSplat8(uint8_t value)
+{
+    return vdupq_n_u8(value);
+}
+
+static ALWAYS_INLINE Vector vectorSplat16(uint16_t value)
+{
+    return vreinterpretq_u8_u16(vdupq_n_u16(value));
+}
+
+static ALWAYS_INLINE Vector vectorTable(const uint8_t* table)
+{
+    return vld1q_u8(table);
+}
+
+static ALWAYS_INLINE Vector vectorAnd(Vector left, Vector right)
+{
+    return vandq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorOr(Vector left, Vector right)
+{
+    return vorrq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorXor(Vector left, Vector right)
+{
+    return veorq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorShiftRight4(Vector value)
+{
+    return vshrq_n_u8(value, 4);
+}
+
+static ALWAYS_INLINE Vector vectorLookup(Vector table, Vector index)
+{
+    return vqtbl1q_u8(table, index);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious1(Vector current, Vector previous)
+{
+    return vextq_u8(previous, current, 15);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious2(Vector current, Vector previous)
+{
+    return vextq_u8(previous, current, 14);
+}
+
+static ALWAYS_INLINE Vector vectorPrevious3(Vector current, Vector previous)
+{
+    return vextq_u8(previous, current, 13);
+}
+
+static ALWAYS_INLINE Vector vectorSubSaturate8(Vector left, Vector right)
+{
+    return vqsubq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorSub8(Vector left, Vector right)
+{
+    return vsubq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual8(Vector left, Vector right)
+{
+    return vcgeq_u8(left, right);
+}
+
+static ALWAYS_INLINE Vector vectorSub16(Vector left, Vector right)
+{
+    return vreinterpretq_u8_u16(vsubq_u16(vreinterpretq_u16_u8(left), vreinterpretq_u16_u8(right)));
+}
+
+static ALWAYS_INLINE Vector vectorEqual16(Vector left, Vector right)
+{
+    return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(left), vreinterpretq_u16_u8(right)));
+}
+
+static ALWAYS_INLINE Vector vectorGreaterEqual16(Vector left, Vector right)
+{
+    return vreinterpretq_u8_u16(vcgeq_u16(vreinterpretq_u16_u8(left), vreinterpretq_u16_u8(right)));
+}
+
+static ALWAYS_INLINE bool vectorIsAscii(Vector value)
+{
+    return vmaxvq_u8(value) < UtfChar1Limit;
+}
+
+static ALWAYS_INLINE bool vectorIsZero(Vector value)
+{
+    return vmaxvq_u8(value) == 0;
+}
+
+static ALWAYS_INLINE uint32_t vectorSum8(Vector value)
+{
+    return vaddlvq_u8(value);
+}
+
+static ALWAYS_INLINE uint32_t vectorSum16(Vector value)
+{
+    return vaddlvq_u16(vreinterpretq_u16_u8(value));
+}
+
+static ALWAYS_INLINE void vectorStoreWidened(uint16_t* dst, Vector value)
+{
+    vst1q_u16(dst, vmovl_u8(vget_low_u8(value)));
+    vst1q_u16(dst + 8, vmovl_high_u8(value));
+}
+
+static ALWAYS_INLINE Vector vectorNarrow(Vector low, Vector high)
+{
+    return vuzp1q_u8(low, high);
+}
+
+// Stores eight code units below 0x800 as UTF8. Writes
+// 16 bytes, and returns with the end of the encoded data.
+static ALWAYS_INLINE uint8_t* vectorStoreUtf8Len2(uint8_t* dst, Vector value)
+{
+    static const uint16_t maskBits[8] = { 0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80 };
+    uint16x8_t units = vreinterpretq_u16_u8(value);
+    uint16x8_t lead = vorrq_u16(vshrq_n_u16(units, Utf8ContShift1), vdupq_n_u16(Utf8Len2));
+    uint16x8_t cont = vorrq_u16(vandq_u16(units, vdupq_n_u16(Utf8ContMask)), vdupq_n_u16(Utf8Cont));
+    uint16x8_t ascii = vcltq_u16(units, vdupq_n_u16(UtfChar1Limit));
+    uint16x8_t encoded = vbslq_u16(ascii, units, vorrq_u16(lead, vshlq_n_u16(cont, 8)));
+    const Utf8Len2Shuffle& entry = utf8Len2ShuffleTable.entries[vaddvq_u16(vandq_u16(ascii, vld1q_u16(maskBits)))];
+
+    vst1q_u8(dst, vqtbl1q_u8(vreinterpretq_u8_u16(encoded), vld1q_u8(entry.shuffle)));
+    return dst + entry.length;
+}
+
+#include "util/UnicodeSimdInl.h"
+
+} // namespace UnicodeNeon
+
+static const Unicode::Kernels neonKernels = UNICODE_KERNELS(Neon, "neon", UnicodeNeon);
+
+#endif
+
+const Unicode::Kernels* Unicode::kernels(Isa isa)
+{
+    switch (isa) {
+    case Scalar:
+        return &scalarKernels;
+#if defined(WALRUS_UNICODE_X86)
+    case SSE41:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.1") ? &sse41Kernels : nullptr;
+    case AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? &avx2Kernels : nullptr;
+#elif defined(WALRUS_UNICODE_NEON)
+    case Neon:
+        return &neonKernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const Unicode::Kernels* Unicode::selectKernels()
+{
+    for (int isa = IsaCount - 1; isa > Scalar; isa--) {
+        const Kernels* result = kernels(static_cast<Isa>(isa));
+
+        if (result != nullptr) {
+            return result;
+        }
+    }
+    return &scalarKernels;
+}
+
+} // namespace Walrus
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusUnicode__
+#define __WalrusUnicode__
+
+namespace Walrus {
+
+// Number of characters of a valid UTF8 or UTF16
+// string grouped by their UTF8 encoded length.
+struct UnicodeCounts {
+    UnicodeCounts()
+        : charL1(0)
+        , char2(0)
+        , char3(0)
+        , char4(0)
+    {
+    }
+
+    uint32_t charL1; // 0x80 - 0xff (two byte long, but Latin1 encodable)
+    uint32_t char2; // 0x100 - 0x7ff
+    uint32_t char3; // 0x800 - 0xffff
+    uint32_t char4; // 0x10000 - 0x10ffff
+};
+
+// String validation and transcoding kernels used by the canonical ABI.
+// Lengths are measured in code units. The transcoding kernels expect valid
+// input (validated or Latin1) and a large enough destination buffer, and
+// return the end of the written data.
+class Unicode {
+public:
+    enum Isa : uint8_t {
+        Scalar,
+        SSE41,
+        AVX2,
+        Neon,
+        IsaCount,
+    };
+
+    struct Kernels {
+        Isa isa;
+        const char* name;
+        bool (*validateUtf8)(const uint8_t* src, size_t length, UnicodeCounts* counts);
+        bool (*validateUtf16)(const uint16_t* src, size_t length, UnicodeCounts* counts);
+        size_t (*countLatin1NonAscii)(const uint8_t* src, size_t length);
+        uint8_t* (*latin1ToUtf8)(const uint8_t* src, size_t length, uint8_t* dst);
+        uint16_t* (*latin1ToUtf16)(const uint8_t* src, size_t length, uint16_t* dst);
+        uint8_t* (*utf8ToLatin1)(const uint8_t* src, size_t length, uint8_t* dst);
+        uint16_t* (*utf8ToUtf16)(const uint8_t* src, size_t length, uint16_t* dst);
+        uint8_t* (*utf16ToLatin1)(const uint16_t* src, size_t length, uint8_t* dst);
+        uint8_t* (*utf16ToUtf8)(const uint16_t* src, size_t length, uint8_t* dst);
+    };
+
+    // The fastest kernels supported by the host cpu, selected on first use.
+    static const Kernels& kernels()
+    {
+        static const Kernels* selected = selectKernels();
+        return *selected;
+    }
+
+    // Returns with nullptr if the host cpu does not support the instruction set.
+    static const Kernels* kernels(Isa isa);
+
+private:
+    static const Kernels* selectKernels();
+};
+
+} // namespace Walrus
+
+#endif // __WalrusUnicode__
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only included by Unicode.cpp, once for each instruction set.
+   The including namespace provides the Vector type and the vector* primitives. */
+
+// Byte counters are flushed before they could overflow.
+static const uint32_t MaxByteCounterIterations = 255;
+static const uint32_t MaxHalfCounterIterations = 0xffff;
+
+// Validation is based on the lookup algorithm of John Keiser and Daniel Lemire:
+// "Validating UTF-8 In Less Than One Instruction Per Byte" (2021). Three table
+// lookups classify every byte pair, and a continuation byte is valid only where
+// the lookup result agrees with the preceding three byte lead bytes.
+static bool validateUtf8(const uint8_t* src, size_t length, UnicodeCounts* counts)
+{
+    const uint8_t* start = src;
+    const uint8_t* end = src + length;
+
+    *counts = UnicodeCounts();
+
+    if (length < VectorSize) {
+        return validateUtf8Chars(src, end, counts);
+    }
+
+    const Vector firstHighTable = vectorTable(utf8FirstHighTable);
+    const Vector firstLowTable = vectorTable(utf8FirstLowTable);
+    const Vector secondHighTable = vectorTable(utf8SecondHighTable);
+    const Vector incompleteLimit = vectorLoad(utf8IncompleteLimit + sizeof(utf8IncompleteLimit) - VectorSize);
+    const Vector lowNibbleMask = vectorSplat8(0x0f);
+    const Vector thirdByteLimit = vectorSplat8(Utf8Len3 - 0x80);
+    const Vector fourthByteLimit = vectorSplat8(Utf8Len4 - 0x80);
+    const Vector highBit = vectorSplat8(0x80);
+    const Vector len2Start = vectorSplat8(Utf8Len2Start);
+    const Vector latin1End = vectorSplat8(Utf8Latin1End);
+    const Vector len3Start = vectorSplat8(Utf8Len3);
+    const Vector len4Start = vectorSplat8(Utf8Len4);
+
+    Vector previous = vectorZero();
+    Vector error = vectorZero();
+    Vector countLen2 = vectorZero();
+    Vector countNonLatin1 = vectorZero();
+    Vector countLen3 = vectorZero();
+    Vector countLen4 = vectorZero();
+    uint32_t iterations = 0;
+    uint32_t leadLen2 = 0;
+    uint32_t leadNonLatin1 = 0;
+    uint32_t leadLen3 = 0;
+    uint32_t leadLen4 = 0;
+
+    while (static_cast<size_t>(end - src) >= VectorSize) {
+        Vector input = vectorLoad(src);
+
+        if (vectorIsAscii(input)) {
+            // Only the sequences started by the previous block need to be checked.
+            error = vectorOr(error, vectorSubSaturate8(previous, incompleteLimit));
+            previous = input;
+            src += VectorSize;
+            continue;
+        }
+
+        Vector previous1 = vectorPrevious1(input, previous);
+        Vector firstHigh = vectorLookup(firstHighTable, vectorShiftRight4(previous1));
+        Vector firstLow = vectorLookup(firstLowTable, vectorAnd(previous1, lowNibbleMask));
+        Vector secondHigh = vectorLookup(secondHighTable, vectorShiftRight4(input));
+        Vector special = vectorAnd(vectorAnd(firstHigh, firstLow), secondHigh);
+
+        Vector isThirdByte = vectorSubSaturate8(vectorPrevious2(input, previous), thirdByteLimit);
+        Vector isFourthByte = vectorSubSaturate8(vectorPrevious3(input, previous), fourthByteLimit);
+        Vector mustBeContinuation = vectorAnd(vectorOr(isThirdByte, isFourthByte), highBit);
+        error = vectorOr(error, vectorXor(mustBeContinuation, special));
+
+        // Lead bytes are counted, subtracting the all-ones masks adds one to each counter.
+        countLen2 = vectorSub8(countLen2, vectorGreaterEqual8(input, len2Start));
+        countNonLatin1 = vectorSub8(countNonLatin1, vectorGreaterEqual8(input, latin1End));
+        countLen3 = vectorSub8(countLen3, vectorGreaterEqual8(input, len3Start));
+        countLen4 = vectorSub8(countLen4, vectorGreaterEqual8(input, len4Start));
+
+        if (++iterations == MaxByteCounterIterations) {
+            leadLen2 += vectorSum8(countLen2);
+            leadNonLatin1 += vectorSum8(countNonLatin1);
+            leadLen3 += vectorSum8(countLen3);
+            leadLen4 += vectorSum8(countLen4);
+            countLen2 = countNonLatin1 = countLen3 = countLen4 = vectorZero();
+            iterations = 0;
+        }
+
+        previous = input;
+        src += VectorSize;
+    }
+
+    if (!vectorIsZero(error)) {
+        return false;
+    }
+
+    leadLen2 += vectorSum8(countLen2);
+    leadNonLatin1 += vectorSum8(countNonLatin1);
+    leadLen3 += vectorSum8(countLen3);
+    leadLen4 += vectorSum8(countLen4);
+
+    // The last character of the vector loop may continue after the
+    // processed bytes, so it is validated again with the remaining bytes.
+    for (uint32_t i = 1; i <= 3; i++) {
+        uint8_t chr = src[-static_cast<ptrdiff_t>(i)];
+
+        if ((chr & ~Utf8ContMask) == Utf8Cont) {
+            continue;
+        }
+
+        if (chr >= Utf8Len2) {
+            src -= i;
+            leadLen2--;
+            if (chr >= Utf8Latin1End) {
+                leadNonLatin1--;
+            }
+            if (chr >= Utf8Len3) {
+                leadLen3--;
+            }
+            if (chr >= Utf8Len4) {
+                leadLen4--;
+            }
+        }
+        break;
+    }
+
+    ASSERT(src >= start);
+    counts->charL1 = leadLen2 - leadNonLatin1;
+    counts->char2 = leadNonLatin1 - leadLen3;
+    counts->char3 = leadLen3 - leadLen4;
+    counts->char4 = leadLen4;
+    return validateUtf8Chars(src, end, counts);
+}
+
+// A high surrogate must be followed by a low surrogate, which is
+// checked by comparing each block with the block starting one unit later.
+static bool validateUtf16(const uint16_t* src, size_t length, UnicodeCounts* counts)
+{
+    const size_t unitCount = VectorSize / sizeof(uint16_t);
+    const uint16_t* start = src;
+    const uint16_t* end = src + length;
+
+    *counts = UnicodeCounts();
+
+    if (length <= unitCount) {
+        return validateUtf16Chars(src, end, end, counts);
+    }
+
+    if ((*src & Utf16PairMask) == Utf16LowSurrogate) {
+        return false;
+    }
+
+    const Vector pairMask = vectorSplat16(Utf16PairMask);
+    const Vector surrogateMask = vectorSplat16(Utf16AnySurrogateMask);
+    const Vector highSurrogate = vectorSplat16(Utf16HighSurrogate);
+    const Vector lowSurrogate = vectorSplat16(Utf16LowSurrogate);
+    const Vector char1Limit = vectorSplat16(UtfChar1Limit);
+    const Vector charL1Limit = vectorSplat16(UtfCharL1Limit);
+    const Vector char2Limit = vectorSplat16(UtfChar2Limit);
+
+    Vector error = vectorZero();
+    Vector countNonAscii = vectorZero();
+    Vector countNonLatin1 = vectorZero();
+    Vector countLen3 = vectorZero();
+    Vector countSurrogate = vectorZero();
+    Vector countHigh = vectorZero();
+    uint32_t iterations = 0;
+    uint32_t nonAscii = 0;
+    uint32_t nonLatin1 = 0;
+    uint32_t len3 = 0;
+    uint32_t surrogates = 0;
+    uint32_t highs = 0;
+
+    while (static_cast<size_t>(end - src) > unitCount) {
+        Vector input = vectorLoad(src);
+        Vector high = vectorEqual16(vectorAnd(input, pairMask), highSurrogate);
+        Vector nextLow = vectorEqual16(vectorAnd(vectorLoad(src + 1), pairMask), lowSurrogate);
+        error = vectorOr(error, vectorXor(high, nextLow));
+
+        countNonAscii = vectorSub16(countNonAscii, vectorGreaterEqual16(input, char1Limit));
+        countNonLatin1 = vectorSub16(countNonLatin1, vectorGreaterEqual16(input, charL1Limit));
+        countLen3 = vectorSub16(countLen3, vectorGreaterEqual16(input, char2Limit));
+        countSurrogate = vectorSub16(countSurrogate, vectorEqual16(vectorAnd(input, surrogateMask), highSurrogate));
+        countHigh = vectorSub16(countHigh, high);
+
+        if (++iterations == MaxHalfCounterIterations) {
+            nonAscii += vectorSum16(countNonAscii);
+            nonLatin1 += vectorSum16(countNonLatin1);
+            len3 += vectorSum16(countLen3);
+            surrogates += vectorSum16(countSurrogate);
+            highs += vectorSum16(countHigh);
+            countNonAscii = countNonLatin1 = countLen3 = countSurrogate = countHigh = vectorZero();
+            iterations = 0;
+        }
+
+        src += unitCount;
+    }
+
+    if (!vectorIsZero(error)) {
+        return false;
+    }
+
+    nonAscii += vectorSum16(countNonAscii);
+    nonLatin1 += vectorSum16(countNonLatin1);
+    len3 += vectorSum16(countLen3);
+    surrogates += vectorSum16(countSurrogate);
+    highs += vectorSum16(countHigh);
+
+    counts->charL1 = nonAscii - nonLatin1;
+    counts->char2 = nonLatin1 - len3;
+    counts->char3 = len3 - surrogates;
+    counts->char4 = highs;
+
+    // The low surrogate after the last block is already validated.
+    if ((src[-1] & Utf16PairMask) == Utf16HighSurrogate) {
+        src++;
+    }
+
+    ASSERT(src > start);
+    return validateUtf16Chars(src, end, end, counts);
+}
+
+static size_t countLatin1NonAscii(const uint8_t* src, size_t length)
+{
+    const uint8_t* end = src + length;
+    const Vector char1Limit = vectorSplat8(UtfChar1Limit);
+    Vector count = vectorZero();
+    uint32_t iterations = 0;
+    size_t result = 0;
+
+    while (static_cast<size_t>(end - src) >= VectorSize) {
+        count = vectorSub8(count, vectorGreaterEqual8(vectorLoad(src), char1Limit));
+        src += VectorSize;
+
+        if (++iterations == MaxByteCounterIterations) {
+            result += vectorSum8(count);
+            count = vectorZero();
+            iterations = 0;
+        }
+    }
+
+    result += vectorSum8(count);
+    while (src < end) {
+        if (*src++ >= UtfChar1Limit) {
+            result++;
+        }
+    }
+    return result;
+}
+
+static uint8_t* latin1ToUtf8(const uint8_t* src, size_t length, uint8_t* dst)
+{
+    const size_t unitCount = VectorSize / sizeof(uint16_t);
+    const uint8_t* end = src + length;
+
+    while (static_cast<size_t>(end - src) >= VectorSize) {
+        Vector input = vectorLoad(src);
+
+        if (vectorIsAscii(input)) {
+            vectorStore(dst, input);
+            src += VectorSize;
+            dst += VectorSize;
+            continue;
+        }
+
+        // The encoded stores may write past the encoded data, which is
+        // overwritten later when at least unitCount characters follow.
+        if (static_cast<size_t>(end - src) >= VectorSize + unitCount) {
+            uint16_t units[VectorSize];
+
+            vectorStoreWidened(units, input);
+            dst = vectorStoreUtf8Len2(dst, vectorLoad(units));
+            dst = vectorStoreUtf8Len2(dst, vectorLoad(units + unitCount));
+            src += VectorSize;
+            continue;
+        }
+        latin1ToUtf8Chars(src, src + VectorSize, dst);
+    }
+
+    latin1ToUtf8Chars(src, end, dst);
+    return dst;
+}
+
+static uint16_t* latin1ToUtf16(const uint8_t* src, size_t length, uint16_t* dst)
+{
+    const uint8_t* end = src + length;
+
+    while (static_cast<size_t>(end - src) >= VectorSize) {
+        vectorStoreWidened(dst, vectorLoad(src));
+        src += VectorSize;
+        dst += VectorSize;
+    }
+
+    while (src < end) {
+        *dst++ = *src++;
+    }
+    return dst;
+}
+
+static uint8_t* utf16ToLatin1(const uint16_t* src, size_t length, uint8_t* dst)
+{
+    const size_t unitCount = VectorSize / sizeof(uint16_t);
+    const uint16_t* end = src + length;
+
+    while (static_cast<size_t>(end - src) >= unitCount * 2) {
+        vectorStore(dst, vectorNarrow(vectorLoad(src), vectorLoad(src + unitCount)));
+        src += unitCount * 2;
+        dst += VectorSize;
+    }
+
+    while (src < end) {
+        *dst++ = static_cast<uint8_t>(*src++);
+    }
+    return dst;
+}
+
+static uint8_t* utf16ToUtf8(const uint16_t* src, size_t length, uint8_t* dst)
+{
+    const size_t unitCount = VectorSize / sizeof(uint16_t);
+    const uint16_t* end = src + length;
+    const Vector nonAsciiMask = vectorSplat16(static_cast<uint16_t>(~(UtfChar1Limit - 1)));
+    const Vector len3Mask = vectorSplat16(static_cast<uint16_t>(~(UtfChar2Limit - 1)));
+
+    while (static_cast<size_t>(end - src) >= unitCount * 2) {
+        Vector low = vectorLoad(src);
+        Vector high = vectorLoad(src + unitCount);
+
+        if (vectorIsZero(vectorAnd(vectorOr(low, high), nonAsciiMask))) {
+            vectorStore(dst, vectorNarrow(low, high));
+            src += unitCount * 2;
+            dst += VectorSize;
+            continue;
+        }
+
+        // Same as latin1ToUtf8: the stores may write past the encoded data.
+        if (static_cast<size_t>(end - src) >= unitCount * 3
+            && vectorIsZero(vectorAnd(vectorOr(low, high), len3Mask))) {
+            dst = vectorStoreUtf8Len2(dst, low);
+            dst = vectorStoreUtf8Len2(dst, high);
+            src += unitCount * 2;
+            continue;
+        }
+        utf16ToUtf8Chars(src, src + unitCount * 2, dst);
+    }
+
+    utf16ToUtf8Chars(src, end, dst);
+    return dst;
+}
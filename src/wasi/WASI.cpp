@@ -25,9 +25,15 @@
 
 namespace Walrus {
 
-uvwasi_t* WASI::g_uvwasi;
 WASI::WasiFuncInfo WASI::g_wasiFunctions[WasiFuncIndex::FuncEnd];
 
+static inline uvwasi_t* get_context(Instance* instance)
+{
+    uvwasi_t* context = instance->store()->wasiContext();
+    ASSERT(context != nullptr);
+    return context;
+}
+
 static void* get_memory_pointer(Instance* instance, Value& value, size_t size)
 {
     Memory* memory = instance->memory(0);
@@ -78,11 +84,8 @@ private:
     T* m_data;
 };
 
-void WASI::initialize(uvwasi_t* uvwasi)
+void WASI::initialize()
 {
-    ASSERT(!!uvwasi);
-    g_uvwasi = uvwasi;
-
     // fill wasi function table
 #define WASI_FUNC_TABLE(NAME, FUNCTYPE)                                        \
     g_wasiFunctions[WasiFuncIndex::NAME##FUNC].name = #NAME;                   \
@@ -106,7 +109,7 @@ void WASI::args_get(ExecutionState& state, Value* argv, Value* result, Instance*
 {
     uvwasi_size_t argc;
     uvwasi_size_t bufSize;
-    uvwasi_args_sizes_get(WASI::g_uvwasi, &argc, &bufSize);
+    uvwasi_args_sizes_get(get_context(instance), &argc, &bufSize);
 
     uint32_t* uvArgv = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[0], argc * sizeof(uint32_t)));
     char* uvArgBuf = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], bufSize));
@@ -119,7 +122,7 @@ void WASI::args_get(ExecutionState& state, Value* argv, Value* result, Instance*
     TemporaryData<void*, 8> pointers(argc);
 
     char** data = reinterpret_cast<char**>(pointers.data());
-    uvwasi_errno_t error = uvwasi_args_get(WASI::g_uvwasi, data, uvArgBuf);
+    uvwasi_errno_t error = uvwasi_args_get(get_context(instance), data, uvArgBuf);
 
     if (error == WasiErrNo::success) {
         char* buffer = reinterpret_cast<char*>(instance->memory(0)->buffer());
@@ -136,34 +139,34 @@ void WASI::args_sizes_get(ExecutionState& state, Value* argv, Value* result, Ins
     uvwasi_size_t* uvArgc = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[0], sizeof(uint32_t)));
     uvwasi_size_t* uvArgvBufSize = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[1], sizeof(uint32_t)));
 
-    result[0] = Value(static_cast<int16_t>(uvwasi_args_sizes_get(WASI::g_uvwasi, uvArgc, uvArgvBufSize)));
+    result[0] = Value(static_cast<int16_t>(uvwasi_args_sizes_get(get_context(instance), uvArgc, uvArgvBufSize)));
 }
 
 void WASI::proc_exit(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     ASSERT(argv[0].type() == Value::I32);
-    uvwasi_proc_exit(WASI::g_uvwasi, argv[0].asI32());
+    uvwasi_proc_exit(get_context(instance), argv[0].asI32());
     ASSERT_NOT_REACHED();
 }
 
 void WASI::proc_raise(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     ASSERT(argv[0].type() == Value::I32);
-    result[0] = Value(uvwasi_proc_raise(WASI::g_uvwasi, argv[0].asI32()));
+    result[0] = Value(uvwasi_proc_raise(get_context(instance), argv[0].asI32()));
 }
 
 void WASI::clock_res_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uvwasi_timestamp_t* out_addr = reinterpret_cast<uvwasi_timestamp_t*>(get_memory_pointer(instance, argv[1], sizeof(uvwasi_timestamp_t)));
 
-    result[0] = Value(uvwasi_clock_res_get(WASI::g_uvwasi, argv[0].asI32(), out_addr));
+    result[0] = Value(uvwasi_clock_res_get(get_context(instance), argv[0].asI32(), out_addr));
 }
 
 void WASI::clock_time_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uvwasi_timestamp_t* out_addr = reinterpret_cast<uvwasi_timestamp_t*>(get_memory_pointer(instance, argv[2], sizeof(uvwasi_timestamp_t)));
 
-    result[0] = Value(uvwasi_clock_time_get(WASI::g_uvwasi, argv[0].asI32(), argv[1].asI64(), out_addr));
+    result[0] = Value(uvwasi_clock_time_get(get_context(instance), argv[0].asI32(), argv[1].asI64(), out_addr));
 }
 
 void WASI::fd_write(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -194,7 +197,7 @@ void WASI::fd_write(ExecutionState& state, Value* argv, Value* result, Instance*
         iovptr += 2;
     }
 
-    result[0] = Value(uvwasi_fd_write(WASI::g_uvwasi, fd, iovs, iovsLen, nwritten));
+    result[0] = Value(uvwasi_fd_write(get_context(instance), fd, iovs, iovsLen, nwritten));
 }
 
 void WASI::fd_tell(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -202,7 +205,7 @@ void WASI::fd_tell(ExecutionState& state, Value* argv, Value* result, Instance*
     uint32_t fd = argv[0].asI32();
     uvwasi_filesize_t* offset = reinterpret_cast<uvwasi_filesize_t*>(get_memory_pointer(instance, argv[1], sizeof(uvwasi_filesize_t)));
 
-    result[0] = Value(uvwasi_fd_tell(WASI::g_uvwasi, fd, offset));
+    result[0] = Value(uvwasi_fd_tell(get_context(instance), fd, offset));
 }
 
 void WASI::fd_read(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -233,7 +236,7 @@ void WASI::fd_read(ExecutionState& state, Value* argv, Value* result, Instance*
         iovptr += 2;
     }
 
-    result[0] = Value(uvwasi_fd_read(WASI::g_uvwasi, fd, iovs, iovsLen, nread));
+    result[0] = Value(uvwasi_fd_read(get_context(instance), fd, iovs, iovsLen, nread));
 }
 
 void WASI::fd_pread(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -265,7 +268,7 @@ void WASI::fd_pread(ExecutionState& state, Value* argv, Value* result, Instance*
         iovptr += 2;
     }
 
-    result[0] = Value(uvwasi_fd_pread(WASI::g_uvwasi, fd, iovs, iovsLen, offset, nread));
+    result[0] = Value(uvwasi_fd_pread(get_context(instance), fd, iovs, iovsLen, offset, nread));
 }
 
 void WASI::fd_readdir(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -276,28 +279,28 @@ void WASI::fd_readdir(ExecutionState& state, Value* argv, Value* result, Instanc
     uint64_t cookie = argv[3].asI64();
     uint32_t* bufUsed = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[4], sizeof(uint32_t)));
 
-    result[0] = Value(uvwasi_fd_readdir(WASI::g_uvwasi, fd, buf, bufLen, cookie, bufUsed));
+    result[0] = Value(uvwasi_fd_readdir(get_context(instance), fd, buf, bufLen, cookie, bufUsed));
 }
 
 void WASI::fd_close(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uint32_t fd = argv[0].asI32();
 
-    result[0] = Value(uvwasi_fd_close(WASI::g_uvwasi, fd));
+    result[0] = Value(uvwasi_fd_close(get_context(instance), fd));
 }
 
 void WASI::fd_datasync(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uint32_t fd = argv[0].asI32();
 
-    result[0] = Value(uvwasi_fd_datasync(WASI::g_uvwasi, fd));
+    result[0] = Value(uvwasi_fd_datasync(get_context(instance), fd));
 }
 
 void WASI::fd_sync(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uint32_t fd = argv[0].asI32();
 
-    result[0] = Value(uvwasi_fd_sync(WASI::g_uvwasi, fd));
+    result[0] = Value(uvwasi_fd_sync(get_context(instance), fd));
 }
 
 void WASI::fd_renumber(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -305,7 +308,7 @@ void WASI::fd_renumber(ExecutionState& state, Value* argv, Value* result, Instan
     uint32_t from = argv[0].asI32();
     uint32_t to = argv[1].asI32();
 
-    result[0] = Value(uvwasi_fd_renumber(WASI::g_uvwasi, from, to));
+    result[0] = Value(uvwasi_fd_renumber(get_context(instance), from, to));
 }
 
 void WASI::fd_filestat_set_times(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -315,7 +318,7 @@ void WASI::fd_filestat_set_times(ExecutionState& state, Value* argv, Value* resu
     uint64_t st_mtim = argv[2].asI64();
     uint32_t fst_flags = argv[3].asI32();
 
-    result[0] = Value(uvwasi_fd_filestat_set_times(WASI::g_uvwasi, fd, st_atim, st_mtim, fst_flags));
+    result[0] = Value(uvwasi_fd_filestat_set_times(get_context(instance), fd, st_atim, st_mtim, fst_flags));
 }
 
 void WASI::sock_shutdown(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -323,7 +326,89 @@ void WASI::sock_shutdown(ExecutionState& state, Value* argv, Value* result, Inst
     uint32_t sock = argv[0].asI32();
     uint32_t how = argv[1].asI32();
 
-    result[0] = Value(uvwasi_sock_shutdown(WASI::g_uvwasi, sock, how));
+    result[0] = Value(uvwasi_sock_shutdown(get_context(instance), sock, how));
+}
+
+void WASI::sock_accept(ExecutionState& state, Value* argv, Value* result, Instance* instance)
+{
+    uint32_t sock = argv[0].asI32();
+    uint32_t flags = argv[1].asI32();
+    uvwasi_fd_t* fd = reinterpret_cast<uvwasi_fd_t*>(get_memory_pointer(instance, argv[2], sizeof(uvwasi_fd_t)));
+
+    if (fd == nullptr) {
+        result[0] = Value(WasiErrNo::inval);
+        return;
+    }
+
+    result[0] = Value(uvwasi_sock_accept(get_context(instance), sock, flags, fd));
+}
+
+// The preview1 socket functions block until data is available, since uvwasi
+// does not expose the non-blocking flag of accepted sockets. Non-blocking
+// transfers are provided by the WASI 0.2 tcp streams.
+void WASI::sock_recv(ExecutionState& state, Value* argv, Value* result, Instance* instance)
+{
+    uint32_t sock = argv[0].asI32();
+    size_t iovsLen = static_cast<size_t>(argv[2].asI32());
+    uint32_t riFlags = argv[3].asI32();
+    uint32_t* iovptr = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[1], iovsLen * (sizeof(uint32_t) << 1)));
+    uvwasi_size_t* nread = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[4], sizeof(uvwasi_size_t)));
+    uvwasi_roflags_t* roFlags = reinterpret_cast<uvwasi_roflags_t*>(get_memory_pointer(instance, argv[5], sizeof(uvwasi_roflags_t)));
+
+    if (iovptr == nullptr || nread == nullptr || roFlags == nullptr) {
+        result[0] = Value(WasiErrNo::inval);
+        return;
+    }
+
+    TemporaryData<uvwasi_iovec_t, 8> iovsBuffer(iovsLen);
+    uvwasi_iovec_t* iovs = iovsBuffer.data();
+    uint64_t sizeInByte = instance->memory(0)->sizeInByte();
+    uint8_t* buffer = instance->memory(0)->buffer();
+
+    for (uint32_t i = 0; i < iovsLen; i++) {
+        if (iovptr[1] > sizeInByte || iovptr[0] > sizeInByte - iovptr[1]) {
+            result[0] = Value(WasiErrNo::inval);
+            return;
+        }
+
+        iovs[i].buf = buffer + iovptr[0];
+        iovs[i].buf_len = iovptr[1];
+        iovptr += 2;
+    }
+
+    result[0] = Value(uvwasi_sock_recv(get_context(instance), sock, iovs, iovsLen, riFlags, nread, roFlags));
+}
+
+void WASI::sock_send(ExecutionState& state, Value* argv, Value* result, Instance* instance)
+{
+    uint32_t sock = argv[0].asI32();
+    size_t iovsLen = static_cast<size_t>(argv[2].asI32());
+    uint32_t siFlags = argv[3].asI32();
+    uint32_t* iovptr = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[1], iovsLen * (sizeof(uint32_t) << 1)));
+    uvwasi_size_t* nwritten = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[4], sizeof(uvwasi_size_t)));
+
+    if (iovptr == nullptr || nwritten == nullptr) {
+        result[0] = Value(WasiErrNo::inval);
+        return;
+    }
+
+    TemporaryData<uvwasi_ciovec_t, 8> iovsBuffer(iovsLen);
+    uvwasi_ciovec_t* iovs = iovsBuffer.data();
+    uint64_t sizeInByte = instance->memory(0)->sizeInByte();
+    uint8_t* buffer = instance->memory(0)->buffer();
+
+    for (uint32_t i = 0; i < iovsLen; i++) {
+        if (iovptr[1] > sizeInByte || iovptr[0] > sizeInByte - iovptr[1]) {
+            result[0] = Value(WasiErrNo::inval);
+            return;
+        }
+
+        iovs[i].buf = buffer + iovptr[0];
+        iovs[i].buf_len = iovptr[1];
+        iovptr += 2;
+    }
+
+    result[0] = Value(uvwasi_sock_send(get_context(instance), sock, iovs, iovsLen, siFlags, nwritten));
 }
 
 void WASI::fd_fdstat_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -331,7 +416,7 @@ void WASI::fd_fdstat_get(ExecutionState& state, Value* argv, Value* result, Inst
     uint32_t fd = argv[0].asI32();
     uvwasi_fdstat_t* fdstat = reinterpret_cast<uvwasi_fdstat_t*>(get_memory_pointer(instance, argv[1], sizeof(uvwasi_fdstat_t)));
 
-    result[0] = Value(uvwasi_fd_fdstat_get(WASI::g_uvwasi, fd, fdstat));
+    result[0] = Value(uvwasi_fd_fdstat_get(get_context(instance), fd, fdstat));
 }
 
 void WASI::fd_fdstat_set_flags(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -339,7 +424,7 @@ void WASI::fd_fdstat_set_flags(ExecutionState& state, Value* argv, Value* result
     uint32_t fd = argv[0].asI32();
     uint32_t fdflags = argv[1].asI32();
 
-    result[0] = Value(uvwasi_fd_fdstat_set_flags(WASI::g_uvwasi, fd, fdflags));
+    result[0] = Value(uvwasi_fd_fdstat_set_flags(get_context(instance), fd, fdflags));
 }
 
 void WASI::fd_prestat_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -347,7 +432,7 @@ void WASI::fd_prestat_get(ExecutionState& state, Value* argv, Value* result, Ins
     uint32_t fd = argv[0].asI32();
     uvwasi_prestat_t* buf = reinterpret_cast<uvwasi_prestat_t*>(get_memory_pointer(instance, argv[1], sizeof(uvwasi_prestat_t)));
 
-    result[0] = Value(uvwasi_fd_prestat_get(WASI::g_uvwasi, fd, buf));
+    result[0] = Value(uvwasi_fd_prestat_get(get_context(instance), fd, buf));
 }
 
 void WASI::fd_prestat_dir_name(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -356,7 +441,7 @@ void WASI::fd_prestat_dir_name(ExecutionState& state, Value* argv, Value* result
     uint32_t length = argv[2].asI32();
     char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], length));
 
-    result[0] = Value(uvwasi_fd_prestat_dir_name(WASI::g_uvwasi, fd, path, length));
+    result[0] = Value(uvwasi_fd_prestat_dir_name(get_context(instance), fd, path, length));
 }
 
 void WASI::fd_seek(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -366,7 +451,7 @@ void WASI::fd_seek(ExecutionState& state, Value* argv, Value* result, Instance*
     uint32_t whence = argv[2].asI32();
     uvwasi_filesize_t* file_size = reinterpret_cast<uvwasi_filesize_t*>(get_memory_pointer(instance, argv[3], sizeof(uvwasi_filesize_t)));
 
-    result[0] = Value(uvwasi_fd_seek(WASI::g_uvwasi, fd, fileDelta, whence, file_size));
+    result[0] = Value(uvwasi_fd_seek(get_context(instance), fd, fileDelta, whence, file_size));
 }
 
 void WASI::fd_filestat_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -374,7 +459,7 @@ void WASI::fd_filestat_get(ExecutionState& state, Value* argv, Value* result, In
     uint32_t fd = argv[0].asI32();
     uvwasi_filestat_t* buf = reinterpret_cast<uvwasi_filestat_t*>(get_memory_pointer(instance, argv[1], sizeof(uvwasi_filestat_t)));
 
-    result[0] = Value(uvwasi_fd_filestat_get(WASI::g_uvwasi, fd, buf));
+    result[0] = Value(uvwasi_fd_filestat_get(get_context(instance), fd, buf));
 }
 
 void WASI::fd_advise(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -384,7 +469,7 @@ void WASI::fd_advise(ExecutionState& state, Value* argv, Value* result, Instance
     uint64_t len = argv[2].asI64();
     uint32_t advise = argv[3].asI32();
 
-    result[0] = Value(uvwasi_fd_advise(WASI::g_uvwasi, fd, offset, len, advise));
+    result[0] = Value(uvwasi_fd_advise(get_context(instance), fd, offset, len, advise));
 }
 
 void WASI::path_open(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -399,7 +484,7 @@ void WASI::path_open(ExecutionState& state, Value* argv, Value* result, Instance
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[2], length));
     uvwasi_fd_t* ret_fd = reinterpret_cast<uvwasi_fd_t*>(get_memory_pointer(instance, argv[8], sizeof(uvwasi_fd_t)));
 
-    result[0] = Value(uvwasi_path_open(WASI::g_uvwasi, fd, dirflags, path, length,
+    result[0] = Value(uvwasi_path_open(get_context(instance), fd, dirflags, path, length,
                                        oflags, rights, right_inheriting, fdflags, ret_fd));
 }
 
@@ -412,7 +497,7 @@ void WASI::path_readlink(ExecutionState& state, Value* argv, Value* result, Inst
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], path_len));
     char* buf = reinterpret_cast<char*>(get_memory_pointer(instance, argv[3], buf_len));
 
-    result[0] = Value(uvwasi_path_readlink(g_uvwasi, fd, path, path_len, buf, buf_len, bufused));
+    result[0] = Value(uvwasi_path_readlink(get_context(instance), fd, path, path_len, buf, buf_len, bufused));
 }
 
 void WASI::path_create_directory(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -421,7 +506,7 @@ void WASI::path_create_directory(ExecutionState& state, Value* argv, Value* resu
     uint32_t length = argv[2].asI32();
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], length));
 
-    result[0] = Value(uvwasi_path_create_directory(WASI::g_uvwasi, fd, path, length));
+    result[0] = Value(uvwasi_path_create_directory(get_context(instance), fd, path, length));
 }
 
 void WASI::path_remove_directory(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -430,7 +515,7 @@ void WASI::path_remove_directory(ExecutionState& state, Value* argv, Value* resu
     uint32_t length = argv[2].asI32();
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], length));
 
-    result[0] = Value(uvwasi_path_remove_directory(WASI::g_uvwasi, fd, path, length));
+    result[0] = Value(uvwasi_path_remove_directory(get_context(instance), fd, path, length));
 }
 
 void WASI::path_filestat_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -441,7 +526,7 @@ void WASI::path_filestat_get(ExecutionState& state, Value* argv, Value* result,
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[2], length));
     uvwasi_filestat_t* buf = reinterpret_cast<uvwasi_filestat_t*>(get_memory_pointer(instance, argv[4], sizeof(uvwasi_filestat_t)));
 
-    result[0] = Value(uvwasi_path_filestat_get(WASI::g_uvwasi, fd, flags, path, length, buf));
+    result[0] = Value(uvwasi_path_filestat_get(get_context(instance), fd, flags, path, length, buf));
 }
 
 void WASI::path_filestat_set_times(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -454,7 +539,7 @@ void WASI::path_filestat_set_times(ExecutionState& state, Value* argv, Value* re
     uint64_t st_mtim = argv[5].asI64();
     uint32_t fst_flags = argv[6].asI32();
 
-    result[0] = Value(uvwasi_path_filestat_set_times(WASI::g_uvwasi, fd, flags, path, length, st_atim, st_mtim, fst_flags));
+    result[0] = Value(uvwasi_path_filestat_set_times(get_context(instance), fd, flags, path, length, st_atim, st_mtim, fst_flags));
 }
 
 void WASI::path_rename(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -466,7 +551,7 @@ void WASI::path_rename(ExecutionState& state, Value* argv, Value* result, Instan
     uint32_t newLength = argv[5].asI32();
     const char* newPath = reinterpret_cast<char*>(get_memory_pointer(instance, argv[4], newLength));
 
-    result[0] = Value(uvwasi_path_rename(WASI::g_uvwasi, oldFd, oldPath, oldLength, newFd, newPath, newLength));
+    result[0] = Value(uvwasi_path_rename(get_context(instance), oldFd, oldPath, oldLength, newFd, newPath, newLength));
 }
 
 void WASI::path_unlink_file(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -475,7 +560,7 @@ void WASI::path_unlink_file(ExecutionState& state, Value* argv, Value* result, I
     uint32_t length = argv[2].asI32();
     const char* path = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], length));
 
-    result[0] = Value(uvwasi_path_unlink_file(WASI::g_uvwasi, fd, path, length));
+    result[0] = Value(uvwasi_path_unlink_file(get_context(instance), fd, path, length));
 }
 
 void WASI::poll_oneoff(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -485,7 +570,7 @@ void WASI::poll_oneoff(ExecutionState& state, Value* argv, Value* result, Instan
     uint32_t nsubscriptions = argv[2].asI32();
     uint32_t* nevents = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[3], sizeof(uint32_t)));
 
-    result[0] = Value(uvwasi_poll_oneoff(WASI::g_uvwasi, in, out, nsubscriptions, nevents));
+    result[0] = Value(uvwasi_poll_oneoff(get_context(instance), in, out, nsubscriptions, nevents));
 }
 
 void WASI::environ_sizes_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
@@ -493,14 +578,14 @@ void WASI::environ_sizes_get(ExecutionState& state, Value* argv, Value* result,
     uvwasi_size_t* uvCount = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[0], sizeof(uint32_t)));
     uvwasi_size_t* uvBufSize = reinterpret_cast<uvwasi_size_t*>(get_memory_pointer(instance, argv[1], sizeof(uint32_t)));
 
-    result[0] = Value(uvwasi_environ_sizes_get(WASI::g_uvwasi, uvCount, uvBufSize));
+    result[0] = Value(uvwasi_environ_sizes_get(get_context(instance), uvCount, uvBufSize));
 }
 
 void WASI::environ_get(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
     uvwasi_size_t count;
     uvwasi_size_t size;
-    uvwasi_environ_sizes_get(WASI::g_uvwasi, &count, &size);
+    uvwasi_environ_sizes_get(get_context(instance), &count, &size);
 
     uint32_t* uvEnviron = reinterpret_cast<uint32_t*>(get_memory_pointer(instance, argv[0], count * sizeof(uint32_t)));
     char* uvEnvironBuf = reinterpret_cast<char*>(get_memory_pointer(instance, argv[1], size));
@@ -513,7 +598,7 @@ void WASI::environ_get(ExecutionState& state, Value* argv, Value* result, Instan
     TemporaryData<void*, 8> pointers(count);
 
     char** data = reinterpret_cast<char**>(pointers.data());
-    uvwasi_errno_t error = uvwasi_environ_get(WASI::g_uvwasi, data, uvEnvironBuf);
+    uvwasi_errno_t error = uvwasi_environ_get(get_context(instance), data, uvEnvironBuf);
 
     if (error == WasiErrNo::success) {
         char* buffer = reinterpret_cast<char*>(instance->memory(0)->buffer());
@@ -530,12 +615,12 @@ void WASI::random_get(ExecutionState& state, Value* argv, Value* result, Instanc
     uint32_t length = argv[1].asI32();
     void* buf = get_memory_pointer(instance, argv[0], length);
 
-    result[0] = Value(uvwasi_random_get(WASI::g_uvwasi, buf, length));
+    result[0] = Value(uvwasi_random_get(get_context(instance), buf, length));
 }
 
 void WASI::sched_yield(ExecutionState& state, Value* argv, Value* result, Instance* instance)
 {
-    result[0] = Value(uvwasi_sched_yield(WASI::g_uvwasi));
+    result[0] = Value(uvwasi_sched_yield(get_context(instance)));
 }
 
 } // namespace Walrus
@@ -72,6 +72,9 @@ public:
     F(environ_get, I32I32_RI32)                            \
     F(environ_sizes_get, I32I32_RI32)                      \
     F(sched_yield, RI32)                                   \
+    F(sock_accept, I32I32I32_RI32)                         \
+    F(sock_recv, I32I32I32I32I32I32_RI32)                  \
+    F(sock_send, I32I32I32I32I32_RI32)                     \
     F(sock_shutdown, I32I32_RI32)
 
 #define ERRORS(ERR)                                                   \
@@ -172,7 +175,7 @@ public:
             FuncEnd,
     };
 
-    static void initialize(uvwasi_t* uvwasi);
+    static void initialize();
     static WasiFuncInfo* find(const std::string& funcName);
 
 private:
@@ -181,7 +184,6 @@ private:
     FOR_EACH_WASI_FUNC(DECLARE_FUNCTION)
 #undef DECLARE_FUNCTION
 
-    static uvwasi_t* g_uvwasi;
     static WasiFuncInfo g_wasiFunctions[FuncEnd];
 };
 
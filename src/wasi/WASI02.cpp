@@ -22,9 +22,11 @@
 
 namespace Walrus {
 
-WasiStoreData::WasiStoreData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens)
+WasiStoreData::WasiStoreData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens, bool inheritNetwork)
     : m_prevNow(0)
     , m_prevClockNow(clock())
+    , m_pendingOutput(nullptr)
+    , m_inheritNetwork(inheritNetwork)
 {
     m_arguments.reserve(static_cast<size_t>(argc));
     while (argc-- > 0) {
@@ -53,12 +55,60 @@ WasiStoreData::WasiStoreData(int argc, const char** argv, const char** envp, Was
 
     for (auto& it : preOpens) {
         m_preOpens.push_back(std::pair<std::string, std::string>(it.mappedPath, it.realPath));
+
+        // Archives are mounted as in-memory file systems.
+        m_fileSystems.push_back(it.image != nullptr ? new WasiVirtualFileSystem(it.image) : nullptr);
+    }
+}
+
+WasiStoreData::~WasiStoreData()
+{
+    flushPendingOutput();
+
+    for (auto fileSystem : m_fileSystems) {
+        delete fileSystem;
+    }
+}
+
+void WasiStoreData::flushPendingOutput()
+{
+    if (m_pendingOutput != nullptr) {
+        // A failure is reported by the next operation of the stream.
+        m_pendingOutput->flush();
+        ASSERT(m_pendingOutput == nullptr);
+    }
+}
+
+bool wasi02LoadImages(Wasi02DirMap& preOpens, std::string& error)
+{
+    for (auto& it : preOpens) {
+        uv_fs_t req;
+        if (uv_fs_stat(nullptr, &req, it.realPath, nullptr) != 0 || (req.statbuf.st_mode & S_IFMT) != S_IFREG) {
+            continue;
+        }
+
+        it.image = WasiFileSystemImage::load(it.realPath, error);
+        if (it.image == nullptr) {
+            error = std::string(it.realPath) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+void wasi02ReleaseImages(Wasi02DirMap& preOpens)
+{
+    for (auto& it : preOpens) {
+        if (it.image != nullptr) {
+            it.image->releaseRef();
+            it.image = nullptr;
+        }
     }
 }
 
-WasiStoreData* wasi02InitData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens)
+WasiStoreData* wasi02InitData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens, bool inheritNetwork)
 {
-    return new WasiStoreData(argc, argv, envp, preOpens);
+    return new WasiStoreData(argc, argv, envp, preOpens, inheritNetwork);
 }
 
 void destroyWasi02Data(WasiStoreData* data)
@@ -98,6 +148,10 @@ enum WasiNamedInstances : size_t {
     InstanceWasiNNErrors02,
     InstanceWasiNNInference02,
     InstanceWasiNNGraph02,
+    InstanceSocketsNetwork02,
+    InstanceSocketsInstanceNetwork02,
+    InstanceSocketsTcpCreateSocket02,
+    InstanceSocketsTcp02,
 };
 
 class ComponentInstanceWasi02 {
@@ -367,6 +421,15 @@ ComponentInstance* ComponentInstanceWasi02::loadInstance(size_t instanceId, bool
         timeType->addRef();
         nowType->result() = timeType;
         addFuncExport(instance, "now", LiftedWasiFunction::clockMonotonicNow02, nowType);
+        ComponentTypeFunc* resolutionType = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        instance->type()->getType(1)->addRef();
+        resolutionType->result() = ComponentTypeRef(instance->type()->getType(1));
+        addFuncExport(instance, "resolution", LiftedWasiFunction::clockMonotonicResolution02, resolutionType);
+        ComponentTypeFunc* subscribeInstantType = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        instance->type()->getType(0)->addRef();
+        subscribeInstantType->params().push_back(ComponentTypeFunc::Param{ "when", ComponentTypeRef(instance->type()->getType(0)) });
+        subscribeInstantType->result() = new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(2));
+        addFuncExport(instance, "subscribe-instant", LiftedWasiFunction::clockSubscribeInstant02, subscribeInstantType);
         ComponentTypeFunc* subscribeDurationType = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
         instance->type()->getType(1)->addRef();
         subscribeDurationType->params().push_back(ComponentTypeFunc::Param{ "when", ComponentTypeRef(instance->type()->getType(1)) });
@@ -658,6 +721,204 @@ ComponentInstance* ComponentInstanceWasi02::loadInstance(size_t instanceId, bool
         addFuncExport(instance, "load", LiftedWasiFunction::neuralNetworkGraphLoad02, load);
         return instance;
     }
+    case InstanceSocketsNetwork02: {
+        m_type = new ComponentType(ComponentType::ComponentTypeKind);
+        ComponentInstance* instance = ComponentInstance::createInstance(m_store, m_type);
+        addResourceExport(instance, "network"); /* 0 */
+        ComponentTypeLabels* errorCode = new ComponentTypeLabels(ComponentRefCounted::EnumKind);
+        errorCode->labels().push_back("unknown");
+        errorCode->labels().push_back("access-denied");
+        errorCode->labels().push_back("not-supported");
+        errorCode->labels().push_back("invalid-argument");
+        errorCode->labels().push_back("out-of-memory");
+        errorCode->labels().push_back("timeout");
+        errorCode->labels().push_back("concurrency-conflict");
+        errorCode->labels().push_back("not-in-progress");
+        errorCode->labels().push_back("would-block");
+        errorCode->labels().push_back("invalid-state");
+        errorCode->labels().push_back("new-socket-limit");
+        errorCode->labels().push_back("address-not-bindable");
+        errorCode->labels().push_back("address-in-use");
+        errorCode->labels().push_back("remote-unreachable");
+        errorCode->labels().push_back("connection-refused");
+        errorCode->labels().push_back("connection-reset");
+        errorCode->labels().push_back("connection-aborted");
+        errorCode->labels().push_back("datagram-too-large");
+        errorCode->labels().push_back("name-unresolvable");
+        errorCode->labels().push_back("temporary-resolver-failure");
+        errorCode->labels().push_back("permanent-resolver-failure");
+        addTypeExport(instance, "error-code", errorCode); /* 1 */
+        ComponentTypeLabels* addressFamily = new ComponentTypeLabels(ComponentRefCounted::EnumKind);
+        addressFamily->labels().push_back("ipv4");
+        addressFamily->labels().push_back("ipv6");
+        addTypeExport(instance, "ip-address-family", addressFamily); /* 2 */
+        ComponentTypeTuple* ipv4Address = new ComponentTypeTuple();
+        for (int i = 0; i < 4; i++) {
+            ipv4Address->items().push_back(ComponentTypeRef(ComponentTypeRef::U8));
+        }
+        addTypeExport(instance, "ipv4-address", ipv4Address); /* 3 */
+        ComponentTypeTuple* ipv6Address = new ComponentTypeTuple();
+        for (int i = 0; i < 8; i++) {
+            ipv6Address->items().push_back(ComponentTypeRef(ComponentTypeRef::U16));
+        }
+        addTypeExport(instance, "ipv6-address", ipv6Address); /* 4 */
+        ComponentTypeItems* ipAddress = new ComponentTypeItems(ComponentRefCounted::VariantKind);
+        ipv4Address->addRef();
+        ipAddress->items().push_back(ComponentTypeItems::Item{ "ipv4", ComponentTypeRef(ipv4Address) });
+        ipv6Address->addRef();
+        ipAddress->items().push_back(ComponentTypeItems::Item{ "ipv6", ComponentTypeRef(ipv6Address) });
+        addTypeExport(instance, "ip-address", ipAddress); /* 5 */
+        ComponentTypeItems* ipv4SocketAddress = new ComponentTypeItems(ComponentRefCounted::RecordKind);
+        ipv4SocketAddress->items().push_back(ComponentTypeItems::Item{ "port", ComponentTypeRef(ComponentTypeRef::U16) });
+        ipv4Address->addRef();
+        ipv4SocketAddress->items().push_back(ComponentTypeItems::Item{ "address", ComponentTypeRef(ipv4Address) });
+        addTypeExport(instance, "ipv4-socket-address", ipv4SocketAddress); /* 6 */
+        ComponentTypeItems* ipv6SocketAddress = new ComponentTypeItems(ComponentRefCounted::RecordKind);
+        ipv6SocketAddress->items().push_back(ComponentTypeItems::Item{ "port", ComponentTypeRef(ComponentTypeRef::U16) });
+        ipv6SocketAddress->items().push_back(ComponentTypeItems::Item{ "flow-info", ComponentTypeRef(ComponentTypeRef::U32) });
+        ipv6Address->addRef();
+        ipv6SocketAddress->items().push_back(ComponentTypeItems::Item{ "address", ComponentTypeRef(ipv6Address) });
+        ipv6SocketAddress->items().push_back(ComponentTypeItems::Item{ "scope-id", ComponentTypeRef(ComponentTypeRef::U32) });
+        addTypeExport(instance, "ipv6-socket-address", ipv6SocketAddress); /* 7 */
+        ComponentTypeItems* ipSocketAddress = new ComponentTypeItems(ComponentRefCounted::VariantKind);
+        ipv4SocketAddress->addRef();
+        ipSocketAddress->items().push_back(ComponentTypeItems::Item{ "ipv4", ComponentTypeRef(ipv4SocketAddress) });
+        ipv6SocketAddress->addRef();
+        ipSocketAddress->items().push_back(ComponentTypeItems::Item{ "ipv6", ComponentTypeRef(ipv6SocketAddress) });
+        addTypeExport(instance, "ip-socket-address", ipSocketAddress); /* 8 */
+        return instance;
+    }
+    case InstanceSocketsInstanceNetwork02: {
+        m_type = new ComponentType(ComponentType::ComponentTypeKind);
+        ComponentInstance* instance = ComponentInstance::createInstance(m_store, m_type);
+        ComponentInstance* networkInstance = loadInstance(InstanceSocketsNetwork02);
+        instance->m_instances.push_back(networkInstance);
+        aliasTypeExport(instance, "network", networkInstance->type()->getType(0)); /* 0 */
+        ComponentTypeFunc* instanceNetwork = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        instanceNetwork->result() = new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(0));
+        addFuncExport(instance, "instance-network", LiftedWasiFunction::socketsInstanceNetwork02, instanceNetwork);
+        return instance;
+    }
+    case InstanceSocketsTcpCreateSocket02: {
+        m_type = new ComponentType(ComponentType::ComponentTypeKind);
+        ComponentInstance* instance = ComponentInstance::createInstance(m_store, m_type);
+        ComponentInstance* networkInstance = loadInstance(InstanceSocketsNetwork02);
+        instance->m_instances.push_back(networkInstance);
+        aliasTypeExport(instance, "network", networkInstance->type()->getType(0)); /* 0 */
+        aliasTypeExport(instance, "error-code", networkInstance->type()->getType(1)); /* 1 */
+        aliasTypeExport(instance, "ip-address-family", networkInstance->type()->getType(2)); /* 2 */
+        ComponentInstance* tcpInstance = loadInstance(InstanceSocketsTcp02);
+        instance->m_instances.push_back(tcpInstance);
+        aliasTypeExport(instance, "tcp-socket", tcpInstance->type()->getType(0)); /* 3 */
+        ComponentTypeFunc* createTcpSocket = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        instance->type()->getType(2)->addRef();
+        createTcpSocket->params().push_back(ComponentTypeFunc::Param{ "address-family", ComponentTypeRef(instance->type()->getType(2)) });
+        instance->type()->getType(1)->addRef();
+        createTcpSocket->result() = new ComponentTypeResult(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(3))), ComponentTypeRef(instance->type()->getType(1)));
+        addFuncExport(instance, "create-tcp-socket", LiftedWasiFunction::socketsCreateTcpSocket02, createTcpSocket);
+        return instance;
+    }
+    case InstanceSocketsTcp02: {
+        m_type = new ComponentType(ComponentType::ComponentTypeKind);
+        ComponentInstance* instance = ComponentInstance::createInstance(m_store, m_type);
+        ComponentRefCounted* tcpSocket = addResourceExport(instance, "tcp-socket"); /* 0 */
+        ComponentInstance* streamsInstance = loadInstance(InstanceIoStreams02);
+        instance->m_instances.push_back(streamsInstance);
+        aliasTypeExport(instance, "input-stream", streamsInstance->type()->getType(0)); /* 1 */
+        aliasTypeExport(instance, "output-stream", streamsInstance->type()->getType(1)); /* 2 */
+        ComponentInstance* pollInstance = loadInstance(InstanceIoPoll02);
+        instance->m_instances.push_back(pollInstance);
+        aliasTypeExport(instance, "pollable", pollInstance->type()->getType(0)); /* 3 */
+        ComponentInstance* networkInstance = loadInstance(InstanceSocketsNetwork02);
+        instance->m_instances.push_back(networkInstance);
+        aliasTypeExport(instance, "network", networkInstance->type()->getType(0)); /* 4 */
+        ComponentRefCounted* errorCode = networkInstance->type()->getType(1);
+        aliasTypeExport(instance, "error-code", errorCode); /* 5 */
+        ComponentRefCounted* ipSocketAddress = networkInstance->type()->getType(8);
+        aliasTypeExport(instance, "ip-socket-address", ipSocketAddress); /* 6 */
+        ComponentRefCounted* addressFamily = networkInstance->type()->getType(2);
+        aliasTypeExport(instance, "ip-address-family", addressFamily); /* 7 */
+        ComponentTypeLabels* shutdownType = new ComponentTypeLabels(ComponentRefCounted::EnumKind);
+        shutdownType->labels().push_back("receive");
+        shutdownType->labels().push_back("send");
+        shutdownType->labels().push_back("both");
+        addTypeExport(instance, "shutdown-type", shutdownType); /* 8 */
+
+        ComponentTypeFunc* startBind = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        startBind->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        startBind->params().push_back(ComponentTypeFunc::Param{ "network", new ComponentTypeResourceRef(ComponentType::BorrowKind, instance->type()->getType(4)) });
+        ipSocketAddress->addRef();
+        startBind->params().push_back(ComponentTypeFunc::Param{ "local-address", ComponentTypeRef(ipSocketAddress) });
+        errorCode->addRef();
+        startBind->result() = new ComponentTypeResult(ComponentTypeRef(), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.start-bind", LiftedWasiFunction::socketsTcpStartBind02, startBind);
+        ComponentTypeFunc* startConnect = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        startConnect->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        startConnect->params().push_back(ComponentTypeFunc::Param{ "network", new ComponentTypeResourceRef(ComponentType::BorrowKind, instance->type()->getType(4)) });
+        ipSocketAddress->addRef();
+        startConnect->params().push_back(ComponentTypeFunc::Param{ "remote-address", ComponentTypeRef(ipSocketAddress) });
+        errorCode->addRef();
+        startConnect->result() = new ComponentTypeResult(ComponentTypeRef(), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.start-connect", LiftedWasiFunction::socketsTcpStartConnect02, startConnect);
+
+        // Functions without arguments, which return with result<_, error-code>.
+        ComponentTypeFunc* noResult = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        noResult->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        errorCode->addRef();
+        noResult->result() = new ComponentTypeResult(ComponentTypeRef(), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.finish-bind", LiftedWasiFunction::socketsTcpFinishBind02, noResult);
+        noResult->addRef();
+        addFuncExport(instance, "[method]tcp-socket.start-listen", LiftedWasiFunction::socketsTcpStartListen02, noResult);
+        noResult->addRef();
+        addFuncExport(instance, "[method]tcp-socket.finish-listen", LiftedWasiFunction::socketsTcpFinishListen02, noResult);
+
+        ComponentTypeFunc* finishConnect = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        finishConnect->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        ComponentTypeTuple* streams = new ComponentTypeTuple();
+        streams->items().push_back(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(1))));
+        streams->items().push_back(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(2))));
+        errorCode->addRef();
+        finishConnect->result() = new ComponentTypeResult(ComponentTypeRef(streams), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.finish-connect", LiftedWasiFunction::socketsTcpFinishConnect02, finishConnect);
+        ComponentTypeFunc* accept = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        accept->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        ComponentTypeTuple* connection = new ComponentTypeTuple();
+        connection->items().push_back(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, tcpSocket)));
+        connection->items().push_back(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(1))));
+        connection->items().push_back(ComponentTypeRef(new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(2))));
+        errorCode->addRef();
+        accept->result() = new ComponentTypeResult(ComponentTypeRef(connection), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.accept", LiftedWasiFunction::socketsTcpAccept02, accept);
+        ComponentTypeFunc* address = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        address->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        ipSocketAddress->addRef();
+        errorCode->addRef();
+        address->result() = new ComponentTypeResult(ComponentTypeRef(ipSocketAddress), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.local-address", LiftedWasiFunction::socketsTcpLocalAddress02, address);
+        address->addRef();
+        addFuncExport(instance, "[method]tcp-socket.remote-address", LiftedWasiFunction::socketsTcpRemoteAddress02, address);
+        ComponentTypeFunc* isListening = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        isListening->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        isListening->result() = ComponentTypeRef(ComponentTypeRef::Bool);
+        addFuncExport(instance, "[method]tcp-socket.is-listening", LiftedWasiFunction::socketsTcpIsListening02, isListening);
+        ComponentTypeFunc* getAddressFamily = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        getAddressFamily->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        addressFamily->addRef();
+        getAddressFamily->result() = ComponentTypeRef(addressFamily);
+        addFuncExport(instance, "[method]tcp-socket.address-family", LiftedWasiFunction::socketsTcpAddressFamily02, getAddressFamily);
+        ComponentTypeFunc* subscribe = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        subscribe->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        subscribe->result() = new ComponentTypeResourceRef(ComponentType::OwnKind, instance->type()->getType(3));
+        addFuncExport(instance, "[method]tcp-socket.subscribe", LiftedWasiFunction::socketsTcpSubscribe02, subscribe);
+        ComponentTypeFunc* shutdown = new ComponentTypeFunc(ComponentRefCounted::FuncKind);
+        shutdown->params().push_back(ComponentTypeFunc::Param{ "self", new ComponentTypeResourceRef(ComponentType::BorrowKind, tcpSocket) });
+        shutdownType->addRef();
+        shutdown->params().push_back(ComponentTypeFunc::Param{ "shutdown-type", ComponentTypeRef(shutdownType) });
+        errorCode->addRef();
+        shutdown->result() = new ComponentTypeResult(ComponentTypeRef(), ComponentTypeRef(errorCode));
+        addFuncExport(instance, "[method]tcp-socket.shutdown", LiftedWasiFunction::socketsTcpShutdown02, shutdown);
+        return instance;
+    }
     default:
         RELEASE_ASSERT_NOT_REACHED();
         return nullptr;
@@ -769,6 +1030,19 @@ ComponentInstance* wasi02LoadInstance(Store* store, std::string& name)
         } else if (compareName(charData, length, "graph")) {
             instanceId = InstanceWasiNNGraph02;
         }
+    } else if (length > 13 && memcmp(charData, "wasi:sockets/", 13) == 0) {
+        charData += 13;
+        length -= 13;
+
+        if (compareName(charData, length, "network")) {
+            instanceId = InstanceSocketsNetwork02;
+        } else if (compareName(charData, length, "instance-network")) {
+            instanceId = InstanceSocketsInstanceNetwork02;
+        } else if (compareName(charData, length, "tcp-create-socket")) {
+            instanceId = InstanceSocketsTcpCreateSocket02;
+        } else if (compareName(charData, length, "tcp")) {
+            instanceId = InstanceSocketsTcp02;
+        }
     }
 
     if (instanceId == InstanceUnknown) {
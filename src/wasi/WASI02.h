@@ -29,15 +29,22 @@ class ComponentInstance;
 class CanonOptions;
 class ComponentHandle;
 class LiftedWasiFunction;
+class WasiFileSystemImage;
 
 struct Wasi02DirMapEntry {
     const char* mappedPath;
     const char* realPath;
+    // Set by wasi02LoadImages when the real path is a tar archive.
+    WasiFileSystemImage* image;
 };
 
 typedef std::vector<Wasi02DirMapEntry> Wasi02DirMap;
 
-WasiStoreData* wasi02InitData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens);
+// Loads the entries whose real path is a regular file as tar archives.
+// Returns with false and sets the error if an archive cannot be loaded.
+bool wasi02LoadImages(Wasi02DirMap& preOpens, std::string& error);
+void wasi02ReleaseImages(Wasi02DirMap& preOpens);
+WasiStoreData* wasi02InitData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens, bool inheritNetwork);
 void destroyWasi02Data(WasiStoreData* data);
 ComponentInstance* wasi02LoadInstance(Store* store, std::string& name);
 const FunctionType* getWasiFunctionType(LiftedWasiFunction* function);
@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef ENABLE_WASI
+
+#include "wasi/WASI02FileSystem.h"
+
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Walrus {
+
+// Numeric fields of tar headers are octal strings, or
+// big-endian binary numbers when the first bit is set.
+static uint64_t parseTarNumber(const uint8_t* field, size_t length)
+{
+    uint64_t value = 0;
+
+    if (field[0] & 0x80) {
+        value = field[0] & 0x7f;
+        for (size_t i = 1; i < length; i++) {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < length && field[i] == ' ') {
+        i++;
+    }
+
+    while (i < length && field[i] >= '0' && field[i] <= '7') {
+        value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+        i++;
+    }
+    return value;
+}
+
+// The checksum is the sum of the header bytes, where the checksum field itself is counted as spaces.
+static bool checkTarHeader(const uint8_t* header)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < WasiFileSystemImage::BlockSize; i++) {
+        sum += (i >= 148 && i < 156) ? ' ' : header[i];
+    }
+    return sum == parseTarNumber(header + 148, 8);
+}
+
+static size_t fieldLength(const uint8_t* field, size_t length)
+{
+    const void* end = memchr(field, '\0', length);
+    return end != nullptr ? static_cast<size_t>(reinterpret_cast<const uint8_t*>(end) - field) : length;
+}
+
+WasiFileSystemImage::WasiFileSystemImage(uint8_t* archive, size_t archiveSize)
+    : m_archive(archive)
+    , m_archiveSize(archiveSize)
+    , m_refCount(1)
+{
+    m_entries[std::string()] = Entry{ nullptr, 0, 0, true };
+}
+
+WasiFileSystemImage::~WasiFileSystemImage()
+{
+    if (m_archive == nullptr) {
+        return;
+    }
+
+#if defined(OS_POSIX)
+    munmap(m_archive, m_archiveSize);
+#else
+    free(m_archive);
+#endif
+}
+
+WasiFileSystemImage* WasiFileSystemImage::load(const char* path, std::string& error)
+{
+    error = "cannot read the archive";
+
+    uint8_t* archive = nullptr;
+    size_t archiveSize = 0;
+
+#if defined(OS_POSIX)
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+
+    archiveSize = static_cast<size_t>(fileStat.st_size);
+    if (archiveSize > 0) {
+        // The pages are loaded on demand, and shared by all processes using the same image.
+        void* mapping = mmap(nullptr, archiveSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        archive = reinterpret_cast<uint8_t*>(mapping);
+    }
+    close(fd);
+#else
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            archiveSize = static_cast<size_t>(size);
+            archive = reinterpret_cast<uint8_t*>(malloc(archiveSize));
+            if (archive != nullptr && fread(archive, 1, archiveSize, file) != archiveSize) {
+                free(archive);
+                archive = nullptr;
+            }
+        }
+    }
+    fclose(file);
+
+    if (archive == nullptr && archiveSize > 0) {
+        return nullptr;
+    }
+#endif
+
+    WasiFileSystemImage* image = new WasiFileSystemImage(archive, archiveSize);
+    if (!image->parse(error)) {
+        image->releaseRef();
+        return nullptr;
+    }
+    return image;
+}
+
+const WasiFileSystemImage::Entry* WasiFileSystemImage::find(const std::string& path) const
+{
+    auto it = m_entries.find(path);
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+bool WasiFileSystemImage::parse(std::string& error)
+{
+    size_t position = 0;
+    std::string longName;
+
+    while (position + BlockSize <= m_archiveSize) {
+        const uint8_t* header = m_archive + position;
+
+        // The archive is terminated by zero blocks.
+        if (header[0] == '\0') {
+            break;
+        }
+
+        if (!checkTarHeader(header)) {
+            error = "invalid tar header checksum at offset " + std::to_string(position);
+            return false;
+        }
+
+        uint64_t size = parseTarNumber(header + 124, 12);
+        uint64_t modificationTime = parseTarNumber(header + 136, 12);
+        uint8_t type = header[156];
+
+        position += BlockSize;
+        if (size > m_archiveSize - position) {
+            error = "truncated tar entry at offset " + std::to_string(position - BlockSize);
+            return false;
+        }
+
+        const uint8_t* data = m_archive + position;
+        position += static_cast<size_t>((size + BlockSize - 1) & ~static_cast<uint64_t>(BlockSize - 1));
+
+        // GNU long names are stored as the data of a separate entry.
+        if (type == 'L') {
+            longName.assign(reinterpret_cast<const char*>(data), fieldLength(data, static_cast<size_t>(size)));
+            continue;
+        }
+
+        std::string name;
+        if (!longName.empty()) {
+            name.swap(longName);
+        } else {
+            if (memcmp(header + 257, "ustar", 5) == 0 && header[345] != '\0') {
+                name.append(reinterpret_cast<const char*>(header + 345), fieldLength(header + 345, 155));
+                name.push_back('/');
+            }
+            name.append(reinterpret_cast<const char*>(header), fieldLength(header, 100));
+        }
+
+        std::string path;
+        if (!WasiVirtualFileSystem::normalizePath(name.data(), name.length(), path) || path.empty()) {
+            continue;
+        }
+
+        switch (type) {
+        case '0':
+        case '7':
+        case '\0':
+            addEntry(path, Entry{ data, size, modificationTime, false });
+            break;
+        case '5':
+            addEntry(path, Entry{ nullptr, 0, modificationTime, true });
+            break;
+        default:
+            // Links, devices and extended headers are ignored.
+            break;
+        }
+    }
+    return true;
+}
+
+void WasiFileSystemImage::addEntry(const std::string& path, const Entry& entry)
+{
+    m_entries[path] = entry;
+
+    // Archives may omit the parent directories.
+    size_t slash = path.rfind('/');
+    while (slash != std::string::npos) {
+        std::string parent = path.substr(0, slash);
+        if (!m_entries.insert(std::make_pair(parent, Entry{ nullptr, 0, entry.modificationTime, true })).second) {
+            break;
+        }
+        slash = parent.rfind('/');
+    }
+}
+
+WasiVirtualFile::WasiVirtualFile(WasiFileSystemImage* image, const WasiFileSystemImage::Entry* entry)
+    : m_image(nullptr)
+    , m_imageData(nullptr)
+    , m_imageSize(0)
+    , m_modificationTime(entry->modificationTime)
+    , m_refCount(1)
+    , m_isDirectory(entry->isDirectory)
+{
+    if (!m_isDirectory) {
+        m_image = image;
+        m_imageData = entry->data;
+        m_imageSize = entry->size;
+        image->addRef();
+    }
+}
+
+WasiVirtualFile::WasiVirtualFile(uint64_t modificationTime)
+    : m_image(nullptr)
+    , m_imageData(nullptr)
+    , m_imageSize(0)
+    , m_modificationTime(modificationTime)
+    , m_refCount(1)
+    , m_isDirectory(false)
+{
+}
+
+WasiVirtualFile::~WasiVirtualFile()
+{
+    if (m_image != nullptr) {
+        m_image->releaseRef();
+    }
+}
+
+size_t WasiVirtualFile::read(uint64_t offset, uint8_t* buffer, size_t size) const
+{
+    uint64_t fileSize = this->size();
+    if (m_isDirectory || offset >= fileSize) {
+        return 0;
+    }
+
+    if (size > fileSize - offset) {
+        size = static_cast<size_t>(fileSize - offset);
+    }
+
+    const uint8_t* data = m_image != nullptr ? m_imageData : m_contents.data();
+    memcpy(buffer, data + offset, size);
+    return size;
+}
+
+bool WasiVirtualFile::write(uint64_t offset, const uint8_t* data, size_t size)
+{
+    if (m_isDirectory || offset > MaxFileSize || size > MaxFileSize - offset) {
+        return false;
+    }
+
+    copyOnWrite();
+
+    size_t end = static_cast<size_t>(offset) + size;
+    if (end > m_contents.size()) {
+        // The gap after the end of the file is filled with zeroes.
+        m_contents.resize(end);
+    }
+
+    memcpy(m_contents.data() + offset, data, size);
+    m_modificationTime = static_cast<uint64_t>(time(nullptr));
+    return true;
+}
+
+void WasiVirtualFile::truncate()
+{
+    ASSERT(!m_isDirectory);
+
+    if (m_image != nullptr) {
+        m_image->releaseRef();
+        m_image = nullptr;
+    }
+
+    m_contents.clear();
+    m_modificationTime = static_cast<uint64_t>(time(nullptr));
+}
+
+void WasiVirtualFile::copyOnWrite()
+{
+    if (m_image == nullptr) {
+        return;
+    }
+
+    m_contents.assign(m_imageData, m_imageData + m_imageSize);
+    m_image->releaseRef();
+    m_image = nullptr;
+}
+
+WasiVirtualFileSystem::WasiVirtualFileSystem(WasiFileSystemImage* image)
+    : m_image(image)
+{
+    image->addRef();
+}
+
+WasiVirtualFileSystem::~WasiVirtualFileSystem()
+{
+    // Open files keep their own references.
+    for (auto& it : m_files) {
+        it.second->releaseRef();
+    }
+    m_image->releaseRef();
+}
+
+bool WasiVirtualFileSystem::normalizePath(const char* path, size_t length, std::string& result)
+{
+    size_t start = 0;
+
+    result.clear();
+    while (start < length) {
+        size_t end = start;
+        while (end < length && path[end] != '/') {
+            end++;
+        }
+
+        size_t segmentLength = end - start;
+        if (segmentLength == 2 && path[start] == '.' && path[start + 1] == '.') {
+            if (result.empty()) {
+                return false;
+            }
+
+            size_t slash = result.rfind('/');
+            result.resize(slash == std::string::npos ? 0 : slash);
+        } else if (segmentLength > 0 && !(segmentLength == 1 && path[start] == '.')) {
+            if (!result.empty()) {
+                result.push_back('/');
+            }
+            result.append(path + start, segmentLength);
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+WasiVirtualFile* WasiVirtualFileSystem::find(const std::string& path)
+{
+    auto it = m_files.find(path);
+    if (it != m_files.end()) {
+        return it->second;
+    }
+
+    const WasiFileSystemImage::Entry* entry = m_image->find(path);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+
+    WasiVirtualFile* file = new WasiVirtualFile(m_image, entry);
+    m_files[path] = file;
+    return file;
+}
+
+WasiVirtualFile* WasiVirtualFileSystem::open(const char* path, size_t length, uint32_t openFlags)
+{
+    std::string normalizedPath;
+    if (!normalizePath(path, length, normalizedPath)) {
+        return nullptr;
+    }
+
+    WasiVirtualFile* file = find(normalizedPath);
+
+    if (file != nullptr) {
+        if ((openFlags & (openCreate | openExclusive)) == (openCreate | openExclusive)) {
+            return nullptr;
+        }
+
+        if (file->isDirectory()) {
+            if (openFlags & openTruncate) {
+                return nullptr;
+            }
+        } else {
+            if (openFlags & openDirectory) {
+                return nullptr;
+            }
+
+            if (openFlags & openTruncate) {
+                file->truncate();
+            }
+        }
+    } else {
+        if ((openFlags & (openCreate | openDirectory)) != openCreate) {
+            return nullptr;
+        }
+
+        size_t slash = normalizedPath.rfind('/');
+        WasiVirtualFile* parent = find(slash == std::string::npos ? std::string() : normalizedPath.substr(0, slash));
+        if (parent == nullptr || !parent->isDirectory()) {
+            return nullptr;
+        }
+
+        file = new WasiVirtualFile(static_cast<uint64_t>(time(nullptr)));
+        m_files[normalizedPath] = file;
+    }
+
+    file->addRef();
+    return file;
+}
+
+} // namespace Walrus
+
+#endif
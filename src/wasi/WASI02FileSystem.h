@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusWASI02FileSystem__
+#define __WalrusWASI02FileSystem__
+
+#ifdef ENABLE_WASI
+
+#include "Walrus.h"
+
+namespace Walrus {
+
+// Open flags of wasi:filesystem descriptors.
+enum OpenFlags : uint32_t {
+    openCreate = 1 << 0,
+    openDirectory = 1 << 1,
+    openExclusive = 1 << 2,
+    openTruncate = 1 << 3,
+};
+
+// Read-only directory tree loaded from a tar archive. The file
+// contents are not copied, they point into the mapped archive.
+class WasiFileSystemImage {
+public:
+    static constexpr size_t BlockSize = 512;
+
+    struct Entry {
+        const uint8_t* data;
+        uint64_t size;
+        uint64_t modificationTime;
+        bool isDirectory;
+    };
+
+    // Returns with nullptr and sets the error if the file cannot be
+    // read or it is not a valid tar archive.
+    static WasiFileSystemImage* load(const char* path, std::string& error);
+
+    void addRef()
+    {
+        m_refCount++;
+    }
+
+    void releaseRef()
+    {
+        if (--m_refCount == 0) {
+            delete this;
+        }
+    }
+
+    // The path must be normalized, the root directory is the empty string.
+    const Entry* find(const std::string& path) const;
+
+private:
+    WasiFileSystemImage(uint8_t* archive, size_t archiveSize);
+    ~WasiFileSystemImage();
+
+    bool parse(std::string& error);
+    void addEntry(const std::string& path, const Entry& entry);
+
+    uint8_t* m_archive;
+    size_t m_archiveSize;
+    std::map<std::string, Entry> m_entries;
+    size_t m_refCount;
+};
+
+// A file or directory of a virtual file system. Files of the image are
+// shared with the image until they are modified (copy-on-write).
+class WasiVirtualFile {
+public:
+    static constexpr uint64_t MaxFileSize = UINT32_MAX;
+
+    WasiVirtualFile(WasiFileSystemImage* image, const WasiFileSystemImage::Entry* entry);
+    explicit WasiVirtualFile(uint64_t modificationTime);
+
+    void addRef()
+    {
+        m_refCount++;
+    }
+
+    void releaseRef()
+    {
+        if (--m_refCount == 0) {
+            delete this;
+        }
+    }
+
+    bool isDirectory() const
+    {
+        return m_isDirectory;
+    }
+
+    uint64_t size() const
+    {
+        return m_image != nullptr ? m_imageSize : m_contents.size();
+    }
+
+    uint64_t modificationTime() const
+    {
+        return m_modificationTime;
+    }
+
+    // Returns with the number of bytes read, which is zero at the end of the file.
+    size_t read(uint64_t offset, uint8_t* buffer, size_t size) const;
+    // Returns with false for directories or when the file would be too large.
+    bool write(uint64_t offset, const uint8_t* data, size_t size);
+    void truncate();
+
+private:
+    ~WasiVirtualFile();
+
+    void copyOnWrite();
+
+    // Non-nullptr while the contents are shared with the image.
+    WasiFileSystemImage* m_image;
+    const uint8_t* m_imageData;
+    uint64_t m_imageSize;
+    std::vector<uint8_t> m_contents;
+    uint64_t m_modificationTime;
+    size_t m_refCount;
+    bool m_isDirectory;
+};
+
+// In-memory file system mounted by --mapdirs when the host path is a tar archive.
+// Each store has its own overlay, so the modifications of a guest are never
+// visible to other guests, and they are dropped when the store is destroyed.
+class WasiVirtualFileSystem {
+public:
+    explicit WasiVirtualFileSystem(WasiFileSystemImage* image);
+    ~WasiVirtualFileSystem();
+
+    // Opens a path relative to the root of the file system. Returns with a new
+    // reference to the file, or nullptr if the path cannot be opened.
+    WasiVirtualFile* open(const char* path, size_t length, uint32_t openFlags);
+
+    // Resolves "." and ".." segments, returns with false if the path leaves the root.
+    static bool normalizePath(const char* path, size_t length, std::string& result);
+
+private:
+    WasiVirtualFile* find(const std::string& path);
+
+    WasiFileSystemImage* m_image;
+    // Files opened at least once, including the created ones.
+    std::map<std::string, WasiVirtualFile*> m_files;
+};
+
+} // namespace Walrus
+
+#endif
+
+#endif // __WalrusWASI02FileSystem__
@@ -20,6 +20,20 @@
 #include "wasi/WASI02Impl.h"
 #include "runtime/Memory.h"
 
+#if defined(OS_POSIX)
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
 namespace Walrus {
 
 enum OptionalTypes : uint8_t {
@@ -37,6 +51,31 @@ enum StreamErrorTypes : uint8_t {
     streamErrClosed = 1,
 };
 
+enum SocketErrorCodes : uint8_t {
+    socketErrUnknown = 0,
+    socketErrAccessDenied = 1,
+    socketErrNotSupported = 2,
+    socketErrInvalidArgument = 3,
+    socketErrOutOfMemory = 4,
+    socketErrTimeout = 5,
+    socketErrConcurrencyConflict = 6,
+    socketErrNotInProgress = 7,
+    socketErrWouldBlock = 8,
+    socketErrInvalidState = 9,
+    socketErrNewSocketLimit = 10,
+    socketErrAddressNotBindable = 11,
+    socketErrAddressInUse = 12,
+    socketErrRemoteUnreachable = 13,
+    socketErrConnectionRefused = 14,
+    socketErrConnectionReset = 15,
+    socketErrConnectionAborted = 16,
+};
+
+enum IpAddressFamily : uint8_t {
+    addressFamilyIPv4 = 0,
+    addressFamilyIPv6 = 1,
+};
+
 enum DescriptorFlags : uint32_t {
     flagRead = 1 << 0,
     flagWrite = 1 << 1,
@@ -46,13 +85,6 @@ enum DescriptorFlags : uint32_t {
     flagMutateDirectory = 1 << 5,
 };
 
-enum OpenFlags : uint32_t {
-    openCreate = 1 << 0,
-    openDirectory = 1 << 1,
-    openExclusive = 1 << 2,
-    openTruncate = 1 << 3,
-};
-
 enum FileType : uint8_t {
     fileTypeUnknown = 0,
     fileTypeBlockDevice = 1,
@@ -76,6 +108,12 @@ static inline ComponentResourceWasiStream* asStream(ComponentHandle* handle)
     return reinterpret_cast<ComponentResourceWasiStream*>(handle);
 }
 
+static inline ComponentResourceWasiPollable* asPollable(ComponentHandle* handle)
+{
+    ASSERT(handle->kind() == ComponentHandle::ResourceWasiPollableKind);
+    return reinterpret_cast<ComponentResourceWasiPollable*>(handle);
+}
+
 static inline ComponentResourceWasiFile* asFile(ComponentHandle* handle)
 {
     ASSERT(handle->kind() == ComponentHandle::ResourceWasiFileKind);
@@ -88,22 +126,640 @@ static inline ComponentResourceWasiDirectory* asDirectory(ComponentHandle* handl
     return reinterpret_cast<ComponentResourceWasiDirectory*>(handle);
 }
 
+static inline ComponentResourceWasiTcpSocket* asTcpSocket(ComponentHandle* handle)
+{
+    ASSERT(handle->kind() == ComponentHandle::ResourceWasiTcpSocketKind);
+    return reinterpret_cast<ComponentResourceWasiTcpSocket*>(handle);
+}
+
 static inline long int maxFileOffset(uint64_t offset)
 {
     unsigned long int max = ~static_cast<long unsigned int>(0) >> 1;
     return offset > max ? static_cast<long int>(max) : static_cast<long int>(offset);
 }
 
+bool WasiRefCountedFile::checkRegularFile(int desc)
+{
+    uv_fs_t req;
+    return uv_fs_fstat(nullptr, &req, desc, nullptr) == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFREG;
+}
+
 void WasiRefCountedFile::destroyFile()
 {
     ASSERT(m_refCount == 0);
-    if (m_uvDescriptor > WASI_STDERR) {
+    if (m_virtualFile != nullptr) {
+        m_virtualFile->releaseRef();
+    } else if (m_uvDescriptor > WASI_STDERR) {
         uv_fs_t req;
         uv_fs_close(nullptr, &req, m_uvDescriptor, nullptr);
     }
     delete this;
 }
 
+ComponentResourceWasiStream::~ComponentResourceWasiStream()
+{
+    if (m_file != nullptr) {
+        flush();
+        m_file->releaseRef();
+    }
+}
+
+bool ComponentResourceWasiStream::write(WasiStoreData* storeData, const uint8_t* data, size_t size)
+{
+    ASSERT(!isClosed());
+
+    // Virtual files are written directly, since they are not accessed by system calls.
+    WasiVirtualFile* virtualFile = m_file->virtualFile();
+    if (virtualFile != nullptr) {
+        if (!virtualFile->write(static_cast<uint64_t>(m_offset), data, size)) {
+            return false;
+        }
+        advanceOffset(size);
+        return true;
+    }
+
+    // Sockets are written without blocking, and the data which
+    // is not accepted by the system is sent later.
+    if (m_file->isSocket()) {
+        m_writeBuffer.insert(m_writeBuffer.end(), data, data + size);
+        return sendBuffered();
+    }
+
+    if (storeData->m_pendingOutput != this) {
+        storeData->flushPendingOutput();
+    }
+
+    if (size < writeBudget()) {
+        m_writeBuffer.insert(m_writeBuffer.end(), data, data + size);
+        if (!m_writeBuffer.empty()) {
+            m_storeData = storeData;
+            storeData->m_pendingOutput = this;
+        }
+        return true;
+    }
+
+    // The buffered data and the new data is written by a single system call.
+    return writeBuffers(data, size);
+}
+
+bool ComponentResourceWasiStream::writeBuffers(const uint8_t* data, size_t size)
+{
+    uv_buf_t iovs[2];
+    unsigned int iovCount = 0;
+    bool success = true;
+
+    if (!m_writeBuffer.empty()) {
+        iovs[iovCount++] = uv_buf_init(reinterpret_cast<char*>(m_writeBuffer.data()), m_writeBuffer.size());
+    }
+
+    if (size > 0) {
+        iovs[iovCount++] = uv_buf_init(const_cast<char*>(reinterpret_cast<const char*>(data)), size);
+    }
+
+    uv_buf_t* iov = iovs;
+    while (iovCount > 0) {
+        uv_fs_t req;
+        int r = uv_fs_write(nullptr, &req, fileDescriptor(), iov, iovCount, -1, nullptr);
+        if (r <= 0) {
+            m_lastOperationFailed = true;
+            success = false;
+            break;
+        }
+
+        size_t written = static_cast<size_t>(r);
+        advanceOffset(written);
+
+        // Skip the completely written buffers after a partial write.
+        while (iovCount > 0 && written >= iov->len) {
+            written -= iov->len;
+            iov++;
+            iovCount--;
+        }
+
+        if (iovCount > 0) {
+            iov->base += written;
+            iov->len -= written;
+        }
+    }
+
+    m_writeBuffer.clear();
+    if (m_storeData != nullptr) {
+        ASSERT(m_storeData->m_pendingOutput == this);
+        m_storeData->m_pendingOutput = nullptr;
+        m_storeData = nullptr;
+    }
+    return success;
+}
+
+bool ComponentResourceWasiStream::sendBuffered()
+{
+    ASSERT(m_file->isSocket());
+#if defined(OS_POSIX)
+#if defined(MSG_NOSIGNAL)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    size_t sent = 0;
+
+    while (sent < m_writeBuffer.size()) {
+        ssize_t r = send(fileDescriptor(), m_writeBuffer.data() + sent, m_writeBuffer.size() - sent, flags);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            m_writeBuffer.clear();
+            m_lastOperationFailed = true;
+            return false;
+        }
+        sent += static_cast<size_t>(r);
+    }
+
+    m_writeBuffer.erase(m_writeBuffer.begin(), m_writeBuffer.begin() + sent);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ComponentResourceWasiStream::flushSocket()
+{
+    ASSERT(m_file->isSocket());
+
+    while (sendBuffered()) {
+        if (m_writeBuffer.empty()) {
+            return true;
+        }
+
+#if defined(OS_POSIX)
+        struct pollfd fds = { fileDescriptor(), POLLOUT, 0 };
+        if (poll(&fds, 1, -1) < 0 && errno != EINTR) {
+            m_writeBuffer.clear();
+            m_lastOperationFailed = true;
+            return false;
+        }
+#endif
+    }
+    return false;
+}
+
+WasiReactor::WasiReactor()
+#if defined(__linux__)
+    : m_epollDescriptor(-1)
+#endif
+{
+}
+
+WasiReactor::~WasiReactor()
+{
+#if defined(__linux__)
+    if (m_epollDescriptor >= 0) {
+        close(m_epollDescriptor);
+    }
+#endif
+}
+
+// Returns with the events a pollable is waiting for, or with zero if the
+// pollable is ready without waiting. Timers are handled by the caller.
+static uint32_t waitedEvents(ComponentResourceWasiPollable* pollable, int& fd)
+{
+    ComponentResourceWasiTcpSocket* socket = pollable->socket();
+    if (socket != nullptr) {
+        // Sockets in other states do not have pending operations.
+        fd = socket->fileDescriptor();
+        if (socket->state() == ComponentResourceWasiTcpSocket::Listening) {
+            return WasiReactor::EventRead;
+        }
+        return socket->state() == ComponentResourceWasiTcpSocket::ConnectStarted ? WasiReactor::EventWrite : 0;
+    }
+
+    ComponentResourceWasiStream* stream = pollable->stream();
+
+    // Closed streams report their state immediately, and virtual files never block.
+    if (stream == nullptr || stream->isClosed() || stream->file()->virtualFile() != nullptr) {
+        return 0;
+    }
+
+    fd = stream->fileDescriptor();
+    if (stream->kind() == ComponentHandle::ResourceWasiInputStreamKind) {
+        return WasiReactor::EventRead;
+    }
+
+    // Output streams are writable into their buffer, which is
+    // only full when a socket cannot send the data.
+    return stream->writeBudget() == 0 ? WasiReactor::EventWrite : 0;
+}
+
+void WasiReactor::wait(ComponentResourceWasiPollable** pollables, size_t count, std::vector<uint32_t>& readyList)
+{
+    std::vector<WatchedDescriptor> watched;
+    std::vector<size_t> watchedIndex(count, SIZE_MAX);
+    std::vector<uint32_t> events(count, 0);
+
+    for (size_t i = 0; i < count; i++) {
+        if (pollables[i]->isTimer()) {
+            continue;
+        }
+
+        int fd = -1;
+        events[i] = waitedEvents(pollables[i], fd);
+        if (events[i] == 0) {
+            continue;
+        }
+
+        size_t index = 0;
+
+        while (index < watched.size() && watched[index].fd != fd) {
+            index++;
+        }
+
+        if (index == watched.size()) {
+            watched.push_back(WatchedDescriptor{ fd, 0, 0 });
+        }
+        watched[index].events |= events[i];
+        watchedIndex[i] = index;
+    }
+
+    for (auto& it : watched) {
+        // Regular files cannot be watched, but they never block.
+        if (!watchDescriptor(it.fd, it.events)) {
+            it.readyEvents = it.events;
+        }
+    }
+
+    while (true) {
+        uint64_t now = uv_hrtime();
+        uint64_t timeout = UINT64_MAX;
+
+        for (size_t i = 0; i < count; i++) {
+            ComponentResourceWasiPollable* pollable = pollables[i];
+
+            if (pollable->isTimer()) {
+                if (pollable->deadline() <= now) {
+                    readyList.push_back(static_cast<uint32_t>(i));
+                } else if (pollable->deadline() - now < timeout) {
+                    timeout = pollable->deadline() - now;
+                }
+            } else if (watchedIndex[i] == SIZE_MAX || (watched[watchedIndex[i]].readyEvents & events[i])) {
+                readyList.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        if (!readyList.empty()) {
+            return;
+        }
+
+        int timeoutMs = -1;
+        if (timeout != UINT64_MAX) {
+            // Rounded up, so the timer is expired when the wait ends.
+            timeout = (timeout + 999999) / 1000000;
+            timeoutMs = timeout > INT_MAX ? INT_MAX : static_cast<int>(timeout);
+        }
+
+        waitEvents(watched, timeoutMs);
+    }
+}
+
+#if defined(__linux__)
+
+bool WasiReactor::watchDescriptor(int fd, uint32_t events)
+{
+    if (m_epollDescriptor < 0) {
+        m_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epollDescriptor < 0) {
+            return false;
+        }
+    }
+
+    // Descriptors are registered in one-shot mode, so descriptors which are
+    // not waited anymore are reported at most once. The registration is
+    // removed by the system when the descriptor is closed.
+    struct epoll_event event;
+    event.events = EPOLLONESHOT;
+    if (events & EventRead) {
+        event.events |= EPOLLIN;
+    }
+    if (events & EventWrite) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.fd = fd;
+
+    if (epoll_ctl(m_epollDescriptor, EPOLL_CTL_MOD, fd, &event) == 0) {
+        return true;
+    }
+
+    return errno == ENOENT && epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void WasiReactor::waitEvents(std::vector<WatchedDescriptor>& watched, int timeout)
+{
+    const int maxEvents = 16;
+    struct epoll_event events[maxEvents];
+
+    if (m_epollDescriptor < 0) {
+        // Only timers can be waited.
+        ASSERT(watched.empty() && timeout >= 0);
+        uv_sleep(static_cast<unsigned int>(timeout));
+        return;
+    }
+
+    int result = epoll_wait(m_epollDescriptor, events, maxEvents, timeout);
+    if (result < 0) {
+        if (errno != EINTR) {
+            // The error is reported by the next operation on the streams.
+            for (auto& it : watched) {
+                it.readyEvents = it.events;
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < result; i++) {
+        for (auto& it : watched) {
+            if (it.fd == events[i].data.fd) {
+                // Errors and hang-ups are reported by the next operation.
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    it.readyEvents = it.events;
+                }
+                if (events[i].events & EPOLLIN) {
+                    it.readyEvents |= EventRead;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    it.readyEvents |= EventWrite;
+                }
+                break;
+            }
+        }
+    }
+}
+
+#elif defined(OS_POSIX)
+
+bool WasiReactor::watchDescriptor(int fd, uint32_t events)
+{
+    return true;
+}
+
+void WasiReactor::waitEvents(std::vector<WatchedDescriptor>& watched, int timeout)
+{
+    std::vector<struct pollfd> fds;
+
+    for (auto& it : watched) {
+        ASSERT(it.readyEvents == 0);
+        short events = 0;
+        if (it.events & EventRead) {
+            events |= POLLIN;
+        }
+        if (it.events & EventWrite) {
+            events |= POLLOUT;
+        }
+        fds.push_back(pollfd{ it.fd, events, 0 });
+    }
+
+    int result = poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout);
+    for (size_t i = 0; i < fds.size(); i++) {
+        if (result < 0) {
+            if (errno != EINTR) {
+                watched[i].readyEvents = watched[i].events;
+            }
+            continue;
+        }
+
+        // Errors and hang-ups are reported by the next operation.
+        if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            watched[i].readyEvents = watched[i].events;
+        }
+        if (fds[i].revents & POLLIN) {
+            watched[i].readyEvents |= EventRead;
+        }
+        if (fds[i].revents & POLLOUT) {
+            watched[i].readyEvents |= EventWrite;
+        }
+    }
+}
+
+#else
+
+bool WasiReactor::watchDescriptor(int fd, uint32_t events)
+{
+    return false;
+}
+
+void WasiReactor::waitEvents(std::vector<WatchedDescriptor>& watched, int timeout)
+{
+    // Only timers can be waited.
+    ASSERT(watched.empty() && timeout >= 0);
+    uv_sleep(static_cast<unsigned int>(timeout));
+}
+
+#endif
+
+// Limits the size of a read to the data which is known to be available, so the guest
+// buffer allocated before the read is not much larger than the data. When nothing
+// is known, the read blocks until some data arrives, and the unused part is freed.
+static uint64_t readSizeHint(ComponentResourceWasiStream* stream, uint64_t size)
+{
+    WasiVirtualFile* virtualFile = stream->file()->virtualFile();
+    if (virtualFile != nullptr) {
+        uint64_t position = static_cast<uint64_t>(stream->offset());
+        uint64_t available = virtualFile->size() > position ? virtualFile->size() - position : 0;
+        return available < size ? available : size;
+    }
+
+    if (stream->isPositional()) {
+        uv_fs_t req;
+        int r = uv_fs_fstat(nullptr, &req, stream->fileDescriptor(), nullptr);
+
+        if (r == 0) {
+            // The stream reads the file from its own offset.
+            uint64_t position = static_cast<uint64_t>(stream->offset());
+            uint64_t fileSize = req.statbuf.st_size;
+            uint64_t available = fileSize > position ? fileSize - position : 0;
+            return available < size ? available : size;
+        }
+    }
+
+#if defined(FIONREAD)
+    int available = 0;
+    if (ioctl(stream->fileDescriptor(), FIONREAD, &available) == 0 && available > 0 && static_cast<uint64_t>(available) < size) {
+        return static_cast<uint64_t>(available);
+    }
+#endif
+    return size;
+}
+
+// Stores a last-operation-failed stream error, and closes the stream.
+static void storeLastOperationFailed(ExecutionState& state, CanonOptions* options, ComponentInstance* instance, uint32_t offset, ComponentResourceWasiStream* stream)
+{
+    ComponentResource* error = new ComponentResourceWasiError(instance->type()->getType(2)->asTypeResource()); /* error */
+    uint32_t index = options->instance()->appendHandle(state, error);
+
+    stream->dropFileRef();
+    options->memory()->buffer()[offset] = streamErrLastOperationFailed;
+    options->memory()->store(state, offset, 4, index);
+}
+
+static ComponentResourceWasiTcpSocket* getTcpSocket(ExecutionState& state, CanonOptions* options, uint32_t index)
+{
+    ComponentHandle* handle = options->instance()->getHandle(state, index);
+    if (handle->kind() != ComponentHandle::ResourceWasiTcpSocketKind) {
+        ComponentInstance::throwInvalidHandle(state, index);
+    }
+    return asTcpSocket(handle);
+}
+
+// Stores the error of a result, the payload starts at payloadOffset.
+static void storeSocketError(CanonOptions* options, uint32_t offset, uint32_t payloadOffset, uint8_t errorCode)
+{
+    options->memory()->buffer()[offset] = resultError;
+    options->memory()->buffer()[offset + payloadOffset] = errorCode;
+}
+
+#if defined(OS_POSIX)
+
+static uint8_t toSocketErrorCode(int error)
+{
+    switch (error) {
+    case EACCES:
+    case EPERM:
+        return socketErrAccessDenied;
+    case EAFNOSUPPORT:
+    case EOPNOTSUPP:
+    case EPROTONOSUPPORT:
+        return socketErrNotSupported;
+    case EINVAL:
+        return socketErrInvalidArgument;
+    case ENOMEM:
+    case ENOBUFS:
+        return socketErrOutOfMemory;
+    case ETIMEDOUT:
+        return socketErrTimeout;
+    case EALREADY:
+        return socketErrConcurrencyConflict;
+    case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+    case EWOULDBLOCK:
+#endif
+        return socketErrWouldBlock;
+    case EISCONN:
+    case ENOTCONN:
+        return socketErrInvalidState;
+    case EMFILE:
+    case ENFILE:
+        return socketErrNewSocketLimit;
+    case EADDRNOTAVAIL:
+        return socketErrAddressNotBindable;
+    case EADDRINUSE:
+        return socketErrAddressInUse;
+    case ENETUNREACH:
+    case EHOSTUNREACH:
+        return socketErrRemoteUnreachable;
+    case ECONNREFUSED:
+        return socketErrConnectionRefused;
+    case ECONNRESET:
+        return socketErrConnectionReset;
+    case ECONNABORTED:
+        return socketErrConnectionAborted;
+    default:
+        return socketErrUnknown;
+    }
+}
+
+// Sockets are not inherited by child processes, and never block.
+static bool initSocket(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) < 0) {
+        return false;
+    }
+
+#if defined(SO_NOSIGPIPE)
+    // Used when send does not support MSG_NOSIGNAL.
+    int value = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+#endif
+    return true;
+}
+
+// Converts the flattened arguments of an ip-socket-address to a system address.
+static bool toSocketAddress(Value* argv, bool isIPv6, struct sockaddr_storage* address, socklen_t* length)
+{
+    memset(address, 0, sizeof(struct sockaddr_storage));
+
+    if (argv[0].asI32() != (isIPv6 ? addressFamilyIPv6 : addressFamilyIPv4)) {
+        return false;
+    }
+
+    uint16_t port = static_cast<uint16_t>(argv[1].asI32());
+
+    if (!isIPv6) {
+        struct sockaddr_in* ipv4 = reinterpret_cast<struct sockaddr_in*>(address);
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&ipv4->sin_addr);
+
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(port);
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = static_cast<uint8_t>(argv[2 + i].asI32());
+        }
+        *length = sizeof(struct sockaddr_in);
+        return true;
+    }
+
+    struct sockaddr_in6* ipv6 = reinterpret_cast<struct sockaddr_in6*>(address);
+    uint8_t* bytes = ipv6->sin6_addr.s6_addr;
+
+    ipv6->sin6_family = AF_INET6;
+    ipv6->sin6_port = htons(port);
+    ipv6->sin6_flowinfo = static_cast<uint32_t>(argv[2].asI32());
+    for (int i = 0; i < 8; i++) {
+        uint32_t segment = static_cast<uint32_t>(argv[3 + i].asI32());
+        bytes[i * 2] = static_cast<uint8_t>(segment >> 8);
+        bytes[i * 2 + 1] = static_cast<uint8_t>(segment);
+    }
+    ipv6->sin6_scope_id = static_cast<uint32_t>(argv[11].asI32());
+    *length = sizeof(struct sockaddr_in6);
+    return true;
+}
+
+// Stores an ip-socket-address to the linear memory (32 bytes).
+static void storeSocketAddress(ExecutionState& state, CanonOptions* options, uint32_t offset, const struct sockaddr_storage& address)
+{
+    if (address.ss_family == AF_INET6) {
+        const struct sockaddr_in6* ipv6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        const uint8_t* bytes = ipv6->sin6_addr.s6_addr;
+
+        options->memory()->buffer()[offset] = addressFamilyIPv6;
+        options->memory()->store(state, offset, 4, static_cast<uint16_t>(ntohs(ipv6->sin6_port)));
+        options->memory()->store(state, offset, 8, static_cast<uint32_t>(ipv6->sin6_flowinfo));
+        for (uint32_t i = 0; i < 8; i++) {
+            options->memory()->store(state, offset, 12 + i * 2, static_cast<uint16_t>((bytes[i * 2] << 8) | bytes[i * 2 + 1]));
+        }
+        options->memory()->store(state, offset, 28, static_cast<uint32_t>(ipv6->sin6_scope_id));
+        return;
+    }
+
+    const struct sockaddr_in* ipv4 = reinterpret_cast<const struct sockaddr_in*>(&address);
+    options->memory()->buffer()[offset] = addressFamilyIPv4;
+    options->memory()->store(state, offset, 4, static_cast<uint16_t>(ntohs(ipv4->sin_port)));
+    memcpy(options->memory()->buffer() + offset + 6, &ipv4->sin_addr, 4);
+}
+
+// Stores the handles of the input and output streams of a connected socket.
+static void storeSocketStreams(ExecutionState& state, CanonOptions* options, ComponentInstance* instance, ComponentResourceWasiTcpSocket* socket, uint32_t offset)
+{
+    ComponentResource* input = new ComponentResourceWasiStream(instance->type()->getType(1)->asTypeResource(), ComponentHandle::ResourceWasiInputStreamKind, socket->addFileRef());
+    options->memory()->store(state, offset, 0, options->instance()->appendHandle(state, input));
+    ComponentResource* output = new ComponentResourceWasiStream(instance->type()->getType(2)->asTypeResource(), ComponentHandle::ResourceWasiOutputStreamKind, socket->addFileRef());
+    options->memory()->store(state, offset, 4, options->instance()->appendHandle(state, output));
+}
+
+#endif /* OS_POSIX */
+
 LiftedWasiFunction::~LiftedWasiFunction()
 {
     TypeStore::ReleaseRef(m_functionType->subTypeList());
@@ -120,18 +776,94 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         if (handle->kind() != ComponentHandle::ResourceWasiPollableKind) {
             ComponentInstance::throwInvalidHandle(state, index);
         }
+
+        ComponentResourceWasiPollable* pollable = asPollable(handle);
+        std::vector<uint32_t> readyList;
+
+        instance->store()->wasiData()->flushPendingOutput();
+        instance->store()->wasiData()->reactor().wait(&pollable, 1, readyList);
+        break;
+    }
+    case LiftedWasiFunction::ioPoll02: {
+        uint32_t listStart = argv[0].asI32();
+        uint32_t listLength = argv[1].asI32();
+        uint32_t offset = argv[2].asI32();
+
+        ASSERT(!options->memory()->is64());
+        if (listLength == 0) {
+            std::string message = "poll list is empty";
+            Trap::throwException(state, message);
+        }
+
+        if (listLength >= Memory::s_maxMemory32 >> 2) {
+            throwNoMemory(state);
+        }
+
+        options->memoryCheckRange32(state, 4, listStart, listLength << 2);
+        options->memoryCheckRange32(state, 4, offset, 8);
+
+        std::vector<ComponentResourceWasiPollable*> pollables;
+        pollables.reserve(listLength);
+
+        for (uint32_t i = 0; i < listLength; i++) {
+            uint32_t index;
+            options->memory()->load(state, listStart, i << 2, &index);
+
+            ComponentHandle* handle = options->instance()->getHandle(state, index);
+            if (handle->kind() != ComponentHandle::ResourceWasiPollableKind) {
+                ComponentInstance::throwInvalidHandle(state, index);
+            }
+            pollables.push_back(asPollable(handle));
+        }
+
+        std::vector<uint32_t> readyList;
+        instance->store()->wasiData()->flushPendingOutput();
+        instance->store()->wasiData()->reactor().wait(pollables.data(), pollables.size(), readyList);
+
+        uint32_t length = static_cast<uint32_t>(readyList.size());
+        uint32_t start = options->memoryMalloc32(state, 4, length << 2);
+        memcpy(options->memory()->buffer() + start, readyList.data(), length << 2);
+        options->memory()->store(state, offset, 0, start);
+        options->memory()->store(state, offset, 4, length);
         break;
     }
     case LiftedWasiFunction::ioOutputStreamCheckWrite02: {
+        uint32_t index = argv[0].asI32();
         uint32_t offset = argv[1].asI32();
-        uint64_t value = 0xffffffff;
+
+        ComponentHandle* handle = options->instance()->getHandle(state, index);
+        if (handle->kind() != ComponentHandle::ResourceWasiOutputStreamKind) {
+            ComponentInstance::throwInvalidHandle(state, index);
+        }
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 8, offset, 16);
+        ComponentResourceWasiStream* stream = asStream(handle);
+        if (stream->isClosed()) {
+            options->memory()->buffer()[offset + 8] = streamErrClosed;
+            options->memory()->buffer()[offset] = resultError;
+            break;
+        }
+
+        // The budget of sockets is increased by the data sent since the last write.
+        if (stream->file()->isSocket()) {
+            stream->sendBuffered();
+        }
+
+        if (stream->lastOperationFailed()) {
+            storeLastOperationFailed(state, options, instance, offset + 8, stream);
+            options->memory()->buffer()[offset] = resultError;
+            break;
+        }
+
+        uint64_t value = stream->writeBudget();
         options->memory()->store(state, offset, 8, value);
         options->memory()->buffer()[offset] = resultOk;
         break;
     }
     case LiftedWasiFunction::ioInputStreamRead02: {
         uint32_t index = argv[0].asI32();
-        long int size = maxFileOffset(argv[1].asI64());
+        uint64_t size = static_cast<uint64_t>(argv[1].asI64());
         uint32_t offset = argv[2].asI32();
 
         ASSERT(!options->memory()->is64());
@@ -155,30 +887,71 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
             break;
         }
 
-        uv_fs_t req;
-        std::vector<uint8_t> buffer;
-        buffer.reserve(size);
-        uv_buf_t iov = uv_buf_init((char*)buffer.data(), size);
+        // Interactive programs expect their prompts to be visible.
+        instance->store()->wasiData()->flushPendingOutput();
 
-        int r = uv_fs_read(nullptr, &req, stream->fileDescriptor(), &iov, 1, -1, nullptr);
-        if (r < 0) {
+        if (size > ComponentResourceWasiStream::MaxReadSize) {
+            size = ComponentResourceWasiStream::MaxReadSize;
+        }
+        size = readSizeHint(stream, size);
+
+        uint32_t size32 = static_cast<uint32_t>(size);
+        uint32_t start = 0;
+        size_t read = 0;
+        bool isEndOfStream = true;
+
+        if (size32 > 0) {
+            // The data is read directly into the linear memory.
+            start = options->memoryMalloc32(state, 1, size32);
+
+            uint8_t* buffer = options->memory()->buffer() + start;
+            WasiVirtualFile* virtualFile = stream->file()->virtualFile();
+            int64_t r;
+
+            if (virtualFile != nullptr) {
+                r = static_cast<int64_t>(virtualFile->read(static_cast<uint64_t>(stream->offset()), buffer, size32));
+            } else {
+                uv_fs_t req;
+                uv_buf_t iov = uv_buf_init(reinterpret_cast<char*>(buffer), size32);
+                int64_t fileOffset = stream->isPositional() ? stream->offset() : -1;
+                r = uv_fs_read(nullptr, &req, stream->fileDescriptor(), &iov, 1, fileOffset, nullptr);
+            }
+
+            if (r == UV_EAGAIN && stream->file()->isSocket()) {
+                // Sockets are non-blocking, and an empty list
+                // is returned when no data is available.
+                r = 0;
+                isEndOfStream = false;
+            } else if (r < 0) {
+                options->memoryRealloc32(state, start, size32, 1, 0);
+                options->memory()->buffer()[offset + 4] = streamErrClosed;
+                options->memory()->buffer()[offset] = resultError;
+                break;
+            } else {
+                isEndOfStream = (r == 0);
+            }
+
+            read = static_cast<size_t>(r);
+            stream->advanceOffset(read);
+
+            if (read < size32) {
+                start = options->memoryRealloc32(state, start, size32, 1, static_cast<uint32_t>(read));
+            }
+        } else if (argv[1].asI64() == 0) {
+            isEndOfStream = false;
+        }
+
+        if (isEndOfStream) {
+            stream->dropFileRef();
             options->memory()->buffer()[offset + 4] = streamErrClosed;
             options->memory()->buffer()[offset] = resultError;
             break;
         }
-        size_t read = req.result;
-
-        uint32_t start = options->memoryMalloc32(state, 1, read);
-        memcpy(options->memory()->buffer() + start, buffer.data(), size);
 
         options->memory()->buffer()[offset] = resultOk;
         uint32_t* list = reinterpret_cast<uint32_t*>(options->memory()->buffer() + offset);
         list[1] = start;
-        list[2] = read;
-
-        if (read < static_cast<size_t>(size)) {
-            stream->dropFileRef();
-        }
+        list[2] = static_cast<uint32_t>(read);
         break;
     }
     case LiftedWasiFunction::ioInputStreamSubscribe02:
@@ -199,7 +972,8 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, resource)));
         break;
     }
-    case LiftedWasiFunction::ioOutputStreamWrite02: {
+    case LiftedWasiFunction::ioOutputStreamWrite02:
+    case LiftedWasiFunction::ioOutputStreamBlockingWriteAndFlush02: {
         uint32_t index = argv[0].asI32();
         uint32_t offset = argv[3].asI32();
 
@@ -227,15 +1001,18 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         uint32_t bufferSize = argv[2].asI32();
         options->memoryCheckRange32(state, 1, bufferStart, bufferSize);
 
-        uv_fs_t req;
-        uv_buf_t iovs = uv_buf_init((char*)(options->memory()->buffer()) + bufferStart, bufferSize);
-        int r = uv_fs_write(nullptr, &req, stream->fileDescriptor(), &iovs, 1, -1, nullptr);
-        if (r < 0) {
-            options->memory()->buffer()[offset + 4] = streamErrClosed;
+        // Writes larger than the check-write budget are
+        // not rejected, they are passed to the system.
+        bool success = !stream->lastOperationFailed() && stream->write(instance->store()->wasiData(), options->memory()->buffer() + bufferStart, bufferSize);
+        if (success && function->type() == LiftedWasiFunction::ioOutputStreamBlockingWriteAndFlush02) {
+            success = stream->flush();
+        }
+
+        if (!success) {
+            storeLastOperationFailed(state, options, instance, offset + 4, stream);
             options->memory()->buffer()[offset] = resultError;
             break;
         }
-        stream->advanceOffset(req.result);
 
         options->memory()->buffer()[offset] = resultOk;
         break;
@@ -251,9 +1028,27 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
 
         ASSERT(!options->memory()->is64());
         options->memoryCheckRange32(state, 4, offset, 12);
+        ComponentResourceWasiStream* stream = asStream(handle);
+        if (stream->isClosed()) {
+            options->memory()->buffer()[offset + 4] = streamErrClosed;
+            options->memory()->buffer()[offset] = resultError;
+            break;
+        }
+
+        if (stream->lastOperationFailed() || !stream->flush()) {
+            storeLastOperationFailed(state, options, instance, offset + 4, stream);
+            options->memory()->buffer()[offset] = resultError;
+            break;
+        }
+
         options->memory()->buffer()[offset] = resultOk;
         break;
     }
+    case LiftedWasiFunction::cliExit02: {
+        instance->store()->wasiData()->flushPendingOutput();
+        exit(argv[0].asI32() == resultOk ? EXIT_SUCCESS : EXIT_FAILURE);
+        break;
+    }
     case LiftedWasiFunction::cliGetEnvironment02: {
         uint32_t offset = argv[0].asI32();
         const std::vector<std::pair<std::string, std::string>>& environment = instance->store()->wasiData()->environment();
@@ -314,7 +1109,7 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         WasiRefCountedFile* fileRef = new WasiRefCountedFile(WASI_STDIN, std::string(), DescriptorFlags::flagRead);
 
         ComponentTypeResource* resourceType = instance->type()->getType(0)->asTypeResource();
-        ComponentResource* resource = new ComponentResourceWasiStream(resourceType, ComponentHandle::ResourceWasiOutputStreamKind, fileRef);
+        ComponentResource* resource = new ComponentResourceWasiStream(resourceType, ComponentHandle::ResourceWasiInputStreamKind, fileRef);
         result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, resource)));
         break;
     }
@@ -359,22 +1154,35 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         break;
     }
     case LiftedWasiFunction::clockMonotonicNow02: {
-        uv_timespec64_t time;
-        int r = uv_clock_gettime(UV_CLOCK_MONOTONIC, &time);
-        if (r < 0) {
-            result[0] = Value(static_cast<int64_t>(0));
-            break;
+        // Instants are measured in nanoseconds by the same clock as the deadlines of timers.
+        result[0] = Value(static_cast<int64_t>(uv_hrtime()));
+        break;
+    }
+    case LiftedWasiFunction::clockMonotonicResolution02: {
+        uint64_t resolution = 1;
+#if defined(OS_POSIX)
+        // Same clock as uv_hrtime.
+        struct timespec time;
+        if (clock_getres(CLOCK_MONOTONIC, &time) == 0) {
+            resolution = static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
         }
-
-        result[0] = Value(time.tv_sec);
-
+#endif
+        result[0] = Value(static_cast<int64_t>(resolution));
+        break;
+    }
+    case LiftedWasiFunction::clockSubscribeInstant02: {
+        // Instants in the past are ready immediately.
+        uint64_t deadline = argv[0].asI64();
+        ComponentResource* timer = new ComponentResourceWasiPollable(instance->type()->getType(2)->asTypeResource(), deadline);
+        result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, timer)));
         break;
     }
     case LiftedWasiFunction::clockSubscribeDuration02: {
         uint64_t duration = argv[0].asI64();
+        uint64_t now = uv_hrtime();
 
-        uint64_t start = uv_hrtime() + duration;
-        ComponentResource* timer = new ComponentResourceWasiPollableTimer(instance->type()->getType(2)->asTypeResource(), start);
+        uint64_t deadline = duration > UINT64_MAX - now ? UINT64_MAX : now + duration;
+        ComponentResource* timer = new ComponentResourceWasiPollable(instance->type()->getType(2)->asTypeResource(), deadline);
         result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, timer)));
         break;
     }
@@ -476,6 +1284,27 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
 
         options->memoryCheckRange32(state, 8, offset, 96);
 
+        WasiVirtualFile* virtualFile = file->file()->virtualFile();
+        if (virtualFile != nullptr) {
+            // Virtual files only have a modification time.
+            int64_t time = static_cast<int64_t>(virtualFile->modificationTime());
+            uint8_t* buffer = options->memory()->buffer() + offset;
+            buffer[0] = resultOk;
+            buffer[8] = virtualFile->isDirectory() ? FileType::fileTypeDirectory : FileType::fileTypeRegularFile;
+            *reinterpret_cast<uint64_t*>(buffer + 16) = 1;
+            *reinterpret_cast<uint64_t*>(buffer + 24) = virtualFile->size();
+            options->memory()->store(state, offset, 36, time);
+            options->memory()->store(state, offset, 44, static_cast<int32_t>(0));
+            buffer[32] = optionalSome;
+            options->memory()->store(state, offset, 60, time);
+            options->memory()->store(state, offset, 68, static_cast<int32_t>(0));
+            buffer[56] = optionalSome;
+            options->memory()->store(state, offset, 84, time);
+            options->memory()->store(state, offset, 92, static_cast<int32_t>(0));
+            buffer[80] = optionalSome;
+            break;
+        }
+
         uv_fs_t req;
         int r = uv_fs_stat(nullptr, &req, file->path().c_str(), nullptr);
         if (r < 0) {
@@ -540,18 +1369,38 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
             ComponentInstance::throwInvalidHandle(state, descriptorIndex);
         }
 
-        std::string path = asDirectory(handle)->realPath();
-        path.append("/");
+        ComponentResourceWasiDirectory* directory = asDirectory(handle);
+        std::string name;
         CanonOptions::UtfData utfData;
         options->validateString(state, pathStart, pathSize, &utfData);
         if (options->encoding() == ComponentCanonOptions::Utf8) {
-            path.append(reinterpret_cast<const char*>(utfData.buffer()), utfData.length());
+            name.append(reinterpret_cast<const char*>(utfData.buffer()), utfData.length());
         } else {
             std::vector<uint8_t> utf8String(utfData.utf8Length());
             utfData.toUtf8String(utf8String.data());
-            path.append(reinterpret_cast<const char*>(utf8String.data()), utf8String.size());
+            name.append(reinterpret_cast<const char*>(utf8String.data()), utf8String.size());
+        }
+
+        if (directory->fileSystem() != nullptr) {
+            WasiVirtualFile* virtualFile = directory->fileSystem()->open(name.data(), name.length(), openFlags);
+            if (virtualFile == nullptr) {
+                options->memory()->store(state, resultOffset, 4, 0);
+                options->memory()->buffer()[resultOffset] = resultError;
+                break;
+            }
+
+            WasiRefCountedFile* fileRef = new WasiRefCountedFile(virtualFile, directory->mappedPath() + "/" + name, flags);
+            ComponentResource* resource = new ComponentResourceWasiFile(instance->type()->getType(0)->asTypeResource(), fileRef);
+            uint32_t resultResource = options->instance()->appendHandle(state, resource);
+            options->memory()->store(state, resultOffset, 4, resultResource);
+            options->memory()->buffer()[resultOffset] = resultOk;
+            break;
         }
 
+        std::string path = directory->realPath();
+        path.append("/");
+        path.append(name);
+
         uv_fs_t req;
         int descriptor = uv_fs_open(NULL, &req, path.c_str(), openFlags, 0666, NULL);
         if (descriptor < 0) {
@@ -578,6 +1427,15 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
             ComponentInstance::throwInvalidHandle(state, descriptorIndex);
         }
         ComponentResourceWasiFile* file = asFile(handle);
+        std::hash<uint64_t> hash;
+
+        WasiVirtualFile* virtualFile = file->file()->virtualFile();
+        if (virtualFile != nullptr) {
+            options->memory()->store(state, offset, 4, hash(virtualFile->modificationTime()));
+            options->memory()->store(state, offset, 12, hash(virtualFile->size()));
+            options->memory()->buffer()[offset] = resultOk;
+            break;
+        }
 
         uv_fs_t req;
         int r = uv_fs_stat(nullptr, &req, file->path().c_str(), nullptr);
@@ -586,7 +1444,6 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
             options->memory()->buffer()[offset] = resultError;
         }
 
-        std::hash<uint64_t> hash;
         options->memory()->store(state, offset, 4, hash(req.statbuf.st_mtim.tv_sec));
         options->memory()->store(state, offset, 12, hash(req.statbuf.st_size));
         options->memory()->buffer()[offset] = resultOk;
@@ -607,12 +1464,14 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         options->memory()->store(state, offset, 0, start);
         options->memory()->store(state, offset, 4, length);
 
-        for (auto& it : preOpens) {
+        for (size_t i = 0; i < preOpens.size(); i++) {
+            const std::pair<std::string, std::string>& it = preOpens[i];
             if (it.first.length() >= Component::MaxStringByteLength || it.second.length() >= Component::MaxStringByteLength) {
                 throwNoMemory(state);
             }
 
-            ComponentResource* resource = new ComponentResourceWasiDirectory(instance->type()->getType(0)->asTypeResource(), it.first, it.second, true);
+            WasiVirtualFileSystem* fileSystem = instance->store()->wasiData()->fileSystem(i);
+            ComponentResource* resource = new ComponentResourceWasiDirectory(instance->type()->getType(0)->asTypeResource(), it.first, it.second, fileSystem, true);
             *argBuffer++ = options->instance()->appendHandle(state, resource);
             length = static_cast<uint32_t>(it.first.length());
             start = static_cast<uint32_t>(options->storeLatin1String(state, reinterpret_cast<const uint8_t*>(it.first.data()), &length));
@@ -621,6 +1480,283 @@ void callWasiFunction(ExecutionState& state, Value* argv, Value* result, LiftedW
         }
         break;
     }
+    case LiftedWasiFunction::socketsInstanceNetwork02: {
+        ComponentResource* resource = new ComponentResourceWasiNetwork(instance->type()->getType(0)->asTypeResource());
+        result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, resource)));
+        break;
+    }
+    case LiftedWasiFunction::socketsCreateTcpSocket02: {
+        uint32_t family = argv[0].asI32();
+        uint32_t offset = argv[1].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 4, offset, 8);
+
+        if (family != addressFamilyIPv4 && family != addressFamilyIPv6) {
+            storeSocketError(options, offset, 4, socketErrInvalidArgument);
+            break;
+        }
+
+#if defined(OS_POSIX)
+        int fd = socket(family == addressFamilyIPv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(errno));
+            break;
+        }
+
+        int value = 1;
+        if (!initSocket(fd) || (family == addressFamilyIPv6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &value, sizeof(value)) != 0)) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(errno));
+            close(fd);
+            break;
+        }
+
+        WasiRefCountedFile* fileRef = WasiRefCountedFile::createSocket(fd, DescriptorFlags::flagRead | DescriptorFlags::flagWrite);
+        ComponentTypeResource* resourceType = instance->type()->getType(3)->asTypeResource();
+        ComponentResource* resource = new ComponentResourceWasiTcpSocket(resourceType, fileRef, family == addressFamilyIPv6, ComponentResourceWasiTcpSocket::Unbound);
+        options->memory()->store(state, offset, 4, options->instance()->appendHandle(state, resource));
+        options->memory()->buffer()[offset] = resultOk;
+#else
+        storeSocketError(options, offset, 4, socketErrNotSupported);
+#endif
+        break;
+    }
+#if defined(OS_POSIX)
+    case LiftedWasiFunction::socketsTcpStartBind02:
+    case LiftedWasiFunction::socketsTcpStartConnect02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t networkIndex = argv[1].asI32();
+        uint32_t offset = argv[14].asI32();
+
+        if (options->instance()->getHandle(state, networkIndex)->kind() != ComponentHandle::ResourceWasiNetworkKind) {
+            ComponentInstance::throwInvalidHandle(state, networkIndex);
+        }
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 1, offset, 2);
+
+        bool isBind = function->type() == LiftedWasiFunction::socketsTcpStartBind02;
+        if (socket->state() != ComponentResourceWasiTcpSocket::Unbound && (isBind || socket->state() != ComponentResourceWasiTcpSocket::Bound)) {
+            storeSocketError(options, offset, 1, socketErrInvalidState);
+            break;
+        }
+
+        if (!instance->store()->wasiData()->inheritNetwork()) {
+            storeSocketError(options, offset, 1, socketErrAccessDenied);
+            break;
+        }
+
+        struct sockaddr_storage address;
+        socklen_t length;
+        if (!toSocketAddress(argv + 2, socket->isIPv6(), &address, &length)) {
+            storeSocketError(options, offset, 1, socketErrInvalidArgument);
+            break;
+        }
+
+        if (isBind) {
+            // Listening sockets can be restarted without waiting for the old connections to time out.
+            int value = 1;
+            setsockopt(socket->fileDescriptor(), SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+
+            if (bind(socket->fileDescriptor(), reinterpret_cast<struct sockaddr*>(&address), length) != 0) {
+                storeSocketError(options, offset, 1, toSocketErrorCode(errno));
+                break;
+            }
+
+            socket->setState(ComponentResourceWasiTcpSocket::BindStarted);
+            options->memory()->buffer()[offset] = resultOk;
+            break;
+        }
+
+        // The connection is finished by finish-connect when the socket becomes writable.
+        if (connect(socket->fileDescriptor(), reinterpret_cast<struct sockaddr*>(&address), length) != 0 && errno != EINPROGRESS) {
+            storeSocketError(options, offset, 1, toSocketErrorCode(errno));
+            socket->setState(ComponentResourceWasiTcpSocket::Closed);
+            break;
+        }
+
+        socket->setState(ComponentResourceWasiTcpSocket::ConnectStarted);
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpFinishBind02:
+    case LiftedWasiFunction::socketsTcpStartListen02:
+    case LiftedWasiFunction::socketsTcpFinishListen02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t offset = argv[1].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 1, offset, 2);
+
+        if (function->type() == LiftedWasiFunction::socketsTcpFinishBind02) {
+            if (socket->state() != ComponentResourceWasiTcpSocket::BindStarted) {
+                storeSocketError(options, offset, 1, socketErrNotInProgress);
+                break;
+            }
+            socket->setState(ComponentResourceWasiTcpSocket::Bound);
+        } else if (function->type() == LiftedWasiFunction::socketsTcpStartListen02) {
+            if (socket->state() != ComponentResourceWasiTcpSocket::Bound) {
+                storeSocketError(options, offset, 1, socketErrInvalidState);
+                break;
+            }
+
+            if (listen(socket->fileDescriptor(), SOMAXCONN) != 0) {
+                storeSocketError(options, offset, 1, toSocketErrorCode(errno));
+                break;
+            }
+            socket->setState(ComponentResourceWasiTcpSocket::ListenStarted);
+        } else {
+            if (socket->state() != ComponentResourceWasiTcpSocket::ListenStarted) {
+                storeSocketError(options, offset, 1, socketErrNotInProgress);
+                break;
+            }
+            socket->setState(ComponentResourceWasiTcpSocket::Listening);
+        }
+
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpFinishConnect02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t offset = argv[1].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 4, offset, 12);
+
+        if (socket->state() != ComponentResourceWasiTcpSocket::ConnectStarted) {
+            storeSocketError(options, offset, 4, socketErrNotInProgress);
+            break;
+        }
+
+        struct pollfd fds = { socket->fileDescriptor(), POLLOUT, 0 };
+        if (poll(&fds, 1, 0) == 0) {
+            storeSocketError(options, offset, 4, socketErrWouldBlock);
+            break;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(socket->fileDescriptor(), SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+            error = errno;
+        }
+
+        if (error != 0) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(error));
+            socket->setState(ComponentResourceWasiTcpSocket::Closed);
+            break;
+        }
+
+        socket->setState(ComponentResourceWasiTcpSocket::Connected);
+        storeSocketStreams(state, options, instance, socket, offset + 4);
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpAccept02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t offset = argv[1].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 4, offset, 16);
+
+        if (socket->state() != ComponentResourceWasiTcpSocket::Listening) {
+            storeSocketError(options, offset, 4, socketErrInvalidState);
+            break;
+        }
+
+        int fd;
+        do {
+            fd = accept(socket->fileDescriptor(), nullptr, nullptr);
+        } while (fd < 0 && errno == EINTR);
+
+        if (fd < 0) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(errno));
+            break;
+        }
+
+        if (!initSocket(fd)) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(errno));
+            close(fd);
+            break;
+        }
+
+        WasiRefCountedFile* fileRef = WasiRefCountedFile::createSocket(fd, DescriptorFlags::flagRead | DescriptorFlags::flagWrite);
+        ComponentResourceWasiTcpSocket* connection = new ComponentResourceWasiTcpSocket(instance->type()->getType(0)->asTypeResource(), fileRef, socket->isIPv6(), ComponentResourceWasiTcpSocket::Connected);
+        options->memory()->store(state, offset, 4, options->instance()->appendHandle(state, connection));
+        storeSocketStreams(state, options, instance, connection, offset + 8);
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpLocalAddress02:
+    case LiftedWasiFunction::socketsTcpRemoteAddress02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t offset = argv[1].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 4, offset, 36);
+
+        bool isLocal = function->type() == LiftedWasiFunction::socketsTcpLocalAddress02;
+        ComponentResourceWasiTcpSocket::State socketState = socket->state();
+
+        if (isLocal ? (socketState == ComponentResourceWasiTcpSocket::Unbound || socketState == ComponentResourceWasiTcpSocket::BindStarted)
+                    : socketState != ComponentResourceWasiTcpSocket::Connected) {
+            storeSocketError(options, offset, 4, socketErrInvalidState);
+            break;
+        }
+
+        struct sockaddr_storage address;
+        socklen_t length = sizeof(address);
+        int r = isLocal ? getsockname(socket->fileDescriptor(), reinterpret_cast<struct sockaddr*>(&address), &length)
+                        : getpeername(socket->fileDescriptor(), reinterpret_cast<struct sockaddr*>(&address), &length);
+
+        if (r != 0) {
+            storeSocketError(options, offset, 4, toSocketErrorCode(errno));
+            break;
+        }
+
+        storeSocketAddress(state, options, offset + 4, address);
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpIsListening02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        result[0] = Value(static_cast<int32_t>(socket->state() == ComponentResourceWasiTcpSocket::Listening));
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpAddressFamily02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        result[0] = Value(static_cast<int32_t>(socket->isIPv6() ? addressFamilyIPv6 : addressFamilyIPv4));
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpSubscribe02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        ComponentResource* resource = new ComponentResourceWasiPollable(instance->type()->getType(3)->asTypeResource(), socket);
+        result[0] = Value(static_cast<int32_t>(options->instance()->appendHandle(state, resource)));
+        break;
+    }
+    case LiftedWasiFunction::socketsTcpShutdown02: {
+        ComponentResourceWasiTcpSocket* socket = getTcpSocket(state, options, argv[0].asI32());
+        uint32_t shutdownType = argv[1].asI32();
+        uint32_t offset = argv[2].asI32();
+
+        ASSERT(!options->memory()->is64());
+        options->memoryCheckRange32(state, 1, offset, 2);
+
+        if (socket->state() != ComponentResourceWasiTcpSocket::Connected) {
+            storeSocketError(options, offset, 1, socketErrInvalidState);
+            break;
+        }
+
+        // The shutdown-type enum is: receive, send, both.
+        int how = shutdownType == 0 ? SHUT_RD : (shutdownType == 1 ? SHUT_WR : SHUT_RDWR);
+        if (shutdown(socket->fileDescriptor(), how) != 0) {
+            storeSocketError(options, offset, 1, toSocketErrorCode(errno));
+            break;
+        }
+
+        options->memory()->buffer()[offset] = resultOk;
+        break;
+    }
+#endif /* OS_POSIX */
     default:
         std::string message = "unimplemented wasi function";
         Trap::throwException(state, message);
@@ -638,10 +1774,18 @@ bool dropWasiResource(ExecutionState& state, ComponentHandle* handle)
             Trap::throwException(state, message);
         }
         break;
+    case ComponentHandle::ResourceWasiTcpSocketKind:
+        if (asTcpSocket(handle)->pollableCount() != 0) {
+            std::string message = "socket cannot be destroyed (has assigned pollable)";
+            Trap::throwException(state, message);
+        }
+        break;
     case ComponentHandle::ResourceWasiPollableKind:
     case ComponentHandle::ResourceWasiTerminalKind:
     case ComponentHandle::ResourceWasiFileKind:
     case ComponentHandle::ResourceWasiDirectoryKind:
+    case ComponentHandle::ResourceWasiErrorKind:
+    case ComponentHandle::ResourceWasiNetworkKind:
         break;
     default:
         return false;
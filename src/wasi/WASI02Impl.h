@@ -22,17 +22,55 @@
 #include "Walrus.h"
 #include "runtime/Component.h"
 #include "runtime/ComponentInstance.h"
+#include "wasi/WASI02FileSystem.h"
 #include "uv.h"
 
 #define WASI_STDIN 0
 #define WASI_STDOUT 1
-#define WASI_STDERR 0
+#define WASI_STDERR 2
 
 namespace Walrus {
 
+class ComponentResourceWasiStream;
+class ComponentResourceWasiPollable;
+class ComponentResourceWasiTcpSocket;
+
+// Waits for pollables of a store. File descriptors are watched by epoll
+// on Linux and by poll on other systems, while timers only limit the
+// time spent in the system call.
+class WasiReactor {
+public:
+    enum Events : uint32_t {
+        EventRead = 1 << 0,
+        EventWrite = 1 << 1,
+    };
+
+    WasiReactor();
+    ~WasiReactor();
+
+    // Blocks until at least one pollable is ready, and
+    // appends the indices of the ready pollables to the list.
+    void wait(ComponentResourceWasiPollable** pollables, size_t count, std::vector<uint32_t>& readyList);
+
+private:
+    struct WatchedDescriptor {
+        int fd;
+        uint32_t events;
+        uint32_t readyEvents;
+    };
+
+    bool watchDescriptor(int fd, uint32_t events);
+    void waitEvents(std::vector<WatchedDescriptor>& watched, int timeout);
+
+#if defined(__linux__)
+    int m_epollDescriptor;
+#endif
+};
+
 class WasiStoreData {
 public:
-    WasiStoreData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens);
+    WasiStoreData(int argc, const char** argv, const char** envp, Wasi02DirMap& preOpens, bool inheritNetwork);
+    ~WasiStoreData();
 
     uint64_t prevNow() const
     {
@@ -69,18 +107,51 @@ public:
         return m_preOpens;
     }
 
+    // Returns with nullptr if the pre-opened directory is on the host file system.
+    WasiVirtualFileSystem* fileSystem(size_t preOpenIndex) const
+    {
+        return m_fileSystems[preOpenIndex];
+    }
+
     std::map<size_t, ComponentInstance*>& wasiInstances()
     {
         return m_wasiInstances;
     }
 
+    // At most one output stream has buffered data at any time. Writing
+    // another stream flushes it first, so the output order is preserved.
+    ComponentResourceWasiStream* pendingOutput() const
+    {
+        return m_pendingOutput;
+    }
+
+    void flushPendingOutput();
+
+    WasiReactor& reactor()
+    {
+        return m_reactor;
+    }
+
+    // TCP sockets can only be bound or connected when the
+    // network of the host is shared with the components.
+    bool inheritNetwork() const
+    {
+        return m_inheritNetwork;
+    }
+
 private:
+    friend class ComponentResourceWasiStream;
+
     uint64_t m_prevNow;
     clock_t m_prevClockNow;
     std::vector<std::string> m_arguments;
     std::vector<std::pair<std::string, std::string>> m_environment;
     std::vector<std::pair<std::string, std::string>> m_preOpens;
+    std::vector<WasiVirtualFileSystem*> m_fileSystems;
     std::map<size_t, ComponentInstance*> m_wasiInstances;
+    ComponentResourceWasiStream* m_pendingOutput;
+    WasiReactor m_reactor;
+    bool m_inheritNetwork;
 };
 
 class WasiRefCountedFile {
@@ -88,9 +159,32 @@ public:
     WasiRefCountedFile(int desc, std::string path, uint32_t flags)
         : m_path(path)
         , m_uvDescriptor(desc)
+        , m_virtualFile(nullptr)
         , m_flags(flags)
         , m_refCount(1)
+        , m_isRegularFile(checkRegularFile(desc))
+        , m_isSocket(false)
+    {
+    }
+
+    // Takes the ownership of the virtual file reference.
+    WasiRefCountedFile(WasiVirtualFile* virtualFile, std::string path, uint32_t flags)
+        : m_path(path)
+        , m_uvDescriptor(-1)
+        , m_virtualFile(virtualFile)
+        , m_flags(flags)
+        , m_refCount(1)
+        , m_isRegularFile(true)
+        , m_isSocket(false)
+    {
+    }
+
+    // Sockets are non-blocking and shared by a tcp-socket and its streams.
+    static WasiRefCountedFile* createSocket(int desc, uint32_t flags)
     {
+        WasiRefCountedFile* file = new WasiRefCountedFile(desc, std::string(), flags);
+        file->m_isSocket = true;
+        return file;
     }
 
     int fileDescriptor()
@@ -103,11 +197,29 @@ public:
         return m_path;
     }
 
+    // Non-nullptr for the files of virtual file systems.
+    WasiVirtualFile* virtualFile()
+    {
+        return m_virtualFile;
+    }
+
     uint32_t flags()
     {
         return m_flags;
     }
 
+    // Only regular files can be read at an offset, pipes,
+    // sockets and terminals fail with ESPIPE.
+    bool isRegularFile()
+    {
+        return m_isRegularFile;
+    }
+
+    bool isSocket()
+    {
+        return m_isSocket;
+    }
+
     void addRef()
     {
         m_refCount++;
@@ -121,23 +233,34 @@ public:
     }
 
 private:
+    static bool checkRegularFile(int desc);
     void destroyFile();
 
     std::string m_path;
     int m_uvDescriptor;
+    WasiVirtualFile* m_virtualFile;
     uint32_t m_flags;
     size_t m_refCount;
+    bool m_isRegularFile;
+    bool m_isSocket;
 };
 
 class ComponentResourceWasiStream : public ComponentResource {
     friend class ComponentResourceWasiPollable;
 
 public:
+    // Number of bytes accepted by write without flushing, reported by check-write.
+    static constexpr size_t WriteBufferSize = 16 * 1024;
+    // Maximum number of bytes returned by a single read.
+    static constexpr uint64_t MaxReadSize = 1024 * 1024;
+
     ComponentResourceWasiStream(ComponentTypeResource* type, Kind kind, WasiRefCountedFile* file)
         : ComponentResource(kind, type)
         , m_file(file)
         , m_pollableCount(0)
         , m_offset(0)
+        , m_storeData(nullptr)
+        , m_lastOperationFailed(false)
     {
         ASSERT(kind == ResourceWasiInputStreamKind || kind == ResourceWasiOutputStreamKind);
     }
@@ -147,16 +270,13 @@ public:
         , m_file(file)
         , m_pollableCount(0)
         , m_offset(offset)
+        , m_storeData(nullptr)
+        , m_lastOperationFailed(false)
     {
         ASSERT(kind == ResourceWasiInputStreamKind || kind == ResourceWasiOutputStreamKind);
     }
 
-    virtual ~ComponentResourceWasiStream() override
-    {
-        if (m_file != nullptr) {
-            m_file->releaseRef();
-        }
-    }
+    virtual ~ComponentResourceWasiStream() override;
 
     bool isClosed() const
     {
@@ -173,6 +293,13 @@ public:
         return m_pollableCount;
     }
 
+    // Streams of the standard descriptors and of non-seekable
+    // files use the current file position.
+    bool isPositional()
+    {
+        return m_file->virtualFile() != nullptr || (m_file->fileDescriptor() > WASI_STDERR && m_file->isRegularFile());
+    }
+
     long int offset() const
     {
         return m_offset;
@@ -196,61 +323,205 @@ public:
     void dropFileRef()
     {
         ASSERT(!isClosed());
+        flush();
         m_file->releaseRef();
         m_file = nullptr;
     }
 
+    size_t writeBudget() const
+    {
+        // Sockets keep the data which cannot be sent without blocking,
+        // so their buffer may grow beyond the budget.
+        return m_writeBuffer.size() < WriteBufferSize ? WriteBufferSize - m_writeBuffer.size() : 0;
+    }
+
+    // Set when the buffered data cannot be written. The data might be flushed
+    // by the operation of another stream, so the failure is reported by the
+    // next operation of this stream.
+    bool lastOperationFailed() const
+    {
+        return m_lastOperationFailed;
+    }
+
+    // Both return with false if the data cannot be written.
+    bool write(WasiStoreData* storeData, const uint8_t* data, size_t size);
+    bool flush()
+    {
+        if (m_file->isSocket()) {
+            return flushSocket();
+        }
+        return writeBuffers(nullptr, 0);
+    }
+
+    // Sends as much buffered data to a socket as possible without blocking.
+    bool sendBuffered();
+
 private:
+    friend class WasiStoreData;
+
+    bool writeBuffers(const uint8_t* data, size_t size);
+    bool flushSocket();
+
     // The m_file is nullptr for closed streams.
     WasiRefCountedFile* m_file;
     size_t m_pollableCount;
     long int m_offset;
+    // Output streams collect the written data until the next flush.
+    std::vector<uint8_t> m_writeBuffer;
+    // Non-nullptr while the buffer is not empty.
+    WasiStoreData* m_storeData;
+    bool m_lastOperationFailed;
 };
 
-class ComponentResourceWasiPollable : public ComponentResource {
+// The error of a last-operation-failed stream error.
+class ComponentResourceWasiError : public ComponentResource {
 public:
-    ComponentResourceWasiPollable(ComponentTypeResource* type, ComponentResourceWasiStream* stream)
-        : ComponentResource(ResourceWasiPollableKind, type)
-        , m_stream(stream)
+    ComponentResourceWasiError(ComponentTypeResource* type)
+        : ComponentResource(ResourceWasiErrorKind, type)
     {
-        stream->m_pollableCount++;
     }
+};
 
-    ~ComponentResourceWasiPollable()
+class ComponentResourceWasiNetwork : public ComponentResource {
+public:
+    ComponentResourceWasiNetwork(ComponentTypeResource* type)
+        : ComponentResource(ResourceWasiNetworkKind, type)
     {
-        m_stream->m_pollableCount--;
     }
+};
 
-    ComponentResourceWasiStream* stream() const
+class ComponentResourceWasiTcpSocket : public ComponentResource {
+    friend class ComponentResourceWasiPollable;
+
+public:
+    enum State : uint8_t {
+        Unbound,
+        BindStarted,
+        Bound,
+        ListenStarted,
+        Listening,
+        ConnectStarted,
+        Connected,
+        // Failed connections cannot be reused.
+        Closed,
+    };
+
+    ComponentResourceWasiTcpSocket(ComponentTypeResource* type, WasiRefCountedFile* file, bool isIPv6, State state)
+        : ComponentResource(ResourceWasiTcpSocketKind, type)
+        , m_file(file)
+        , m_pollableCount(0)
+        , m_isIPv6(isIPv6)
+        , m_state(state)
     {
-        return m_stream;
+    }
+
+    ~ComponentResourceWasiTcpSocket()
+    {
+        m_file->releaseRef();
+    }
+
+    int fileDescriptor()
+    {
+        return m_file->fileDescriptor();
+    }
+
+    WasiRefCountedFile* addFileRef()
+    {
+        m_file->addRef();
+        return m_file;
+    }
+
+    size_t pollableCount() const
+    {
+        return m_pollableCount;
+    }
+
+    bool isIPv6() const
+    {
+        return m_isIPv6;
+    }
+
+    State state() const
+    {
+        return m_state;
+    }
+
+    void setState(State state)
+    {
+        m_state = state;
     }
 
 private:
-    ComponentResourceWasiStream* m_stream;
+    WasiRefCountedFile* m_file;
+    size_t m_pollableCount;
+    bool m_isIPv6;
+    State m_state;
 };
 
-class ComponentResourceWasiPollableTimer : public ComponentResource {
+class ComponentResourceWasiPollable : public ComponentResource {
 public:
-    ComponentResourceWasiPollableTimer(ComponentTypeResource* type, uint64_t startSeconds)
+    // Ready when the stream can be read or written.
+    ComponentResourceWasiPollable(ComponentTypeResource* type, ComponentResourceWasiStream* stream)
         : ComponentResource(ResourceWasiPollableKind, type)
-        , m_startNanosec(startSeconds)
+        , m_stream(stream)
+        , m_socket(nullptr)
+        , m_deadline(0)
     {
+        stream->m_pollableCount++;
     }
 
-    bool isReady()
+    // Ready when a connection can be accepted or a connect operation is finished.
+    ComponentResourceWasiPollable(ComponentTypeResource* type, ComponentResourceWasiTcpSocket* socket)
+        : ComponentResource(ResourceWasiPollableKind, type)
+        , m_stream(nullptr)
+        , m_socket(socket)
+        , m_deadline(0)
     {
-        uint64_t nanosecs = uv_hrtime();
+        socket->m_pollableCount++;
+    }
 
-        if (m_startNanosec < nanosecs) {
-            return true;
+    // Ready when the monotonic clock reaches the deadline (in nanoseconds).
+    ComponentResourceWasiPollable(ComponentTypeResource* type, uint64_t deadline)
+        : ComponentResource(ResourceWasiPollableKind, type)
+        , m_stream(nullptr)
+        , m_socket(nullptr)
+        , m_deadline(deadline)
+    {
+    }
+
+    ~ComponentResourceWasiPollable()
+    {
+        if (m_stream != nullptr) {
+            m_stream->m_pollableCount--;
+        } else if (m_socket != nullptr) {
+            m_socket->m_pollableCount--;
         }
+    }
+
+    bool isTimer() const
+    {
+        return m_stream == nullptr && m_socket == nullptr;
+    }
+
+    ComponentResourceWasiStream* stream() const
+    {
+        return m_stream;
+    }
 
-        return false;
+    ComponentResourceWasiTcpSocket* socket() const
+    {
+        return m_socket;
+    }
+
+    uint64_t deadline() const
+    {
+        return m_deadline;
     }
 
 private:
-    uint64_t m_startNanosec;
+    ComponentResourceWasiStream* m_stream;
+    ComponentResourceWasiTcpSocket* m_socket;
+    uint64_t m_deadline;
 };
 
 class ComponentResourceWasiTerminal : public ComponentResource {
@@ -307,10 +578,11 @@ private:
 
 class ComponentResourceWasiDirectory : public ComponentResource {
 public:
-    ComponentResourceWasiDirectory(ComponentTypeResource* type, const std::string& mappedPath, const std::string& realPath, bool mut)
+    ComponentResourceWasiDirectory(ComponentTypeResource* type, const std::string& mappedPath, const std::string& realPath, WasiVirtualFileSystem* fileSystem, bool mut)
         : ComponentResource(ResourceWasiDirectoryKind, type)
         , m_mappedPath(mappedPath)
         , m_realPath(realPath)
+        , m_fileSystem(fileSystem)
         , m_mutable(mut)
     {
     }
@@ -325,6 +597,12 @@ public:
         return m_realPath;
     }
 
+    // Non-nullptr if the directory is the root of a virtual file system.
+    WasiVirtualFileSystem* fileSystem() const
+    {
+        return m_fileSystem;
+    }
+
     bool isMutable()
     {
         return m_mutable;
@@ -333,6 +611,7 @@ public:
 private:
     std::string m_mappedPath;
     std::string m_realPath;
+    WasiVirtualFileSystem* m_fileSystem;
     bool m_mutable;
 };
 
@@ -358,6 +637,8 @@ public:
         cliGetTerminalStdout02,
         cliGetTerminalStderr02,
         clockMonotonicNow02,
+        clockMonotonicResolution02,
+        clockSubscribeInstant02,
         clockSubscribeDuration02,
         clockWallNow02,
         fileSystemDescriptorReadViaStream02,
@@ -372,6 +653,21 @@ public:
         neuralNetworkInferenceGraphExecutionContextCompute,
         neuralNetworkGraphInitExectionContext02,
         neuralNetworkGraphLoad02,
+        socketsInstanceNetwork02,
+        socketsCreateTcpSocket02,
+        socketsTcpStartBind02,
+        socketsTcpFinishBind02,
+        socketsTcpStartConnect02,
+        socketsTcpFinishConnect02,
+        socketsTcpStartListen02,
+        socketsTcpFinishListen02,
+        socketsTcpAccept02,
+        socketsTcpLocalAddress02,
+        socketsTcpRemoteAddress02,
+        socketsTcpIsListening02,
+        socketsTcpAddressFamily02,
+        socketsTcpSubscribe02,
+        socketsTcpShutdown02,
     };
 
     LiftedWasiFunction(Type type, ComponentInstance* instance, FunctionType* functionType)
@@ -0,0 +1,110 @@
+// Parses a module once, and instantiates it in two stores of the same engine.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "wasm.h"
+
+// (module
+//   (global $counter (mut i32) (i32.const 0))
+//   (func (export "inc") (result i32)
+//     (global.set $counter (i32.add (global.get $counter) (i32.const 1)))
+//     (global.get $counter)))
+static const char binary[] = {
+  0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60,
+  0x00, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x06, 0x06, 0x01, 0x7f, 0x01,
+  0x41, 0x00, 0x0b, 0x07, 0x07, 0x01, 0x03, 0x69, 0x6e, 0x63, 0x00, 0x00,
+  0x0a, 0x0d, 0x01, 0x0b, 0x00, 0x23, 0x00, 0x41, 0x01, 0x6a, 0x24, 0x00,
+  0x23, 0x00, 0x0b
+};
+
+static void check(bool success, const char* message) {
+  if (!success) {
+    printf("> Error: %s!\n", message);
+    exit(1);
+  }
+}
+
+static wasm_instance_t* instantiate(wasm_store_t* store, const wasm_module_t* module, wasm_func_t** inc) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  wasm_instance_t* instance = wasm_instance_new(store, module, &imports, NULL);
+  check(instance != NULL, "instantiating module");
+
+  wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  check(exports.size == 1, "number of exports");
+  *inc = wasm_func_copy(wasm_extern_as_func(exports.data[0]));
+  wasm_extern_vec_delete(&exports);
+  return instance;
+}
+
+static void call(const wasm_func_t* inc, int32_t expected) {
+  wasm_val_t results_val[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_vec_t results = WASM_ARRAY_VEC(results_val);
+
+  check(wasm_func_call(inc, &args, &results) == NULL, "calling inc");
+  check(results_val[0].of.i32 == expected, "unexpected counter value");
+}
+
+int main(int argc, const char* argv[]) {
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* first_store = wasm_store_new(engine);
+  wasm_store_t* second_store = wasm_store_new(engine);
+
+  printf("Compiling module...\n");
+  wasm_byte_vec_t bytes;
+  wasm_byte_vec_new(&bytes, sizeof(binary), binary);
+  wasm_module_t* first_module = wasm_module_new(first_store, &bytes);
+  wasm_byte_vec_delete(&bytes);
+  check(first_module != NULL, "compiling module");
+
+  printf("Sharing module...\n");
+  wasm_shared_module_t* shared = wasm_module_share(first_module);
+  wasm_module_t* second_module = wasm_module_obtain(second_store, shared);
+  check(second_module != NULL, "obtaining module");
+
+  // Only the stores of the same engine can obtain the module.
+  wasm_engine_t* other_engine = wasm_engine_new();
+  wasm_store_t* other_store = wasm_store_new(other_engine);
+  check(wasm_module_obtain(other_store, shared) == NULL, "obtaining module from another engine");
+  wasm_store_delete(other_store);
+  wasm_engine_delete(other_engine);
+
+  printf("Instantiating modules...\n");
+  wasm_func_t* first_inc;
+  wasm_func_t* second_inc;
+  wasm_instance_t* first_instance = instantiate(first_store, first_module, &first_inc);
+  wasm_instance_t* second_instance = instantiate(second_store, second_module, &second_inc);
+
+  // The instances have their own globals.
+  printf("Calling exports...\n");
+  call(first_inc, 1);
+  call(first_inc, 2);
+  call(second_inc, 1);
+
+  // The module is kept alive by the second store.
+  printf("Deleting the first store...\n");
+  wasm_func_delete(first_inc);
+  wasm_instance_delete(first_instance);
+  wasm_module_delete(first_module);
+  wasm_store_delete(first_store);
+
+  call(second_inc, 2);
+  wasm_instance_t* third_instance = instantiate(second_store, second_module, &first_inc);
+  call(first_inc, 1);
+
+  printf("Shutting down...\n");
+  wasm_func_delete(first_inc);
+  wasm_instance_delete(third_instance);
+  wasm_func_delete(second_inc);
+  wasm_instance_delete(second_instance);
+  wasm_module_delete(second_module);
+  wasm_shared_module_delete(shared);
+  wasm_store_delete(second_store);
+  wasm_engine_delete(engine);
+
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,103 @@
+// Calls a function which traps after a few nested calls in a loop, and
+// checks that every call reports the trap, and the store keeps working.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wasm.h"
+
+#define ITERATIONS 20000
+#define DEPTH 16
+
+// (module
+//   (memory 1)
+//   (func $load (param i32) (result i32)
+//     (i32.load (local.get 0)))
+//   (func $nest (export "nest") (param i32 i32) (result i32)
+//     (if (result i32) (local.get 1)
+//       (then (call $nest (local.get 0) (i32.sub (local.get 1) (i32.const 1))))
+//       (else (call $load (local.get 0))))))
+static const char binary[] = {
+  0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0c, 0x02, 0x60,
+  0x01, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x03,
+  0x02, 0x00, 0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x08, 0x01, 0x04,
+  0x6e, 0x65, 0x73, 0x74, 0x00, 0x01, 0x0a, 0x1f, 0x02, 0x07, 0x00, 0x20,
+  0x00, 0x28, 0x02, 0x00, 0x0b, 0x15, 0x00, 0x20, 0x01, 0x04, 0x7f, 0x20,
+  0x00, 0x20, 0x01, 0x41, 0x01, 0x6b, 0x10, 0x01, 0x05, 0x20, 0x00, 0x10,
+  0x00, 0x0b, 0x0b
+};
+
+static const char expected_message[] = "out of bounds memory access: access at 65536+4";
+
+static void check(bool success, const char* message) {
+  if (!success) {
+    printf("> Error: %s!\n", message);
+    exit(1);
+  }
+}
+
+static wasm_trap_t* call(const wasm_func_t* nest, int32_t address) {
+  wasm_val_t args_val[2] = { WASM_I32_VAL(address), WASM_I32_VAL(DEPTH) };
+  wasm_val_t results_val[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(args_val);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(results_val);
+
+  return wasm_func_call(nest, &args, &results);
+}
+
+int main(int argc, const char* argv[]) {
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  printf("Compiling module...\n");
+  wasm_byte_vec_t bytes;
+  wasm_byte_vec_new(&bytes, sizeof(binary), binary);
+  wasm_module_t* module = wasm_module_new(store, &bytes);
+  wasm_byte_vec_delete(&bytes);
+  check(module != NULL, "compiling module");
+
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  wasm_instance_t* instance = wasm_instance_new(store, module, &imports, NULL);
+  check(instance != NULL, "instantiating module");
+
+  wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  check(exports.size == 1, "number of exports");
+  const wasm_func_t* nest = wasm_extern_as_func(exports.data[0]);
+
+  printf("Calling trapping function...\n");
+  clock_t start = clock();
+  for (int i = 0; i < ITERATIONS; i++) {
+    wasm_trap_t* trap = call(nest, 65536);
+    check(trap != NULL, "missing trap");
+
+    wasm_message_t message;
+    wasm_trap_message(trap, &message);
+    check(message.size >= sizeof(expected_message) - 1
+              && memcmp(message.data, expected_message, sizeof(expected_message) - 1) == 0,
+          "unexpected trap message");
+    wasm_byte_vec_delete(&message);
+    wasm_trap_delete(trap);
+
+    // A trap does not affect the next call.
+    if (i % 1000 == 0) {
+      check(call(nest, 0) == NULL, "calling nest");
+    }
+  }
+  printf("Traps: %d calls in %.1f ms\n", ITERATIONS,
+         (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+
+  printf("Shutting down...\n");
+  wasm_extern_vec_delete(&exports);
+  wasm_instance_delete(instance);
+  wasm_module_delete(module);
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  printf("Done.\n");
+  return 0;
+}
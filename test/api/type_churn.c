@@ -0,0 +1,114 @@
+// Creates modules with new struct types in short lived stores, and checks
+// that the types are freed after their objects are collected.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wasm.h"
+
+#define ITERATIONS 200
+
+static void check(bool success, const char* message) {
+  if (!success) {
+    printf("> Error: %s!\n", message);
+    exit(1);
+  }
+}
+
+static size_t append_leb(char* out, uint32_t value) {
+  size_t size = 0;
+  do {
+    char byte = value & 0x7f;
+    value >>= 7;
+    out[size++] = value ? (byte | 0x80) : byte;
+  } while (value);
+  return size;
+}
+
+static size_t append_section(char* out, char id, const char* content, size_t content_size) {
+  size_t size = 0;
+  out[size++] = id;
+  size += append_leb(out + size, content_size);
+  memcpy(out + size, content, content_size);
+  return size + content_size;
+}
+
+// (module
+//   (type $struct (struct (field i32) ... field_count times))
+//   (type $bytes (array (mut i8)))
+//   (global anyref (struct.new_default $struct))
+//   (global anyref (array.new_default $bytes (i32.const 65536))))
+static size_t create_binary(char* out, uint32_t field_count) {
+  static const char header[] = { 0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00 };
+  static const char globals[] = {
+    0x02,
+    0x6e, 0x00, 0xfb, 0x01, 0x00, 0x0b,
+    0x6e, 0x00, 0x41, 0x80, 0x80, 0x04, 0xfb, 0x07, 0x01, 0x0b
+  };
+  char* types = malloc(16 + 2 * field_count);
+  size_t types_size = 0;
+
+  types[types_size++] = 0x02;
+  types[types_size++] = 0x5f;
+  types_size += append_leb(types + types_size, field_count);
+  for (uint32_t i = 0; i < field_count; i++) {
+    types[types_size++] = 0x7f;
+    types[types_size++] = 0x00;
+  }
+  types[types_size++] = 0x5e;
+  types[types_size++] = 0x78;
+  types[types_size++] = 0x01;
+
+  size_t size = sizeof(header);
+  memcpy(out, header, sizeof(header));
+  size += append_section(out + size, 0x01, types, types_size);
+  size += append_section(out + size, 0x06, globals, sizeof(globals));
+  free(types);
+  return size;
+}
+
+int main(int argc, const char* argv[]) {
+  printf("Initializing...\n");
+  wasm_config_t* config = wasm_config_new();
+  walrus_config_set_web_assembly3(config, true);
+  wasm_engine_t* engine = wasm_engine_new_with_config(config);
+  char* binary = malloc(64 + 2 * ITERATIONS);
+
+  printf("Creating modules...\n");
+  for (uint32_t i = 1; i <= ITERATIONS; i++) {
+    wasm_store_t* store = wasm_store_new(engine);
+
+    wasm_byte_vec_t bytes;
+    wasm_byte_vec_new(&bytes, create_binary(binary, i), binary);
+    wasm_module_t* module = wasm_module_new(store, &bytes);
+    wasm_byte_vec_delete(&bytes);
+    check(module != NULL, "compiling module");
+
+    wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+    wasm_instance_t* instance = wasm_instance_new(store, module, &imports, NULL);
+    check(instance != NULL, "instantiating module");
+
+    wasm_instance_delete(instance);
+    wasm_module_delete(module);
+    // Deleting a store starts a collection.
+    wasm_store_delete(store);
+  }
+
+  // Each module created a new struct type. The types of collected
+  // objects are freed, a few may be kept by conservative scanning.
+  printf("Checking types...\n");
+  wasm_store_t* store = wasm_store_new(engine);
+  walrus_gc_stats_t stats;
+  walrus_store_gc_stats(store, &stats);
+  printf("Recursive types: %d\n", (int)stats.recursive_types);
+  check(stats.recursive_types < ITERATIONS / 10, "types are not freed");
+
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+  free(binary);
+
+  printf("Done.\n");
+  return 0;
+}
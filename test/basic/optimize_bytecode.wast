@@ -0,0 +1,155 @@
+(module
+  (global $g (mut i32) (i32.const 0))
+  (memory 1)
+
+  ;; constant folding across blocks
+  (func (export "fold")(result i32)
+    (local i32 i32)
+    i32.const 6
+    local.set 0
+    (block
+      local.get 0
+      i32.const 7
+      i32.mul
+      local.set 1
+    )
+    local.get 1
+    i32.const 1
+    i32.shl
+    i32.const -1
+    i32.xor
+    i32.const 2
+    i32.shr_s
+  )
+
+  (func (export "fold64")(result i64)
+    i64.const 0x7fffffffffffffff
+    i64.const 1
+    i64.add
+    i32.const -1
+    i64.extend_i32_u
+    i64.xor
+  )
+
+  ;; folded conditions turn into jumps
+  (func (export "branch")(param i32)(result i32)
+    i32.const 1
+    (if (result i32)
+      (then local.get 0)
+      (else i32.const 100)
+    )
+    i32.const 0
+    (if (result i32)
+      (then i32.const 100)
+      (else local.get 0)
+    )
+    i32.add
+  )
+
+  ;; copies must not be forwarded after the source is overwritten
+  (func (export "copy")(param i32 i32)(result i32)
+    (local i32)
+    local.get 0
+    local.set 2
+    local.get 1
+    local.set 0
+    local.get 2
+    local.get 0
+    i32.sub
+  )
+
+  ;; dead stores around a loop
+  (func (export "loop")(param i32)(result i32)
+    (local i32 i32)
+    i32.const 55
+    local.set 2
+    (loop $l
+      local.get 1
+      local.get 0
+      i32.add
+      local.set 1
+      local.get 0
+      i32.const 1
+      i32.sub
+      local.tee 0
+      br_if $l
+    )
+    i32.const 77
+    local.set 2
+    local.get 1
+  )
+
+  (func (export "brtable")(param i32)(result i32)
+    (local i32)
+    i32.const 10
+    local.set 1
+    (block
+      (block
+        (block
+          local.get 0
+          br_table 0 1 2
+        )
+        local.get 1
+        i32.const 1
+        i32.add
+        return
+      )
+      local.get 1
+      i32.const 2
+      i32.add
+      return
+    )
+    local.get 1
+  )
+
+  ;; trapping operations are never removed
+  (func (export "trap")(param i32)
+    (local i32)
+    i32.const 1
+    local.get 0
+    i32.div_u
+    local.set 1
+  )
+
+  (func (export "store")(param i32)(result i32)
+    (local i32)
+    local.get 0
+    local.set 1
+    i32.const 0
+    local.get 1
+    i32.store
+    local.get 1
+    global.set $g
+    i32.const 0
+    i32.load
+    global.get $g
+    i32.add
+  )
+
+  (func (export "select")(param i32)(result i64)
+    (local i64 i64)
+    i64.const 5
+    local.set 1
+    i64.const 9
+    local.set 2
+    local.get 1
+    local.get 2
+    local.get 0
+    select
+  )
+)
+
+(assert_return (invoke "fold") (i32.const -22))
+(assert_return (invoke "fold64") (i64.const 0x80000000ffffffff))
+(assert_return (invoke "branch" (i32.const 3)) (i32.const 6))
+(assert_return (invoke "copy" (i32.const 10) (i32.const 4)) (i32.const 6))
+(assert_return (invoke "loop" (i32.const 4)) (i32.const 10))
+(assert_return (invoke "brtable" (i32.const 0)) (i32.const 11))
+(assert_return (invoke "brtable" (i32.const 1)) (i32.const 12))
+(assert_return (invoke "brtable" (i32.const 2)) (i32.const 10))
+(assert_return (invoke "brtable" (i32.const 7)) (i32.const 10))
+(assert_return (invoke "trap" (i32.const 1)))
+(assert_trap (invoke "trap" (i32.const 0)) "integer divide by zero")
+(assert_return (invoke "store" (i32.const 21)) (i32.const 42))
+(assert_return (invoke "select" (i32.const 1)) (i64.const 5))
+(assert_return (invoke "select" (i32.const 0)) (i64.const 9))
@@ -0,0 +1,319 @@
+;; Lists, records, parameters and results passed in memory, and
+;; post-return functions called between two components.
+(component
+  (component $callee
+    (core module $m
+      (memory (export "memory") 1)
+      (global $heap (mut i32) (i32.const 1024))
+      (global $post-return-count (mut i32) (i32.const 0))
+      (global $post-return-value (mut i32) (i32.const 0))
+      (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+        (local $ptr i32)
+        ;; Bump allocator, aligned to the requested alignment.
+        (local.set $ptr (i32.and (i32.add (global.get $heap) (i32.sub (local.get 2) (i32.const 1)))
+                                 (i32.sub (i32.const 0) (local.get 2))))
+        (global.set $heap (i32.add (local.get $ptr) (local.get 3)))
+        (local.get $ptr)
+      )
+      (func $equal (param $ptr i32) (param $expected i32) (param $size i32) (result i32)
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $size)))
+            (if (i32.ne (i32.load8_u (local.get $ptr)) (i32.load8_u (local.get $expected)))
+              (then (return (i32.const 0))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 1)))
+            (local.set $expected (i32.add (local.get $expected) (i32.const 1)))
+            (local.set $size (i32.sub (local.get $size) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (i32.const 1)
+      )
+      (func $sum (export "sum") (param $ptr i32) (param $len i32) (result i32)
+        (local $sum i32)
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $len)))
+            (local.set $sum (i32.add (local.get $sum) (i32.load (local.get $ptr))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 4)))
+            (local.set $len (i32.sub (local.get $len) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (local.get $sum)
+      )
+      ;; Compares the UTF16 strings stored at every stride bytes to the
+      ;; expected bytes. Returns with the number of strings, or -1.
+      (func $strings (param $ptr i32) (param $len i32) (param $stride i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (local $i i32)
+        (local $size i32)
+        (block $done
+          (loop $next
+            (br_if $done (i32.eq (local.get $i) (local.get $len)))
+            (local.set $size (i32.shl (i32.load offset=4 (local.get $ptr)) (i32.const 1)))
+            (if (i32.gt_u (local.get $size) (local.get $expected-size))
+              (then (return (i32.const -1))))
+            (if (i32.eqz (call $equal (i32.load (local.get $ptr)) (local.get $expected) (local.get $size)))
+              (then (return (i32.const -1))))
+            (local.set $expected (i32.add (local.get $expected) (local.get $size)))
+            (local.set $expected-size (i32.sub (local.get $expected-size) (local.get $size)))
+            (local.set $ptr (i32.add (local.get $ptr) (local.get $stride)))
+            (local.set $i (i32.add (local.get $i) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (if (i32.ne (local.get $expected-size) (i32.const 0))
+          (then (return (i32.const -1))))
+        (local.get $len)
+      )
+      (func (export "strings") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $strings (local.get $ptr) (local.get $len) (i32.const 8) (local.get $expected) (local.get $expected-size))
+      )
+      ;; Returns with the sum of the ids if the names are the expected ones.
+      (func (export "persons") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (if (i32.ne (call $strings (i32.add (local.get $ptr) (i32.const 4)) (local.get $len) (i32.const 12)
+                                   (local.get $expected) (local.get $expected-size))
+                    (local.get $len))
+          (then (return (i32.const -1))))
+        (call $sum3 (local.get $ptr) (local.get $len))
+      )
+      (func $sum3 (param $ptr i32) (param $len i32) (result i32)
+        (local $sum i32)
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $len)))
+            (local.set $sum (i32.add (local.get $sum) (i32.load (local.get $ptr))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 12)))
+            (local.set $len (i32.sub (local.get $len) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (local.get $sum)
+      )
+      (func (export "sum-nested") (param $ptr i32) (param $len i32) (result i32)
+        (local $sum i32)
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $len)))
+            (local.set $sum (i32.add (local.get $sum)
+                                     (call $sum (i32.load (local.get $ptr)) (i32.load offset=4 (local.get $ptr)))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 8)))
+            (local.set $len (i32.sub (local.get $len) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (local.get $sum)
+      )
+      ;; The sixteen numbers, the string and the expected bytes of the
+      ;; string are passed in memory.
+      (func (export "spill-params") (param $ptr i32) (result i32)
+        (if (i32.ne (i32.shl (i32.load offset=68 (local.get $ptr)) (i32.const 1)) (i32.load offset=76 (local.get $ptr)))
+          (then (return (i32.const -1))))
+        (if (i32.eqz (call $equal (i32.load offset=64 (local.get $ptr)) (i32.load offset=72 (local.get $ptr))
+                                  (i32.load offset=76 (local.get $ptr))))
+          (then (return (i32.const -1))))
+        (call $sum (local.get $ptr) (i32.const 16))
+      )
+      ;; The result record is returned in memory.
+      (func (export "describe") (param $id i32) (param $ptr i32) (param $len i32) (result i32)
+        (i32.store (i32.const 512) (local.get $id))
+        (i64.store (i32.const 520) (i64.mul (i64.extend_i32_u (local.get $id)) (i64.const 0x100000001)))
+        (i32.store (i32.const 528) (local.get $ptr))
+        (i32.store (i32.const 532) (local.get $len))
+        (i32.const 512)
+      )
+      (func (export "post-return") (param $value i32)
+        (global.set $post-return-count (i32.add (global.get $post-return-count) (i32.const 1)))
+        (global.set $post-return-value (local.get $value))
+      )
+      (func (export "post-return-count") (result i32)
+        (global.get $post-return-count)
+      )
+      (func (export "post-return-value") (result i32)
+        (global.get $post-return-value)
+      )
+    )
+    (core instance $i (instantiate $m))
+    (alias core export $i "memory" (core memory $mem))
+    (alias core export $i "realloc" (core func $realloc))
+    (alias core export $i "post-return" (core func $post-return))
+    (alias core export $i "sum" (core func $core-sum))
+    (alias core export $i "strings" (core func $core-strings))
+    (alias core export $i "persons" (core func $core-persons))
+    (alias core export $i "sum-nested" (core func $core-sum-nested))
+    (alias core export $i "spill-params" (core func $core-spill-params))
+    (alias core export $i "describe" (core func $core-describe))
+    (alias core export $i "post-return-count" (core func $core-post-return-count))
+    (alias core export $i "post-return-value" (core func $core-post-return-value))
+
+    (type $bytes (list u8))
+    (type $u32s (list u32))
+    (type $strings (list string))
+    (type $person (record (field "id" u32) (field "name" string)))
+    (type $persons (list $person))
+    (type $nested (list $u32s))
+    (type $info (record (field "id" u32) (field "big" u64) (field "name" string)))
+
+    (func $sum (param "l" $u32s) (result u32)
+      (canon lift (core func $core-sum) (memory $mem) (realloc $realloc) (post-return $post-return)))
+    (func $strings (param "l" $strings) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-strings) (memory $mem) (realloc $realloc) string-encoding=utf16))
+    (func $persons (param "l" $persons) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-persons) (memory $mem) (realloc $realloc) string-encoding=utf16))
+    (func $sum-nested (param "l" $nested) (result u32)
+      (canon lift (core func $core-sum-nested) (memory $mem) (realloc $realloc)))
+    (func $spill-params
+      (param "a0" u32) (param "a1" u32) (param "a2" u32) (param "a3" u32)
+      (param "a4" u32) (param "a5" u32) (param "a6" u32) (param "a7" u32)
+      (param "a8" u32) (param "a9" u32) (param "a10" u32) (param "a11" u32)
+      (param "a12" u32) (param "a13" u32) (param "a14" u32) (param "a15" u32)
+      (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-spill-params) (memory $mem) (realloc $realloc) string-encoding=utf16))
+    (func $describe (param "id" u32) (param "name" string) (result $info)
+      (canon lift (core func $core-describe) (memory $mem) (realloc $realloc) (post-return $post-return) string-encoding=utf16))
+    (func $post-return-count (result u32) (canon lift (core func $core-post-return-count)))
+    (func $post-return-value (result u32) (canon lift (core func $core-post-return-value)))
+
+    (export "sum" (func $sum))
+    (export "strings" (func $strings))
+    (export "persons" (func $persons))
+    (export "sum-nested" (func $sum-nested))
+    (export "spill-params" (func $spill-params))
+    (export "describe" (func $describe))
+    (export "post-return-count" (func $post-return-count))
+    (export "post-return-value" (func $post-return-value))
+  )
+  (instance $c (instantiate $callee))
+  (alias export $c "sum" (func $sum))
+  (alias export $c "strings" (func $strings))
+  (alias export $c "persons" (func $persons))
+  (alias export $c "sum-nested" (func $sum-nested))
+  (alias export $c "spill-params" (func $spill-params))
+  (alias export $c "describe" (func $describe))
+  (alias export $c "post-return-count" (func $post-return-count))
+  (alias export $c "post-return-value" (func $post-return-value))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (global $heap (mut i32) (i32.const 4096))
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+      (local $ptr i32)
+      (local.set $ptr (i32.and (i32.add (global.get $heap) (i32.sub (local.get 2) (i32.const 1)))
+                               (i32.sub (i32.const 0) (local.get 2))))
+      (global.set $heap (i32.add (local.get $ptr) (local.get 3)))
+      (local.get $ptr)
+    )
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+  (core func $sum-lowered (canon lower (func $sum) (memory $memory) (realloc $realloc)))
+  (core func $strings-lowered (canon lower (func $strings) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $persons-lowered (canon lower (func $persons) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $sum-nested-lowered (canon lower (func $sum-nested) (memory $memory) (realloc $realloc)))
+  (core func $spill-params-lowered (canon lower (func $spill-params) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $describe-lowered (canon lower (func $describe) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $post-return-count-lowered (canon lower (func $post-return-count)))
+  (core func $post-return-value-lowered (canon lower (func $post-return-value)))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "callee" "sum" (func $sum (param i32 i32) (result i32)))
+    (import "callee" "strings" (func $strings (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "persons" (func $persons (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "sum-nested" (func $sum-nested (param i32 i32) (result i32)))
+    (import "callee" "spill-params" (func $spill-params (param i32) (result i32)))
+    (import "callee" "describe" (func $describe (param i32 i32 i32 i32)))
+    (import "callee" "post-return-count" (func $post-return-count (result i32)))
+    (import "callee" "post-return-value" (func $post-return-value (result i32)))
+    ;; list<u32>
+    (data (i32.const 16) "\01\00\00\00\02\00\00\00\03\00\00\00\04\00\00\00\05\00\00\00")
+    (data (i32.const 40) "\64\00\00\00\c8\00\00\00")
+    ;; Strings in UTF8
+    (data (i32.const 64) "ab")
+    (data (i32.const 72) "h\c3\a9llo")
+    (data (i32.const 80) "\f0\9f\98\80")
+    ;; list<string>
+    (data (i32.const 96) "\40\00\00\00\02\00\00\00\48\00\00\00\06\00\00\00\50\00\00\00\00\00\00\00\50\00\00\00\04\00\00\00")
+    ;; The strings of the list in UTF16
+    (data (i32.const 128) "a\00b\00h\00\e9\00l\00l\00o\00\3d\d8\00\de")
+    ;; list<person>
+    (data (i32.const 160) "\0a\00\00\00\40\00\00\00\02\00\00\00\14\00\00\00\48\00\00\00\06\00\00\00")
+    ;; The names of the persons in UTF16
+    (data (i32.const 192) "a\00b\00h\00\e9\00l\00l\00o\00")
+    ;; list<list<u32>>
+    (data (i32.const 224) "\10\00\00\00\05\00\00\00\10\00\00\00\00\00\00\00\28\00\00\00\02\00\00\00")
+    ;; Parameters spilled to memory: 1-16, "héllo" and its UTF16 bytes
+    (data (i32.const 256) "\01\00\00\00\02\00\00\00\03\00\00\00\04\00\00\00\05\00\00\00\06\00\00\00\07\00\00\00\08\00\00\00"
+                          "\09\00\00\00\0a\00\00\00\0b\00\00\00\0c\00\00\00\0d\00\00\00\0e\00\00\00\0f\00\00\00\10\00\00\00"
+                          "\48\00\00\00\06\00\00\00\84\00\00\00\0a\00\00\00")
+    (func $expect (param i32 i32)
+      (if (i32.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+    (func $expect64 (param i64 i64)
+      (if (i64.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+    (func $equal (param $ptr i32) (param $expected i32) (param $size i32) (result i32)
+      (block $done
+        (loop $next
+          (br_if $done (i32.eqz (local.get $size)))
+          (if (i32.ne (i32.load8_u (local.get $ptr)) (i32.load8_u (local.get $expected)))
+            (then (return (i32.const 0))))
+          (local.set $ptr (i32.add (local.get $ptr) (i32.const 1)))
+          (local.set $expected (i32.add (local.get $expected) (i32.const 1)))
+          (local.set $size (i32.sub (local.get $size) (i32.const 1)))
+          (br $next)
+        )
+      )
+      (i32.const 1)
+    )
+    (func (export "run")
+      ;; Lists without strings are copied at once.
+      (call $expect (call $sum (i32.const 16) (i32.const 5)) (i32.const 15))
+      (call $expect (call $sum (i32.const 16) (i32.const 0)) (i32.const 0))
+      (call $expect (call $sum-nested (i32.const 224) (i32.const 3)) (i32.const 315))
+
+      ;; The strings of the list elements are transcoded one by one.
+      (call $expect (call $strings (i32.const 96) (i32.const 4) (i32.const 128) (i32.const 18)) (i32.const 4))
+      (call $expect (call $persons (i32.const 160) (i32.const 2) (i32.const 192) (i32.const 14)) (i32.const 30))
+
+      ;; More than 16 flat parameters.
+      (call $expect (call $spill-params (i32.const 256)) (i32.const 136))
+
+      ;; More than one flat result: the record is written to 400.
+      (call $describe (i32.const 7) (i32.const 72) (i32.const 6) (i32.const 400))
+      (call $expect (i32.load (i32.const 400)) (i32.const 7))
+      (call $expect64 (i64.load (i32.const 408)) (i64.const 0x700000007))
+      (call $expect (i32.load (i32.const 420)) (i32.const 6))
+      (call $expect (call $equal (i32.load (i32.const 416)) (i32.const 72) (i32.const 6)) (i32.const 1))
+      ;; The string is allocated by the realloc of the caller.
+      (call $expect (i32.ge_u (i32.load (i32.const 416)) (i32.const 4096)) (i32.const 1))
+
+      ;; Post-return receives the result of the core function: the sum
+      ;; of the three calls of $sum, and the address of the record.
+      (call $expect (call $post-return-count) (i32.const 3))
+      (call $expect (call $post-return-value) (i32.const 512))
+      (call $expect (call $sum (i32.const 40) (i32.const 2)) (i32.const 300))
+      (call $expect (call $post-return-count) (i32.const 4))
+      (call $expect (call $post-return-value) (i32.const 300))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "callee" (instance
+      (export "sum" (func $sum-lowered))
+      (export "strings" (func $strings-lowered))
+      (export "persons" (func $persons-lowered))
+      (export "sum-nested" (func $sum-nested-lowered))
+      (export "spill-params" (func $spill-params-lowered))
+      (export "describe" (func $describe-lowered))
+      (export "post-return-count" (func $post-return-count-lowered))
+      (export "post-return-value" (func $post-return-value-lowered))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
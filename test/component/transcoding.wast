@@ -0,0 +1,287 @@
+;; Strings passed between components with every pair of string encodings.
+(component
+  (component $callee
+    (core module $m
+      (memory (export "memory") 1)
+      (global $heap (mut i32) (i32.const 1024))
+      (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+        (local $ptr i32)
+        ;; Bump allocator, aligned to the requested alignment.
+        (local.set $ptr (i32.and (i32.add (global.get $heap) (i32.sub (local.get 2) (i32.const 1)))
+                                 (i32.sub (i32.const 0) (local.get 2))))
+        (global.set $heap (i32.add (local.get $ptr) (local.get 3)))
+        (local.get $ptr)
+      )
+      ;; Returns with the length of the string if its bytes are equal to the
+      ;; expected bytes, and -1 otherwise.
+      (func $check (param $ptr i32) (param $size i32) (param $expected i32) (param $expected-size i32) (param $len i32) (result i32)
+        (if (i32.ne (local.get $size) (local.get $expected-size))
+          (then (return (i32.const -1))))
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $size)))
+            (if (i32.ne (i32.load8_u (local.get $ptr)) (i32.load8_u (local.get $expected)))
+              (then (return (i32.const -1))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 1)))
+            (local.set $expected (i32.add (local.get $expected) (i32.const 1)))
+            (local.set $size (i32.sub (local.get $size) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (local.get $len)
+      )
+      (func (export "check-utf8") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr) (local.get $len) (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+      (func (export "check-utf16") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr) (i32.shl (local.get $len) (i32.const 1)) (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+      ;; The highest bit of the length is set for UTF16 strings.
+      (func (export "check-compact") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr)
+                     (select (i32.shl (local.get $len) (i32.const 1)) (local.get $len) (i32.lt_s (local.get $len) (i32.const 0)))
+                     (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+    )
+    (core instance $i (instantiate $m))
+    (alias core export $i "memory" (core memory $mem))
+    (alias core export $i "realloc" (core func $realloc))
+    (alias core export $i "check-utf8" (core func $core-check-utf8))
+    (alias core export $i "check-utf16" (core func $core-check-utf16))
+    (alias core export $i "check-compact" (core func $core-check-compact))
+    (type $bytes (list u8))
+    (func $check-utf8 (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-utf8) (memory $mem) (realloc $realloc) string-encoding=utf8))
+    (func $check-utf16 (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-utf16) (memory $mem) (realloc $realloc) string-encoding=utf16))
+    (func $check-compact (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-compact) (memory $mem) (realloc $realloc) string-encoding=latin1+utf16))
+    (export "check-utf8" (func $check-utf8))
+    (export "check-utf16" (func $check-utf16))
+    (export "check-compact" (func $check-compact))
+  )
+  (instance $c (instantiate $callee))
+  (alias export $c "check-utf8" (func $check-utf8))
+  (alias export $c "check-utf16" (func $check-utf16))
+  (alias export $c "check-compact" (func $check-compact))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32) unreachable)
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+  (core func $compact-to-compact (canon lower (func $check-compact) (memory $memory) (realloc $realloc) string-encoding=latin1+utf16))
+  (core func $compact-to-utf16 (canon lower (func $check-utf16) (memory $memory) (realloc $realloc) string-encoding=latin1+utf16))
+  (core func $compact-to-utf8 (canon lower (func $check-utf8) (memory $memory) (realloc $realloc) string-encoding=latin1+utf16))
+  (core func $utf16-to-compact (canon lower (func $check-compact) (memory $memory) (realloc $realloc) string-encoding=utf16))
+  (core func $utf16-to-utf16 (canon lower (func $check-utf16) (memory $memory) (realloc $realloc) string-encoding=utf16))
+  (core func $utf16-to-utf8 (canon lower (func $check-utf8) (memory $memory) (realloc $realloc) string-encoding=utf16))
+  (core func $utf8-to-compact (canon lower (func $check-compact) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $utf8-to-utf16 (canon lower (func $check-utf16) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $utf8-to-utf8 (canon lower (func $check-utf8) (memory $memory) (realloc $realloc) string-encoding=utf8))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "callee" "compact-to-compact" (func $compact-to-compact (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "compact-to-utf16" (func $compact-to-utf16 (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "compact-to-utf8" (func $compact-to-utf8 (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf16-to-compact" (func $utf16-to-compact (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf16-to-utf16" (func $utf16-to-utf16 (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf16-to-utf8" (func $utf16-to-utf8 (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf8-to-compact" (func $utf8-to-compact (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf8-to-utf16" (func $utf8-to-utf16 (param i32 i32 i32 i32) (result i32)))
+    (import "callee" "utf8-to-utf8" (func $utf8-to-utf8 (param i32 i32 i32 i32) (result i32)))
+    (data (i32.const 16) "\68\65\6c\6c\6f")
+    (data (i32.const 24) "\68\65\6c\6c\6f")
+    (data (i32.const 32) "\68\65\6c\6c\6f")
+    (data (i32.const 40) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 56) "\68\65\6c\6c\6f")
+    (data (i32.const 64) "\68\65\6c\6c\6f")
+    (data (i32.const 72) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 88) "\68\65\6c\6c\6f")
+    (data (i32.const 96) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 112) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 128) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 144) "\68\65\6c\6c\6f")
+    (data (i32.const 152) "\68\65\6c\6c\6f")
+    (data (i32.const 160) "\68\65\6c\6c\6f")
+    (data (i32.const 168) "\68\65\6c\6c\6f")
+    (data (i32.const 176) "\68\00\65\00\6c\00\6c\00\6f\00")
+    (data (i32.const 192) "\68\65\6c\6c\6f")
+    (data (i32.const 200) "\68\65\6c\6c\6f")
+    (data (i32.const 208) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 216) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 224) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 232) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 248) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 256) "\68\e9\6c\6c\6f")
+    (data (i32.const 264) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 280) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 288) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 304) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 320) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 336) "\68\e9\6c\6c\6f")
+    (data (i32.const 344) "\68\e9\6c\6c\6f")
+    (data (i32.const 352) "\68\c3\a9\6c\6c\6f")
+    (data (i32.const 360) "\68\e9\6c\6c\6f")
+    (data (i32.const 368) "\68\00\e9\00\6c\00\6c\00\6f\00")
+    (data (i32.const 384) "\68\e9\6c\6c\6f")
+    (data (i32.const 392) "\68\e9\6c\6c\6f")
+    (data (i32.const 400) "\80\ff")
+    (data (i32.const 408) "\c2\80\c3\bf")
+    (data (i32.const 416) "\80\ff")
+    (data (i32.const 424) "\80\00\ff\00")
+    (data (i32.const 432) "\80\ff")
+    (data (i32.const 440) "\80\ff")
+    (data (i32.const 448) "\c3\a9")
+    (data (i32.const 456) "\e9\00")
+    (data (i32.const 464) "\c3\a9")
+    (data (i32.const 472) "\e9")
+    (data (i32.const 480) "\f0\9f\98\80")
+    (data (i32.const 488) "\f0\9f\98\80")
+    (data (i32.const 496) "\f0\9f\98\80")
+    (data (i32.const 504) "\3d\d8\00\de")
+    (data (i32.const 512) "\f0\9f\98\80")
+    (data (i32.const 520) "\3d\d8\00\de")
+    (data (i32.const 528) "\3d\d8\00\de")
+    (data (i32.const 536) "\f0\9f\98\80")
+    (data (i32.const 544) "\3d\d8\00\de")
+    (data (i32.const 552) "\3d\d8\00\de")
+    (data (i32.const 560) "\3d\d8\00\de")
+    (data (i32.const 568) "\3d\d8\00\de")
+    (data (i32.const 576) "\3d\d8\00\de")
+    (data (i32.const 584) "\f0\9f\98\80")
+    (data (i32.const 592) "\3d\d8\00\de")
+    (data (i32.const 600) "\3d\d8\00\de")
+    (data (i32.const 608) "\3d\d8\00\de")
+    (data (i32.const 616) "\3d\d8\00\de")
+    (data (i32.const 624) "\c4\80\df\bf")
+    (data (i32.const 632) "\00\01\ff\07")
+    (data (i32.const 640) "\00\01\ff\07")
+    (data (i32.const 648) "\00\01\ff\07")
+    (data (i32.const 656) "\00\01\ff\07")
+    (data (i32.const 664) "\c4\80\df\bf")
+    (data (i32.const 672) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 720) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 768) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 816) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 904) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 952) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1000) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 1088) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1136) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 1224) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 1312) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 1400) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1448) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1496) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1544) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1592) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00")
+    (data (i32.const 1680) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1728) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67")
+    (data (i32.const 1776) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 1832) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 1888) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 1944) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2048) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 2104) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2208) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2312) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 2368) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2472) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2576) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2680) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2784) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 2888) "\54\68\65\20\71\75\69\63\6b\20\62\72\6f\77\6e\20\66\6f\78\20\6a\75\6d\70\73\20\6f\76\65\72\20\74\68\65\20\6c\61\7a\79\20\64\6f\67\3a\20\c3\a9\e2\82\ac\f0\9f\98\80\21")
+    (data (i32.const 2944) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 3048) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 3152) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (data (i32.const 3256) "\54\00\68\00\65\00\20\00\71\00\75\00\69\00\63\00\6b\00\20\00\62\00\72\00\6f\00\77\00\6e\00\20\00\66\00\6f\00\78\00\20\00\6a\00\75\00\6d\00\70\00\73\00\20\00\6f\00\76\00\65\00\72\00\20\00\74\00\68\00\65\00\20\00\6c\00\61\00\7a\00\79\00\20\00\64\00\6f\00\67\00\3a\00\20\00\e9\00\ac\20\3d\d8\00\de\21\00")
+    (func $expect (param i32 i32)
+      (if (i32.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+    (func (export "run")
+      ;; ASCII
+      (call $expect (call $utf8-to-utf8 (i32.const 16) (i32.const 5) (i32.const 24) (i32.const 5)) (i32.const 5))
+      (call $expect (call $utf8-to-utf16 (i32.const 32) (i32.const 5) (i32.const 40) (i32.const 10)) (i32.const 5))
+      (call $expect (call $utf8-to-compact (i32.const 56) (i32.const 5) (i32.const 64) (i32.const 5)) (i32.const 5))
+      (call $expect (call $utf16-to-utf8 (i32.const 72) (i32.const 5) (i32.const 88) (i32.const 5)) (i32.const 5))
+      (call $expect (call $utf16-to-utf16 (i32.const 96) (i32.const 5) (i32.const 112) (i32.const 10)) (i32.const 5))
+      (call $expect (call $utf16-to-compact (i32.const 128) (i32.const 5) (i32.const 144) (i32.const 5)) (i32.const 5))
+      (call $expect (call $compact-to-utf8 (i32.const 152) (i32.const 5) (i32.const 160) (i32.const 5)) (i32.const 5))
+      (call $expect (call $compact-to-utf16 (i32.const 168) (i32.const 5) (i32.const 176) (i32.const 10)) (i32.const 5))
+      (call $expect (call $compact-to-compact (i32.const 192) (i32.const 5) (i32.const 200) (i32.const 5)) (i32.const 5))
+      ;; Latin1
+      (call $expect (call $utf8-to-utf8 (i32.const 208) (i32.const 6) (i32.const 216) (i32.const 6)) (i32.const 6))
+      (call $expect (call $utf8-to-utf16 (i32.const 224) (i32.const 6) (i32.const 232) (i32.const 10)) (i32.const 5))
+      (call $expect (call $utf8-to-compact (i32.const 248) (i32.const 6) (i32.const 256) (i32.const 5)) (i32.const 5))
+      (call $expect (call $utf16-to-utf8 (i32.const 264) (i32.const 5) (i32.const 280) (i32.const 6)) (i32.const 6))
+      (call $expect (call $utf16-to-utf16 (i32.const 288) (i32.const 5) (i32.const 304) (i32.const 10)) (i32.const 5))
+      (call $expect (call $utf16-to-compact (i32.const 320) (i32.const 5) (i32.const 336) (i32.const 5)) (i32.const 5))
+      (call $expect (call $compact-to-utf8 (i32.const 344) (i32.const 5) (i32.const 352) (i32.const 6)) (i32.const 6))
+      (call $expect (call $compact-to-utf16 (i32.const 360) (i32.const 5) (i32.const 368) (i32.const 10)) (i32.const 5))
+      (call $expect (call $compact-to-compact (i32.const 384) (i32.const 5) (i32.const 392) (i32.const 5)) (i32.const 5))
+      ;; Latin1 0x80 is not ASCII
+      (call $expect (call $compact-to-utf8 (i32.const 400) (i32.const 2) (i32.const 408) (i32.const 4)) (i32.const 4))
+      (call $expect (call $compact-to-utf16 (i32.const 416) (i32.const 2) (i32.const 424) (i32.const 4)) (i32.const 2))
+      (call $expect (call $compact-to-compact (i32.const 432) (i32.const 2) (i32.const 440) (i32.const 2)) (i32.const 2))
+      ;; Two byte UTF8 sequence
+      (call $expect (call $utf8-to-utf16 (i32.const 448) (i32.const 2) (i32.const 456) (i32.const 2)) (i32.const 1))
+      (call $expect (call $utf8-to-compact (i32.const 464) (i32.const 2) (i32.const 472) (i32.const 1)) (i32.const 1))
+      ;; Four byte UTF8 sequence starting with 0xf0, and a surrogate pair
+      (call $expect (call $utf8-to-utf8 (i32.const 480) (i32.const 4) (i32.const 488) (i32.const 4)) (i32.const 4))
+      (call $expect (call $utf8-to-utf16 (i32.const 496) (i32.const 4) (i32.const 504) (i32.const 4)) (i32.const 2))
+      (call $expect (call $utf8-to-compact (i32.const 512) (i32.const 4) (i32.const 520) (i32.const 4)) (i32.const -2147483646))
+      (call $expect (call $utf16-to-utf8 (i32.const 528) (i32.const 2) (i32.const 536) (i32.const 4)) (i32.const 4))
+      (call $expect (call $utf16-to-utf16 (i32.const 544) (i32.const 2) (i32.const 552) (i32.const 4)) (i32.const 2))
+      (call $expect (call $utf16-to-compact (i32.const 560) (i32.const 2) (i32.const 568) (i32.const 4)) (i32.const -2147483646))
+      (call $expect (call $compact-to-utf8 (i32.const 576) (i32.const 2147483650) (i32.const 584) (i32.const 4)) (i32.const 4))
+      (call $expect (call $compact-to-utf16 (i32.const 592) (i32.const 2147483650) (i32.const 600) (i32.const 4)) (i32.const 2))
+      (call $expect (call $compact-to-compact (i32.const 608) (i32.const 2147483650) (i32.const 616) (i32.const 4)) (i32.const -2147483646))
+      ;; UTF16 characters 0x100-0x7ff are not Latin1
+      (call $expect (call $utf8-to-compact (i32.const 624) (i32.const 4) (i32.const 632) (i32.const 4)) (i32.const -2147483646))
+      (call $expect (call $utf16-to-compact (i32.const 640) (i32.const 2) (i32.const 648) (i32.const 4)) (i32.const -2147483646))
+      (call $expect (call $utf16-to-utf8 (i32.const 656) (i32.const 2) (i32.const 664) (i32.const 4)) (i32.const 4))
+      ;; Long ASCII string
+      (call $expect (call $utf8-to-utf8 (i32.const 672) (i32.const 43) (i32.const 720) (i32.const 43)) (i32.const 43))
+      (call $expect (call $utf8-to-utf16 (i32.const 768) (i32.const 43) (i32.const 816) (i32.const 86)) (i32.const 43))
+      (call $expect (call $utf8-to-compact (i32.const 904) (i32.const 43) (i32.const 952) (i32.const 43)) (i32.const 43))
+      (call $expect (call $utf16-to-utf8 (i32.const 1000) (i32.const 43) (i32.const 1088) (i32.const 43)) (i32.const 43))
+      (call $expect (call $utf16-to-utf16 (i32.const 1136) (i32.const 43) (i32.const 1224) (i32.const 86)) (i32.const 43))
+      (call $expect (call $utf16-to-compact (i32.const 1312) (i32.const 43) (i32.const 1400) (i32.const 43)) (i32.const 43))
+      (call $expect (call $compact-to-utf8 (i32.const 1448) (i32.const 43) (i32.const 1496) (i32.const 43)) (i32.const 43))
+      (call $expect (call $compact-to-utf16 (i32.const 1544) (i32.const 43) (i32.const 1592) (i32.const 86)) (i32.const 43))
+      (call $expect (call $compact-to-compact (i32.const 1680) (i32.const 43) (i32.const 1728) (i32.const 43)) (i32.const 43))
+      ;; Long mixed string
+      (call $expect (call $utf8-to-utf8 (i32.const 1776) (i32.const 55) (i32.const 1832) (i32.const 55)) (i32.const 55))
+      (call $expect (call $utf8-to-utf16 (i32.const 1888) (i32.const 55) (i32.const 1944) (i32.const 100)) (i32.const 50))
+      (call $expect (call $utf8-to-compact (i32.const 2048) (i32.const 55) (i32.const 2104) (i32.const 100)) (i32.const -2147483598))
+      (call $expect (call $utf16-to-utf8 (i32.const 2208) (i32.const 50) (i32.const 2312) (i32.const 55)) (i32.const 55))
+      (call $expect (call $utf16-to-utf16 (i32.const 2368) (i32.const 50) (i32.const 2472) (i32.const 100)) (i32.const 50))
+      (call $expect (call $utf16-to-compact (i32.const 2576) (i32.const 50) (i32.const 2680) (i32.const 100)) (i32.const -2147483598))
+      (call $expect (call $compact-to-utf8 (i32.const 2784) (i32.const 2147483698) (i32.const 2888) (i32.const 55)) (i32.const 55))
+      (call $expect (call $compact-to-utf16 (i32.const 2944) (i32.const 2147483698) (i32.const 3048) (i32.const 100)) (i32.const 50))
+      (call $expect (call $compact-to-compact (i32.const 3152) (i32.const 2147483698) (i32.const 3256) (i32.const 100)) (i32.const -2147483598))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "callee" (instance
+      (export "compact-to-compact" (func $compact-to-compact))
+      (export "compact-to-utf16" (func $compact-to-utf16))
+      (export "compact-to-utf8" (func $compact-to-utf8))
+      (export "utf16-to-compact" (func $utf16-to-compact))
+      (export "utf16-to-utf16" (func $utf16-to-utf16))
+      (export "utf16-to-utf8" (func $utf16-to-utf8))
+      (export "utf8-to-compact" (func $utf8-to-compact))
+      (export "utf8-to-utf16" (func $utf8-to-utf16))
+      (export "utf8-to-utf8" (func $utf8-to-utf8))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
@@ -0,0 +1,99 @@
+;; A lone high surrogate at the end of a UTF16 string is rejected.
+(component
+  (component $callee
+    (core module $m
+      (memory (export "memory") 1)
+      (global $heap (mut i32) (i32.const 1024))
+      (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+        (local $ptr i32)
+        ;; Bump allocator, aligned to the requested alignment.
+        (local.set $ptr (i32.and (i32.add (global.get $heap) (i32.sub (local.get 2) (i32.const 1)))
+                                 (i32.sub (i32.const 0) (local.get 2))))
+        (global.set $heap (i32.add (local.get $ptr) (local.get 3)))
+        (local.get $ptr)
+      )
+      ;; Returns with the length of the string if its bytes are equal to the
+      ;; expected bytes, and -1 otherwise.
+      (func $check (param $ptr i32) (param $size i32) (param $expected i32) (param $expected-size i32) (param $len i32) (result i32)
+        (if (i32.ne (local.get $size) (local.get $expected-size))
+          (then (return (i32.const -1))))
+        (block $done
+          (loop $next
+            (br_if $done (i32.eqz (local.get $size)))
+            (if (i32.ne (i32.load8_u (local.get $ptr)) (i32.load8_u (local.get $expected)))
+              (then (return (i32.const -1))))
+            (local.set $ptr (i32.add (local.get $ptr) (i32.const 1)))
+            (local.set $expected (i32.add (local.get $expected) (i32.const 1)))
+            (local.set $size (i32.sub (local.get $size) (i32.const 1)))
+            (br $next)
+          )
+        )
+        (local.get $len)
+      )
+      (func (export "check-utf8") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr) (local.get $len) (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+      (func (export "check-utf16") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr) (i32.shl (local.get $len) (i32.const 1)) (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+      ;; The highest bit of the length is set for UTF16 strings.
+      (func (export "check-compact") (param $ptr i32) (param $len i32) (param $expected i32) (param $expected-size i32) (result i32)
+        (call $check (local.get $ptr)
+                     (select (i32.shl (local.get $len) (i32.const 1)) (local.get $len) (i32.lt_s (local.get $len) (i32.const 0)))
+                     (local.get $expected) (local.get $expected-size) (local.get $len))
+      )
+    )
+    (core instance $i (instantiate $m))
+    (alias core export $i "memory" (core memory $mem))
+    (alias core export $i "realloc" (core func $realloc))
+    (alias core export $i "check-utf8" (core func $core-check-utf8))
+    (alias core export $i "check-utf16" (core func $core-check-utf16))
+    (alias core export $i "check-compact" (core func $core-check-compact))
+    (type $bytes (list u8))
+    (func $check-utf8 (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-utf8) (memory $mem) (realloc $realloc) string-encoding=utf8))
+    (func $check-utf16 (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-utf16) (memory $mem) (realloc $realloc) string-encoding=utf16))
+    (func $check-compact (param "s" string) (param "expected" $bytes) (result u32)
+      (canon lift (core func $core-check-compact) (memory $mem) (realloc $realloc) string-encoding=latin1+utf16))
+    (export "check-utf8" (func $check-utf8))
+    (export "check-utf16" (func $check-utf16))
+    (export "check-compact" (func $check-compact))
+  )
+  (instance $c (instantiate $callee))
+  (alias export $c "check-utf8" (func $check-utf8))
+  (alias export $c "check-utf16" (func $check-utf16))
+  (alias export $c "check-compact" (func $check-compact))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32) unreachable)
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+  (core func $utf16-to-utf8 (canon lower (func $check-utf8) (memory $memory) (realloc $realloc) string-encoding=utf16))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "callee" "utf16-to-utf8" (func $utf16-to-utf8 (param i32 i32 i32 i32) (result i32)))
+    (data (i32.const 16) "\61\00\3d\d8")
+    (data (i32.const 24) "")
+    (func $expect (param i32 i32)
+      (if (i32.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+    (func (export "run")
+      (call $expect (call $utf16-to-utf8 (i32.const 16) (i32.const 2) (i32.const 24) (i32.const 0)) (i32.const 0))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "callee" (instance
+      (export "utf16-to-utf8" (func $utf16-to-utf8))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
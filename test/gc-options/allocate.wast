@@ -0,0 +1,27 @@
+;; Allocates garbage collected objects, tools/run-tests.py runs it
+;; with the --gc-* options and checks the --gc-stats output.
+(module
+  (type $pair (struct (field (mut i64)) (field (mut anyref))))
+
+  (func (export "allocate") (param $count i32) (result i64)
+    (local $list (ref null $pair))
+    (local $sum i64)
+
+    loop $loop
+      (local.set $list (struct.new $pair (i64.extend_i32_u (local.get $count)) (local.get $list)))
+      (local.tee $count (i32.sub (local.get $count) (i32.const 1)))
+      br_if $loop
+    end
+
+    ;; Sum the values of the last 1000 objects.
+    loop $loop
+      (local.set $sum (i64.add (local.get $sum) (struct.get $pair 0 (local.get $list))))
+      (local.set $list (ref.cast (ref null $pair) (struct.get $pair 1 (local.get $list))))
+      (local.set $count (i32.add (local.get $count) (i32.const 1)))
+      (br_if $loop (i32.lt_u (local.get $count) (i32.const 1000)))
+    end
+    local.get $sum
+  )
+)
+
+(assert_return (invoke "allocate" (i32.const 100000)) (i64.const 500500))
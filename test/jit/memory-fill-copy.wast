@@ -0,0 +1,167 @@
+(module
+  (memory 1)
+
+  (func (export "fill3") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.const 3
+    memory.fill
+  )
+
+  (func (export "fill13") (param i32)
+    local.get 0
+    i32.const 0x1ab
+    i32.const 13
+    memory.fill
+  )
+
+  (func (export "fill40") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.const 40
+    memory.fill
+  )
+
+  (func (export "copy7") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.const 7
+    memory.copy
+  )
+
+  (func (export "copy16") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.const 16
+    memory.copy
+  )
+
+  (func (export "copy27") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.const 27
+    memory.copy
+  )
+
+  ;; The sizes below are entry constants, and
+  ;; memory.fill / memory.copy does not follow them.
+  (func (export "fill5Loop") (param i32 i32 i32)
+    (loop $l
+      local.get 0
+      local.get 1
+      i32.const 5
+      memory.fill
+      local.get 0
+      i32.const 8
+      i32.add
+      local.set 0
+      local.get 2
+      i32.const 1
+      i32.sub
+      local.tee 2
+      br_if $l
+    )
+  )
+
+  (func (export "copy12Offset") (param i32 i32)
+    local.get 0
+    i32.const 4
+    i32.add
+    local.get 1
+    i32.const 12
+    memory.copy
+  )
+
+  (func (export "load8") (param i32) (result i32)
+    local.get 0
+    i32.load8_u
+  )
+
+  (func (export "init") (param i32 i32)
+    (loop $l
+      local.get 0
+      local.get 0
+      i32.store8
+      local.get 0
+      i32.const 1
+      i32.add
+      local.set 0
+      local.get 1
+      i32.const 1
+      i32.sub
+      local.tee 1
+      br_if $l
+    )
+  )
+)
+
+(invoke "fill3" (i32.const 10) (i32.const 0x1ff))
+(assert_return (invoke "load8" (i32.const 9)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 10)) (i32.const 0xff))
+(assert_return (invoke "load8" (i32.const 12)) (i32.const 0xff))
+(assert_return (invoke "load8" (i32.const 13)) (i32.const 0))
+
+(invoke "fill13" (i32.const 100))
+(assert_return (invoke "load8" (i32.const 99)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 100)) (i32.const 0xab))
+(assert_return (invoke "load8" (i32.const 112)) (i32.const 0xab))
+(assert_return (invoke "load8" (i32.const 113)) (i32.const 0))
+
+(invoke "fill40" (i32.const 201) (i32.const 0x5c))
+(assert_return (invoke "load8" (i32.const 200)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 201)) (i32.const 0x5c))
+(assert_return (invoke "load8" (i32.const 240)) (i32.const 0x5c))
+(assert_return (invoke "load8" (i32.const 241)) (i32.const 0))
+
+(assert_trap (invoke "fill40" (i32.const 65497) (i32.const 1)) "out of bounds memory access")
+(assert_return (invoke "load8" (i32.const 65535)) (i32.const 0))
+(invoke "fill40" (i32.const 65496) (i32.const 1))
+(assert_return (invoke "load8" (i32.const 65535)) (i32.const 1))
+
+(invoke "init" (i32.const 1000) (i32.const 64))
+(invoke "copy7" (i32.const 2000) (i32.const 1000))
+(assert_return (invoke "load8" (i32.const 2000)) (i32.const 0xe8))
+(assert_return (invoke "load8" (i32.const 2006)) (i32.const 0xee))
+(assert_return (invoke "load8" (i32.const 2007)) (i32.const 0))
+(invoke "copy27" (i32.const 3000) (i32.const 1001))
+(assert_return (invoke "load8" (i32.const 3000)) (i32.const 0xe9))
+(assert_return (invoke "load8" (i32.const 3017)) (i32.const 0xfa))
+(assert_return (invoke "load8" (i32.const 3026)) (i32.const 0x03))
+(assert_return (invoke "load8" (i32.const 3027)) (i32.const 0))
+
+;; overlapping ranges
+(invoke "copy27" (i32.const 1005) (i32.const 1000))
+(assert_return (invoke "load8" (i32.const 1004)) (i32.const 0xec))
+(assert_return (invoke "load8" (i32.const 1005)) (i32.const 0xe8))
+(assert_return (invoke "load8" (i32.const 1025)) (i32.const 0xfc))
+(assert_return (invoke "load8" (i32.const 1031)) (i32.const 0x02))
+(assert_return (invoke "load8" (i32.const 1032)) (i32.const 0x08))
+(invoke "init" (i32.const 1000) (i32.const 32))
+(invoke "copy16" (i32.const 1000) (i32.const 1003))
+(assert_return (invoke "load8" (i32.const 1000)) (i32.const 0xeb))
+(assert_return (invoke "load8" (i32.const 1015)) (i32.const 0xfa))
+(assert_return (invoke "load8" (i32.const 1016)) (i32.const 0xf8))
+
+(invoke "fill5Loop" (i32.const 4000) (i32.const 0x77) (i32.const 3))
+(assert_return (invoke "load8" (i32.const 4000)) (i32.const 0x77))
+(assert_return (invoke "load8" (i32.const 4004)) (i32.const 0x77))
+(assert_return (invoke "load8" (i32.const 4005)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 4016)) (i32.const 0x77))
+(assert_return (invoke "load8" (i32.const 4020)) (i32.const 0x77))
+(assert_return (invoke "load8" (i32.const 4021)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 4024)) (i32.const 0))
+(assert_trap (invoke "fill5Loop" (i32.const 65520) (i32.const 1) (i32.const 3)) "out of bounds memory access")
+(assert_return (invoke "load8" (i32.const 65528)) (i32.const 1))
+(assert_return (invoke "load8" (i32.const 65532)) (i32.const 1))
+
+(invoke "init" (i32.const 5000) (i32.const 16))
+(invoke "copy12Offset" (i32.const 6000) (i32.const 5000))
+(assert_return (invoke "load8" (i32.const 6003)) (i32.const 0))
+(assert_return (invoke "load8" (i32.const 6004)) (i32.const 0x88))
+(assert_return (invoke "load8" (i32.const 6015)) (i32.const 0x93))
+(assert_return (invoke "load8" (i32.const 6016)) (i32.const 0))
+(assert_trap (invoke "copy12Offset" (i32.const 65524) (i32.const 0)) "out of bounds memory access")
+
+(assert_trap (invoke "copy16" (i32.const 65521) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "copy16" (i32.const 0) (i32.const 65521)) "out of bounds memory access")
+(assert_trap (invoke "copy7" (i32.const -1) (i32.const 0)) "out of bounds memory access")
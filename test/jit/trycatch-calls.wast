@@ -0,0 +1,107 @@
+(module
+  (tag $e (param i32))
+  (table 2 funcref)
+  (elem (i32.const 0) $thrower $trapper)
+
+  (func $thrower (param i32)
+    local.get 0
+    i32.const 0
+    i32.ne
+    (if (then
+      local.get 0
+      throw $e
+    ))
+  )
+
+  (func $trapper (param i32)
+    i32.const 1
+    local.get 0
+    i32.div_u
+    drop
+  )
+
+  ;; the exception passes through several frames
+  (func $depth (param i32 i32)
+    local.get 0
+    i32.eqz
+    (if (then
+      local.get 1
+      call $thrower
+      return
+    ))
+    local.get 0
+    i32.const 1
+    i32.sub
+    local.get 1
+    call $depth
+  )
+
+  (func (export "deep") (param i32 i32) (result i32)
+    (try (result i32)
+      (do
+        local.get 0
+        local.get 1
+        call $depth
+        i32.const -1
+      )
+      (catch $e)
+    )
+  )
+
+  (func (export "indirect") (param i32 i32) (result i32)
+    (try (result i32)
+      (do
+        local.get 1
+        local.get 0
+        call_indirect (param i32)
+        i32.const -1
+      )
+      (catch $e)
+      (catch_all
+        i32.const -2
+      )
+    )
+  )
+
+  ;; exceptions caught in the callee are not seen by the caller
+  (func $catcher (param i32) (result i32)
+    (try (result i32)
+      (do
+        local.get 0
+        call $thrower
+        i32.const 0
+      )
+      (catch $e
+        i32.const 100
+        i32.add
+      )
+    )
+  )
+
+  (func (export "nested") (param i32) (result i32)
+    (try (result i32)
+      (do
+        local.get 0
+        call $catcher
+        local.get 0
+        call $thrower
+      )
+      (catch $e
+        i32.const 1000
+        i32.add
+      )
+    )
+  )
+)
+
+(assert_return (invoke "deep" (i32.const 10) (i32.const 5)) (i32.const 5))
+(assert_return (invoke "deep" (i32.const 10) (i32.const 0)) (i32.const -1))
+(assert_return (invoke "deep" (i32.const 0) (i32.const 7)) (i32.const 7))
+(assert_return (invoke "indirect" (i32.const 0) (i32.const 3)) (i32.const 3))
+(assert_return (invoke "indirect" (i32.const 0) (i32.const 0)) (i32.const -1))
+(assert_return (invoke "indirect" (i32.const 1) (i32.const 1)) (i32.const -1))
+(assert_trap (invoke "indirect" (i32.const 1) (i32.const 0)) "integer divide by zero")
+(assert_trap (invoke "indirect" (i32.const 2) (i32.const 0)) "undefined element")
+(assert_return (invoke "nested" (i32.const 0)) (i32.const 0))
+(assert_return (invoke "nested" (i32.const 4)) (i32.const 1004))
+(assert_exhaustion (invoke "deep" (i32.const 1000000) (i32.const 1)) "call stack exhausted")
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Micro-benchmark of the canonical ABI string kernels, built with -DWALRUS_UNICODE_BENCHMARK=ON.
+   Every kernel is checked against the scalar kernel before it is measured.
+   Usage: walrus-unicode-benchmark [string length in characters] [iterations] */
+
+#include "Walrus.h"
+
+#include "util/Unicode.h"
+
+#include <chrono>
+
+using namespace Walrus;
+
+struct Input {
+    const char* name;
+    std::vector<uint8_t> latin1;
+    std::vector<uint8_t> utf8;
+    std::vector<uint16_t> utf16;
+    bool isLatin1;
+};
+
+static void appendCodePoint(Input& input, uint32_t chr)
+{
+    if (chr < 0x80) {
+        input.utf8.push_back(static_cast<uint8_t>(chr));
+    } else if (chr < 0x800) {
+        input.utf8.push_back(static_cast<uint8_t>(0xc0 | (chr >> 6)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | (chr & 0x3f)));
+    } else if (chr < 0x10000) {
+        input.utf8.push_back(static_cast<uint8_t>(0xe0 | (chr >> 12)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | ((chr >> 6) & 0x3f)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | (chr & 0x3f)));
+    } else {
+        input.utf8.push_back(static_cast<uint8_t>(0xf0 | (chr >> 18)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | ((chr >> 12) & 0x3f)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | ((chr >> 6) & 0x3f)));
+        input.utf8.push_back(static_cast<uint8_t>(0x80 | (chr & 0x3f)));
+    }
+
+    if (chr < 0x10000) {
+        input.utf16.push_back(static_cast<uint16_t>(chr));
+    } else {
+        input.utf16.push_back(static_cast<uint16_t>(0xd800 | ((chr - 0x10000) >> 10)));
+        input.utf16.push_back(static_cast<uint16_t>(0xdc00 | ((chr - 0x10000) & 0x3ff)));
+    }
+
+    if (chr < 0x100) {
+        input.latin1.push_back(static_cast<uint8_t>(chr));
+    } else {
+        input.isLatin1 = false;
+    }
+}
+
+// Characters are ASCII, except every nonAsciiPeriod-th one, which is below maxChar.
+static Input createInput(const char* name, size_t length, uint32_t nonAsciiPeriod, uint32_t maxChar)
+{
+    std::mt19937 random(static_cast<uint32_t>(length));
+    Input input;
+
+    input.name = name;
+    input.isLatin1 = true;
+
+    for (size_t i = 0; i < length; i++) {
+        uint32_t chr = 0x20 + random() % 0x5f;
+
+        if (nonAsciiPeriod != 0 && random() % nonAsciiPeriod == 0) {
+            chr = 0x80 + random() % (maxChar - 0x80);
+            if (chr >= 0xd800 && chr <= 0xdfff) {
+                chr += 0x800;
+            }
+        }
+        appendCodePoint(input, chr);
+    }
+    return input;
+}
+
+static bool sameCounts(const UnicodeCounts& left, const UnicodeCounts& right)
+{
+    return left.charL1 == right.charL1 && left.char2 == right.char2 && left.char3 == right.char3 && left.char4 == right.char4;
+}
+
+static bool verify(const Unicode::Kernels& kernels, const Unicode::Kernels& scalar, const Input& input)
+{
+    UnicodeCounts counts;
+    UnicodeCounts expected;
+    bool result = kernels.validateUtf8(input.utf8.data(), input.utf8.size(), &counts);
+
+    if (!result || !scalar.validateUtf8(input.utf8.data(), input.utf8.size(), &expected) || !sameCounts(counts, expected)) {
+        return false;
+    }
+
+    result = kernels.validateUtf16(input.utf16.data(), input.utf16.size(), &counts);
+    if (!result || !scalar.validateUtf16(input.utf16.data(), input.utf16.size(), &expected) || !sameCounts(counts, expected)) {
+        return false;
+    }
+
+    // Every truncated or corrupted UTF8 tail must be rejected by both.
+    for (size_t i = 1; i <= 3 && i <= input.utf8.size(); i++) {
+        std::vector<uint8_t> broken(input.utf8.begin(), input.utf8.end() - i);
+        broken.push_back(0xf0);
+        if (kernels.validateUtf8(broken.data(), broken.size(), &counts) != scalar.validateUtf8(broken.data(), broken.size(), &expected)) {
+            return false;
+        }
+    }
+
+    std::vector<uint8_t> utf8(input.utf16.size() * 3);
+    std::vector<uint16_t> utf16(input.utf8.size());
+    std::vector<uint8_t> latin1(input.utf16.size());
+
+    if (static_cast<size_t>(kernels.utf16ToUtf8(input.utf16.data(), input.utf16.size(), utf8.data()) - utf8.data()) != input.utf8.size()
+        || memcmp(utf8.data(), input.utf8.data(), input.utf8.size()) != 0) {
+        return false;
+    }
+
+    if (static_cast<size_t>(kernels.utf8ToUtf16(input.utf8.data(), input.utf8.size(), utf16.data()) - utf16.data()) != input.utf16.size()
+        || memcmp(utf16.data(), input.utf16.data(), input.utf16.size() * sizeof(uint16_t)) != 0) {
+        return false;
+    }
+
+    if (!input.isLatin1) {
+        return true;
+    }
+
+    if (kernels.countLatin1NonAscii(input.latin1.data(), input.latin1.size()) != input.utf8.size() - input.latin1.size()) {
+        return false;
+    }
+
+    if (static_cast<size_t>(kernels.latin1ToUtf8(input.latin1.data(), input.latin1.size(), utf8.data()) - utf8.data()) != input.utf8.size()
+        || memcmp(utf8.data(), input.utf8.data(), input.utf8.size()) != 0) {
+        return false;
+    }
+
+    if (static_cast<size_t>(kernels.latin1ToUtf16(input.latin1.data(), input.latin1.size(), utf16.data()) - utf16.data()) != input.utf16.size()
+        || memcmp(utf16.data(), input.utf16.data(), input.utf16.size() * sizeof(uint16_t)) != 0) {
+        return false;
+    }
+
+    if (static_cast<size_t>(kernels.utf8ToLatin1(input.utf8.data(), input.utf8.size(), latin1.data()) - latin1.data()) != input.latin1.size()
+        || memcmp(latin1.data(), input.latin1.data(), input.latin1.size()) != 0) {
+        return false;
+    }
+
+    if (static_cast<size_t>(kernels.utf16ToLatin1(input.utf16.data(), input.utf16.size(), latin1.data()) - latin1.data()) != input.latin1.size()
+        || memcmp(latin1.data(), input.latin1.data(), input.latin1.size()) != 0) {
+        return false;
+    }
+    return true;
+}
+
+template <typename Operation>
+static double measure(size_t iterations, size_t bytes, Operation operation)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; i++) {
+        operation();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // Result is in GB/s of input.
+    return static_cast<double>(bytes) * static_cast<double>(iterations) / elapsed.count() / 1e9;
+}
+
+static void benchmark(const Unicode::Kernels& kernels, const Input& input, size_t iterations)
+{
+    std::vector<uint8_t> utf8(input.utf16.size() * 3);
+    std::vector<uint16_t> utf16(input.utf8.size());
+    std::vector<uint8_t> latin1(input.utf16.size());
+    UnicodeCounts counts;
+
+    printf("  %-8s validate-utf8 %6.2f", kernels.name,
+           measure(iterations, input.utf8.size(), [&] { kernels.validateUtf8(input.utf8.data(), input.utf8.size(), &counts); }));
+    printf("  validate-utf16 %6.2f",
+           measure(iterations, input.utf16.size() * 2, [&] { kernels.validateUtf16(input.utf16.data(), input.utf16.size(), &counts); }));
+    printf("  utf8-utf16 %6.2f",
+           measure(iterations, input.utf8.size(), [&] { kernels.utf8ToUtf16(input.utf8.data(), input.utf8.size(), utf16.data()); }));
+    printf("  utf16-utf8 %6.2f",
+           measure(iterations, input.utf16.size() * 2, [&] { kernels.utf16ToUtf8(input.utf16.data(), input.utf16.size(), utf8.data()); }));
+
+    if (input.isLatin1) {
+        printf("  latin1-utf8 %6.2f",
+               measure(iterations, input.latin1.size(), [&] { kernels.latin1ToUtf8(input.latin1.data(), input.latin1.size(), utf8.data()); }));
+        printf("  latin1-utf16 %6.2f",
+               measure(iterations, input.latin1.size(), [&] { kernels.latin1ToUtf16(input.latin1.data(), input.latin1.size(), utf16.data()); }));
+        printf("  utf8-latin1 %6.2f",
+               measure(iterations, input.utf8.size(), [&] { kernels.utf8ToLatin1(input.utf8.data(), input.utf8.size(), latin1.data()); }));
+        printf("  utf16-latin1 %6.2f",
+               measure(iterations, input.utf16.size() * 2, [&] { kernels.utf16ToLatin1(input.utf16.data(), input.utf16.size(), latin1.data()); }));
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t length = argc > 1 ? strtoul(argv[1], nullptr, 10) : 64 * 1024;
+    size_t iterations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000;
+    const Unicode::Kernels& scalar = *Unicode::kernels(Unicode::Scalar);
+
+    Input inputs[] = {
+        createInput("ascii", length, 0, 0),
+        createInput("latin1", length, 16, 0x100),
+        createInput("mixed", length, 8, 0x800),
+        createInput("bmp", length, 2, 0x10000),
+        createInput("supplementary", length, 4, 0x110000),
+    };
+
+    printf("selected kernels: %s, string length: %zu, throughput in GB/s of input\n", Unicode::kernels().name, length);
+
+    bool success = true;
+    for (const Input& input : inputs) {
+        printf("%s\n", input.name);
+
+        for (int isa = Unicode::Scalar; isa < Unicode::IsaCount; isa++) {
+            const Unicode::Kernels* kernels = Unicode::kernels(static_cast<Unicode::Isa>(isa));
+
+            if (kernels == nullptr) {
+                continue;
+            }
+
+            // Short lengths exercise the scalar tails of the vector loops.
+            for (size_t i = 0; i < 80 && i < length; i++) {
+                Input prefix = createInput(input.name, i, 3, 0x110000);
+                if (!verify(*kernels, scalar, prefix)) {
+                    printf("  %s: mismatch at length %zu\n", kernels->name, i);
+                    success = false;
+                }
+            }
+
+            if (!verify(*kernels, scalar, input)) {
+                printf("  %s: mismatch\n", kernels->name);
+                success = false;
+                continue;
+            }
+            benchmark(*kernels, input, iterations);
+        }
+    }
+    return success ? 0 : 1;
+}
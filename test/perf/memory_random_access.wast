@@ -0,0 +1,51 @@
+;; Random read-modify-write accesses over a 512MB linear memory,
+;; which misses the TLB on almost every access with 4K pages.
+;; Compare the dTLB misses with and without huge pages:
+;;   perf stat -e dTLB-load-misses,dTLB-store-misses ./walrus test/perf/memory_random_access.wast
+;;   perf stat -e dTLB-load-misses,dTLB-store-misses ./walrus --memory-huge-pages test/perf/memory_random_access.wast
+;; Adding --memory-prefault moves the page faults out of the measured loop.
+(module
+  (global $iterations i32 (i32.const 20000000))
+
+  (func $start
+    (local $i i32)
+    (local $state i32)
+    (local $address i32)
+
+    i32.const 12345
+    local.set $state
+
+    loop $loop
+      ;; Linear congruential generator.
+      local.get $state
+      i32.const 1103515245
+      i32.mul
+      i32.const 12345
+      i32.add
+      local.tee $state
+
+      ;; 4 byte aligned address in the 512MB memory.
+      i32.const 0x1ffffffc
+      i32.and
+      local.tee $address
+
+      local.get $address
+      i32.load
+      i32.const 1
+      i32.add
+      i32.store
+
+      local.get $i
+      i32.const 1
+      i32.add
+      local.tee $i
+      global.get $iterations
+      i32.ne
+      br_if $loop
+    end
+  )
+
+  (memory (;0;) 8192 8192)
+
+  (start $start)
+)
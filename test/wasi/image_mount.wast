@@ -0,0 +1,337 @@
+;; Reads and writes the tar archive mounted as /image by tools/run-tests.py.
+(component
+  (import "wasi:io/streams@0.2.0" (instance $streams
+    (export "input-stream" (type (sub resource)))
+    (export "output-stream" (type (sub resource)))
+    (export "error" (type (sub resource)))
+    (type $stream-error (variant (case "last-operation-failed" (own 2)) (case "closed")))
+    (export "stream-error" (type (eq $stream-error)))
+    (export "[method]input-stream.read" (func (param "self" (borrow 0)) (param "len" u64) (result (result (list u8) (error 4)))))
+    (export "[method]output-stream.blocking-write-and-flush" (func (param "self" (borrow 1)) (param "contents" (list u8)) (result (result (error 4)))))
+  ))
+  (alias export $streams "input-stream" (type $input-stream))
+  (alias export $streams "output-stream" (type $output-stream))
+
+  (import "wasi:filesystem/types@0.2.0" (instance $types
+    (export "descriptor" (type (sub resource)))
+    (type $filesize u64)
+    (export "filesize" (type (eq $filesize)))
+    (alias outer 1 $input-stream (type $input-stream))
+    (export "input-stream" (type (eq $input-stream)))
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (type $error-code (enum "access" "would-block" "already" "bad-descriptor" "busy" "deadlock" "quota" "exist" "file-too-large" "illegal-byte-sequence" "in-progress" "interrupted" "invalid" "io" "is-directory" "loop" "too-many-links" "message-size" "name-too-long" "no-device" "no-entry" "no-lock" "insufficient-memory" "insufficient-space" "not-directory" "not-empty" "not-recoverable" "unsupported" "no-tty" "no-such-device" "overflow" "not-permitted" "pipe" "read-only" "invalid-seek" "text-file-busy" "cross-device"))
+    (export "error-code" (type (eq $error-code)))
+    (type $descriptor-flags (flags "read" "write" "file-integrity-sync" "data-integrity-sync" "requested-write-sync" "mutate-directory"))
+    (export "descriptor-flags" (type (eq $descriptor-flags)))
+    (type $path-flags (flags "symlink-follow"))
+    (export "path-flags" (type (eq $path-flags)))
+    (type $open-flags (flags "create" "directory" "exclusive" "truncate"))
+    (export "open-flags" (type (eq $open-flags)))
+    (export "[method]descriptor.read-via-stream" (func (param "self" (borrow 0)) (param "offset" 2) (result (result (own 4) (error 8)))))
+    (export "[method]descriptor.write-via-stream" (func (param "self" (borrow 0)) (param "offset" 2) (result (result (own 6) (error 8)))))
+    (export "[method]descriptor.open-at" (func (param "self" (borrow 0)) (param "path-flags" 12) (param "path" string) (param "open-flags" 14) (param "flags" 10) (result (result (own 0) (error 8)))))
+  ))
+  (alias export $types "descriptor" (type $descriptor))
+
+  (import "wasi:filesystem/preopens@0.2.0" (instance $preopens
+    (alias outer 1 $descriptor (type $descriptor))
+    (export "descriptor" (type (eq $descriptor)))
+    (export "get-directories" (func (result (list (tuple (own 1) string)))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (global $heap (mut i32) (i32.const 8192))
+    ;; Bump allocator, the memory is never freed.
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+      (local $ptr i32)
+      global.get $heap
+      local.get 2
+      i32.add
+      i32.const -1
+      i32.add
+      i32.const 0
+      local.get 2
+      i32.sub
+      i32.and
+      local.tee $ptr
+      local.get 3
+      i32.add
+      global.set $heap
+      local.get $ptr
+    )
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+
+  (alias export $preopens "get-directories" (func $get-directories))
+  (alias export $types "[method]descriptor.open-at" (func $open-at))
+  (alias export $types "[method]descriptor.read-via-stream" (func $read-via-stream))
+  (alias export $types "[method]descriptor.write-via-stream" (func $write-via-stream))
+  (alias export $streams "[method]input-stream.read" (func $read))
+  (alias export $streams "[method]output-stream.blocking-write-and-flush" (func $write))
+
+  (core func $get-directories (canon lower (func $get-directories) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $open-at (canon lower (func $open-at) (memory $memory) (realloc $realloc) string-encoding=utf8))
+  (core func $read-via-stream (canon lower (func $read-via-stream) (memory $memory)))
+  (core func $write-via-stream (canon lower (func $write-via-stream) (memory $memory)))
+  (core func $read (canon lower (func $read) (memory $memory) (realloc $realloc)))
+  (core func $write (canon lower (func $write) (memory $memory) (realloc $realloc)))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "get-directories" (func $get-directories (param i32)))
+    (import "wasi" "open-at" (func $open-at (param i32 i32 i32 i32 i32 i32 i32)))
+    (import "wasi" "read-via-stream" (func $read-via-stream (param i32 i64 i32)))
+    (import "wasi" "write-via-stream" (func $write-via-stream (param i32 i64 i32)))
+    (import "wasi" "read" (func $read (param i32 i64 i32)))
+    (import "wasi" "write" (func $write (param i32 i32 i32 i32)))
+
+    ;; Strings used by the test, the first byte is the length.
+    (data (i32.const 256) "\06/image")
+    (data (i32.const 288) "\08data.txt")
+    (data (i32.const 320) "\0eoriginal data\n")
+    (data (i32.const 352) "\08new data")
+    (data (i32.const 384) "\0bcreated.txt")
+    (data (i32.const 416) "\0ecreated a file")
+    (data (i32.const 448) "\0d../image.tar")
+    (data (i32.const 480) "\12dir/../../data.txt")
+    (data (i32.const 512) "\0dustar prefix\n")
+    (data (i32.const 544) "\0egnu long name\n")
+    (data (i32.const 576) "\79prefix-dir-aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/ustar.txt")
+    (data (i32.const 704) "\80gnu-bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb.txt")
+
+    (global $root (mut i32) (i32.const 0))
+
+    (func $check (param i32)
+      local.get 0
+      i32.eqz
+      if unreachable end
+    )
+
+    (func $equals (param $ptr i32) (param $len i32) (param $str i32) (result i32)
+      local.get $len
+      local.get $str
+      i32.load8_u
+      i32.ne
+      if i32.const 0 return end
+      loop $next
+        local.get $len
+        i32.eqz
+        if i32.const 1 return end
+        local.get $len
+        i32.const -1
+        i32.add
+        local.tee $len
+        local.get $ptr
+        i32.add
+        i32.load8_u
+        local.get $len
+        local.get $str
+        i32.add
+        i32.load8_u offset=1
+        i32.ne
+        if i32.const 0 return end
+        br $next
+      end
+      unreachable
+    )
+
+    ;; Returns with the descriptor, or -1 on error.
+    (func $open (param $path i32) (param $openFlags i32) (param $flags i32) (result i32)
+      global.get $root
+      i32.const 0
+      local.get $path
+      i32.const 1
+      i32.add
+      local.get $path
+      i32.load8_u
+      local.get $openFlags
+      local.get $flags
+      i32.const 0
+      call $open-at
+      i32.const 0
+      i32.load8_u
+      if i32.const -1 return end
+      i32.const 4
+      i32.load
+    )
+
+    ;; Checks that the file contains the expected string.
+    (func $expect (param $path i32) (param $str i32)
+      (local $fd i32)
+      local.get $path
+      i32.const 0
+      i32.const 1 ;; read
+      call $open
+      local.tee $fd
+      i32.const -1
+      i32.ne
+      call $check
+
+      local.get $fd
+      i64.const 0
+      i32.const 0
+      call $read-via-stream
+      i32.const 0
+      i32.load8_u
+      i32.eqz
+      call $check
+
+      i32.const 4
+      i32.load
+      i64.const 1024
+      i32.const 0
+      call $read
+      i32.const 0
+      i32.load8_u
+      i32.eqz
+      call $check
+
+      i32.const 4
+      i32.load
+      i32.const 8
+      i32.load
+      local.get $str
+      call $equals
+      call $check
+    )
+
+    (func $store (param $path i32) (param $openFlags i32) (param $str i32)
+      (local $fd i32)
+      local.get $path
+      local.get $openFlags
+      i32.const 3 ;; read | write
+      call $open
+      local.tee $fd
+      i32.const -1
+      i32.ne
+      call $check
+
+      local.get $fd
+      i64.const 0
+      i32.const 0
+      call $write-via-stream
+      i32.const 0
+      i32.load8_u
+      i32.eqz
+      call $check
+
+      i32.const 4
+      i32.load
+      local.get $str
+      i32.const 1
+      i32.add
+      local.get $str
+      i32.load8_u
+      i32.const 0
+      call $write
+      i32.const 0
+      i32.load8_u
+      i32.eqz
+      call $check
+    )
+
+    (func (export "run")
+      (local $entry i32)
+      (local $count i32)
+
+      ;; Find the image among the pre-opened directories.
+      i32.const 0
+      call $get-directories
+      i32.const 0
+      i32.load
+      local.set $entry
+      i32.const 4
+      i32.load
+      local.set $count
+      block $found
+        loop $next
+          local.get $count
+          i32.eqz
+          if unreachable end
+          local.get $entry
+          i32.load offset=4
+          local.get $entry
+          i32.load offset=8
+          i32.const 256
+          call $equals
+          if
+            local.get $entry
+            i32.load
+            global.set $root
+            br $found
+          end
+          local.get $entry
+          i32.const 12
+          i32.add
+          local.set $entry
+          local.get $count
+          i32.const -1
+          i32.add
+          local.set $count
+          br $next
+        end
+      end
+
+      ;; Names split into the ustar prefix and name fields, and GNU long names.
+      i32.const 576
+      i32.const 512
+      call $expect
+      i32.const 704
+      i32.const 544
+      call $expect
+      i32.const 288
+      i32.const 320
+      call $expect
+
+      ;; Paths cannot leave the root of the image.
+      i32.const 448
+      i32.const 0
+      i32.const 1
+      call $open
+      i32.const -1
+      i32.eq
+      call $check
+      i32.const 480
+      i32.const 0
+      i32.const 1
+      call $open
+      i32.const -1
+      i32.eq
+      call $check
+
+      ;; Truncate and rewrite a file of the image, then create a new file.
+      i32.const 288
+      i32.const 8 ;; truncate
+      i32.const 352
+      call $store
+      i32.const 288
+      i32.const 352
+      call $expect
+      i32.const 384
+      i32.const 1 ;; create
+      i32.const 416
+      call $store
+      i32.const 384
+      i32.const 416
+      call $expect
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "get-directories" (func $get-directories))
+      (export "open-at" (func $open-at))
+      (export "read-via-stream" (func $read-via-stream))
+      (export "write-via-stream" (func $write-via-stream))
+      (export "read" (func $read))
+      (export "write" (func $write))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
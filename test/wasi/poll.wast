@@ -0,0 +1,126 @@
+;; Waits for timers of the monotonic clock.
+(component
+  (import "wasi:io/poll@0.2.0" (instance $poll
+    (export "pollable" (type (sub resource)))
+    (export "[method]pollable.block" (func (param "self" (borrow 0))))
+    (export "poll" (func (param "in" (list (borrow 0))) (result (list u32))))
+  ))
+  (alias export $poll "pollable" (type $pollable))
+
+  (import "wasi:clocks/monotonic-clock@0.2.0" (instance $clock
+    (type $time u64)
+    (export "instant" (type (eq $time)))
+    (export "duration" (type (eq $time)))
+    (alias outer 1 $pollable (type $pollable))
+    (export "pollable" (type (eq $pollable)))
+    (export "now" (func (result 1)))
+    (export "resolution" (func (result 2)))
+    (export "subscribe-instant" (func (param "when" 1) (result (own 4))))
+    (export "subscribe-duration" (func (param "when" 2) (result (own 4))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (global $heap (mut i32) (i32.const 1024))
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+      (local $result i32)
+      (local.set $result (global.get $heap))
+      (global.set $heap (i32.add (global.get $heap) (local.get 3)))
+      (local.get $result)
+    )
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+
+  (alias export $poll "[method]pollable.block" (func $block))
+  (alias export $poll "poll" (func $poll))
+  (alias export $clock "now" (func $now))
+  (alias export $clock "resolution" (func $resolution))
+  (alias export $clock "subscribe-instant" (func $subscribe-instant))
+  (alias export $clock "subscribe-duration" (func $subscribe-duration))
+
+  (core func $block (canon lower (func $block)))
+  (core func $poll (canon lower (func $poll) (memory $memory) (realloc $realloc)))
+  (core func $now (canon lower (func $now)))
+  (core func $resolution (canon lower (func $resolution)))
+  (core func $subscribe-instant (canon lower (func $subscribe-instant)))
+  (core func $subscribe-duration (canon lower (func $subscribe-duration)))
+  (core func $drop-pollable (canon resource.drop $pollable))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "block" (func $block (param i32)))
+    (import "wasi" "poll" (func $poll (param i32 i32 i32)))
+    (import "wasi" "now" (func $now (result i64)))
+    (import "wasi" "resolution" (func $resolution (result i64)))
+    (import "wasi" "subscribe-instant" (func $subscribe-instant (param i64) (result i32)))
+    (import "wasi" "subscribe-duration" (func $subscribe-duration (param i64) (result i32)))
+    (import "wasi" "drop-pollable" (func $drop-pollable (param i32)))
+
+    (func $expect (param i32)
+      (if (i32.eqz (local.get 0))
+        (then unreachable))
+    )
+
+    (func (export "run")
+      (local $start i64)
+      (local $elapsed i64)
+      (local $timer i32)
+
+      ;; The resolution is measured in nanoseconds.
+      (call $expect (i64.gt_u (call $resolution) (i64.const 0)))
+      (call $expect (i64.le_u (call $resolution) (i64.const 1000000)))
+
+      ;; Blocks for 20ms. The time is measured in nanoseconds, so
+      ;; it must be less than a minute.
+      (local.set $start (call $now))
+      (local.set $timer (call $subscribe-duration (i64.const 20000000)))
+      (call $block (local.get $timer))
+      (call $drop-pollable (local.get $timer))
+      (local.set $elapsed (i64.sub (call $now) (local.get $start)))
+      (call $expect (i64.ge_u (local.get $elapsed) (i64.const 20000000)))
+      (call $expect (i64.lt_u (local.get $elapsed) (i64.const 60000000000)))
+
+      ;; An instant in the past is ready immediately.
+      (local.set $start (call $now))
+      (local.set $timer (call $subscribe-instant (i64.sub (local.get $start) (i64.const 1))))
+      (call $block (local.get $timer))
+      (call $drop-pollable (local.get $timer))
+      (call $expect (i64.lt_u (i64.sub (call $now) (local.get $start)) (i64.const 10000000000)))
+
+      ;; Only the ready pollables are returned: a timer which expires
+      ;; in an hour, an instant in the past, and an expired duration.
+      (i32.store (i32.const 0) (call $subscribe-duration (i64.const 3600000000000)))
+      (i32.store (i32.const 4) (call $subscribe-instant (i64.const 0)))
+      (i32.store (i32.const 8) (call $subscribe-duration (i64.const 0)))
+      (call $poll (i32.const 0) (i32.const 3) (i32.const 16))
+      (call $expect (i32.eq (i32.load (i32.const 20)) (i32.const 2)))
+      (call $expect (i32.eq (i32.load (i32.load (i32.const 16))) (i32.const 1)))
+      (call $expect (i32.eq (i32.load offset=4 (i32.load (i32.const 16))) (i32.const 2)))
+
+      ;; Waits until the first timer expires.
+      (local.set $start (call $now))
+      (i32.store (i32.const 4) (call $subscribe-duration (i64.const 20000000)))
+      (call $poll (i32.const 0) (i32.const 2) (i32.const 16))
+      (call $expect (i32.eq (i32.load (i32.const 20)) (i32.const 1)))
+      (call $expect (i32.eq (i32.load (i32.load (i32.const 16))) (i32.const 1)))
+      (call $expect (i64.ge_u (i64.sub (call $now) (local.get $start)) (i64.const 20000000)))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "block" (func $block))
+      (export "poll" (func $poll))
+      (export "now" (func $now))
+      (export "resolution" (func $resolution))
+      (export "subscribe-instant" (func $subscribe-instant))
+      (export "subscribe-duration" (func $subscribe-duration))
+      (export "drop-pollable" (func $drop-pollable))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
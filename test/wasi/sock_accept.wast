@@ -0,0 +1,31 @@
+(module
+  (import "wasi_snapshot_preview1" "sock_accept"
+    (func $sock_accept (param i32 i32 i32) (result i32)))
+
+  (memory 1)
+
+  ;; Call sock_accept with an invalid fd.
+  ;; uvwasi fails the fd lookup -> errno::badf (8).
+  (func (export "test_sock_accept_invalid_fd") (result i32)
+    i32.const 99   ;; non-existent fd
+    i32.const 0    ;; flags: none
+    i32.const 0    ;; offset to store the accepted fd
+    call $sock_accept
+  )
+
+  ;; The accepted fd would be stored outside of the memory -> errno::inval (28).
+  (func (export "test_sock_accept_bad_pointer") (result i32)
+    i32.const 99   ;; fd (irrelevant: pointer check fires first)
+    i32.const 0    ;; flags: none
+    i32.const 65534 ;; 4 byte fd does not fit into the memory
+    call $sock_accept
+  )
+
+  (export "memory" (memory 0))
+)
+
+;; Invalid fd: errno::badf (8)
+(assert_return (invoke "test_sock_accept_invalid_fd") (i32.const 8))
+
+;; Result pointer out of bounds: errno::inval (28)
+(assert_return (invoke "test_sock_accept_bad_pointer") (i32.const 28))
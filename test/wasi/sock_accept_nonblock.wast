@@ -0,0 +1,61 @@
+;; Run with --tcplisten 127.0.0.1:0, see run-tests.py.
+(module
+  (import "wasi_snapshot_preview1" "fd_fdstat_get"
+    (func $fd_fdstat_get (param i32 i32) (result i32)))
+  (import "wasi_snapshot_preview1" "sock_accept"
+    (func $sock_accept (param i32 i32 i32) (result i32)))
+
+  (memory 1)
+
+  ;; Returns the first preopened fd whose filetype is socket_stream (6), or -1.
+  (func $find_listen_socket (result i32)
+    (local $fd i32)
+    i32.const 3
+    local.set $fd
+    loop $next
+      local.get $fd
+      i32.const 100 ;; offset of the fdstat
+      call $fd_fdstat_get
+      i32.eqz
+      if
+        i32.const 100
+        i32.load8_u ;; fs_filetype
+        i32.const 6
+        i32.eq
+        if
+          local.get $fd
+          return
+        end
+      end
+      local.get $fd
+      i32.const 1
+      i32.add
+      local.tee $fd
+      i32.const 32
+      i32.lt_u
+      br_if $next
+    end
+    i32.const -1
+  )
+
+  (func (export "test_listen_socket_found") (result i32)
+    call $find_listen_socket
+    i32.const -1
+    i32.ne
+  )
+
+  ;; No client connects, so a non-blocking accept returns immediately with errno::again (6).
+  (func (export "test_sock_accept_nonblock") (result i32)
+    call $find_listen_socket
+    i32.const 4    ;; fdflags: nonblock
+    i32.const 0    ;; offset to store the accepted fd
+    call $sock_accept
+  )
+
+  (export "memory" (memory 0))
+)
+
+(assert_return (invoke "test_listen_socket_found") (i32.const 1))
+
+;; Nothing to accept: errno::again (6)
+(assert_return (invoke "test_sock_accept_nonblock") (i32.const 6))
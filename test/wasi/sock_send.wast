@@ -0,0 +1,51 @@
+(module
+  (import "wasi_snapshot_preview1" "sock_send"
+    (func $sock_send (param i32 i32 i32 i32 i32) (result i32)))
+
+  (memory 1)
+
+  ;; iovec at 0: buf = 100, buf_len = 16
+  (data (i32.const 0) "\64\00\00\00\10\00\00\00")
+  ;; iovec at 8: buf = 65530, buf_len = 16 (ends outside of the memory)
+  (data (i32.const 8) "\fa\ff\00\00\10\00\00\00")
+
+  ;; Call sock_send with an invalid fd and a valid iovec.
+  ;; uvwasi fails the fd lookup -> errno::badf (8).
+  (func (export "test_sock_send_invalid_fd") (result i32)
+    i32.const 99   ;; non-existent fd
+    i32.const 0    ;; iovec array
+    i32.const 1    ;; iovec count
+    i32.const 0    ;; siflags: none
+    i32.const 200  ;; offset to store the sent byte count
+    call $sock_send
+  )
+
+  ;; The buffer of the second iovec is outside of the memory -> errno::inval (28).
+  (func (export "test_sock_send_bad_iovec") (result i32)
+    i32.const 99   ;; fd (irrelevant: iovec check fires first)
+    i32.const 0    ;; iovec array
+    i32.const 2    ;; iovec count
+    i32.const 0    ;; siflags: none
+    i32.const 200  ;; offset to store the sent byte count
+    call $sock_send
+  )
+
+  ;; The iovec array itself is outside of the memory -> errno::inval (28).
+  (func (export "test_sock_send_bad_iovec_array") (result i32)
+    i32.const 99   ;; fd (irrelevant: iovec check fires first)
+    i32.const 65532 ;; iovec array
+    i32.const 1    ;; iovec count
+    i32.const 0    ;; siflags: none
+    i32.const 200  ;; offset to store the sent byte count
+    call $sock_send
+  )
+
+  (export "memory" (memory 0))
+)
+
+;; Invalid fd: errno::badf (8)
+(assert_return (invoke "test_sock_send_invalid_fd") (i32.const 8))
+
+;; Bad iovec: errno::inval (28)
+(assert_return (invoke "test_sock_send_bad_iovec") (i32.const 28))
+(assert_return (invoke "test_sock_send_bad_iovec_array") (i32.const 28))
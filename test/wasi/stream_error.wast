@@ -0,0 +1,101 @@
+;; The standard output is redirected to a read only file by tools/run-tests.py,
+;; so writing it fails. The output of stderr must be: "stderr\n"
+(component
+  (import "wasi:io/streams@0.2.0" (instance $streams
+    (export "output-stream" (type (sub resource)))
+    (export "error" (type (sub resource)))
+    (type $stream-error (variant (case "last-operation-failed" (own 1)) (case "closed")))
+    (export "stream-error" (type (eq $stream-error)))
+    (export "[method]output-stream.check-write" (func (param "self" (borrow 0)) (result (result u64 (error 3)))))
+    (export "[method]output-stream.write" (func (param "self" (borrow 0)) (param "contents" (list u8)) (result (result (error 3)))))
+  ))
+  (alias export $streams "output-stream" (type $output-stream))
+  (alias export $streams "error" (type $error))
+
+  (import "wasi:cli/stdout@0.2.0" (instance $stdout
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (export "get-stdout" (func (result (own 0))))
+  ))
+  (import "wasi:cli/stderr@0.2.0" (instance $stderr
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (export "get-stderr" (func (result (own 0))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+
+  (alias export $stdout "get-stdout" (func $get-stdout))
+  (alias export $stderr "get-stderr" (func $get-stderr))
+  (alias export $streams "[method]output-stream.check-write" (func $check-write))
+  (alias export $streams "[method]output-stream.write" (func $write))
+
+  (core func $get-stdout (canon lower (func $get-stdout)))
+  (core func $get-stderr (canon lower (func $get-stderr)))
+  (core func $check-write (canon lower (func $check-write) (memory $memory)))
+  (core func $write (canon lower (func $write) (memory $memory)))
+  (core func $drop-error (canon resource.drop $error))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "get-stdout" (func $get-stdout (result i32)))
+    (import "wasi" "get-stderr" (func $get-stderr (result i32)))
+    (import "wasi" "check-write" (func $check-write (param i32 i32)))
+    (import "wasi" "write" (func $write (param i32 i32 i32 i32)))
+    (import "wasi" "drop-error" (func $drop-error (param i32)))
+
+    (data (i32.const 64) "stdout\0astderr\0a")
+
+    (func $expect (param i32 i32)
+      (if (i32.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+
+    (func (export "run")
+      (local $stdout i32)
+      (local $stderr i32)
+      (local.set $stdout (call $get-stdout))
+      (local.set $stderr (call $get-stderr))
+
+      ;; The data is buffered, so no error is reported.
+      (call $write (local.get $stdout) (i32.const 64) (i32.const 7) (i32.const 16))
+      (call $expect (i32.load8_u (i32.const 16)) (i32.const 0))
+
+      ;; Flushes stdout, which fails.
+      (call $write (local.get $stderr) (i32.const 71) (i32.const 7) (i32.const 16))
+      (call $expect (i32.load8_u (i32.const 16)) (i32.const 0))
+
+      ;; The failure is reported by the next operation of stdout.
+      (call $check-write (local.get $stdout) (i32.const 0))
+      (call $expect (i32.load8_u (i32.const 0)) (i32.const 1))
+      (call $expect (i32.load8_u (i32.const 8)) (i32.const 0))
+      (call $drop-error (i32.load (i32.const 12)))
+
+      ;; The stream is closed after the failure.
+      (call $check-write (local.get $stdout) (i32.const 0))
+      (call $expect (i32.load8_u (i32.const 0)) (i32.const 1))
+      (call $expect (i32.load8_u (i32.const 8)) (i32.const 1))
+
+      (call $write (local.get $stdout) (i32.const 64) (i32.const 7) (i32.const 16))
+      (call $expect (i32.load8_u (i32.const 16)) (i32.const 1))
+      (call $expect (i32.load8_u (i32.const 20)) (i32.const 1))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "get-stdout" (func $get-stdout))
+      (export "get-stderr" (func $get-stderr))
+      (export "check-write" (func $check-write))
+      (export "write" (func $write))
+      (export "drop-error" (func $drop-error))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
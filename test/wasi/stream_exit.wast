@@ -0,0 +1,65 @@
+;; The buffered output must be written when the program exits.
+;; The output must be: "buffered\n" and the exit code must be 1.
+(component
+  (import "wasi:io/streams@0.2.0" (instance $streams
+    (export "output-stream" (type (sub resource)))
+    (export "error" (type (sub resource)))
+    (type $stream-error (variant (case "last-operation-failed" (own 1)) (case "closed")))
+    (export "stream-error" (type (eq $stream-error)))
+    (export "[method]output-stream.write" (func (param "self" (borrow 0)) (param "contents" (list u8)) (result (result (error 3)))))
+  ))
+  (alias export $streams "output-stream" (type $output-stream))
+
+  (import "wasi:cli/stdout@0.2.0" (instance $stdout
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (export "get-stdout" (func (result (own 0))))
+  ))
+  (import "wasi:cli/exit@0.2.0" (instance $exit
+    (export "exit" (func (param "status" (result))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+
+  (alias export $stdout "get-stdout" (func $get-stdout))
+  (alias export $streams "[method]output-stream.write" (func $write))
+  (alias export $exit "exit" (func $exit))
+
+  (core func $get-stdout (canon lower (func $get-stdout)))
+  (core func $write (canon lower (func $write) (memory $memory)))
+  (core func $exit (canon lower (func $exit)))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "get-stdout" (func $get-stdout (result i32)))
+    (import "wasi" "write" (func $write (param i32 i32 i32 i32)))
+    (import "wasi" "exit" (func $exit (param i32)))
+
+    (data (i32.const 64) "buffered\0a")
+
+    (func (export "run")
+      (call $write (call $get-stdout) (i32.const 64) (i32.const 9) (i32.const 16))
+      (if (i32.load8_u (i32.const 16))
+        (then unreachable))
+
+      ;; Exit with an error.
+      (call $exit (i32.const 1))
+      unreachable
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "get-stdout" (func $get-stdout))
+      (export "write" (func $write))
+      (export "exit" (func $exit))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
@@ -0,0 +1,111 @@
+;; Writes stdout and stderr, which are redirected to the same pipe by
+;; tools/run-tests.py. The output must be: "one two three four\nfive\n"
+(component
+  (import "wasi:io/streams@0.2.0" (instance $streams
+    (export "output-stream" (type (sub resource)))
+    (export "error" (type (sub resource)))
+    (type $stream-error (variant (case "last-operation-failed" (own 1)) (case "closed")))
+    (export "stream-error" (type (eq $stream-error)))
+    (export "[method]output-stream.check-write" (func (param "self" (borrow 0)) (result (result u64 (error 3)))))
+    (export "[method]output-stream.write" (func (param "self" (borrow 0)) (param "contents" (list u8)) (result (result (error 3)))))
+    (export "[method]output-stream.blocking-write-and-flush" (func (param "self" (borrow 0)) (param "contents" (list u8)) (result (result (error 3)))))
+  ))
+  (alias export $streams "output-stream" (type $output-stream))
+
+  (import "wasi:cli/stdout@0.2.0" (instance $stdout
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (export "get-stdout" (func (result (own 0))))
+  ))
+  (import "wasi:cli/stderr@0.2.0" (instance $stderr
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (export "get-stderr" (func (result (own 0))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+
+  (alias export $stdout "get-stdout" (func $get-stdout))
+  (alias export $stderr "get-stderr" (func $get-stderr))
+  (alias export $streams "[method]output-stream.check-write" (func $check-write))
+  (alias export $streams "[method]output-stream.write" (func $write))
+  (alias export $streams "[method]output-stream.blocking-write-and-flush" (func $blocking-write-and-flush))
+
+  (core func $get-stdout (canon lower (func $get-stdout)))
+  (core func $get-stderr (canon lower (func $get-stderr)))
+  (core func $check-write (canon lower (func $check-write) (memory $memory)))
+  (core func $write (canon lower (func $write) (memory $memory)))
+  (core func $blocking-write-and-flush (canon lower (func $blocking-write-and-flush) (memory $memory)))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "get-stdout" (func $get-stdout (result i32)))
+    (import "wasi" "get-stderr" (func $get-stderr (result i32)))
+    (import "wasi" "check-write" (func $check-write (param i32 i32)))
+    (import "wasi" "write" (func $write (param i32 i32 i32 i32)))
+    (import "wasi" "blocking-write-and-flush" (func $blocking-write-and-flush (param i32 i32 i32 i32)))
+
+    (data (i32.const 64) "one two three four\0afive\0a")
+
+    (func $expect (param i64 i64)
+      (if (i64.ne (local.get 0) (local.get 1))
+        (then unreachable))
+    )
+
+    ;; Returns with the number of bytes which can be written without blocking.
+    (func $budget (param $stream i32) (result i64)
+      (call $check-write (local.get $stream) (i32.const 0))
+      (call $expect (i64.load8_u (i32.const 0)) (i64.const 0))
+      (i64.load (i32.const 8))
+    )
+
+    (func $write-ok (param $stream i32) (param $ptr i32) (param $len i32)
+      (call $write (local.get $stream) (local.get $ptr) (local.get $len) (i32.const 16))
+      (call $expect (i64.load8_u (i32.const 16)) (i64.const 0))
+    )
+
+    (func (export "run")
+      (local $stdout i32)
+      (local $stderr i32)
+      (local.set $stdout (call $get-stdout))
+      (local.set $stderr (call $get-stderr))
+
+      ;; Written data is buffered until the budget runs out.
+      (call $expect (call $budget (local.get $stdout)) (i64.const 16384))
+      (call $write-ok (local.get $stdout) (i32.const 64) (i32.const 4))
+      (call $expect (call $budget (local.get $stdout)) (i64.const 16380))
+
+      ;; Writing another stream flushes the buffered data first.
+      (call $write-ok (local.get $stderr) (i32.const 68) (i32.const 4))
+      (call $expect (call $budget (local.get $stdout)) (i64.const 16384))
+      (call $expect (call $budget (local.get $stderr)) (i64.const 16380))
+      (call $write-ok (local.get $stdout) (i32.const 72) (i32.const 6))
+
+      ;; The data is written before the function returns.
+      (call $blocking-write-and-flush (local.get $stderr) (i32.const 78) (i32.const 5) (i32.const 16))
+      (call $expect (i64.load8_u (i32.const 16)) (i64.const 0))
+      (call $expect (call $budget (local.get $stderr)) (i64.const 16384))
+      (call $expect (call $budget (local.get $stdout)) (i64.const 16384))
+
+      ;; Flushed when the program ends.
+      (call $write-ok (local.get $stdout) (i32.const 83) (i32.const 5))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "get-stdout" (func $get-stdout))
+      (export "get-stderr" (func $get-stderr))
+      (export "check-write" (func $check-write))
+      (export "write" (func $write))
+      (export "blocking-write-and-flush" (func $blocking-write-and-flush))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
@@ -0,0 +1,396 @@
+;; Connects two loopback TCP sockets, and sends data between them without
+;; blocking. Runs with --inherit-network, see tools/run-tests.py.
+(component
+  (import "wasi:io/error@0.2.0" (instance $error
+    (export "error" (type (sub resource)))
+  ))
+  (alias export $error "error" (type $error))
+
+  (import "wasi:io/poll@0.2.0" (instance $poll
+    (export "pollable" (type (sub resource)))
+    (export "[method]pollable.block" (func (param "self" (borrow 0))))
+  ))
+  (alias export $poll "pollable" (type $pollable))
+
+  (import "wasi:io/streams@0.2.0" (instance $streams
+    (export "input-stream" (type (sub resource)))
+    (export "output-stream" (type (sub resource)))
+    (alias outer 1 $error (type $error))
+    (export "error" (type (eq $error)))
+    (alias outer 1 $pollable (type $pollable))
+    (export "pollable" (type (eq $pollable)))
+    (type $stream-error (variant (case "last-operation-failed" (own 3)) (case "closed")))
+    (export "stream-error" (type (eq $stream-error)))
+    (export "[method]input-stream.read" (func (param "self" (borrow 0)) (param "len" u64) (result (result (list u8) (error 7)))))
+    (export "[method]input-stream.subscribe" (func (param "self" (borrow 0)) (result (own 5))))
+    (export "[method]output-stream.blocking-write-and-flush" (func (param "self" (borrow 1)) (param "contents" (list u8)) (result (result (error 7)))))
+  ))
+  (alias export $streams "input-stream" (type $input-stream))
+  (alias export $streams "output-stream" (type $output-stream))
+
+  (import "wasi:sockets/network@0.2.0" (instance $network
+    (export "network" (type (sub resource)))
+    (type $error-code (enum "unknown" "access-denied" "not-supported" "invalid-argument" "out-of-memory" "timeout"
+      "concurrency-conflict" "not-in-progress" "would-block" "invalid-state" "new-socket-limit" "address-not-bindable"
+      "address-in-use" "remote-unreachable" "connection-refused" "connection-reset" "connection-aborted"
+      "datagram-too-large" "name-unresolvable" "temporary-resolver-failure" "permanent-resolver-failure"))
+    (export "error-code" (type (eq $error-code)))
+    (type $ip-address-family (enum "ipv4" "ipv6"))
+    (export "ip-address-family" (type (eq $ip-address-family)))
+    (type $ipv4-address (tuple u8 u8 u8 u8))
+    (export "ipv4-address" (type (eq $ipv4-address)))
+    (type $ipv6-address (tuple u16 u16 u16 u16 u16 u16 u16 u16))
+    (export "ipv6-address" (type (eq $ipv6-address)))
+    (type $ipv4-socket-address (record (field "port" u16) (field "address" $ipv4-address)))
+    (export "ipv4-socket-address" (type (eq $ipv4-socket-address)))
+    (type $ipv6-socket-address (record (field "port" u16) (field "flow-info" u32) (field "address" $ipv6-address) (field "scope-id" u32)))
+    (export "ipv6-socket-address" (type (eq $ipv6-socket-address)))
+    (type $ip-socket-address (variant (case "ipv4" $ipv4-socket-address) (case "ipv6" $ipv6-socket-address)))
+    (export "ip-socket-address" (type (eq $ip-socket-address)))
+  ))
+  (alias export $network "network" (type $network))
+  (alias export $network "error-code" (type $error-code))
+  (alias export $network "ip-address-family" (type $ip-address-family))
+  (alias export $network "ip-socket-address" (type $ip-socket-address))
+
+  (import "wasi:sockets/instance-network@0.2.0" (instance $instance-network
+    (alias outer 1 $network (type $network))
+    (export "network" (type (eq $network)))
+    (export "instance-network" (func (result (own 0))))
+  ))
+
+  (import "wasi:sockets/tcp@0.2.0" (instance $tcp
+    (export "tcp-socket" (type (sub resource)))
+    (alias outer 1 $input-stream (type $input-stream))
+    (export "input-stream" (type (eq $input-stream)))
+    (alias outer 1 $output-stream (type $output-stream))
+    (export "output-stream" (type (eq $output-stream)))
+    (alias outer 1 $pollable (type $pollable))
+    (export "pollable" (type (eq $pollable)))
+    (alias outer 1 $network (type $network))
+    (export "network" (type (eq $network)))
+    (alias outer 1 $error-code (type $error-code))
+    (export "error-code" (type (eq $error-code)))
+    (alias outer 1 $ip-socket-address (type $ip-socket-address))
+    (export "ip-socket-address" (type (eq $ip-socket-address)))
+    (alias outer 1 $ip-address-family (type $ip-address-family))
+    (export "ip-address-family" (type (eq $ip-address-family)))
+    (type $shutdown-type (enum "receive" "send" "both"))
+    (export "shutdown-type" (type (eq $shutdown-type)))
+    (export "[method]tcp-socket.start-bind" (func (param "self" (borrow 0)) (param "network" (borrow 8)) (param "local-address" 12) (result (result (error 10)))))
+    (export "[method]tcp-socket.finish-bind" (func (param "self" (borrow 0)) (result (result (error 10)))))
+    (export "[method]tcp-socket.start-connect" (func (param "self" (borrow 0)) (param "network" (borrow 8)) (param "remote-address" 12) (result (result (error 10)))))
+    (export "[method]tcp-socket.finish-connect" (func (param "self" (borrow 0)) (result (result (tuple (own 2) (own 4)) (error 10)))))
+    (export "[method]tcp-socket.start-listen" (func (param "self" (borrow 0)) (result (result (error 10)))))
+    (export "[method]tcp-socket.finish-listen" (func (param "self" (borrow 0)) (result (result (error 10)))))
+    (export "[method]tcp-socket.accept" (func (param "self" (borrow 0)) (result (result (tuple (own 0) (own 2) (own 4)) (error 10)))))
+    (export "[method]tcp-socket.local-address" (func (param "self" (borrow 0)) (result (result 12 (error 10)))))
+    (export "[method]tcp-socket.remote-address" (func (param "self" (borrow 0)) (result (result 12 (error 10)))))
+    (export "[method]tcp-socket.is-listening" (func (param "self" (borrow 0)) (result bool)))
+    (export "[method]tcp-socket.address-family" (func (param "self" (borrow 0)) (result 14)))
+    (export "[method]tcp-socket.subscribe" (func (param "self" (borrow 0)) (result (own 6))))
+    (export "[method]tcp-socket.shutdown" (func (param "self" (borrow 0)) (param "shutdown-type" 16) (result (result (error 10)))))
+  ))
+  (alias export $tcp "tcp-socket" (type $tcp-socket))
+
+  (import "wasi:sockets/tcp-create-socket@0.2.0" (instance $tcp-create-socket
+    (alias outer 1 $network (type $network))
+    (export "network" (type (eq $network)))
+    (alias outer 1 $error-code (type $error-code))
+    (export "error-code" (type (eq $error-code)))
+    (alias outer 1 $ip-address-family (type $ip-address-family))
+    (export "ip-address-family" (type (eq $ip-address-family)))
+    (alias outer 1 $tcp-socket (type $tcp-socket))
+    (export "tcp-socket" (type (eq $tcp-socket)))
+    (export "create-tcp-socket" (func (param "address-family" 5) (result (result (own 7) (error 3)))))
+  ))
+
+  (core module $libc
+    (memory (export "memory") 1)
+    (global $heap (mut i32) (i32.const 1024))
+    (func (export "realloc") (param i32 i32 i32 i32) (result i32)
+      (local $result i32)
+      (local.set $result (global.get $heap))
+      (global.set $heap (i32.add (global.get $heap) (local.get 3)))
+      (local.get $result)
+    )
+  )
+  (core instance $libc (instantiate $libc))
+  (alias core export $libc "memory" (core memory $memory))
+  (alias core export $libc "realloc" (core func $realloc))
+
+  (alias export $poll "[method]pollable.block" (func $block))
+  (alias export $streams "[method]input-stream.read" (func $read))
+  (alias export $streams "[method]input-stream.subscribe" (func $subscribe-input))
+  (alias export $streams "[method]output-stream.blocking-write-and-flush" (func $write))
+  (alias export $instance-network "instance-network" (func $instance-network))
+  (alias export $tcp-create-socket "create-tcp-socket" (func $create))
+  (alias export $tcp "[method]tcp-socket.start-bind" (func $start-bind))
+  (alias export $tcp "[method]tcp-socket.finish-bind" (func $finish-bind))
+  (alias export $tcp "[method]tcp-socket.start-connect" (func $start-connect))
+  (alias export $tcp "[method]tcp-socket.finish-connect" (func $finish-connect))
+  (alias export $tcp "[method]tcp-socket.start-listen" (func $start-listen))
+  (alias export $tcp "[method]tcp-socket.finish-listen" (func $finish-listen))
+  (alias export $tcp "[method]tcp-socket.accept" (func $accept))
+  (alias export $tcp "[method]tcp-socket.local-address" (func $local-address))
+  (alias export $tcp "[method]tcp-socket.remote-address" (func $remote-address))
+  (alias export $tcp "[method]tcp-socket.is-listening" (func $is-listening))
+  (alias export $tcp "[method]tcp-socket.address-family" (func $address-family))
+  (alias export $tcp "[method]tcp-socket.subscribe" (func $subscribe))
+  (alias export $tcp "[method]tcp-socket.shutdown" (func $shutdown))
+
+  (core func $block (canon lower (func $block)))
+  (core func $read (canon lower (func $read) (memory $memory) (realloc $realloc)))
+  (core func $subscribe-input (canon lower (func $subscribe-input)))
+  (core func $write (canon lower (func $write) (memory $memory)))
+  (core func $instance-network (canon lower (func $instance-network)))
+  (core func $create (canon lower (func $create) (memory $memory)))
+  (core func $start-bind (canon lower (func $start-bind) (memory $memory)))
+  (core func $finish-bind (canon lower (func $finish-bind) (memory $memory)))
+  (core func $start-connect (canon lower (func $start-connect) (memory $memory)))
+  (core func $finish-connect (canon lower (func $finish-connect) (memory $memory)))
+  (core func $start-listen (canon lower (func $start-listen) (memory $memory)))
+  (core func $finish-listen (canon lower (func $finish-listen) (memory $memory)))
+  (core func $accept (canon lower (func $accept) (memory $memory)))
+  (core func $local-address (canon lower (func $local-address) (memory $memory)))
+  (core func $remote-address (canon lower (func $remote-address) (memory $memory)))
+  (core func $is-listening (canon lower (func $is-listening)))
+  (core func $address-family (canon lower (func $address-family)))
+  (core func $subscribe (canon lower (func $subscribe)))
+  (core func $shutdown (canon lower (func $shutdown) (memory $memory)))
+  (core func $drop-pollable (canon resource.drop $pollable))
+  (core func $drop-input-stream (canon resource.drop $input-stream))
+  (core func $drop-output-stream (canon resource.drop $output-stream))
+  (core func $drop-tcp-socket (canon resource.drop $tcp-socket))
+
+  (core module $test
+    (import "libc" "memory" (memory 0))
+    (import "wasi" "block" (func $block (param i32)))
+    (import "wasi" "read" (func $read (param i32 i64 i32)))
+    (import "wasi" "subscribe-input" (func $subscribe-input (param i32) (result i32)))
+    (import "wasi" "write" (func $write (param i32 i32 i32 i32)))
+    (import "wasi" "instance-network" (func $instance-network (result i32)))
+    (import "wasi" "create" (func $create (param i32 i32)))
+    (import "wasi" "start-bind" (func $start-bind (param i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32)))
+    (import "wasi" "finish-bind" (func $finish-bind (param i32 i32)))
+    (import "wasi" "start-connect" (func $start-connect (param i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32)))
+    (import "wasi" "finish-connect" (func $finish-connect (param i32 i32)))
+    (import "wasi" "start-listen" (func $start-listen (param i32 i32)))
+    (import "wasi" "finish-listen" (func $finish-listen (param i32 i32)))
+    (import "wasi" "accept" (func $accept (param i32 i32)))
+    (import "wasi" "local-address" (func $local-address (param i32 i32)))
+    (import "wasi" "remote-address" (func $remote-address (param i32 i32)))
+    (import "wasi" "is-listening" (func $is-listening (param i32) (result i32)))
+    (import "wasi" "address-family" (func $address-family (param i32) (result i32)))
+    (import "wasi" "subscribe" (func $subscribe (param i32) (result i32)))
+    (import "wasi" "shutdown" (func $shutdown (param i32 i32 i32)))
+    (import "wasi" "drop-pollable" (func $drop-pollable (param i32)))
+    (import "wasi" "drop-input-stream" (func $drop-input-stream (param i32)))
+    (import "wasi" "drop-output-stream" (func $drop-output-stream (param i32)))
+    (import "wasi" "drop-tcp-socket" (func $drop-tcp-socket (param i32)))
+
+    (data (i32.const 256) "hello")
+
+    (func $expect (param i32)
+      (if (i32.eqz (local.get 0))
+        (then unreachable))
+    )
+
+    ;; Results are stored at address 0.
+    (func $expect-ok
+      (call $expect (i32.eqz (i32.load8_u (i32.const 0))))
+    )
+
+    ;; Checks the error of a result<_, error-code>.
+    (func $expect-error (param $code i32)
+      (call $expect (i32.eq (i32.load8_u (i32.const 0)) (i32.const 1)))
+      (call $expect (i32.eq (i32.load8_u (i32.const 1)) (local.get $code)))
+    )
+
+    ;; Checks the error of a result with a payload aligned to 4 bytes.
+    (func $expect-error4 (param $code i32)
+      (call $expect (i32.eq (i32.load8_u (i32.const 0)) (i32.const 1)))
+      (call $expect (i32.eq (i32.load8_u (i32.const 4)) (local.get $code)))
+    )
+
+    (func $wait (param $pollable i32)
+      (call $block (local.get $pollable))
+      (call $drop-pollable (local.get $pollable))
+    )
+
+    (func $create-ipv4 (result i32)
+      (call $create (i32.const 0) (i32.const 0))
+      (call $expect-ok)
+      (i32.load (i32.const 4))
+    )
+
+    ;; Calls start-bind or start-connect with 127.0.0.1:port.
+    (func $bind-loopback (param $socket i32) (param $network i32) (param $port i32)
+      (call $start-bind (local.get $socket) (local.get $network)
+        (i32.const 0) (local.get $port) (i32.const 127) (i32.const 0) (i32.const 0) (i32.const 1)
+        (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0)
+        (i32.const 0))
+    )
+
+    (func $connect-loopback (param $socket i32) (param $network i32) (param $port i32)
+      (call $start-connect (local.get $socket) (local.get $network)
+        (i32.const 0) (local.get $port) (i32.const 127) (i32.const 0) (i32.const 0) (i32.const 1)
+        (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0)
+        (i32.const 0))
+    )
+
+    ;; Returns with the port of a 127.0.0.1 address.
+    (func $loopback-port (result i32)
+      (call $expect-ok)
+      (call $expect (i32.eqz (i32.load8_u (i32.const 4))))
+      (call $expect (i32.eq (i32.load (i32.const 10)) (i32.const 0x0100007f)))
+      (i32.load16_u (i32.const 8))
+    )
+
+    (func (export "run")
+      (local $network i32)
+      (local $server i32)
+      (local $client i32)
+      (local $connection i32)
+      (local $port i32)
+      (local $server-input i32)
+      (local $server-output i32)
+      (local $client-input i32)
+      (local $client-output i32)
+
+      (local.set $network (call $instance-network))
+      (local.set $server (call $create-ipv4))
+      (call $expect (i32.eqz (call $address-family (local.get $server))))
+      (call $expect (i32.eqz (call $is-listening (local.get $server))))
+
+      ;; Operations which are not valid in the unbound state.
+      (call $finish-bind (local.get $server) (i32.const 0))
+      (call $expect-error (i32.const 7)) ;; not-in-progress
+      (call $start-listen (local.get $server) (i32.const 0))
+      (call $expect-error (i32.const 9)) ;; invalid-state
+      (call $local-address (local.get $server) (i32.const 0))
+      (call $expect-error4 (i32.const 9)) ;; invalid-state
+
+      ;; An IPv6 address cannot be bound to an IPv4 socket.
+      (call $start-bind (local.get $server) (local.get $network)
+        (i32.const 1) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0)
+        (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 0) (i32.const 1) (i32.const 0)
+        (i32.const 0))
+      (call $expect-error (i32.const 3)) ;; invalid-argument
+
+      ;; The system picks a free port.
+      (call $bind-loopback (local.get $server) (local.get $network) (i32.const 0))
+      (call $expect-ok)
+      (call $finish-bind (local.get $server) (i32.const 0))
+      (call $expect-ok)
+      (call $bind-loopback (local.get $server) (local.get $network) (i32.const 0))
+      (call $expect-error (i32.const 9)) ;; invalid-state
+      (call $start-listen (local.get $server) (i32.const 0))
+      (call $expect-ok)
+      (call $finish-listen (local.get $server) (i32.const 0))
+      (call $expect-ok)
+      (call $expect (call $is-listening (local.get $server)))
+
+      (call $local-address (local.get $server) (i32.const 0))
+      (local.set $port (call $loopback-port))
+      (call $expect (i32.ne (local.get $port) (i32.const 0)))
+
+      ;; Accept does not block when no client is waiting.
+      (call $accept (local.get $server) (i32.const 0))
+      (call $expect-error4 (i32.const 8)) ;; would-block
+
+      (local.set $client (call $create-ipv4))
+      (call $finish-connect (local.get $client) (i32.const 0))
+      (call $expect-error4 (i32.const 7)) ;; not-in-progress
+      (call $connect-loopback (local.get $client) (local.get $network) (local.get $port))
+      (call $expect-ok)
+
+      (call $wait (call $subscribe (local.get $server)))
+      (call $accept (local.get $server) (i32.const 0))
+      (call $expect-ok)
+      (local.set $connection (i32.load (i32.const 4)))
+      (local.set $server-input (i32.load (i32.const 8)))
+      (local.set $server-output (i32.load (i32.const 12)))
+
+      (call $wait (call $subscribe (local.get $client)))
+      (call $finish-connect (local.get $client) (i32.const 0))
+      (call $expect-ok)
+      (local.set $client-input (i32.load (i32.const 4)))
+      (local.set $client-output (i32.load (i32.const 8)))
+
+      (call $remote-address (local.get $client) (i32.const 0))
+      (call $expect (i32.eq (call $loopback-port) (local.get $port)))
+      (call $remote-address (local.get $server) (i32.const 0))
+      (call $expect-error4 (i32.const 9)) ;; invalid-state
+
+      ;; Reading does not block when no data is available.
+      (call $read (local.get $server-input) (i64.const 100) (i32.const 0))
+      (call $expect-ok)
+      (call $expect (i32.eqz (i32.load (i32.const 8))))
+
+      (call $write (local.get $client-output) (i32.const 256) (i32.const 5) (i32.const 0))
+      (call $expect-ok)
+      (call $wait (call $subscribe-input (local.get $server-input)))
+      (call $read (local.get $server-input) (i64.const 100) (i32.const 0))
+      (call $expect-ok)
+      (call $expect (i32.eq (i32.load (i32.const 8)) (i32.const 5)))
+      (call $expect (i32.eq (i32.load (i32.load (i32.const 4))) (i32.load (i32.const 256))))
+
+      ;; The other direction.
+      (call $write (local.get $server-output) (i32.const 257) (i32.const 4) (i32.const 0))
+      (call $expect-ok)
+      (call $wait (call $subscribe-input (local.get $client-input)))
+      (call $read (local.get $client-input) (i64.const 100) (i32.const 0))
+      (call $expect-ok)
+      (call $expect (i32.eq (i32.load (i32.const 8)) (i32.const 4)))
+      (call $expect (i32.eq (i32.load (i32.load (i32.const 4))) (i32.load (i32.const 257))))
+
+      ;; The server input stream is closed after the client stops sending.
+      (call $shutdown (local.get $client) (i32.const 1) (i32.const 0))
+      (call $expect-ok)
+      (call $wait (call $subscribe-input (local.get $server-input)))
+      (call $read (local.get $server-input) (i64.const 100) (i32.const 0))
+      (call $expect (i32.eq (i32.load8_u (i32.const 0)) (i32.const 1)))
+      (call $expect (i32.eq (i32.load8_u (i32.const 4)) (i32.const 1))) ;; closed
+
+      (call $drop-input-stream (local.get $server-input))
+      (call $drop-output-stream (local.get $server-output))
+      (call $drop-tcp-socket (local.get $connection))
+      (call $drop-input-stream (local.get $client-input))
+      (call $drop-output-stream (local.get $client-output))
+      (call $drop-tcp-socket (local.get $client))
+      (call $drop-tcp-socket (local.get $server))
+    )
+  )
+  (core instance $test (instantiate $test
+    (with "libc" (instance $libc))
+    (with "wasi" (instance
+      (export "block" (func $block))
+      (export "read" (func $read))
+      (export "subscribe-input" (func $subscribe-input))
+      (export "write" (func $write))
+      (export "instance-network" (func $instance-network))
+      (export "create" (func $create))
+      (export "start-bind" (func $start-bind))
+      (export "finish-bind" (func $finish-bind))
+      (export "start-connect" (func $start-connect))
+      (export "finish-connect" (func $finish-connect))
+      (export "start-listen" (func $start-listen))
+      (export "finish-listen" (func $finish-listen))
+      (export "accept" (func $accept))
+      (export "local-address" (func $local-address))
+      (export "remote-address" (func $remote-address))
+      (export "is-listening" (func $is-listening))
+      (export "address-family" (func $address-family))
+      (export "subscribe" (func $subscribe))
+      (export "shutdown" (func $shutdown))
+      (export "drop-pollable" (func $drop-pollable))
+      (export "drop-input-stream" (func $drop-input-stream))
+      (export "drop-output-stream" (func $drop-output-stream))
+      (export "drop-tcp-socket" (func $drop-tcp-socket))
+    ))
+  ))
+  (alias core export $test "run" (core func $core-run))
+  (func $run (canon lift (core func $core-run)))
+  (export "run" (func $run))
+)
@@ -142,8 +142,9 @@ def parse_args():
                       action="store_true", default=False)
   parser.add_argument(
       "--results",
-      choices=["i", "j", "n", "j2i", "i2j", "n2j", "j2n", "n2i", "i2n"],
-      help="Type of results to show, seperated by spaces, default: i j n",
+      choices=["i", "j", "n", "l", "j2i", "i2j", "n2j", "j2n", "n2i", "i2n", "l2j", "j2l"],
+      help="Type of results to show, seperated by spaces, default: i j n"
+      " (l: JIT with the linear scan register allocator)",
       nargs="*",
       default=["i", "j", "n"],
   )
@@ -186,6 +187,14 @@ def parse_args():
       "j2n" in args.results) in args.results and "n" not in args.results:
     args.results.append("n")
 
+  if ("l2j" in args.results or
+      "j2l" in args.results) and "j" not in args.results:
+    args.results.append("j")
+
+  if ("l2j" in args.results or
+      "j2l" in args.results) and "l" not in args.results:
+    args.results.append("l")
+
   if args.no_time and not args.mem:
     raise Exception("You couldn't use --no-time without --mem")
 
@@ -304,14 +313,20 @@ def compile_tests(emcc_path, path, only_game, only_simd, compile_anyway, run,
   return test_names
 
 
-def run_wasm(engine, path, test_name, jit, jit_no_reg_alloc):
+def jit_flags(engine, jit, jit_no_reg_alloc, jit_linear_scan):
+  flags = " --jit" if ((jit or jit_no_reg_alloc or jit_linear_scan) and
+                       "walrus" in engine) else ""
+  flags += " --jit-no-reg-alloc" if jit_no_reg_alloc else ""
+  flags += " --jit-linear-scan" if jit_linear_scan else ""
+  return flags
+
+
+def run_wasm(engine, path, test_name, jit, jit_no_reg_alloc, jit_linear_scan):
   if not os.path.exists(path):
     raise Exception(f"Invalid path for run: {path}")
 
   tc_path = f"{path}/wasm/{test_name}.wasm"
-  flags = " --jit" if ((jit or jit_no_reg_alloc) and
-                       "walrus" in engine) else ""
-  flags += " --jit-no-reg-alloc" if jit_no_reg_alloc else ""
+  flags = jit_flags(engine, jit, jit_no_reg_alloc, jit_linear_scan)
 
   result = subprocess.check_output(f"{engine} {flags} {tc_path}", shell=True)
 
@@ -323,22 +338,21 @@ def run_wasm(engine, path, test_name, jit, jit_no_reg_alloc):
     raise Exception(message)
 
 
-def measure_time(path, name, function, engine, jit, jit_no_reg_alloc):
+def measure_time(path, name, function, engine, jit, jit_no_reg_alloc,
+                 jit_linear_scan):
   start_time = time.perf_counter_ns()
-  function(engine, path, name, jit, jit_no_reg_alloc)
+  function(engine, path, name, jit, jit_no_reg_alloc, jit_linear_scan)
   end_time = time.perf_counter_ns()
   return end_time - start_time
 
 
-def measure_memory(path, name, engine, jit, jit_no_reg_alloc):
+def measure_memory(path, name, engine, jit, jit_no_reg_alloc, jit_linear_scan):
   if not os.path.exists(path):
     raise Exception(f"Invalid path for run: {path}")
 
   mem_tool = "/usr/bin/time -f %M"
   tc_path = f"{path}/wasm/{name}.wasm"
-  flags = " --jit" if ((jit or jit_no_reg_alloc) and
-                       "walrus" in engine) else ""
-  flags += " --jit-no-reg-alloc" if jit_no_reg_alloc else ""
+  flags = jit_flags(engine, jit, jit_no_reg_alloc, jit_linear_scan)
   run_cmd = f"{mem_tool} {engine} {flags} {tc_path}"
 
   outputs = subprocess.check_output(run_cmd, shell=True,
@@ -358,6 +372,7 @@ def run_tests(
     no_time,
     jit,
     jit_no_reg_alloc,
+    jit_linear_scan,
     interpreter,
     verbose,
 ):
@@ -372,6 +387,7 @@ def run_tests(
           "path": engine,
           "jit": False,
           "jit_no_reg_alloc": False,
+          "jit_linear_scan": False,
       })
 
     if jit:
@@ -380,6 +396,7 @@ def run_tests(
           "path": engine,
           "jit": True,
           "jit_no_reg_alloc": False,
+          "jit_linear_scan": False,
       })
 
     if jit_no_reg_alloc:
@@ -388,6 +405,16 @@ def run_tests(
           "path": engine,
           "jit": True,
           "jit_no_reg_alloc": True,
+          "jit_linear_scan": False,
+      })
+
+    if jit_linear_scan:
+      _engines.append({
+          "name": f"{engine_display_name(engine)} JIT_LINEAR_SCAN",
+          "path": engine,
+          "jit": True,
+          "jit_no_reg_alloc": False,
+          "jit_linear_scan": True,
       })
 
   for name in test_names:
@@ -421,6 +448,7 @@ def run_tests(
                     engine["path"],
                     engine["jit"],
                     engine["jit_no_reg_alloc"],
+                    engine["jit_linear_scan"],
                 ))
           if mem:
             mem_results[engine["name"]].append(
@@ -430,6 +458,7 @@ def run_tests(
                     engine["path"],
                     engine["jit"],
                     engine["jit_no_reg_alloc"],
+                    engine["jit_linear_scan"],
                 ))
         except Exception as e:
           errorList.append(f"{name} {engine['name']} {e}")
@@ -545,10 +574,13 @@ def compare(
     interpreter_to_jit,
     interpreter_to_jit_no_reg_alloc,
     jit_to_jit_no_reg_alloc,
+    jit_linear_scan_to_jit,
+    jit_to_jit_linear_scan,
 ):
   if (not jit_to_interpreter and not jit_no_reg_alloc_to_interpreter and
       not jit_no_reg_alloc_to_jit and not interpreter_to_jit and
-      not interpreter_to_jit_no_reg_alloc and not jit_to_jit_no_reg_alloc):
+      not interpreter_to_jit_no_reg_alloc and not jit_to_jit_no_reg_alloc and
+      not jit_linear_scan_to_jit and not jit_to_jit_linear_scan):
     return
   for i in range(len(data)):
     test = data[i]["test"]
@@ -597,6 +629,22 @@ def compare(
             f"{jit} ({'{:.2f}'.format(-1 if float(jit) < 0 or float(jit_no_reg_alloc) < 0 else float(jit_no_reg_alloc) / float(jit))}x)"
         )
 
+      if jit_linear_scan_to_jit:
+        jit_linear_scan = data[i][
+            f"{engine_display_name(engine)} JIT_LINEAR_SCAN"]
+        jit = data[i][f"{engine_display_name(engine)} JIT"]
+        data[i][f"{engine_display_name(engine)} JIT/JIT_LINEAR_SCAN"] = (
+            f"{jit_linear_scan} ({'{:.2f}'.format(-1 if float(jit) < 0 or float(jit_linear_scan) < 0 else float(jit) / float(jit_linear_scan))}x)"
+        )
+
+      if jit_to_jit_linear_scan:
+        jit = data[i][f"{engine_display_name(engine)} JIT"]
+        jit_linear_scan = data[i][
+            f"{engine_display_name(engine)} JIT_LINEAR_SCAN"]
+        data[i][f"{engine_display_name(engine)} JIT_LINEAR_SCAN/JIT"] = (
+            f"{jit} ({'{:.2f}'.format(-1 if float(jit) < 0 or float(jit_linear_scan) < 0 else float(jit_linear_scan) / float(jit))}x)"
+        )
+
 
 def orderData(data, engines, orig_results):
   orderedData = list()
@@ -615,6 +663,16 @@ def orderData(data, engines, orig_results):
           record[engine_display_name(engine) +
                  " JIT_NO_REG_ALLOC"] = test[engine_display_name(engine) +
                                              " JIT_NO_REG_ALLOC"]
+        elif result == "l":
+          record[engine_display_name(engine) +
+                 " JIT_LINEAR_SCAN"] = test[engine_display_name(engine) +
+                                            " JIT_LINEAR_SCAN"]
+        elif result == "l2j":
+          record[engine_display_name(engine) + " JIT/JIT_LINEAR_SCAN"] = (
+              test[engine_display_name(engine) + " JIT/JIT_LINEAR_SCAN"])
+        elif result == "j2l":
+          record[engine_display_name(engine) + " JIT_LINEAR_SCAN/JIT"] = (
+              test[engine_display_name(engine) + " JIT_LINEAR_SCAN/JIT"])
         elif result == "j2i":
           record[engine_display_name(engine) +
                  " INTERPRETER/JIT"] = test[engine_display_name(engine) +
@@ -719,6 +777,7 @@ def main():
       args.no_time,
       "j" in args.results,
       "n" in args.results,
+      "l" in args.results,
       "i" in args.results,
       args.verbose,
   )
@@ -732,6 +791,8 @@ def main():
         "i2j" in args.results,
         "i2n" in args.results,
         "j2n" in args.results,
+        "l2j" in args.results,
+        "j2l" in args.results,
     )
     result_data["time"] = orderData(result_data["time"], args.engines,
                                     args.orig_results)
@@ -748,6 +809,8 @@ def main():
         "i2j" in args.results,
         "i2n" in args.results,
         "j2n" in args.results,
+        "l2j" in args.results,
+        "j2l" in args.results,
     )
     result_data["mem"] = orderData(result_data["mem"], args.engines,
                                    args.orig_results)
@@ -0,0 +1,83 @@
+;; References passed by a tail call to a function with a larger frame
+;; are kept in a heap allocated frame buffer, which must be marked by
+;; the collector.
+(module
+  (type $pair (struct (field (mut i32)) (field (mut i32))))
+  (type $list (struct (field i32) (field (ref null $list))))
+
+  (func $build (param $n i32) (result (ref null $list))
+    (local $list (ref null $list))
+    (block $done
+      (loop $l
+        local.get $n
+        i32.eqz
+        br_if $done
+        local.get $n
+        i32.const 1
+        i32.sub
+        local.tee $n
+        local.get $list
+        struct.new $list
+        local.set $list
+        br $l
+      )
+    )
+    local.get $list
+  )
+
+  (func $sum (param $list (ref null $list)) (result i32)
+    (local $sum i32)
+    (block $done
+      (loop $l
+        local.get $list
+        ref.is_null
+        br_if $done
+        local.get $sum
+        local.get $list
+        struct.get $list 0
+        i32.add
+        local.set $sum
+        local.get $list
+        struct.get $list 1
+        local.set $list
+        br $l
+      )
+    )
+    local.get $sum
+  )
+
+  (func $churn (param $list (ref null $list)) (param $pair (ref null $pair)) (param $count i32) (result i32)
+    (local i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64 i64)
+    ;; Allocates garbage until several collections run.
+    (loop $l
+      i32.const 100
+      call $build
+      drop
+      local.get $count
+      i32.const 1
+      i32.sub
+      local.tee $count
+      br_if $l
+    )
+    local.get $list
+    call $sum
+    local.get $pair
+    struct.get $pair 0
+    i32.add
+    local.get $pair
+    struct.get $pair 1
+    i32.add
+  )
+
+  (func (export "run") (param $count i32) (result i32)
+    i32.const 1000
+    call $build
+    i32.const 7
+    i32.const 8
+    struct.new $pair
+    local.get $count
+    return_call $churn
+  )
+)
+
+(assert_return (invoke "run" (i32.const 5000)) (i32.const 499515))
@@ -0,0 +1,148 @@
+(module
+  (type $mixed (struct (field i8) (field (mut i16)) (field i32) (field i64) (field f32) (field f64) (field (ref null $mixed))))
+  (type $pair (struct (field (mut i32)) (field (mut i32))))
+  (type $list (struct (field i32) (field (ref null $list))))
+  (type $refs (array (ref null $pair)))
+  (type $big (struct (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64)
+                     (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64)
+                     (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64)
+                     (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64) (field i64)))
+
+  (func $mixed (param i32 i64 f32 f64) (result (ref null $mixed))
+    local.get 0
+    local.get 0
+    local.get 0
+    local.get 1
+    local.get 2
+    local.get 3
+    ref.null $mixed
+    struct.new $mixed
+  )
+
+  (func (export "mixed") (param i32 i64 f32 f64) (result i32 i32 i32 i64 f32 f64 i32)
+    (local (ref $mixed))
+    local.get 0
+    local.get 0
+    local.get 0
+    local.get 1
+    local.get 2
+    local.get 3
+    local.get 0
+    local.get 1
+    local.get 2
+    local.get 3
+    call $mixed
+    struct.new $mixed
+    local.tee 4
+    struct.get_s $mixed 0
+    local.get 4
+    struct.get_u $mixed 1
+    local.get 4
+    struct.get $mixed 2
+    local.get 4
+    struct.get $mixed 3
+    local.get 4
+    struct.get $mixed 4
+    local.get 4
+    struct.get $mixed 5
+    local.get 4
+    struct.get $mixed 6
+    struct.get $mixed 2
+  )
+
+  (func (export "default") (result i32)
+    (local (ref $pair))
+    struct.new_default $pair
+    local.tee 0
+    struct.get $pair 0
+    local.get 0
+    struct.get $pair 1
+    i32.or
+  )
+
+  (func (export "big") (param i64) (result i64)
+    (local (ref $big))
+    struct.new_default $big
+    local.set 1
+    local.get 0
+    local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0
+    local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0
+    local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0
+    local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0 local.get 0
+    struct.new $big
+    struct.get $big 31
+    local.get 1
+    struct.get $big 0
+    i64.add
+  )
+
+  ;; allocates enough objects to refill the free lists several times
+  (func (export "list") (param i32) (result i32)
+    (local (ref null $list) i32)
+    (block $done
+      (loop $l
+        local.get 0
+        i32.eqz
+        br_if $done
+        local.get 0
+        local.get 1
+        struct.new $list
+        local.set 1
+        local.get 0
+        i32.const 1
+        i32.sub
+        local.set 0
+        br $l
+      )
+    )
+    (block $done
+      (loop $l
+        local.get 1
+        ref.is_null
+        br_if $done
+        local.get 2
+        local.get 1
+        struct.get $list 0
+        i32.add
+        local.set 2
+        local.get 1
+        struct.get $list 1
+        local.set 1
+        br $l
+      )
+    )
+    local.get 2
+  )
+
+  (func (export "fixed") (param i32 i32) (result i32 i32)
+    (local (ref $refs))
+    local.get 0
+    local.get 1
+    struct.new $pair
+    ref.null $pair
+    local.get 1
+    local.get 0
+    struct.new $pair
+    array.new_fixed $refs 3
+    local.tee 2
+    array.len
+    local.get 2
+    i32.const 2
+    array.get $refs
+    struct.get $pair 0
+    local.get 2
+    i32.const 1
+    array.get $refs
+    ref.is_null
+    i32.const 10
+    i32.mul
+    i32.add
+  )
+)
+
+(assert_return (invoke "mixed" (i32.const 0x1ff80) (i64.const -5) (f32.const 1.5) (f64.const -2.25))
+  (i32.const -128) (i32.const 0xff80) (i32.const 0x1ff80) (i64.const -5) (f32.const 1.5) (f64.const -2.25) (i32.const 0x1ff80))
+(assert_return (invoke "default") (i32.const 0))
+(assert_return (invoke "big" (i64.const 7)) (i64.const 7))
+(assert_return (invoke "list" (i32.const 1000)) (i32.const 500500))
+(assert_return (invoke "fixed" (i32.const 3) (i32.const 4)) (i32.const 3) (i32.const 14))
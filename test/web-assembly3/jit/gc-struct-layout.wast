@@ -0,0 +1,66 @@
+(module
+  (type $a (sub (struct (field (mut i8)) (field (mut i64)) (field (mut i8)) (field (mut i64)))))
+  ;; new fields are packed into the unused space of $a
+  (type $b (sub $a (struct (field (mut i8)) (field (mut i64)) (field (mut i8)) (field (mut i64))
+                           (field (mut i16)) (field (mut i32)) (field (mut i8)))))
+  (type $c (struct (field (mut i8)) (field v128) (field (mut i16)) (field (mut f32)) (field (mut i8)) (field (mut f64))))
+
+  (func $sum (param $o (ref $a)) (result i64)
+    (i64.add
+      (i64.add (i64.extend_i32_u (struct.get_u $a 0 (local.get $o))) (struct.get $a 1 (local.get $o)))
+      (i64.add (i64.extend_i32_s (struct.get_s $a 2 (local.get $o))) (struct.get $a 3 (local.get $o))))
+  )
+
+  (func (export "sub") (result i64)
+    (local $o (ref null $b))
+    (local.set $o (struct.new $b (i32.const 1) (i64.const 2) (i32.const 3) (i64.const 4)
+                                 (i32.const 0x1ffff) (i32.const 6) (i32.const 7)))
+    (struct.set $a 0 (local.get $o) (i32.const 0x1ff))
+    (struct.set $a 2 (local.get $o) (i32.const -1))
+    (struct.set $b 6 (local.get $o) (i32.const 0x80))
+    (i64.add
+      (call $sum (ref.as_non_null (local.get $o)))
+      (i64.add
+        (i64.extend_i32_u (struct.get_u $b 4 (local.get $o)))
+        (i64.add (i64.extend_i32_s (struct.get $b 5 (local.get $o)))
+                 (i64.extend_i32_s (struct.get_s $b 6 (local.get $o))))))
+  )
+
+  (func (export "super") (result i64)
+    (call $sum (struct.new $a (i32.const 10) (i64.const 20) (i32.const 30) (i64.const 40)))
+  )
+
+  (func (export "default") (result i64)
+    (local $o (ref null $b))
+    (local.set $o (struct.new_default $b))
+    (struct.set $b 4 (local.get $o) (i32.const 5))
+    (i64.add
+      (call $sum (ref.as_non_null (local.get $o)))
+      (i64.add
+        (i64.extend_i32_u (struct.get_u $b 4 (local.get $o)))
+        (i64.add (i64.extend_i32_s (struct.get $b 5 (local.get $o)))
+                 (i64.extend_i32_s (struct.get_s $b 6 (local.get $o))))))
+  )
+
+  (func (export "mixed") (result f64)
+    (local $o (ref null $c))
+    (local.set $o (struct.new $c (i32.const 1) (v128.const i64x2 2 3) (i32.const 4)
+                                 (f32.const 5.5) (i32.const 6) (f64.const 7.25)))
+    (struct.set $c 0 (local.get $o) (i32.const 0x102))
+    (struct.set $c 4 (local.get $o) (i32.const 8))
+    (f64.add
+      (f64.add
+        (f64.convert_i32_u (struct.get_u $c 0 (local.get $o)))
+        (f64.convert_i64_u (i64x2.extract_lane 1 (struct.get $c 1 (local.get $o)))))
+      (f64.add
+        (f64.add (f64.convert_i32_u (struct.get_u $c 2 (local.get $o)))
+                 (f64.promote_f32 (struct.get $c 3 (local.get $o))))
+        (f64.add (f64.convert_i32_u (struct.get_u $c 4 (local.get $o)))
+                 (struct.get $c 5 (local.get $o)))))
+  )
+)
+
+(assert_return (invoke "sub") (i64.const 65673))
+(assert_return (invoke "super") (i64.const 100))
+(assert_return (invoke "default") (i64.const 5))
+(assert_return (invoke "mixed") (f64.const 29.75))
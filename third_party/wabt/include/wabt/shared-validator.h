@@ -552,11 +552,6 @@ class SharedComponentValidator {
   void CoreModuleAddMemoryExport(nonstd::string_view name, bool is_64);
   void CoreModuleAddTagExport(nonstd::string_view name);
 
-  // Can be nullptr on error.
-  const CoreFuncType* GetLoweredFunctionType(uint32_t func_index,
-                                             bool is_ptr64,
-                                             uint32_t* out_info);
-
  private:
   enum class TypeDef : uint8_t {
     ValueType,
@@ -955,6 +950,10 @@ class SharedComponentValidator {
   Result CheckCanonOptions(uint32_t option_count,
                            const ComponentCanonOption* options,
                            uint32_t* info);
+  // Can be nullptr on error.
+  const CoreFuncType* GetLoweredFunctionType(TypeBase* func_type,
+                                             bool is_ptr64,
+                                             uint32_t* out_info);
 
   Result CheckExternalInfo(const ComponentExternalInfo& external_info,
                            TypeBase** out_type_base);
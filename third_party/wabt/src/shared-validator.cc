@@ -2602,13 +2602,19 @@ Result SharedComponentValidator::OnCanonLift(
   result |= CheckCanonOptions(option_count, options, &info);
   if (result == Result::Ok) {
     uint32_t lower_info = 0;
-    GetLoweredFunctionType(type_index.index, (info & HasMemory64Option) != 0,
+    GetLoweredFunctionType(type_base, (info & HasMemory64Option) != 0,
                            &lower_info);
     if ((lower_info & RequireMemory) != 0 &&
         (info & (HasMemory32Option | HasMemory64Option)) == 0) {
       result |= PrintError(type_index.loc, "memory option must be present.");
     }
   }
+  // The lifted function has the function type, which is
+  // needed when the function is lowered by another component.
+  if (type_base != nullptr && type_base->IsTypeFunc()) {
+    CurrentAsComponent()->funcs.push_back(type_base);
+    return result;
+  }
   auto type_value = MakeUnique<TypeBase>(TypeDef::Func);
   CurrentAsComponent()->funcs.push_back(type_value.get());
   objects_.push_back(std::move(type_value));
@@ -2625,7 +2631,7 @@ Result SharedComponentValidator::OnCanonLower(
   result |= CheckCanonOptions(option_count, options, &info);
   if (result == Result::Ok) {
     uint32_t lower_info = 0;
-    GetLoweredFunctionType(func_index.index, (info & HasMemory64Option) != 0,
+    GetLoweredFunctionType(func, (info & HasMemory64Option) != 0,
                            &lower_info);
     if ((lower_info & RequireMemory) != 0 &&
         (info & (HasMemory32Option | HasMemory64Option)) == 0) {
@@ -2791,21 +2797,15 @@ void SharedComponentValidator::CoreModuleAddTagExport(nonstd::string_view name)
 }
 
 const SharedComponentValidator::CoreFuncType*
-SharedComponentValidator::GetLoweredFunctionType(uint32_t func_index,
+SharedComponentValidator::GetLoweredFunctionType(TypeBase* func_type,
                                                  bool is_ptr64,
                                                  uint32_t* out_info) {
   *out_info = 0;
-  if ((current_->info_bits & IsObject) == 0) {
-    return nullptr;
-  }
-
-  Component* component = reinterpret_cast<Component*>(current_);
-
-  if (func_index >= component->funcs.size()) {
+  if (func_type == nullptr || !func_type->IsTypeFunc()) {
     return nullptr;
   }
 
-  TypeFunc* func = component->funcs[func_index]->AsTypeFunc();
+  TypeFunc* func = func_type->AsTypeFunc();
 
   if ((func->ltype_status & TypeFunc::LoweredTypeError) != 0) {
     return nullptr;
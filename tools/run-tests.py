@@ -22,13 +22,17 @@ import sys
 import time
 import re
 import fnmatch
+import socket
+import tarfile
+import tempfile
+import threading
 
 from argparse import ArgumentParser
 from difflib import unified_diff
 from glob import glob
 from os.path import abspath, basename, dirname, join, relpath
 from shutil import copy
-from subprocess import PIPE, Popen, run, CalledProcessError
+from subprocess import PIPE, STDOUT, Popen, run, CalledProcessError
 
 
 PROJECT_SOURCE_DIR = dirname(dirname(abspath(__file__)))
@@ -48,6 +52,8 @@ DEFAULT_RUNNERS = []
 JIT_EXCLUDE_FILES = []
 jit = False
 jit_no_reg_alloc = False
+jit_linear_scan = False
+optimize_bytecode = False
 web_assembly3 = False
 
 
@@ -63,17 +69,20 @@ class runner(object):
             DEFAULT_RUNNERS.append(self.suite)
         return fn
 
-def _run_wast_tests(engine, files, is_fail, args=None):
+def _run_wast_tests(engine, files, is_fail, args=None, options=None):
     fails = 0
     for file in files:
-        if jit or jit_no_reg_alloc:
+        if jit or jit_no_reg_alloc or jit_linear_scan:
             filename = os.path.basename(file)
             if filename in JIT_EXCLUDE_FILES:
                 continue
         subprocess_args =  qemu + [engine, "--mapdirs", "./test/wasi", "/var"]
-        if jit or jit_no_reg_alloc: subprocess_args.append("--jit")
+        if jit or jit_no_reg_alloc or jit_linear_scan: subprocess_args.append("--jit")
         if jit_no_reg_alloc: subprocess_args.append("--jit-no-reg-alloc")
+        if jit_linear_scan: subprocess_args.append("--jit-linear-scan")
+        if optimize_bytecode: subprocess_args.append("--optimize-bytecode")
         if web_assembly3: subprocess_args.append("--enable-web-assembly3")
+        if options: subprocess_args.extend(options)
         if args: subprocess_args.append("--args")
         subprocess_args.append(file)
         if args: subprocess_args.extend(args)
@@ -101,6 +110,131 @@ def _run_wast_tests(engine, files, is_fail, args=None):
     return fails
 
 
+def _free_tcp_port():
+    # The port is released before the engine binds it, which is fine for
+    # loopback tests as long as nothing else picks it in the meantime.
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def _tar_entry(name, data, format):
+    info = tarfile.TarInfo(name)
+    info.size = len(data)
+    info.mtime = 1700000000
+    return info.tobuf(format, 'utf-8', 'surrogateescape') + data + b'\0' * (-len(data) % 512)
+
+
+def _run_image_test(engine, file):
+    # The image contains a short name, a name split into the
+    # ustar prefix and name fields, and a GNU long name.
+    image = _tar_entry('data.txt', b'original data\n', tarfile.USTAR_FORMAT)
+    image += _tar_entry('prefix-dir-' + 'a' * 100 + '/ustar.txt', b'ustar prefix\n', tarfile.USTAR_FORMAT)
+    image += _tar_entry('gnu-' + 'b' * 120 + '.txt', b'gnu long name\n', tarfile.GNU_FORMAT)
+    image += b'\0' * 1024
+
+    corrupted = bytearray(image)
+    corrupted[512 * 2 + 100] ^= 1
+
+    fails = 0
+    with tempfile.TemporaryDirectory() as temp_dir:
+        image_path = join(temp_dir, 'image.tar')
+        corrupted_path = join(temp_dir, 'corrupted.tar')
+        with open(image_path, 'wb') as f:
+            f.write(image)
+        with open(corrupted_path, 'wb') as f:
+            f.write(corrupted)
+
+        # Writes must only change the in-memory copy of the archive.
+        proc = Popen(qemu + [engine, "--mapdirs", image_path, "/image", file], stdout=PIPE, stderr=PIPE)
+        out, err = proc.communicate()
+        out = out.decode('utf-8') + err.decode('utf-8')
+        with open(image_path, 'rb') as f:
+            unchanged = f.read() == image
+        if proc.returncode or 'Error' in out or not unchanged:
+            print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+            print(out if unchanged else 'the archive is modified')
+            fails += 1
+        else:
+            print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+
+        proc = Popen(qemu + [engine, "--mapdirs", corrupted_path, "/image", file], stdout=PIPE, stderr=PIPE)
+        out, err = proc.communicate()
+        out = out.decode('utf-8') + err.decode('utf-8')
+        if proc.returncode and 'invalid tar header checksum at offset 1024' in out:
+            print('%sOK: %s (corrupted archive)%s' % (COLOR_GREEN, file, COLOR_RESET))
+        else:
+            print('%sFAIL(%d): %s (corrupted archive)%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+            print(out)
+            fails += 1
+
+    return fails
+
+
+def _run_pipe_test(engine, file):
+    fails = 0
+    with tempfile.TemporaryDirectory() as temp_dir:
+        pipe_path = join(temp_dir, 'data.txt')
+        os.mkfifo(pipe_path)
+
+        def write_pipe():
+            with open(pipe_path, 'wb') as f:
+                f.write(b'original data\n')
+
+        writer = threading.Thread(target=write_pipe)
+        writer.start()
+        proc = Popen(qemu + [engine, "--mapdirs", temp_dir, "/pipe", file], stdout=PIPE, stderr=PIPE)
+        out, err = proc.communicate()
+        out = out.decode('utf-8') + err.decode('utf-8')
+
+        # Unblock the writer if the engine has not opened the pipe.
+        if writer.is_alive():
+            os.close(os.open(pipe_path, os.O_RDONLY | os.O_NONBLOCK))
+        writer.join()
+
+        if proc.returncode or 'Error' in out:
+            print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+            print(out)
+            fails += 1
+        else:
+            print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+
+    return fails
+
+
+# Expected output and exit code of the stream tests.
+STREAM_TESTS = {
+    'stream_order.wast': ('one two three four\nfive\n', 0),
+    'stream_exit.wast': ('buffered\n', 1),
+    'stream_error.wast': ('stderr\n', 0),
+}
+
+
+def _run_stream_test(engine, file):
+    expected_out, expected_returncode = STREAM_TESTS[os.path.basename(file)]
+    with tempfile.TemporaryDirectory() as temp_dir:
+        if os.path.basename(file) == 'stream_error.wast':
+            # Writing a read only file fails.
+            stdout_path = join(temp_dir, 'stdout.txt')
+            open(stdout_path, 'wb').close()
+            with open(stdout_path, 'rb') as stdout:
+                proc = Popen(qemu + [engine, file], stdout=stdout, stderr=PIPE)
+                err = proc.communicate()[1]
+            out = err.decode('utf-8')
+        else:
+            # Both streams are written to the same pipe, so their order is visible.
+            proc = Popen(qemu + [engine, file], stdout=PIPE, stderr=STDOUT)
+            out = proc.communicate()[0].decode('utf-8')
+
+    if proc.returncode != expected_returncode or out != expected_out:
+        print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+        print(out)
+        return 1
+
+    print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+    return 0
+
+
 @runner('basic-tests', default=True)
 def run_basic_tests(engine):
     TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'basic')
@@ -146,12 +280,41 @@ def run_wasi_tests(engine):
     args_tests = glob(join(TEST_DIR, 'args.wast'))
     for item in args_tests:
         xpass.remove(item)
+    tcplisten_tests = glob(join(TEST_DIR, 'sock_accept_nonblock.wast'))
+    for item in tcplisten_tests:
+        xpass.remove(item)
+    image_tests = glob(join(TEST_DIR, 'image_mount.wast'))
+    for item in image_tests:
+        xpass.remove(item)
+    pipe_tests = glob(join(TEST_DIR, 'pipe_read.wast'))
+    for item in pipe_tests:
+        xpass.remove(item)
+    stream_tests = [join(TEST_DIR, name) for name in sorted(STREAM_TESTS)]
+    for item in stream_tests:
+        xpass.remove(item)
+    network_tests = glob(join(TEST_DIR, 'tcp.wast'))
+    for item in network_tests:
+        xpass.remove(item)
+    # Named pipes cannot be created on Windows.
+    if not hasattr(os, 'mkfifo'):
+        pipe_tests = []
+    # WASI 0.2 sockets are only supported on POSIX systems.
+    if os.name == 'nt':
+        network_tests = []
 
     xpass_result = _run_wast_tests(engine, xpass, False)
     xpass_result += _run_wast_tests(engine, args_tests, False,
                                     args=["Hello", "World!", "Lorem ipsum dolor sit amet, consectetur adipiscing elit"])
-
-    tests_total = len(xpass) + len(args_tests)
+    xpass_result += _run_wast_tests(engine, tcplisten_tests, False, options=["--tcplisten", "127.0.0.1:%d" % _free_tcp_port()])
+    for item in image_tests:
+        xpass_result += _run_image_test(engine, item)
+    for item in pipe_tests:
+        xpass_result += _run_pipe_test(engine, item)
+    for item in stream_tests:
+        xpass_result += _run_stream_test(engine, item)
+    xpass_result += _run_wast_tests(engine, network_tests, False, options=["--inherit-network"])
+
+    tests_total = len(xpass) + len(args_tests) + len(tcplisten_tests) + 2 * len(image_tests) + len(pipe_tests) + len(stream_tests) + len(network_tests)
     fail_total = xpass_result
     print('TOTAL: %d' % (tests_total))
     print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fail_total, COLOR_RESET))
@@ -160,6 +323,47 @@ def run_wasi_tests(engine):
     if fail_total > 0:
         raise Exception("basic wasi tests failed")
 
+@runner('gc-options', default=True)
+def run_gc_options_tests(engine):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'gc-options')
+
+    print('Running gc-options tests:')
+    file = join(TEST_DIR, 'allocate.wast')
+    gc_options = ["--gc-markers", "1", "--gc-free-space-divisor", "4", "--gc-initial-heap", "1M", "--gc-max-heap", "1G"]
+    # Each test is a tuple of (extra options, expected output pattern, expected failure).
+    tests = [
+        (["--gc-stats"], r'GC collections: \d+\n.*GC bytes allocated by the process: [1-9]\d*\nGC heap size: [1-9]\d*\nGC recursive types: [1-9]\d*\n', False),
+        (["--gc-incremental", "--gc-stats"], r'GC pause time: total \d+us, max \d+us\n    < 1ms: \d+\n', False),
+        (["--gc-generational", "--gc-stats"], r'    >= 64ms: \d+\n', False),
+        (["--gc-max-heap", "1X"], r'error: invalid argument for --gc-max-heap: 1X', True),
+        (["--gc-markers"], r'error: --gc-markers requires an argument', True),
+    ]
+
+    fail_total = 0
+    for extra_options, pattern, is_fail in tests:
+        subprocess_args = qemu + [engine, "--enable-web-assembly3"] + gc_options + extra_options
+        if not is_fail:
+            subprocess_args.append(file)
+        proc = Popen(subprocess_args, stdout=PIPE, stderr=PIPE)
+        out, err = proc.communicate()
+        out = out.decode('utf-8') + err.decode('utf-8')
+        name = '%s %s' % (file, ' '.join(extra_options))
+
+        if bool(proc.returncode) == is_fail and re.search(pattern, out, re.DOTALL):
+            print('%sOK: %s%s' % (COLOR_GREEN, name, COLOR_RESET))
+        else:
+            print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, name, COLOR_RESET))
+            print(out)
+            fail_total += 1
+
+    tests_total = len(tests)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fail_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("gc-options tests failed")
+
 @runner('jit', default=True)
 def run_jit_tests(engine):
     TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'jit')
@@ -214,6 +418,42 @@ def run_extended_tests(engine):
     if fail_total > 0:
         raise Exception("wasm-test-web-assembly3 failed")
 
+@runner('component', default=True)
+def run_component_tests(engine):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'component')
+
+    print('Running component tests:')
+    xpass = glob(join(TEST_DIR, '*.wast'))
+    # The xfail tests must trap with the given error message.
+    xfail = {
+        'transcoding_invalid_utf8.wast': 'Error: Invalid UTF8 string',
+        'transcoding_lone_surrogate.wast': 'Error: Invalid UTF16 string',
+    }
+    xfail_files = [join(TEST_DIR, name) for name in sorted(xfail)]
+    for item in xfail_files:
+        xpass.remove(item)
+
+    fail_total = _run_wast_tests(engine, xpass, False)
+    for file in xfail_files:
+        proc = Popen(qemu + [engine, file], stdout=PIPE, stderr=PIPE)
+        out, err = proc.communicate()
+        out = out.decode('utf-8') + err.decode('utf-8')
+
+        if proc.returncode and xfail[basename(file)] in out:
+            print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+        else:
+            print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+            print(out)
+            fail_total += 1
+
+    tests_total = len(xpass) + len(xfail_files)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fail_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("component tests failed")
+
 def main():
     parser = ArgumentParser(description='Walrus Test Suite Runner')
     parser.add_argument('--engine', metavar='PATH', default=DEFAULT_WALRUS,
@@ -223,6 +463,8 @@ def main():
                         help='test suite to run (%s; default: %s)' % (', '.join(sorted(RUNNERS.keys())), ' '.join(sorted(DEFAULT_RUNNERS))))
     parser.add_argument('--jit', action='store_true', help='test with JIT')
     parser.add_argument('--jit-no-reg-alloc', action='store_true', help='test with JIT without register allocation')
+    parser.add_argument('--jit-linear-scan', action='store_true', help='test with JIT using the linear scan register allocator')
+    parser.add_argument('--optimize-bytecode', action='store_true', help='test with byte code optimization')
     args = parser.parse_args()
     global jit
     jit = args.jit
@@ -230,13 +472,22 @@ def main():
     global jit_no_reg_alloc
     jit_no_reg_alloc = args.jit_no_reg_alloc
 
+    global jit_linear_scan
+    jit_linear_scan = args.jit_linear_scan
+
+    global optimize_bytecode
+    optimize_bytecode = args.optimize_bytecode
+
     global qemu
     qemu = [args.qemu] if args.qemu else []
 
     if jit and jit_no_reg_alloc:
         parser.error('jit and jit-no-reg-alloc cannot be used together')
 
-    if jit or jit_no_reg_alloc:
+    if jit_no_reg_alloc and jit_linear_scan:
+        parser.error('jit-no-reg-alloc and jit-linear-scan cannot be used together')
+
+    if jit or jit_no_reg_alloc or jit_linear_scan:
         exclude_list_file = join(PROJECT_SOURCE_DIR, 'tools', 'jit_exclude_list.txt')
         with open(exclude_list_file) as f:
             global JIT_EXCLUDE_FILES
@@ -251,7 +502,9 @@ def main():
 
     for suite in args.suite:
         text = ""
-        if jit:
+        if jit_linear_scan:
+            text = " with jit using linear scan register allocation"
+        elif jit:
             text = " with jit"
         elif jit_no_reg_alloc:
             text = " with jit without register allocation"